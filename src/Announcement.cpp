@@ -0,0 +1,387 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Announcement.h"
+
+#include "Log.h"
+#include "SdCard.h"
+
+#include <FSImpl.h>
+
+namespace {
+#if (LANGUAGE == DE)
+constexpr char Announcement_Language[] = "de";
+#elif (LANGUAGE == FR)
+constexpr char Announcement_Language[] = "fr";
+#else
+constexpr char Announcement_Language[] = "en";
+#endif
+constexpr uint8_t Announcement_HeaderSize = 44;
+
+struct AnnouncementFormat {
+	uint16_t channels = 0;
+	uint32_t sampleRate = 0;
+	uint16_t bitsPerSample = 0;
+
+	bool operator==(const AnnouncementFormat &other) const {
+		return channels == other.channels && sampleRate == other.sampleRate && bitsPerSample == other.bitsPerSample;
+	}
+};
+
+// PCM-data of a clip and where it starts within the virtual file
+struct AnnouncementSegment {
+	String path;
+	uint32_t dataOffset = 0; // within the clip
+	uint32_t length = 0;
+	uint32_t start = 0; // within the virtual file
+};
+
+std::vector<AnnouncementSegment> Announcement_Segments;
+uint8_t Announcement_Header[Announcement_HeaderSize];
+
+String Announcement_ClipPath(const String &clip) {
+	String path = ANNOUNCEMENT_CLIP_DIR;
+	path.concat('/');
+	path.concat(Announcement_Language);
+	path.concat('/');
+	path.concat(clip);
+	path.concat(".wav");
+	return path;
+}
+
+bool Announcement_ClipExists(const String &clip) {
+	return gFSystem.exists(Announcement_ClipPath(clip));
+}
+
+void Announcement_AppendNumber(std::vector<String> &clips, uint8_t number, const AnnouncementClipAvailable &available) {
+	const String clip(number);
+	if (number < 10 || available(clip)) {
+		clips.push_back(clip);
+		return;
+	}
+	for (uint8_t i = 0; i < clip.length(); i++) {
+		clips.push_back(String(clip[i]));
+	}
+}
+
+uint16_t Announcement_Get16(const uint8_t *p) {
+	return p[0] | (p[1] << 8);
+}
+
+uint32_t Announcement_Get32(const uint8_t *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24);
+}
+
+void Announcement_Put16(uint8_t *p, uint16_t value) {
+	p[0] = value;
+	p[1] = value >> 8;
+}
+
+void Announcement_Put32(uint8_t *p, uint32_t value) {
+	Announcement_Put16(p, value);
+	Announcement_Put16(p + 2, value >> 16);
+}
+
+// Walks the RIFF-chunks of a clip up to its data-chunk
+bool Announcement_ParseClip(File &file, AnnouncementFormat &format, AnnouncementSegment &segment) {
+	uint8_t buffer[16];
+	if (file.read(buffer, 12) != 12 || memcmp(buffer, "RIFF", 4) != 0 || memcmp(buffer + 8, "WAVE", 4) != 0) {
+		return false;
+	}
+	bool hasFormat = false;
+	while (file.read(buffer, 8) == 8) {
+		const uint32_t chunkSize = Announcement_Get32(buffer + 4);
+		const uint32_t chunkEnd = file.position() + chunkSize + (chunkSize & 1); // chunks are padded to even size
+		if (memcmp(buffer, "fmt ", 4) == 0) {
+			if (chunkSize < 16 || file.read(buffer, 16) != 16 || Announcement_Get16(buffer) != 1) {
+				return false; // PCM only
+			}
+			format.channels = Announcement_Get16(buffer + 2);
+			format.sampleRate = Announcement_Get32(buffer + 4);
+			format.bitsPerSample = Announcement_Get16(buffer + 14);
+			hasFormat = true;
+		} else if (memcmp(buffer, "data", 4) == 0) {
+			const uint16_t blockAlign = format.channels * format.bitsPerSample / 8;
+			if (!hasFormat || blockAlign == 0) {
+				return false;
+			}
+			segment.dataOffset = file.position();
+			segment.length = std::min<uint32_t>(chunkSize, file.size() - segment.dataOffset);
+			segment.length -= segment.length % blockAlign; // a partial frame would shift the channels of all following clips
+			return true;
+		}
+		if (!file.seek(chunkEnd)) {
+			return false;
+		}
+	}
+	return false;
+}
+
+void Announcement_BuildHeader(const AnnouncementFormat &format, uint32_t dataSize) {
+	uint8_t *p = Announcement_Header;
+	const uint16_t blockAlign = format.channels * format.bitsPerSample / 8;
+	memcpy(p, "RIFF", 4);
+	Announcement_Put32(p + 4, Announcement_HeaderSize - 8 + dataSize);
+	memcpy(p + 8, "WAVEfmt ", 8);
+	Announcement_Put32(p + 16, 16);
+	Announcement_Put16(p + 20, 1);
+	Announcement_Put16(p + 22, format.channels);
+	Announcement_Put32(p + 24, format.sampleRate);
+	Announcement_Put32(p + 28, format.sampleRate * blockAlign);
+	Announcement_Put16(p + 32, blockAlign);
+	Announcement_Put16(p + 34, format.bitsPerSample);
+	memcpy(p + 36, "data", 4);
+	Announcement_Put32(p + 40, dataSize);
+}
+
+bool Announcement_Prepare(const std::vector<String> &clips) {
+	std::vector<AnnouncementSegment> segments;
+	AnnouncementFormat format;
+	uint32_t dataSize = 0;
+	for (const String &clip : clips) {
+		AnnouncementSegment segment;
+		AnnouncementFormat clipFormat;
+		segment.path = Announcement_ClipPath(clip);
+		File file = gFSystem.open(segment.path, FILE_READ);
+		const bool valid = file && Announcement_ParseClip(file, clipFormat, segment);
+		file.close();
+		if (!valid || (!segments.empty() && !(clipFormat == format))) {
+			Log_Printf(LOGLEVEL_DEBUG, "Announcement: clip %s is missing or differs in format", segment.path.c_str());
+			return false;
+		}
+		format = clipFormat;
+		segment.start = dataSize;
+		dataSize += segment.length;
+		segments.push_back(segment);
+	}
+	if (segments.empty()) {
+		return false;
+	}
+	Announcement_Segments = std::move(segments);
+	Announcement_BuildHeader(format, dataSize);
+	return true;
+}
+
+// Read-only concatenation of the generated header and the data-chunks of the clips. Only one
+// clip is open at a time; it's switched when reading crosses a segment-border.
+class AnnouncementFileImpl : public fs::FileImpl {
+public:
+	AnnouncementFileImpl(const std::vector<AnnouncementSegment> &segments, const uint8_t *header)
+		: segments_(segments) {
+		memcpy(header_, header, sizeof(header_));
+		size_ = Announcement_HeaderSize + (segments_.empty() ? 0 : segments_.back().start + segments_.back().length);
+	}
+
+	size_t write(const uint8_t *, size_t) override {
+		return 0;
+	}
+
+	size_t read(uint8_t *buf, size_t size) override {
+		size_t done = 0;
+		while (done < size && position_ < size_) {
+			size_t bytesThisRound;
+			if (position_ < Announcement_HeaderSize) {
+				bytesThisRound = std::min<size_t>(size - done, Announcement_HeaderSize - position_);
+				memcpy(buf + done, header_ + position_, bytesThisRound);
+			} else {
+				const uint32_t dataPosition = position_ - Announcement_HeaderSize;
+				const AnnouncementSegment &segment = segments_[findSegment(dataPosition)];
+				const uint32_t clipPosition = segment.dataOffset + dataPosition - segment.start;
+				if (!openClip(&segment - segments_.data()) || (clip_.position() != clipPosition && !clip_.seek(clipPosition))) {
+					break;
+				}
+				bytesThisRound = clip_.read(buf + done, std::min<size_t>(size - done, segment.start + segment.length - dataPosition));
+				if (bytesThisRound == 0) {
+					break;
+				}
+			}
+			done += bytesThisRound;
+			position_ += bytesThisRound;
+		}
+		return done;
+	}
+
+	void flush() override { }
+
+	bool seek(uint32_t pos, SeekMode mode) override {
+		int64_t target;
+		switch (mode) {
+			case SeekCur:
+				target = static_cast<int64_t>(position_) + static_cast<int32_t>(pos);
+				break;
+			case SeekEnd:
+				target = static_cast<int64_t>(size_) + static_cast<int32_t>(pos);
+				break;
+			case SeekSet:
+			default:
+				target = pos;
+				break;
+		}
+		if (target < 0 || target > static_cast<int64_t>(size_)) {
+			return false;
+		}
+		position_ = static_cast<uint32_t>(target);
+		return true;
+	}
+
+	size_t position() const override {
+		return position_;
+	}
+
+	size_t size() const override {
+		return size_;
+	}
+
+	bool setBufferSize(size_t) override {
+		return false;
+	}
+
+	void close() override {
+		clip_.close();
+		open_ = false;
+	}
+
+	time_t getLastWrite() override {
+		return 0;
+	}
+
+	const char *path() const override {
+		return announcementPath;
+	}
+
+	const char *name() const override {
+		return announcementPath + 1;
+	}
+
+	boolean isDirectory(void) override {
+		return false;
+	}
+
+	fs::FileImplPtr openNextFile(const char *) override {
+		return fs::FileImplPtr();
+	}
+
+	boolean seekDir(long) override {
+		return false;
+	}
+
+	String getNextFileName(void) override {
+		return String();
+	}
+
+	String getNextFileName(bool *) override {
+		return String();
+	}
+
+	void rewindDirectory(void) override { }
+
+	operator bool() override {
+		return open_;
+	}
+
+private:
+	size_t findSegment(uint32_t dataPosition) const {
+		size_t index = 0;
+		while (index + 1 < segments_.size() && dataPosition >= segments_[index + 1].start) {
+			index++;
+		}
+		return index;
+	}
+
+	bool openClip(size_t index) {
+		if (clip_ && clipIndex_ == index) {
+			return true;
+		}
+		clip_.close();
+		clip_ = gFSystem.open(segments_[index].path, FILE_READ);
+		clipIndex_ = index;
+		return static_cast<bool>(clip_);
+	}
+
+	std::vector<AnnouncementSegment> segments_;
+	uint8_t header_[Announcement_HeaderSize];
+	File clip_;
+	size_t clipIndex_ = 0;
+	uint32_t size_ = 0;
+	uint32_t position_ = 0;
+	bool open_ = true;
+};
+
+// Knows the prepared announcement only
+class AnnouncementFSImpl : public fs::FSImpl {
+public:
+	fs::FileImplPtr open(const char *path, const char *mode, const bool) override {
+		if (!exists(path) || strcmp(mode, FILE_READ) != 0) {
+			return fs::FileImplPtr();
+		}
+		return std::make_shared<AnnouncementFileImpl>(Announcement_Segments, Announcement_Header);
+	}
+
+	bool exists(const char *path) override {
+		return !Announcement_Segments.empty() && strcmp(path, announcementPath) == 0;
+	}
+
+	bool rename(const char *, const char *) override {
+		return false;
+	}
+
+	bool remove(const char *) override {
+		return false;
+	}
+
+	bool mkdir(const char *) override {
+		return false;
+	}
+
+	bool rmdir(const char *) override {
+		return false;
+	}
+};
+} // namespace
+
+fs::FS gFSystemAnnouncement = fs::FS(std::make_shared<AnnouncementFSImpl>());
+
+// Digit by digit, dots as "point"
+std::vector<String> Announcement_SequenceIp(const char *ipAddress) {
+	std::vector<String> clips;
+	for (const char *c = ipAddress; *c != '\0'; c++) {
+		if (isdigit(*c)) {
+			clips.push_back(String(*c));
+		} else if (*c == '.') {
+			clips.push_back("point");
+		}
+	}
+	return clips;
+}
+
+// "It is 3 o'clock pm" / "It is 3 0 5 pm" (EN), "Es ist 15 Uhr 5" (DE, FR likewise)
+std::vector<String> Announcement_SequenceTime(uint8_t hour, uint8_t minute, const AnnouncementClipAvailable &available) {
+	std::vector<String> clips = {"itIs"};
+#if (LANGUAGE == DE) || (LANGUAGE == FR)
+	Announcement_AppendNumber(clips, hour, available);
+	clips.push_back("oclock");
+	if (minute > 0) {
+		Announcement_AppendNumber(clips, minute, available);
+	}
+#else
+	Announcement_AppendNumber(clips, (hour % 12 == 0) ? 12 : hour % 12, available);
+	if (minute == 0) {
+		clips.push_back("oclock");
+	} else {
+		if (minute < 10) {
+			clips.push_back("0");
+		}
+		Announcement_AppendNumber(clips, minute, available);
+	}
+	clips.push_back(hour < 12 ? "am" : "pm");
+#endif
+	return clips;
+}
+
+bool Announcement_PrepareIp(const char *ipAddress) {
+	return Announcement_Prepare(Announcement_SequenceIp(ipAddress));
+}
+
+bool Announcement_PrepareTime(uint8_t hour, uint8_t minute) {
+	return Announcement_Prepare(Announcement_SequenceTime(hour, minute, Announcement_ClipExists));
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <FS.h>
+#include <functional>
+#include <vector>
+
+// Status-announcements (IP-address, time) composed of pre-recorded clips on SD:
+// ANNOUNCEMENT_CLIP_DIR/<de|en|fr>/<clip>.wav. The clips of an announcement are served as one
+// virtual wav-file via gFSystemAnnouncement, so the decoder plays them without gaps and no
+// network is needed. Clips: 0..9 (10..59 optional, spoken digit by digit otherwise), point, itIs,
+// oclock, am, pm. All clips have to share the same PCM-format.
+typedef std::function<bool(const String &clip)> AnnouncementClipAvailable;
+
+constexpr char announcementPath[] = "/announcement.wav"; // to be opened via gFSystemAnnouncement
+extern fs::FS gFSystemAnnouncement;
+
+// Sequencing (no file-access; available tells if the clip of a number >= 10 exists)
+std::vector<String> Announcement_SequenceIp(const char *ipAddress);
+std::vector<String> Announcement_SequenceTime(uint8_t hour, uint8_t minute, const AnnouncementClipAvailable &available);
+
+// Only to be called by the audio-task; false if a clip is missing or differs in format
+bool Announcement_PrepareIp(const char *ipAddress);
+bool Announcement_PrepareTime(uint8_t hour, uint8_t minute);
@@ -0,0 +1,182 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "AudioFade.h"
+
+#include "EnumUtils.h"
+
+// Every envelope runs on an amplitude-position x (Q15) that moves linearly from sample to sample;
+// the applied gain is x^2 so fades sound even instead of dropping off at the end.
+namespace {
+constexpr uint8_t AudioFade_PosShift = 15; // fractional bits of the position (Q30 in total)
+constexpr int32_t AudioFade_UnityPos = int32_t(audioFadeUnity) << AudioFade_PosShift;
+constexpr uint8_t AudioFade_Envelopes = EnumUtils::underlying_value(AudioFadeEnvelope::Count);
+
+struct AudioFadeRequest {
+	bool pending = false;
+	uint16_t target = audioFadeUnity;
+	uint32_t durationMs = 0;
+};
+
+struct AudioFadeRamp {
+	int32_t pos = AudioFade_UnityPos;
+	int32_t step = 0;
+	int32_t targetPos = AudioFade_UnityPos;
+	uint32_t framesLeft = 0;
+};
+
+portMUX_TYPE AudioFade_Mux = portMUX_INITIALIZER_UNLOCKED;
+AudioFadeRequest AudioFade_Requests[AudioFade_Envelopes];
+volatile int32_t AudioFade_Positions[AudioFade_Envelopes] = {AudioFade_UnityPos, AudioFade_UnityPos}; // position after the last block (for other tasks)
+AudioFadeStats AudioFade_Stats;
+uint32_t AudioFade_SampleRate = 44100;
+uint32_t AudioFade_CyclesPerFrame = 240000000 / 44100;
+
+AudioFadeRamp AudioFade_Ramps[AudioFade_Envelopes]; // only touched by the audio-task (inside audio_process_i2s)
+volatile int32_t AudioFade_TrackGain = audioFadeUnity; // Q15; above unity for quiet tracks
+
+void AudioFade_ApplyRequests(void) {
+	AudioFadeRequest requests[AudioFade_Envelopes];
+	portENTER_CRITICAL(&AudioFade_Mux);
+	const uint32_t sampleRate = AudioFade_SampleRate;
+	for (uint8_t i = 0; i < AudioFade_Envelopes; i++) {
+		requests[i] = AudioFade_Requests[i];
+		AudioFade_Requests[i].pending = false;
+	}
+	portEXIT_CRITICAL(&AudioFade_Mux);
+
+	for (uint8_t i = 0; i < AudioFade_Envelopes; i++) {
+		if (!requests[i].pending) {
+			continue;
+		}
+		AudioFadeRamp &ramp = AudioFade_Ramps[i];
+		ramp.targetPos = int32_t(requests[i].target) << AudioFade_PosShift;
+		ramp.framesLeft = uint64_t(requests[i].durationMs) * sampleRate / 1000;
+		if (ramp.framesLeft == 0) {
+			ramp.pos = ramp.targetPos;
+			ramp.step = 0;
+		} else {
+			ramp.step = (ramp.targetPos - ramp.pos) / int32_t(ramp.framesLeft);
+		}
+	}
+}
+
+inline int16_t AudioFade_Scale(int16_t sample, int32_t gain) {
+	const int32_t scaled = (sample * gain) >> 15;
+	return std::min<int32_t>(std::max<int32_t>(scaled, INT16_MIN), INT16_MAX); // track-gain may exceed unity
+}
+
+// Gain (Q15) of the current frame; advances the ramps by one frame
+inline int32_t AudioFade_NextGain(int32_t trackGain) {
+	int32_t gain = trackGain;
+	for (AudioFadeRamp &ramp : AudioFade_Ramps) {
+		if (ramp.framesLeft > 0) {
+			ramp.pos += ramp.step;
+			if (--ramp.framesLeft == 0) {
+				ramp.pos = ramp.targetPos; // no rounding-error left at the end of the ramp
+			}
+		}
+		const int32_t x = ramp.pos >> AudioFade_PosShift;
+		gain = (gain * ((x * x) >> 15)) >> 15;
+	}
+	return gain;
+}
+
+void AudioFade_UpdateStats(uint32_t cycles, uint16_t frames) {
+	portENTER_CRITICAL(&AudioFade_Mux);
+	const uint32_t blockCycles = frames * AudioFade_CyclesPerFrame;
+	AudioFadeStats &stats = AudioFade_Stats;
+	stats.blocks++;
+	stats.lastCycles = cycles;
+	stats.avgCycles = (stats.blocks == 1) ? cycles : stats.avgCycles - stats.avgCycles / 16 + cycles / 16;
+	stats.maxCycles = std::max(stats.maxCycles, cycles);
+	if (blockCycles > 0) {
+		stats.loadPermille = uint64_t(stats.avgCycles) * 1000 / blockCycles;
+	}
+	portEXIT_CRITICAL(&AudioFade_Mux);
+}
+} // namespace
+
+void AudioFade_SetSampleRate(uint32_t sampleRate) {
+	if (sampleRate == 0) {
+		return;
+	}
+	portENTER_CRITICAL(&AudioFade_Mux);
+	AudioFade_SampleRate = sampleRate;
+	AudioFade_CyclesPerFrame = ESP.getCpuFreqMHz() * 1000000u / sampleRate;
+	portEXIT_CRITICAL(&AudioFade_Mux);
+}
+
+void AudioFade_SetTrackGain(int16_t gainCb) {
+	const float gain = powf(10.0f, gainCb / 2000.0f) * audioFadeUnity;
+	AudioFade_TrackGain = std::min(gain, 2.0f * audioFadeUnity - 1); // gain * gain and sample * gain have to fit into 32 bit
+}
+
+void AudioFade_To(AudioFadeEnvelope envelope, uint16_t gain, uint32_t durationMs) {
+	AudioFadeRequest &request = AudioFade_Requests[EnumUtils::underlying_value(envelope)];
+	portENTER_CRITICAL(&AudioFade_Mux);
+	request.pending = true;
+	request.target = std::min(gain, audioFadeUnity);
+	request.durationMs = durationMs;
+	portEXIT_CRITICAL(&AudioFade_Mux);
+}
+
+bool AudioFade_IsSilent(AudioFadeEnvelope envelope) {
+	const uint8_t i = EnumUtils::underlying_value(envelope);
+	portENTER_CRITICAL(&AudioFade_Mux);
+	const bool silent = !AudioFade_Requests[i].pending && AudioFade_Positions[i] == 0;
+	portEXIT_CRITICAL(&AudioFade_Mux);
+	return silent;
+}
+
+bool AudioFade_IsUnity(AudioFadeEnvelope envelope) {
+	const uint8_t i = EnumUtils::underlying_value(envelope);
+	portENTER_CRITICAL(&AudioFade_Mux);
+	const bool unity = AudioFade_Requests[i].pending ? (AudioFade_Requests[i].target == audioFadeUnity) : (AudioFade_Positions[i] == AudioFade_UnityPos);
+	portEXIT_CRITICAL(&AudioFade_Mux);
+	return unity;
+}
+
+// Called for every PCM-block (interleaved 16 bit samples)
+void AudioFade_Process(int16_t *samples, uint16_t frames, uint8_t channels) {
+	const uint32_t startCycles = ESP.getCycleCount();
+	AudioFade_ApplyRequests();
+
+	const int32_t trackGain = AudioFade_TrackGain;
+	bool ramping = false;
+	for (const AudioFadeRamp &ramp : AudioFade_Ramps) {
+		ramping |= ramp.framesLeft > 0;
+	}
+	if (!ramping) {
+		// constant gain: nothing to do at unity, mute at zero
+		const int32_t gain = AudioFade_NextGain(trackGain);
+		if (gain == 0) {
+			memset(samples, 0, size_t(frames) * channels * sizeof(int16_t));
+		} else if (gain != audioFadeUnity) {
+			for (uint32_t i = 0; i < uint32_t(frames) * channels; i++) {
+				samples[i] = AudioFade_Scale(samples[i], gain);
+			}
+		}
+	} else {
+		for (uint16_t frame = 0; frame < frames; frame++) {
+			const int32_t gain = AudioFade_NextGain(trackGain);
+			for (uint8_t channel = 0; channel < channels; channel++) {
+				int16_t &sample = samples[frame * channels + channel];
+				sample = AudioFade_Scale(sample, gain);
+			}
+		}
+	}
+
+	portENTER_CRITICAL(&AudioFade_Mux);
+	for (uint8_t i = 0; i < AudioFade_Envelopes; i++) {
+		AudioFade_Positions[i] = (AudioFade_Ramps[i].framesLeft > 0) ? -1 : AudioFade_Ramps[i].pos; // -1: still fading
+	}
+	portEXIT_CRITICAL(&AudioFade_Mux);
+	AudioFade_UpdateStats(ESP.getCycleCount() - startCycles, frames);
+}
+
+void AudioFade_GetStats(AudioFadeStats &stats) {
+	portENTER_CRITICAL(&AudioFade_Mux);
+	stats = AudioFade_Stats;
+	portEXIT_CRITICAL(&AudioFade_Mux);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+// Gain-envelopes in front of I2S/Bluetooth: every PCM-block passes audio_process_i2s() and is
+// scaled with a per-sample ramp. Fades can be requested from any task; they start with the
+// next block and end exactly after the requested number of samples. The envelopes are
+// independent of each other and multiplied, so a track-change can't undo the sleep-fade.
+constexpr uint16_t audioFadeUnity = 0x8000; // gain 1.0 (Q15)
+
+enum class AudioFadeEnvelope : uint8_t {
+	Transition = 0, // pause/resume, track-changes and crossfades
+	Sleep, // sleep-timer
+	Count // has to be the last entry
+};
+
+typedef struct {
+	uint32_t blocks = 0;
+	uint32_t lastCycles = 0; // CPU-cycles of the last block
+	uint32_t avgCycles = 0;
+	uint32_t maxCycles = 0;
+	uint16_t loadPermille = 0; // processing time per block relative to its playtime
+} AudioFadeStats;
+
+void AudioFade_SetSampleRate(uint32_t sampleRate);
+void AudioFade_To(AudioFadeEnvelope envelope, uint16_t gain, uint32_t durationMs); // durationMs = 0: at once
+void AudioFade_SetTrackGain(int16_t gainCb); // static gain of the current track (1/100 dB; max. +6 dB)
+bool AudioFade_IsSilent(AudioFadeEnvelope envelope); // faded out completely
+bool AudioFade_IsUnity(AudioFadeEnvelope envelope);
+void AudioFade_Process(int16_t *samples, uint16_t frames, uint8_t channels);
+void AudioFade_GetStats(AudioFadeStats &stats);
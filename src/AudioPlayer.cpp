@@ -3,29 +3,42 @@
 
 #include "AudioPlayer.h"
 
+#include "Announcement.h"
 #include "Audio.h"
+#include "AudioFade.h"
 #include "Bluetooth.h"
 #include "Cmd.h"
 #include "Common.h"
+#include "CoverCache.h"
 #include "EnumUtils.h"
+#include "Equalizer.h"
+#include "Latency.h"
 #include "Led.h"
 #include "Log.h"
+#include "Loudness.h"
 #include "MemX.h"
+#include "Metadata.h"
 #include "Mqtt.h"
 #include "Port.h"
 #include "Queues.h"
+#include "ReadCache.h"
 #include "Rfid.h"
 #include "RotaryEncoder.h"
 #include "SdCard.h"
+#include "SeekTable.h"
+#include "ShuffleState.h"
+#include "StreamMirror.h"
 #include "System.h"
+#include "Trace.h"
 #include "Web.h"
 #include "Wlan.h"
 #include "main.h"
-#include "strnatcmp.h"
 
+#include <algorithm>
+#include <atomic>
+#include <esp_random.h>
 #include <esp_task_wdt.h>
 #include <freertos/task.h>
-#include <random>
 
 #define AUDIOPLAYER_VOLUME_MAX	21u
 #define AUDIOPLAYER_VOLUME_MIN	0u
@@ -84,41 +97,88 @@ struct AudioPlayer_HealthState {
 	uint32_t lastPlaybackProgressMs = 0;
 	uint32_t lastLowBufferWarningMs = 0;
 	uint32_t lastLowBufferSampleMs = 0;
-	uint32_t lastRecoveryAttemptMs = 0;
 	uint32_t lastObservedBufferFilled = 0;
 	uint32_t lastObservedFilePos = 0;
 	uint32_t lastObservedCurrentTime = 0;
 	uint8_t consecutiveLowBufferWindows = 0;
-	uint8_t streamRecoveryAttempts = 0;
 };
 static AudioPlayer_HealthState AudioPlayer_Health;
 
+// Adaptive webstream control: compares measured throughput with the codec's bitrate and
+// rebuffers (silent reconnect) instead of letting the stream stutter
+struct AudioPlayer_StreamState {
+	uint32_t lastSampleMs = 0;
+	uint32_t lastSampleFilled = 0;
+	float ingressBytesPerSec = 0.f; // smoothed
+	uint32_t codecBytesPerSec = 0;
+	uint32_t prebufferTargetBytes = 0;
+	uint8_t sessionRebuffers = 0; // rebuffers since the stream was started
+	bool rebuffering = false;
+	bool reconnectPending = false;
+	uint32_t rebufferStartMs = 0;
+	uint32_t reconnectAtMs = 0;
+	uint32_t reconnectedMs = 0;
+	uint8_t reconnectAttempts = 0;
+	AudioPlayerStreamStats stats = {};
+};
+static AudioPlayer_StreamState AudioPlayer_Stream;
+static volatile uint32_t AudioPlayer_LastPcmMs = 0; // last time PCM-data reached audio_process_i2s
+
+// Commands that cut the playing track are executed once the transition-envelope faded out
+static TrackControlMessage AudioPlayer_FadingCommand = {NO_ACTION, 0};
+static uint32_t AudioPlayer_FadingDeadlineMs = 0; // execute anyway if no PCM-data flows
+static uint32_t AudioPlayer_FadeInMs = 0; // fade-in of the next track (or resume) that matches the preceding fade-out
+static bool AudioPlayer_CrossfadeStarted = false; // end of the current track is being faded out
+static bool AudioPlayer_AnnouncementActive = false; // clips of an announcement are played (instead of online speech)
+
+// Published playback-state (see AudioPlayer_PublishState()); the sequence is odd while a publication is in progress
+static std::atomic<uint32_t> AudioPlayer_StateSequence {0};
+static PlaybackState AudioPlayer_PublishedState = {};
+
 #ifdef HEADPHONE_ADJUST_ENABLE
 static bool AudioPlayer_HeadphoneLastDetectionState;
 static uint32_t AudioPlayer_HeadphoneLastDetectionTimestamp = 0u;
 static uint8_t AudioPlayer_MaxVolumeHeadphone = 11u; // Maximum volume that can be adjusted in headphone-mode (default; can be changed later via GUI)
 #endif
 
+// Position in ms of a card (only known for files with seek-table): kept in a namespace of its own, so the card's entry
+// in rfidTags keeps the format older firmware reads
+static constexpr char AudioPlayer_PositionMsNamespace[] = "rfidPosMs";
+struct PlayPositionMsRecord {
+	uint32_t playPosition; // byte-position and track of the entry the record belongs to
+	uint32_t playPositionMs;
+	uint16_t trackLastPlayed;
+	uint16_t reserved;
+};
+static_assert(sizeof(PlayPositionMsRecord) == 12, "PlayPositionMsRecord is stored in NVS and has to keep its size");
+static Preferences AudioPlayer_PrefsPositionMs;
+
 static void AudioPlayer_Process(void);
 static void AudioPlayer_HeadphoneVolumeManager(void);
 static std::optional<Playlist *> AudioPlayer_ReturnPlaylistFromWebstream(const char *_webUrl);
-static bool AudioPlayer_ArrSortHelper_strcmp(const char *a, const char *b);
-static bool AudioPlayer_ArrSortHelper_strnatcmp(const char *a, const char *b);
-static bool AudioPlayer_ArrSortHelper_strnatcasecmp(const char *a, const char *b);
-static void AudioPlayer_SortPlaylist(Playlist *playlist);
 static void AudioPlayer_RandomizePlaylist(Playlist *playlist);
 static void AudioPlayer_Task(void *parameter);
-static size_t AudioPlayer_NvsRfidWriteWrapper(const char *_rfidCardId, const char *_track, const uint32_t _playPosition, const uint8_t _playMode, const uint16_t _trackLastPlayed, const uint16_t _numberOfTracks);
+static size_t AudioPlayer_NvsRfidWriteWrapper(const char *_rfidCardId, const char *_track, const uint32_t _playPosition, const uint8_t _playMode, const uint16_t _trackLastPlayed, const uint16_t _numberOfTracks, const uint32_t _playPositionMs = 0);
 static void AudioPlayer_ClearCover(void);
+static void AudioPlayer_EditPlaylist(PlaylistEditMessage &message);
+static void AudioPlayer_SaveLastPlayPosition(const size_t trackNumber, const uint32_t playPosition, const uint32_t playPositionMs = 0);
 static uint32_t AudioPlayer_NextPlaylistRevision(uint32_t currentRevision);
 static void AudioPlayer_ResetHealth(Audio *audio, bool resetRecoveryAttempts = true);
 static void AudioPlayer_UpdateHealth(Audio *audio);
 static bool AudioPlayer_AttemptStreamRecovery(Audio *audio, uint32_t now);
+static void AudioPlayer_StartRebuffer(Audio *audio, uint32_t now, const char *reason);
+static void AudioPlayer_UpdateStream(Audio *audio);
 static bool AudioPlayer_HandleWatchdog(Audio *audio);
+static bool AudioPlayer_FadeOutBefore(Audio *audio, const TrackControlMessage &command);
+static void AudioPlayer_UpdateCrossfade(Audio *audio, uint32_t remainingMs);
 
 void AudioPlayer_Init(void) {
 	// load playtime total from NVS
 	playTimeSecTotal = gPrefsSettings.getULong("playTimeTotal", 0);
+	StreamMirror_Init();
+	AudioPlayer_PrefsPositionMs.begin(AudioPlayer_PositionMsNamespace);
+	ShuffleState_Init();
+	SeekTable_Init();
 
 	uint8_t playListSortModeValue = gPrefsSettings.getUChar("PLSortMode", EnumUtils::underlying_value(AudioPlayer_PlaylistSortMode));
 	AudioPlayer_PlaylistSortMode = EnumUtils::to_enum<playlistSortMode>(playListSortModeValue);
@@ -219,6 +279,7 @@ void AudioPlayer_Exit(void) {
 		}
 	}
 #endif
+	ShuffleState_Flush();
 
 	if (AudioPlayer_TaskHandle) {
 		vTaskDelete(AudioPlayer_TaskHandle);
@@ -245,6 +306,7 @@ void AudioPlayer_Cyclic(void) {
 		playTimeSecSinceStart += 1;
 	}
 	AudioPlayer_Process();
+	AudioPlayer_PublishState();
 }
 
 // Wrapper-function to reverse detection of connected headphones.
@@ -344,6 +406,7 @@ void Audio_setTitle(const char *format, ...) {
 	va_start(args, format);
 	vsnprintf(gPlayProperties.title, sizeof(gPlayProperties.title) / sizeof(gPlayProperties.title[0]), format, args);
 	va_end(args);
+	AudioPlayer_PublishState();
 
 	// notify web ui and mqtt
 	Web_SendWebsocketData(0, WebsocketCodeType::TrackInfo);
@@ -375,6 +438,7 @@ void AudioPlayer_SetupVolumeAndAmps(void) {
 #else
 	if (Audio_Detect_Mode_HP(Port_Read(HP_DETECT))) {
 		AudioPlayer_MaxVolume = AudioPlayer_MaxVolumeSpeaker; // 1 if headphone is not connected
+		Equalizer_SelectOutput(EqualizerOutput::Speaker);
 	#ifdef GPIO_PA_EN
 		Port_Write(GPIO_PA_EN, true, true);
 	#endif
@@ -384,6 +448,7 @@ void AudioPlayer_SetupVolumeAndAmps(void) {
 	} else {
 		AudioPlayer_MaxVolume = AudioPlayer_MaxVolumeHeadphone; // 0 if headphone is connected (put to GND)
 		gPlayProperties.newPlayMono = false; // always stereo for headphones!
+		Equalizer_SelectOutput(EqualizerOutput::Headphone);
 
 	#ifdef GPIO_PA_EN
 		Port_Write(GPIO_PA_EN, false, true);
@@ -404,6 +469,7 @@ void AudioPlayer_HeadphoneVolumeManager(void) {
 	if (AudioPlayer_HeadphoneLastDetectionState != currentHeadPhoneDetectionState && (millis() - AudioPlayer_HeadphoneLastDetectionTimestamp >= headphoneLastDetectionDebounce)) {
 		if (currentHeadPhoneDetectionState) {
 			AudioPlayer_MaxVolume = AudioPlayer_MaxVolumeSpeaker;
+			Equalizer_SelectOutput(EqualizerOutput::Speaker);
 	#ifdef PLAY_MONO_SPEAKER
 			gPlayProperties.newPlayMono = true;
 	#else
@@ -419,6 +485,7 @@ void AudioPlayer_HeadphoneVolumeManager(void) {
 		} else {
 			AudioPlayer_MaxVolume = AudioPlayer_MaxVolumeHeadphone;
 			gPlayProperties.newPlayMono = false; // Always stereo for headphones
+			Equalizer_SelectOutput(EqualizerOutput::Headphone);
 			if (AudioPlayer_GetCurrentVolume() > AudioPlayer_MaxVolume) {
 				AudioPlayer_VolumeToQueueSender(AudioPlayer_MaxVolume, true); // Lower volume for headphone if headphone's maxvolume is exceeded by volume set in speaker-mode
 			}
@@ -464,8 +531,10 @@ static void AudioPlayer_ResetHealth(Audio *audio, bool resetRecoveryAttempts) {
 	AudioPlayer_Health.lastObservedCurrentTime = audio ? audio->getAudioCurrentTime() : 0;
 	AudioPlayer_Health.consecutiveLowBufferWindows = 0;
 	if (resetRecoveryAttempts) {
-		AudioPlayer_Health.streamRecoveryAttempts = 0;
-		AudioPlayer_Health.lastRecoveryAttemptMs = 0;
+		const AudioPlayerStreamStats stats = AudioPlayer_Stream.stats;
+		AudioPlayer_Stream = AudioPlayer_StreamState {};
+		AudioPlayer_Stream.stats = stats;
+		AudioPlayer_Stream.lastSampleMs = now;
 	}
 }
 
@@ -509,29 +578,222 @@ static bool AudioPlayer_AttemptStreamRecovery(Audio *audio, uint32_t now) {
 	if (!gPlayProperties.isWebstream || gPlayProperties.playlist == nullptr || gPlayProperties.currentTrackNumber >= gPlayProperties.playlist->size()) {
 		return false;
 	}
-	if (AudioPlayer_Health.streamRecoveryAttempts >= 1) {
+	if (AudioPlayer_Stream.reconnectAttempts >= AUDIO_STREAM_RECONNECT_MAX_ATTEMPTS) {
 		return false;
 	}
 
-	const char *url = gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber);
-	if (strncmp(url, "http", 4) != 0) {
+	const String url = gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber);
+	if (!url.startsWith("http")) {
 		return false;
 	}
 
-	AudioPlayer_Health.streamRecoveryAttempts++;
-	AudioPlayer_Health.lastRecoveryAttemptMs = now;
 	Log_Printf(LOGLEVEL_DEBUG, "Audio watchdog: reconnect stalled stream, lowBufferWindows=%u, buffered=%u", AudioPlayer_Health.consecutiveLowBufferWindows, audio->inBufferFilled());
+	AudioPlayer_StartRebuffer(audio, now, "stall");
+	return true;
+}
+
+// Returns the delay before the next reconnect: doubled for every failed attempt
+static uint32_t AudioPlayer_StreamReconnectDelay(uint8_t failedAttempts) {
+	const uint32_t delay = static_cast<uint32_t>(AUDIO_STREAM_RECONNECT_BASE_MS) << std::min<uint8_t>(failedAttempts, 15);
+	return std::min<uint32_t>(delay, AUDIO_STREAM_RECONNECT_MAX_MS);
+}
+
+// Stops output (silence instead of stutter) and reconnects; the audio-lib fills its buffer before playback continues
+static void AudioPlayer_StartRebuffer(Audio *audio, uint32_t now, const char *reason) {
+	Log_Printf(LOGLEVEL_INFO, "Stream rebuffering (%s): throughput=%u kbit/s, bitrate=%u kbit/s, buffered=%u", reason, (uint32_t) (AudioPlayer_Stream.ingressBytesPerSec * 8 / 1000), AudioPlayer_Stream.codecBytesPerSec * 8 / 1000, audio->inBufferFilled());
 	audio->stopSong();
-	const bool recovered = audio->connecttohost(url);
-	if (!recovered) {
-		return false;
+	AudioPlayer_Stream.reconnectPending = true;
+	if (AudioPlayer_Stream.rebuffering) {
+		// previous reconnect didn't bring back audio => back off
+		AudioPlayer_Stream.reconnectAttempts++;
+		AudioPlayer_Stream.reconnectAtMs = now + AudioPlayer_StreamReconnectDelay(AudioPlayer_Stream.reconnectAttempts);
+		return;
 	}
+	AudioPlayer_Stream.rebuffering = true;
+	AudioPlayer_Stream.rebufferStartMs = now;
+	AudioPlayer_Stream.reconnectAtMs = now;
+	if (AudioPlayer_Stream.sessionRebuffers < UINT8_MAX) {
+		AudioPlayer_Stream.sessionRebuffers++;
+	}
+	AudioPlayer_Stream.stats.rebufferCount++;
+	Web_SendWebsocketData(0, WebsocketCodeType::Dropout);
+}
 
-	gPlayProperties.playlistFinished = false;
-	gPlayProperties.trackFinished = false;
-	gTriedToConnectToHost = true;
-	AudioPlayer_ResetHealth(audio, false);
-	return true;
+// Prebuffer target in ms of audio: minimum with enough throughput-headroom, growing with the deficit and with every rebuffer
+static uint32_t AudioPlayer_StreamPrebufferTargetMs(void) {
+	const float ratio = AudioPlayer_Stream.ingressBytesPerSec / AudioPlayer_Stream.codecBytesPerSec;
+	uint32_t targetMs;
+	if (ratio >= 1.5f) {
+		targetMs = AUDIO_STREAM_PREBUFFER_MIN_MS;
+	} else if (ratio <= 1.0f) {
+		targetMs = AUDIO_STREAM_PREBUFFER_MAX_MS;
+	} else {
+		targetMs = AUDIO_STREAM_PREBUFFER_MIN_MS + (uint32_t) ((1.5f - ratio) * 2.f * (AUDIO_STREAM_PREBUFFER_MAX_MS - AUDIO_STREAM_PREBUFFER_MIN_MS));
+	}
+	targetMs += AudioPlayer_Stream.sessionRebuffers * AUDIO_STREAM_PREBUFFER_MIN_MS;
+	return std::min<uint32_t>(targetMs, AUDIO_STREAM_PREBUFFER_MAX_MS);
+}
+
+static void AudioPlayer_UpdateStream(Audio *audio) {
+	const bool activeMode = (gPlayProperties.playMode != NO_PLAYLIST && gPlayProperties.playMode != BUSY);
+	if (!gPlayProperties.isWebstream || !activeMode || gPlayProperties.pausePlay || gPlayProperties.currentSpeechActive) {
+		return;
+	}
+	const uint32_t now = millis();
+
+	// Reconnect (with exponential backoff)
+	if (AudioPlayer_Stream.reconnectPending) {
+		if ((int32_t) (now - AudioPlayer_Stream.reconnectAtMs) < 0) {
+			AudioPlayer_ResetHealth(audio, false); // waiting for the backoff is no stall
+			return;
+		}
+		if (gPlayProperties.playlist == nullptr || gPlayProperties.currentTrackNumber >= gPlayProperties.playlist->size()) {
+			AudioPlayer_Stream.reconnectPending = false;
+			AudioPlayer_Stream.rebuffering = false;
+			return;
+		}
+		AudioPlayer_Stream.stats.reconnects++;
+		if (StreamMirror_Connect(audio, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber).c_str())) {
+			AudioPlayer_Stream.reconnectPending = false;
+			AudioPlayer_Stream.reconnectedMs = now;
+			gPlayProperties.playlistFinished = false;
+			gPlayProperties.trackFinished = false;
+			gTriedToConnectToHost = true;
+			AudioPlayer_ResetHealth(audio, false);
+			return;
+		}
+		AudioPlayer_Stream.stats.failedReconnects++;
+		AudioPlayer_Stream.reconnectAttempts++;
+		if (AudioPlayer_Stream.reconnectAttempts >= AUDIO_STREAM_RECONNECT_MAX_ATTEMPTS) {
+			Log_Printf(LOGLEVEL_ERROR, "Stream reconnect failed %u times, giving up", AudioPlayer_Stream.reconnectAttempts);
+			AudioPlayer_Stream.reconnectPending = false;
+			AudioPlayer_Stream.rebuffering = false;
+			System_IndicateError();
+			gPlayProperties.trackFinished = true;
+			return;
+		}
+		const uint32_t delay = AudioPlayer_StreamReconnectDelay(AudioPlayer_Stream.reconnectAttempts);
+		Log_Printf(LOGLEVEL_INFO, "Stream reconnect failed, next attempt in %u ms", delay);
+		AudioPlayer_Stream.reconnectAtMs = now + delay;
+		AudioPlayer_ResetHealth(audio, false);
+		return;
+	}
+
+	// Rebuffer is over as soon as PCM-data is flowing again
+	if (AudioPlayer_Stream.rebuffering) {
+		if ((int32_t) (AudioPlayer_LastPcmMs - AudioPlayer_Stream.reconnectedMs) > 0) {
+			const uint32_t duration = now - AudioPlayer_Stream.rebufferStartMs;
+			AudioPlayer_Stream.rebuffering = false;
+			AudioPlayer_Stream.reconnectAttempts = 0;
+			AudioPlayer_Stream.stats.rebufferTotalMs += duration;
+			AudioPlayer_Stream.stats.lastRebufferMs = duration;
+			AudioPlayer_Stream.stats.maxRebufferMs = std::max(AudioPlayer_Stream.stats.maxRebufferMs, duration);
+			AudioPlayer_Stream.lastSampleMs = now;
+			AudioPlayer_Stream.lastSampleFilled = audio->inBufferFilled();
+			Log_Printf(LOGLEVEL_INFO, "Stream rebuffered in %u ms", duration);
+		}
+		return;
+	}
+
+	// Throughput: change of buffer-fill plus what the decoder consumed meanwhile
+	const uint32_t elapsedMs = now - AudioPlayer_Stream.lastSampleMs;
+	if (elapsedMs < 250) {
+		return;
+	}
+	const uint32_t bufferFilled = audio->inBufferFilled();
+	const bool decoding = (now - AudioPlayer_LastPcmMs) < 250;
+	AudioPlayer_Stream.codecBytesPerSec = audio->getBitRate() / 8;
+	const int64_t consumed = decoding ? ((int64_t) AudioPlayer_Stream.codecBytesPerSec * elapsedMs) / 1000 : 0;
+	const int64_t received = std::max<int64_t>(0, (int64_t) bufferFilled - AudioPlayer_Stream.lastSampleFilled + consumed);
+	const float sample = (float) received * 1000.f / elapsedMs;
+	AudioPlayer_Stream.ingressBytesPerSec = (AudioPlayer_Stream.ingressBytesPerSec == 0.f) ? sample : (AudioPlayer_Stream.ingressBytesPerSec * 0.8f + sample * 0.2f);
+	AudioPlayer_Stream.lastSampleMs = now;
+	AudioPlayer_Stream.lastSampleFilled = bufferFilled;
+
+	if (AudioPlayer_Stream.codecBytesPerSec == 0) {
+		return;
+	}
+	const uint32_t targetBytes = (uint64_t) AudioPlayer_Stream.codecBytesPerSec * AudioPlayer_StreamPrebufferTargetMs() / 1000;
+	AudioPlayer_Stream.prebufferTargetBytes = std::min<uint32_t>(targetBytes, (audio->inBufferSize() * 9) / 10);
+
+	// Buffer is (almost) drained and the connection can't keep up: a clean pause is better than stuttering
+	const uint32_t underrunBytes = (AudioPlayer_Stream.codecBytesPerSec * AUDIO_STREAM_UNDERRUN_MS) / 1000;
+	if (decoding && (bufferFilled < underrunBytes) && (AudioPlayer_Stream.ingressBytesPerSec < AudioPlayer_Stream.codecBytesPerSec)) {
+		AudioPlayer_StartRebuffer(audio, now, "underrun");
+	}
+}
+
+void AudioPlayer_GetStreamStats(AudioPlayerStreamStats &stats) {
+	stats = AudioPlayer_Stream.stats;
+	stats.ingressKbps = (uint32_t) (AudioPlayer_Stream.ingressBytesPerSec * 8 / 1000);
+	stats.codecKbps = AudioPlayer_Stream.codecBytesPerSec * 8 / 1000;
+	stats.bufferedBytes = AudioPlayer_Stream.lastSampleFilled;
+	stats.prebufferTargetBytes = AudioPlayer_Stream.prebufferTargetBytes;
+	stats.rebuffering = AudioPlayer_Stream.rebuffering;
+}
+
+// Copies the playback-state for other tasks if it changed. Only the audio-task publishes
+// (calls from other tasks are ignored; their changes are published with the next cycle).
+void AudioPlayer_PublishState(void) {
+	if (xTaskGetCurrentTaskHandle() != AudioPlayer_TaskHandle) {
+		return;
+	}
+	PlaybackState state;
+	memset(&state, 0, sizeof(state)); // padding included as states are compared bytewise
+	state.version = AudioPlayer_PublishedState.version;
+	state.playMode = gPlayProperties.playMode;
+	state.currentTrackNumber = gPlayProperties.currentTrackNumber;
+	state.numberOfTracks = (gPlayProperties.playlist) ? gPlayProperties.playlist->size() : 0;
+	state.playlistRevision = gPlayProperties.playlistRevision;
+	state.currentRelPos = gPlayProperties.currentRelPos;
+	state.audioFileSize = gPlayProperties.audioFileSize;
+	state.pausePlay = gPlayProperties.pausePlay;
+	state.trackFinished = gPlayProperties.trackFinished;
+	state.playlistFinished = gPlayProperties.playlistFinished;
+	state.isWebstream = gPlayProperties.isWebstream;
+	state.currentSpeechActive = gPlayProperties.currentSpeechActive;
+	state.repeatCurrentTrack = gPlayProperties.repeatCurrentTrack;
+	state.repeatPlaylist = gPlayProperties.repeatPlaylist;
+	state.coverFilePos = gPlayProperties.coverFilePos;
+	state.coverFileSize = gPlayProperties.coverFileSize;
+	strlcpy(state.title, gPlayProperties.title, sizeof(state.title));
+	// Resolving an entry can mean reading the playlist-index from SD: only done when the track or playlist changed
+	if (state.numberOfTracks > 0 && state.currentTrackNumber < state.numberOfTracks) {
+		const bool trackChanged = state.currentTrackNumber != AudioPlayer_PublishedState.currentTrackNumber || state.playlistRevision != AudioPlayer_PublishedState.playlistRevision || state.numberOfTracks != AudioPlayer_PublishedState.numberOfTracks || !AudioPlayer_PublishedState.trackPath[0];
+		if (trackChanged) {
+			strlcpy(state.trackPath, gPlayProperties.playlist->at(state.currentTrackNumber).c_str(), sizeof(state.trackPath));
+		} else {
+			memcpy(state.trackPath, AudioPlayer_PublishedState.trackPath, sizeof(state.trackPath)); // only the audio-task writes it
+		}
+	}
+	if (memcmp(&state, &AudioPlayer_PublishedState, sizeof(state)) == 0) {
+		return;
+	}
+	state.version++;
+
+	const uint32_t sequence = AudioPlayer_StateSequence.load(std::memory_order_relaxed);
+	AudioPlayer_StateSequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	AudioPlayer_PublishedState = state;
+	AudioPlayer_StateSequence.store(sequence + 2, std::memory_order_release);
+}
+
+// Retries until the copy wasn't torn by a publication. If the audio-task was preempted while
+// publishing, the reader sleeps for a tick to let it finish.
+void AudioPlayer_GetState(PlaybackState &state) {
+	for (uint8_t attempt = 1;; attempt++) {
+		const uint32_t sequence = AudioPlayer_StateSequence.load(std::memory_order_acquire);
+		if (!(sequence & 1u)) {
+			state = AudioPlayer_PublishedState;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (AudioPlayer_StateSequence.load(std::memory_order_relaxed) == sequence) {
+				return;
+			}
+		}
+		if (attempt % 8u == 0) {
+			vTaskDelay(1);
+		}
+	}
 }
 
 static bool AudioPlayer_HandleWatchdog(Audio *audio) {
@@ -545,6 +807,9 @@ static bool AudioPlayer_HandleWatchdog(Audio *audio) {
 		AudioPlayer_ResetHealth(audio);
 		return false;
 	}
+	if (AudioPlayer_Stream.reconnectPending) {
+		return false; // handled by AudioPlayer_UpdateStream()
+	}
 
 	const uint32_t now = millis();
 	const bool isStream = gPlayProperties.isWebstream;
@@ -576,12 +841,55 @@ static bool AudioPlayer_HandleWatchdog(Audio *audio) {
 	return true;
 }
 
+// Delays commands that cut the playing track by a short fade-out. Returns true if the command
+// was taken over (it's executed once the fade is done).
+static bool AudioPlayer_FadeOutBefore(Audio *audio, const TrackControlMessage &command) {
+	if (AUDIO_FADE_PAUSE_MS == 0 || gPlayProperties.pausePlay || gPlayProperties.currentSpeechActive || !audio->isRunning()) {
+		return false;
+	}
+	switch (command.action) {
+		case STOP:
+		case PAUSEPLAY:
+		case NEXTTRACK:
+		case PREVIOUSTRACK:
+		case JUMPTRACK:
+		case FIRSTTRACK:
+		case LASTTRACK:
+			break;
+		default:
+			return false;
+	}
+	AudioFade_To(AudioFadeEnvelope::Transition, 0, AUDIO_FADE_PAUSE_MS);
+	AudioPlayer_FadingCommand = command;
+	AudioPlayer_FadingDeadlineMs = millis() + AUDIO_FADE_PAUSE_MS + 250;
+	AudioPlayer_FadeInMs = AUDIO_FADE_PAUSE_MS;
+	return true;
+}
+
+// Fades out the last AUDIO_CROSSFADE_MS of a track if another one follows; the next track
+// fades in. The audio-lib has one decoder only, so the tracks can't overlap.
+static void AudioPlayer_UpdateCrossfade(Audio *audio, uint32_t remainingMs) {
+	if (AUDIO_CROSSFADE_MS == 0 || AudioPlayer_CrossfadeStarted || remainingMs > AUDIO_CROSSFADE_MS) {
+		return;
+	}
+	if (gPlayProperties.pausePlay || gPlayProperties.currentSpeechActive || gPlayProperties.repeatCurrentTrack || AudioPlayer_FadingCommand.action != NO_ACTION || !audio->isRunning()) {
+		return;
+	}
+	const bool hasNextTrack = gPlayProperties.playlist != nullptr && (gPlayProperties.currentTrackNumber + 1u < gPlayProperties.playlist->size() || (gPlayProperties.repeatPlaylist && gPlayProperties.playlist->size() > 1));
+	if (!hasNextTrack) {
+		return;
+	}
+	AudioFade_To(AudioFadeEnvelope::Transition, 0, remainingMs);
+	AudioPlayer_FadeInMs = AUDIO_CROSSFADE_MS;
+	AudioPlayer_CrossfadeStarted = true;
+}
+
 // Function to play music as task
 static void AudioPlayer_Process(void) {
 	Audio *audio = AudioPlayer_GetAudio();
 
 	uint8_t currentVolume;
-	static int8_t currentEqualizer[3];
+	EqualizerPresets equalizerPresets;
 	BaseType_t trackQStatus = pdFAIL;
 	TrackControlMessage trackCommand = {NO_ACTION, 0};
 	bool audioReturnCode;
@@ -592,10 +900,8 @@ static void AudioPlayer_Process(void) {
 		audio->setVolumeSteps(AUDIOPLAYER_VOLUME_MAX);
 		audio->setVolume(AudioPlayer_CurrentVolume, VOLUMECURVE);
 		audio->forceMono(gPlayProperties.currentPlayMono);
-		currentEqualizer[0] = gPrefsSettings.getChar("gainLowPass", 0);
-		currentEqualizer[1] = gPrefsSettings.getChar("gainBandPass", 0);
-		currentEqualizer[2] = gPrefsSettings.getChar("gainHighPass", 0);
-		audio->setTone(currentEqualizer[0], currentEqualizer[1], currentEqualizer[2]);
+		Equalizer_LoadPresets(equalizerPresets); // audio-lib's tone-control stays neutral
+		Equalizer_SetPresets(equalizerPresets);
 		audio->setBufsize(AUDIO_INPUT_BUFFER_RAM_BYTES, AUDIO_INPUT_BUFFER_PSRAM_BYTES);
 		audio->setConnectionTimeout(AUDIO_CONNECTION_TIMEOUT_MS, AUDIO_CONNECTION_TIMEOUT_SSL_MS);
 		AudioPlayer_CurrentTime = 0;
@@ -624,13 +930,36 @@ static void AudioPlayer_Process(void) {
 #endif
 	}
 
-	if (xQueueReceive(gEqualizerQueue, &currentEqualizer, 0) == pdPASS) {
-		Log_Printf(LOGLEVEL_DEBUG, newEqualizerReceivedQueue, currentEqualizer[0], currentEqualizer[1], currentEqualizer[2]);
-		audio->setTone(currentEqualizer[0], currentEqualizer[1], currentEqualizer[2]);
+	if (xQueueReceive(gEqualizerQueue, &equalizerPresets, 0) == pdPASS) {
+		Log_Println(newEqualizerReceivedQueue, LOGLEVEL_DEBUG);
+		Equalizer_SetPresets(equalizerPresets);
+	}
+
+	PlaylistEditMessage playlistEdit;
+	if (xQueueReceive(gPlaylistEditQueue, &playlistEdit, 0) == pdPASS) {
+		AudioPlayer_EditPlaylist(playlistEdit);
 	}
 
-	if (xQueueReceive(gTrackControlQueue, &trackCommand, 0) == pdPASS) {
+	if (CoverCache_TakeReady()) {
+		gPlayProperties.coverFilePos = 1; // flacMarker gives 4 Bytes before METADATA_BLOCK_PICTURE, whereas for flac files audioI2S points 3 Bytes before METADATA_BLOCK_PICTURE, so gPlayProperties.coverFilePos has to be set to 4-3=1
+		// websocket and mqtt notify cover image has changed
+		Web_SendWebsocketData(0, WebsocketCodeType::CoverImg);
+#ifdef MQTT_ENABLE
+		publishMqtt(topicCoverChangedState, "", false);
+#endif
+	}
+
+	if (AudioPlayer_FadingCommand.action != NO_ACTION) {
+		// further commands stay in the queue until the faded one is executed
+		if (AudioFade_IsSilent(AudioFadeEnvelope::Transition) || (int32_t) (millis() - AudioPlayer_FadingDeadlineMs) >= 0) {
+			trackCommand = AudioPlayer_FadingCommand;
+			AudioPlayer_FadingCommand.action = NO_ACTION;
+		}
+	} else if (xQueueReceive(gTrackControlQueue, &trackCommand, 0) == pdPASS) {
 		Log_Printf(LOGLEVEL_INFO, newCntrlReceivedQueue, trackCommand.action);
+		if (AudioPlayer_FadeOutBefore(audio, trackCommand)) {
+			trackCommand.action = NO_ACTION;
+		}
 	}
 
 	// Update playtime stats every 250 ms
@@ -642,12 +971,28 @@ static void AudioPlayer_Process(void) {
 		// Calculate relative position in file (for trackprogress neopixel & web-ui)
 		uint32_t fileSize = audio->getFileSize();
 		gPlayProperties.audioFileSize = fileSize;
-		if (!gPlayProperties.playlistFinished && fileSize > 0) {
+		AudioFade_SetSampleRate(audio->getSampleRate());
+		Equalizer_SetSampleRate(audio->getSampleRate());
+		uint32_t playTimeMs, durationMs;
+		if (!gPlayProperties.playlistFinished && SeekTable_GetDurationMs(durationMs) && durationMs > 0 && SeekTable_TimeForOffset(audio->getFilePos() - audio->inBufferFilled(), playTimeMs)) {
+			// VBR-file with seek-table: bitrate-based values of the audio-lib are off
+			AudioPlayer_CurrentTime = playTimeMs / 1000;
+			AudioPlayer_FileDuration = durationMs / 1000;
+			if (!gPlayProperties.pausePlay && (gPlayProperties.seekmode != SEEK_POS_PERCENT)) {
+				gPlayProperties.currentRelPos = (double) playTimeMs / durationMs * 100;
+			}
+			AudioPlayer_UpdateCrossfade(audio, (durationMs > playTimeMs) ? durationMs - playTimeMs : 0);
+		} else if (!gPlayProperties.playlistFinished && fileSize > 0) {
 			// for local files and web files with known size
 			if (!gPlayProperties.pausePlay && (gPlayProperties.seekmode != SEEK_POS_PERCENT)) { // To progress necessary when paused
 				uint32_t audioDataStartPos = audio->getAudioDataStartPos();
 				gPlayProperties.currentRelPos = ((double) (audio->getFilePos() - audioDataStartPos - audio->inBufferFilled()) / (fileSize - audioDataStartPos)) * 100;
 			}
+			const uint32_t playedBytes = audio->getFilePos() - audio->inBufferFilled();
+			const uint32_t bitRate = audio->getBitRate();
+			if (!gPlayProperties.isWebstream && bitRate > 0 && fileSize > playedBytes) {
+				AudioPlayer_UpdateCrossfade(audio, uint64_t(fileSize - playedBytes) * 8000 / bitRate);
+			}
 		} else {
 			if (gPlayProperties.isWebstream && (audio->inBufferSize() > 0)) {
 				// calc current fillbuffer percent for webstream with unknown size/end
@@ -667,8 +1012,11 @@ static void AudioPlayer_Process(void) {
 			// destroy the old playlist and assign the new
 			freePlaylist(gPlayProperties.playlist);
 			gPlayProperties.playlist = newPlaylist;
+			AudioPlayer_FadingCommand.action = NO_ACTION; // was meant for the old playlist
+			ShuffleState_Activate(gPlayProperties.playlist);
 			gPlayProperties.playlistRevision = AudioPlayer_NextPlaylistRevision(gPlayProperties.playlistRevision);
 			Web_UpdatePlaylistSnapshot(gPlayProperties.playlist, gPlayProperties.playlistRevision);
+			Metadata_IndexPlaylist(gPlayProperties.playlist);
 			Log_Printf(LOGLEVEL_NOTICE, newPlaylistReceived, gPlayProperties.playlist->size());
 			Log_Printf(LOGLEVEL_DEBUG, "Free heap: %u", ESP.getFreeHeap());
 			gPlayProperties.pausePlay = false;
@@ -695,7 +1043,7 @@ static void AudioPlayer_Process(void) {
 			if (gPlayProperties.saveLastPlayPosition) { // Don't save for AUDIOBOOK_LOOP because not necessary
 				if (gPlayProperties.currentTrackNumber + 1 < gPlayProperties.playlist->size()) {
 					// Only save if there's another track, otherwise it will be saved at end of playlist anyway
-					AudioPlayer_NvsRfidWriteWrapper(gPlayProperties.playRfidTag, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber), 0, gPlayProperties.playMode, gPlayProperties.currentTrackNumber + 1, gPlayProperties.playlist->size());
+					AudioPlayer_SaveLastPlayPosition(gPlayProperties.currentTrackNumber + 1, 0);
 				}
 			}
 			if (gPlayProperties.sleepAfterCurrentTrack) { // Go to sleep if "sleep after track" was requested
@@ -707,7 +1055,8 @@ static void AudioPlayer_Process(void) {
 				return;
 			}
 			if (!gPlayProperties.repeatCurrentTrack) { // If endless-loop requested, track-number will not be incremented
-				gPlayProperties.currentTrackNumber++;
+				ShuffleState_TrackFinished(gPlayProperties.playlist, gPlayProperties.currentTrackNumber);
+				gPlayProperties.currentTrackNumber = ShuffleState_NextTrack(gPlayProperties.playlist, gPlayProperties.currentTrackNumber + 1);
 			} else {
 				Log_Println(repeatTrackDueToPlaymode, LOGLEVEL_INFO);
 				Led_Indicate(LedIndicatorType::Rewind);
@@ -737,10 +1086,15 @@ static void AudioPlayer_Process(void) {
 				Audio_setTitle(noPlaylist);
 				AudioPlayer_ClearCover();
 				AudioPlayer_ResetHealth(audio);
+				ShuffleState_Flush();
 				return;
 
 			case PAUSEPLAY:
 				trackCommand.action = NO_ACTION;
+				if (gPlayProperties.pausePlay) {
+					AudioFade_To(AudioFadeEnvelope::Transition, audioFadeUnity, AudioPlayer_FadeInMs);
+					AudioPlayer_FadeInMs = 0;
+				}
 				audio->pauseResume();
 				if (gPlayProperties.pausePlay) {
 					Log_Println(cmndResumeFromPause, LOGLEVEL_INFO);
@@ -748,10 +1102,17 @@ static void AudioPlayer_Process(void) {
 					Log_Println(cmndPause, LOGLEVEL_INFO);
 				}
 				if (gPlayProperties.saveLastPlayPosition && !gPlayProperties.pausePlay) {
-					Log_Printf(LOGLEVEL_INFO, trackPausedAtPos, audio->getFilePos(), audio->getFilePos() - audio->inBufferFilled());
-					AudioPlayer_NvsRfidWriteWrapper(gPlayProperties.playRfidTag, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber), audio->getFilePos() - audio->inBufferFilled(), gPlayProperties.playMode, gPlayProperties.currentTrackNumber, gPlayProperties.playlist->size());
+					const uint32_t pausePos = audio->getFilePos() - audio->inBufferFilled();
+					uint32_t pauseTimeMs = 0;
+					SeekTable_TimeForOffset(pausePos, pauseTimeMs);
+					Log_Printf(LOGLEVEL_INFO, trackPausedAtPos, audio->getFilePos(), pausePos);
+					AudioPlayer_SaveLastPlayPosition(gPlayProperties.currentTrackNumber, pausePos, pauseTimeMs);
+				}
+				if (!gPlayProperties.pausePlay) {
+					ShuffleState_Flush();
 				}
 				gPlayProperties.pausePlay = !gPlayProperties.pausePlay;
+				AudioPlayer_PublishState();
 				Web_SendWebsocketData(0, WebsocketCodeType::TrackInfo);
 				AudioPlayer_ResetHealth(audio);
 				return;
@@ -771,13 +1132,19 @@ static void AudioPlayer_Process(void) {
 				// Allow next track if current track played in playlist isn't the last track.
 				// Exception: loop-playlist is active. In this case playback restarts at the first track of the playlist.
 				if ((gPlayProperties.currentTrackNumber + 1 < gPlayProperties.playlist->size()) || gPlayProperties.repeatPlaylist) {
+					ShuffleState_TrackFinished(gPlayProperties.playlist, gPlayProperties.currentTrackNumber); // skipped tracks don't come again in this bag
 					if ((gPlayProperties.currentTrackNumber + 1 >= gPlayProperties.playlist->size()) && gPlayProperties.repeatPlaylist) {
 						gPlayProperties.currentTrackNumber = 0;
+						if (ShuffleState_NewBag(gPlayProperties.playlist)) {
+							gPlayProperties.playlistRevision = AudioPlayer_NextPlaylistRevision(gPlayProperties.playlistRevision);
+							Web_UpdatePlaylistSnapshot(gPlayProperties.playlist, gPlayProperties.playlistRevision);
+						}
+						gPlayProperties.currentTrackNumber = ShuffleState_NextTrack(gPlayProperties.playlist, 0); // tracks left out of the bag
 					} else {
-						gPlayProperties.currentTrackNumber++;
+						gPlayProperties.currentTrackNumber = ShuffleState_NextTrack(gPlayProperties.playlist, gPlayProperties.currentTrackNumber + 1);
 					}
 					if (gPlayProperties.saveLastPlayPosition) {
-						AudioPlayer_NvsRfidWriteWrapper(gPlayProperties.playRfidTag, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber), 0, gPlayProperties.playMode, gPlayProperties.currentTrackNumber, gPlayProperties.playlist->size());
+						AudioPlayer_SaveLastPlayPosition(gPlayProperties.currentTrackNumber, 0);
 						Log_Println(trackStartAudiobook, LOGLEVEL_INFO);
 					}
 					Log_Println(cmndNextTrack, LOGLEVEL_INFO);
@@ -826,7 +1193,7 @@ static void AudioPlayer_Process(void) {
 						}
 
 						if (gPlayProperties.saveLastPlayPosition) {
-							AudioPlayer_NvsRfidWriteWrapper(gPlayProperties.playRfidTag, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber), 0, gPlayProperties.playMode, gPlayProperties.currentTrackNumber, gPlayProperties.playlist->size());
+							AudioPlayer_SaveLastPlayPosition(gPlayProperties.currentTrackNumber, 0);
 							Log_Println(trackStartAudiobook, LOGLEVEL_INFO);
 						}
 
@@ -836,11 +1203,14 @@ static void AudioPlayer_Process(void) {
 						}
 					} else {
 						if (gPlayProperties.saveLastPlayPosition) {
-							AudioPlayer_NvsRfidWriteWrapper(gPlayProperties.playRfidTag, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber), 0, gPlayProperties.playMode, gPlayProperties.currentTrackNumber, gPlayProperties.playlist->size());
+							AudioPlayer_SaveLastPlayPosition(gPlayProperties.currentTrackNumber, 0);
 						}
 						audio->stopSong();
 						Led_Indicate(LedIndicatorType::Rewind);
-						audioReturnCode = audio->connecttoFS(gFSystem, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber));
+						AudioPlayer_AnnouncementActive = false;
+						TRACE_BEGIN(AudioConnect);
+						audioReturnCode = audio->connecttoFS(gFSystemAudio, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber).c_str());
+						TRACE_END(AudioConnect);
 						// consider track as finished, when audio lib call was not successful
 						if (!audioReturnCode) {
 							System_IndicateError();
@@ -872,7 +1242,7 @@ static void AudioPlayer_Process(void) {
 				}
 				gPlayProperties.currentTrackNumber = trackCommand.trackNumber;
 				if (gPlayProperties.saveLastPlayPosition) {
-					AudioPlayer_NvsRfidWriteWrapper(gPlayProperties.playRfidTag, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber), 0, gPlayProperties.playMode, gPlayProperties.currentTrackNumber, gPlayProperties.playlist->size());
+					AudioPlayer_SaveLastPlayPosition(gPlayProperties.currentTrackNumber, 0);
 					Log_Println(trackStartAudiobook, LOGLEVEL_INFO);
 				}
 				Log_Printf(LOGLEVEL_INFO, "Command: jump to track %u", gPlayProperties.currentTrackNumber + 1);
@@ -889,7 +1259,7 @@ static void AudioPlayer_Process(void) {
 				}
 				gPlayProperties.currentTrackNumber = 0;
 				if (gPlayProperties.saveLastPlayPosition) {
-					AudioPlayer_NvsRfidWriteWrapper(gPlayProperties.playRfidTag, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber), 0, gPlayProperties.playMode, gPlayProperties.currentTrackNumber, gPlayProperties.playlist->size());
+					AudioPlayer_SaveLastPlayPosition(gPlayProperties.currentTrackNumber, 0);
 					Log_Println(trackStartAudiobook, LOGLEVEL_INFO);
 				}
 				Log_Println(cmndFirstTrack, LOGLEVEL_INFO);
@@ -907,7 +1277,7 @@ static void AudioPlayer_Process(void) {
 				if (gPlayProperties.currentTrackNumber + 1 < gPlayProperties.playlist->size()) {
 					gPlayProperties.currentTrackNumber = gPlayProperties.playlist->size() - 1;
 					if (gPlayProperties.saveLastPlayPosition) {
-						AudioPlayer_NvsRfidWriteWrapper(gPlayProperties.playRfidTag, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber), 0, gPlayProperties.playMode, gPlayProperties.currentTrackNumber, gPlayProperties.playlist->size());
+						AudioPlayer_SaveLastPlayPosition(gPlayProperties.currentTrackNumber, 0);
 						Log_Println(trackStartAudiobook, LOGLEVEL_INFO);
 					}
 					Log_Println(cmndLastTrack, LOGLEVEL_INFO);
@@ -933,7 +1303,7 @@ static void AudioPlayer_Process(void) {
 
 		if (gPlayProperties.playUntilTrackNumber == gPlayProperties.currentTrackNumber && gPlayProperties.playUntilTrackNumber > 0) {
 			if (gPlayProperties.saveLastPlayPosition) {
-				AudioPlayer_NvsRfidWriteWrapper(gPlayProperties.playRfidTag, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber), 0, gPlayProperties.playMode, 0, gPlayProperties.playlist->size());
+				AudioPlayer_SaveLastPlayPosition(0, 0);
 			}
 			gPlayProperties.playlistFinished = true;
 			gPlayProperties.playMode = NO_PLAYLIST;
@@ -948,7 +1318,7 @@ static void AudioPlayer_Process(void) {
 			if (!gPlayProperties.repeatPlaylist) {
 				if (gPlayProperties.saveLastPlayPosition) {
 					// Set back to first track
-					AudioPlayer_NvsRfidWriteWrapper(gPlayProperties.playRfidTag, gPlayProperties.playlist->at(0), 0, gPlayProperties.playMode, 0, gPlayProperties.playlist->size());
+					AudioPlayer_SaveLastPlayPosition(0, 0);
 				}
 				gPlayProperties.playlistFinished = true;
 				gPlayProperties.playMode = NO_PLAYLIST;
@@ -975,33 +1345,44 @@ static void AudioPlayer_Process(void) {
 				} // Repeat playlist; set current track number back to 0
 				Log_Println(repeatPlaylistDueToPlaymode, LOGLEVEL_NOTICE);
 				gPlayProperties.currentTrackNumber = 0;
+				if (ShuffleState_NewBag(gPlayProperties.playlist)) {
+					gPlayProperties.playlistRevision = AudioPlayer_NextPlaylistRevision(gPlayProperties.playlistRevision);
+					Web_UpdatePlaylistSnapshot(gPlayProperties.playlist, gPlayProperties.playlistRevision);
+				}
+				gPlayProperties.currentTrackNumber = ShuffleState_NextTrack(gPlayProperties.playlist, 0); // tracks left out of the bag
 				if (gPlayProperties.saveLastPlayPosition) {
-					AudioPlayer_NvsRfidWriteWrapper(gPlayProperties.playRfidTag, gPlayProperties.playlist->at(0), 0, gPlayProperties.playMode, gPlayProperties.currentTrackNumber, gPlayProperties.playlist->size());
+					AudioPlayer_SaveLastPlayPosition(gPlayProperties.currentTrackNumber, 0);
 				}
 			}
 		}
 
-		if (!strncmp("http", gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber), 4)) {
+		if (!strncmp("http", gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber).c_str(), 4)) {
 			gPlayProperties.isWebstream = true;
 		} else {
 			gPlayProperties.isWebstream = false;
 		}
 		gPlayProperties.currentRelPos = 0;
 		audioReturnCode = false;
+		AudioPlayer_AnnouncementActive = false; // a running announcement gets replaced
+		SeekTable_Select(gPlayProperties.isWebstream ? nullptr : gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber).c_str());
 
 		if (gPlayProperties.playMode == WEBSTREAM || (gPlayProperties.playMode == LOCAL_M3U && gPlayProperties.isWebstream)) { // Webstream
-			audioReturnCode = audio->connecttohost(gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber));
+			TRACE_BEGIN(AudioConnect);
+			audioReturnCode = StreamMirror_Connect(audio, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber).c_str());
+			TRACE_END(AudioConnect);
 			gPlayProperties.playlistFinished = false;
 			gTriedToConnectToHost = true;
 		} else if (gPlayProperties.playMode != WEBSTREAM && !gPlayProperties.isWebstream) {
 			// Files from SD
-			if (!gFSystem.exists(gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber))) { // Check first if file/folder exists
-				Log_Printf(LOGLEVEL_ERROR, dirOrFileDoesNotExist, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber));
+			if (!gFSystem.exists(gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber).c_str())) { // Check first if file/folder exists
+				Log_Printf(LOGLEVEL_ERROR, dirOrFileDoesNotExist, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber).c_str());
 				gPlayProperties.trackFinished = true;
 				return;
 			} else {
-				// Log_Printf(LOGLEVEL_DEBUG, "audio->connecttoFS: %s", gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber));
-				audioReturnCode = audio->connecttoFS(gFSystem, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber));
+				// Log_Printf(LOGLEVEL_DEBUG, "audio->connecttoFS: %s", gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber).c_str());
+				TRACE_BEGIN(AudioConnect);
+				audioReturnCode = audio->connecttoFS(gFSystemAudio, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber).c_str());
+				TRACE_END(AudioConnect);
 				// consider track as finished, when audio lib call was not successful
 			}
 		}
@@ -1011,18 +1392,49 @@ static void AudioPlayer_Process(void) {
 			gPlayProperties.trackFinished = true;
 			return;
 		} else {
+			Latency_Mark(LatencyStage::DecoderConnected);
 			AudioPlayer_ResetHealth(audio);
+			AudioFade_To(AudioFadeEnvelope::Transition, audioFadeUnity, AudioPlayer_FadeInMs);
+			AudioPlayer_FadeInMs = 0;
+			AudioPlayer_CrossfadeStarted = false;
 			if (gPlayProperties.currentTrackNumber) {
 				Led_Indicate(LedIndicatorType::PlaylistProgress);
 			}
-			if (gPlayProperties.startAtFilePos > 0) {
+			const bool startsAtBeginning = gPlayProperties.startAtTimeMs == 0 && gPlayProperties.startAtFilePos == 0;
+			uint32_t startOffset;
+			if (gPlayProperties.startAtTimeMs > 0 && SeekTable_OffsetForTime(gPlayProperties.startAtTimeMs, startOffset)) {
+				// Byte-position of VBR-files is only a guess of the audio-lib; time is exact
+				audio->setFilePos(startOffset);
+				Log_Printf(LOGLEVEL_NOTICE, trackStartatTime, gPlayProperties.startAtTimeMs, startOffset);
+			} else if (gPlayProperties.startAtFilePos > 0) {
 				audio->setFilePos(gPlayProperties.startAtFilePos);
 				Log_Printf(LOGLEVEL_NOTICE, trackStartatPos, gPlayProperties.startAtFilePos);
-				gPlayProperties.startAtFilePos = 0;
 			}
-			const char *title = gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber);
+			gPlayProperties.startAtFilePos = 0;
+			gPlayProperties.startAtTimeMs = 0;
+			const String track = gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber);
+			const char *title = track.c_str();
+			char tagTitle[metadataTitleLength + metadataArtistLength + 3];
+			MetadataInfo metadata;
+			const bool indexed = !gPlayProperties.isWebstream && Metadata_Lookup(title, metadata);
+#ifdef REPLAYGAIN_ENABLE
+			// Files not (yet) in the index play unchanged
+			int16_t trackGain = 0;
+			if (indexed && Metadata_HasReplayGain(metadata)) {
+				trackGain = std::min<int16_t>(metadata.replayGain + REPLAYGAIN_PREAMP_CB, REPLAYGAIN_MAX_BOOST_CB);
+			}
+			AudioFade_SetTrackGain(trackGain);
+			// Untagged files are measured while being played, so they are levelled next time
+			Loudness_BeginTrack((indexed && startsAtBeginning && metadata.replayGain == metadataGainUnknown) ? track.c_str() : nullptr);
+#endif
 			if (gPlayProperties.isWebstream) {
 				title = "Webradio";
+			} else if (indexed) {
+				// Show the indexed tag-title until the decoder reports it
+				Metadata_FormatTitle(metadata, tagTitle, sizeof(tagTitle));
+				if (tagTitle[0] != '\0') {
+					title = tagTitle;
+				}
 			}
 			if (gPlayProperties.playlist->size() > 1) {
 				Audio_setTitle("(%u/%u): %s", gPlayProperties.currentTrackNumber + 1, gPlayProperties.playlist->size(), title);
@@ -1030,27 +1442,41 @@ static void AudioPlayer_Process(void) {
 				Audio_setTitle("%s", title);
 			}
 			AudioPlayer_ClearCover();
-			Log_Printf(LOGLEVEL_NOTICE, currentlyPlaying, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber), (gPlayProperties.currentTrackNumber + 1), gPlayProperties.playlist->size());
+			Log_Printf(LOGLEVEL_NOTICE, currentlyPlaying, gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber).c_str(), (gPlayProperties.currentTrackNumber + 1), gPlayProperties.playlist->size());
 			gPlayProperties.playlistFinished = false;
 		}
 	}
 
 	// Handle seekmodes
 	if (gPlayProperties.seekmode != SEEK_NORMAL) {
+		if (AudioPlayer_CrossfadeStarted) { // jumped away from the end of the track
+			AudioFade_To(AudioFadeEnvelope::Transition, audioFadeUnity, AUDIO_FADE_PAUSE_MS);
+			AudioPlayer_CrossfadeStarted = false;
+		}
+		uint32_t durationMs, playTimeMs, newFilePos;
+		const bool hasSeekTable = SeekTable_GetDurationMs(durationMs) && SeekTable_TimeForOffset(audio->getFilePos() - audio->inBufferFilled(), playTimeMs);
 		if (gPlayProperties.seekmode == SEEK_FORWARDS) {
-			if (audio->setTimeOffset(jumpOffset)) {
+			if (hasSeekTable) {
+				playTimeMs = std::min(playTimeMs + jumpOffset * 1000, durationMs);
+			}
+			if (hasSeekTable ? (SeekTable_OffsetForTime(playTimeMs, newFilePos) && audio->setFilePos(newFilePos)) : audio->setTimeOffset(jumpOffset)) {
 				Log_Printf(LOGLEVEL_NOTICE, secondsJumpForward, jumpOffset);
 			} else {
 				System_IndicateError();
 			}
 		} else if (gPlayProperties.seekmode == SEEK_BACKWARDS) {
-			if (audio->setTimeOffset(-(jumpOffset))) {
+			if (hasSeekTable) {
+				playTimeMs = (playTimeMs > jumpOffset * 1000) ? playTimeMs - jumpOffset * 1000 : 0;
+			}
+			if (hasSeekTable ? (SeekTable_OffsetForTime(playTimeMs, newFilePos) && audio->setFilePos(newFilePos)) : audio->setTimeOffset(-(jumpOffset))) {
 				Log_Printf(LOGLEVEL_NOTICE, secondsJumpBackward, jumpOffset);
 			} else {
 				System_IndicateError();
 			}
 		} else if ((gPlayProperties.seekmode == SEEK_POS_PERCENT) && (gPlayProperties.currentRelPos > 0) && (gPlayProperties.currentRelPos < 100)) {
-			uint32_t newFilePos = uint32_t((double) audio->getAudioDataStartPos() * (1 - gPlayProperties.currentRelPos / 100) + (gPlayProperties.currentRelPos / 100) * audio->getFileSize());
+			if (!hasSeekTable || !SeekTable_OffsetForTime(uint32_t(gPlayProperties.currentRelPos / 100 * durationMs), newFilePos)) {
+				newFilePos = uint32_t((double) audio->getAudioDataStartPos() * (1 - gPlayProperties.currentRelPos / 100) + (gPlayProperties.currentRelPos / 100) * audio->getFileSize());
+			}
 			if (audio->setFilePos(newFilePos)) {
 				Log_Printf(LOGLEVEL_NOTICE, JumpToPosition, newFilePos, audio->getFileSize());
 			} else {
@@ -1058,28 +1484,41 @@ static void AudioPlayer_Process(void) {
 			}
 		}
 		gPlayProperties.seekmode = SEEK_NORMAL;
+#ifdef REPLAYGAIN_ENABLE
+		Loudness_EndTrack(false); // only tracks played completely are measured
+#endif
 	}
 
 	// Handle IP-announcement
 	if (gPlayProperties.tellMode == TTS_IP_ADDRESS) {
 		gPlayProperties.tellMode = TTS_NONE;
+		AudioFade_To(AudioFadeEnvelope::Transition, audioFadeUnity, 0);
 		String ipText = Wlan_GetIpAddress();
 		bool speechOk;
-		// make IP as text (replace thousand separator with locale text)
-		switch (LANGUAGE) {
-			case DE:
-				ipText.replace(".", "Punkt");
-				speechOk = audio->connecttospeech(ipText.c_str(), "de");
-				break;
-			case FR:
-				ipText.replace(".", "point");
-				speechOk = audio->connecttospeech(ipText.c_str(), "fr");
-				break;
-			default:
-				ipText.replace(".", "point");
-				speechOk = audio->connecttospeech(ipText.c_str(), "en");
+		AudioFade_SetTrackGain(0);
+#ifdef REPLAYGAIN_ENABLE
+		Loudness_EndTrack(false);
+#endif
+		if (Announcement_PrepareIp(ipText.c_str())) {
+			speechOk = AudioPlayer_AnnouncementActive = audio->connecttoFS(gFSystemAnnouncement, announcementPath);
+		} else {
+			// make IP as text (replace thousand separator with locale text)
+			switch (LANGUAGE) {
+				case DE:
+					ipText.replace(".", "Punkt");
+					speechOk = audio->connecttospeech(ipText.c_str(), "de");
+					break;
+				case FR:
+					ipText.replace(".", "point");
+					speechOk = audio->connecttospeech(ipText.c_str(), "fr");
+					break;
+				default:
+					ipText.replace(".", "point");
+					speechOk = audio->connecttospeech(ipText.c_str(), "en");
+			}
 		}
 		if (!speechOk) {
+			gPlayProperties.currentSpeechActive = false;
 			System_IndicateError();
 		}
 	}
@@ -1087,22 +1526,34 @@ static void AudioPlayer_Process(void) {
 	// Handle time-announcement
 	if (gPlayProperties.tellMode == TTS_CURRENT_TIME) {
 		gPlayProperties.tellMode = TTS_NONE;
+		AudioFade_To(AudioFadeEnvelope::Transition, audioFadeUnity, 0);
 		struct tm timeinfo;
 		getLocalTime(&timeinfo);
 		static char timeStringBuff[64];
 		bool speechOk;
+		AudioFade_SetTrackGain(0);
+#ifdef REPLAYGAIN_ENABLE
+		Loudness_EndTrack(false);
+#endif
+		if (Announcement_PrepareTime(timeinfo.tm_hour, timeinfo.tm_min)) {
+			speechOk = AudioPlayer_AnnouncementActive = audio->connecttoFS(gFSystemAnnouncement, announcementPath);
+		} else if (!Wlan_IsConnected()) {
+			speechOk = false;
+		} else {
 #if (LANGUAGE == DE)
-		snprintf(timeStringBuff, sizeof(timeStringBuff), "Es ist %02d:%02d Uhr", timeinfo.tm_hour, timeinfo.tm_min);
-		speechOk = audio->connecttospeech(timeStringBuff, "de");
+			snprintf(timeStringBuff, sizeof(timeStringBuff), "Es ist %02d:%02d Uhr", timeinfo.tm_hour, timeinfo.tm_min);
+			speechOk = audio->connecttospeech(timeStringBuff, "de");
 #else
-		if (timeinfo.tm_hour > 12) {
-			snprintf(timeStringBuff, sizeof(timeStringBuff), "It is %02d:%02d PM", timeinfo.tm_hour - 12, timeinfo.tm_min);
-		} else {
-			snprintf(timeStringBuff, sizeof(timeStringBuff), "It is %02d:%02d AM", timeinfo.tm_hour, timeinfo.tm_min);
-		}
-		speechOk = audio->connecttospeech(timeStringBuff, "en");
+			if (timeinfo.tm_hour > 12) {
+				snprintf(timeStringBuff, sizeof(timeStringBuff), "It is %02d:%02d PM", timeinfo.tm_hour - 12, timeinfo.tm_min);
+			} else {
+				snprintf(timeStringBuff, sizeof(timeStringBuff), "It is %02d:%02d AM", timeinfo.tm_hour, timeinfo.tm_min);
+			}
+			speechOk = audio->connecttospeech(timeStringBuff, "en");
 #endif
+		}
 		if (!speechOk) {
+			gPlayProperties.currentSpeechActive = false;
 			System_IndicateError();
 		}
 	}
@@ -1124,7 +1575,6 @@ static void AudioPlayer_Process(void) {
 		} else {
 			Log_Println(newPlayModeStereo, LOGLEVEL_NOTICE);
 		}
-		audio->setTone(gPlayProperties.gainLowPass, gPlayProperties.gainBandPass, gPlayProperties.gainHighPass);
 	}
 
 	audio->loop();
@@ -1136,6 +1586,7 @@ static void AudioPlayer_Process(void) {
 		System_UpdateActivityTimer(); // Refresh if playlist is active so uC will not fall asleep due to reaching inactivity-time
 	}
 	AudioPlayer_UpdateHealth(audio);
+	AudioPlayer_UpdateStream(audio);
 	if (AudioPlayer_HandleWatchdog(audio)) {
 		return;
 	}
@@ -1197,10 +1648,9 @@ void AudioPlayer_VolumeToQueueSender(const int32_t _newVolume, bool reAdjustRota
 	}
 }
 
-// Adds equalizer settings low, band and high pass and readjusts the equalizer
-void AudioPlayer_EqualizerToQueueSender(const int8_t gainLowPass, const int8_t gainBandPass, const int8_t gainHighPass) {
-	int8_t _equalizer[3] = {gainLowPass, gainBandPass, gainHighPass};
-	xQueueSend(gEqualizerQueue, &_equalizer, 0);
+// Adds equalizer-presets (speaker and headphone) and readjusts the equalizer
+void AudioPlayer_EqualizerToQueueSender(const EqualizerPresets &presets) {
+	xQueueSend(gEqualizerQueue, &presets, 0);
 }
 
 // Pauses playback if playback is active and volume is changes from minVolume+1 to minVolume (usually 0)
@@ -1225,7 +1675,7 @@ void AudioPlayer_PauseOnMinVolume(const uint8_t oldVolume, const uint8_t newVolu
 
 // Receives de-serialized RFID-data (from NVS) and dispatches playlists for the given
 // playmode to the track-queue.
-void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _lastPlayPos, const uint32_t _playMode, const uint16_t _trackLastPlayed) {
+void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _lastPlayPos, const uint32_t _playMode, const uint16_t _trackLastPlayed, const uint32_t _lastPlayPosMs) {
 // Make sure last playposition for audiobook is saved when new RFID-tag is applied
 #ifdef SAVE_PLAYPOS_WHEN_RFID_CHANGE
 	if (!gPlayProperties.pausePlay && (gPlayProperties.playMode == AUDIOBOOK || gPlayProperties.playMode == AUDIOBOOK_LOOP)) {
@@ -1237,6 +1687,7 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 #endif
 
 	gPlayProperties.startAtFilePos = _lastPlayPos;
+	gPlayProperties.startAtTimeMs = _lastPlayPosMs;
 	gPlayProperties.currentTrackNumber = _trackLastPlayed;
 	std::optional<Playlist *> musicFiles;
 	String folderPath = _itemToPlay;
@@ -1266,6 +1717,7 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 		}
 		return;
 	}
+	Latency_Mark(LatencyStage::PlaylistBuilt);
 
 	gPlayProperties.playMode = BUSY; // Show @Neopixel, if uC is busy with creating playlist
 	Playlist *list = musicFiles.value();
@@ -1317,13 +1769,7 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 			gPlayProperties.playUntilTrackNumber = 0;
 			Led_SetNightmode(true);
 			Log_Println(modeSingleTrackRandom, LOGLEVEL_NOTICE);
-			AudioPlayer_RandomizePlaylist(list);
-			// we have a random order, so pick the first entry and scrap the rest
-			auto first = list->at(0);
-			list->at(0) = nullptr; // prevent our entry from being destroyed
-			freePlaylist(list); // this also scrapped our vector --> recreate it
-			list = new Playlist();
-			list->push_back(first);
+			// the track was already picked while scanning the directory (see SdCard_ReturnPlaylist)
 			break;
 		}
 
@@ -1331,6 +1777,7 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 			gPlayProperties.saveLastPlayPosition = true;
 			Log_Println(modeSingleAudiobook, LOGLEVEL_NOTICE);
 			AudioPlayer_SortPlaylist(list);
+			Metadata_SortByTrackNumber(list);
 			break;
 		}
 
@@ -1339,6 +1786,7 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 			gPlayProperties.saveLastPlayPosition = true;
 			Log_Println(modeSingleAudiobookLoop, LOGLEVEL_NOTICE);
 			AudioPlayer_SortPlaylist(list);
+			Metadata_SortByTrackNumber(list);
 			break;
 		}
 
@@ -1349,8 +1797,13 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 			break;
 		}
 
-		case ALL_TRACKS_OF_DIR_RANDOM:
-		case RANDOM_SUBDIRECTORY_OF_DIRECTORY_ALL_TRACKS_OF_DIR_RANDOM: {
+		case ALL_TRACKS_OF_DIR_RANDOM: {
+			Log_Printf(LOGLEVEL_NOTICE, modeAllTrackRandom, folderPath.c_str());
+			gPlayProperties.currentTrackNumber = ShuffleState_Restore(gCurrentRfidTagId, folderPath.c_str(), list);
+			break;
+		}
+
+		case RANDOM_SUBDIRECTORY_OF_DIRECTORY_ALL_TRACKS_OF_DIR_RANDOM: { // the subdirectory changes every time, nothing to continue
 			Log_Printf(LOGLEVEL_NOTICE, modeAllTrackRandom, folderPath.c_str());
 			AudioPlayer_RandomizePlaylist(list);
 			break;
@@ -1366,7 +1819,7 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 		case ALL_TRACKS_OF_DIR_RANDOM_LOOP: {
 			gPlayProperties.repeatPlaylist = true;
 			Log_Println(modeAllTrackRandomLoop, LOGLEVEL_NOTICE);
-			AudioPlayer_RandomizePlaylist(list);
+			gPlayProperties.currentTrackNumber = ShuffleState_Restore(gCurrentRfidTagId, folderPath.c_str(), list);
 			break;
 		}
 
@@ -1378,7 +1831,7 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 
 		case ALL_TRACKS_OF_ALL_SUBDIRS_RANDOM: {
 			Log_Printf(LOGLEVEL_NOTICE, modeAllTrackRecursiveRandom, folderPath.c_str());
-			AudioPlayer_RandomizePlaylist(list);
+			gPlayProperties.currentTrackNumber = ShuffleState_Restore(gCurrentRfidTagId, folderPath.c_str(), list);
 			break;
 		}
 
@@ -1403,19 +1856,56 @@ void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _l
 
 	if (!error) {
 		gPlayProperties.playMode = _playMode;
+		Latency_Mark(LatencyStage::PlaylistOrdered);
 		xQueueSend(gTrackQueue, &list, 0);
+		Latency_Mark(LatencyStage::Enqueued);
 		return;
 	}
 
 	// we had an error, blink and destroy playlist
 	gPlayProperties.playMode = NO_PLAYLIST;
 	System_IndicateError();
+	ShuffleState_Discard(list);
 	freePlaylist(list);
 }
 
+// Position in ms of a card's entry (0 if unknown); the record only belongs to the entry while byte-position and track match
+uint32_t AudioPlayer_GetPlayPositionMs(const char *rfidTag, const uint32_t playPosition, const uint16_t trackLastPlayed) {
+	PlayPositionMsRecord record;
+	if (AudioPlayer_PrefsPositionMs.getBytesLength(rfidTag) != sizeof(record)) {
+		return 0;
+	}
+	AudioPlayer_PrefsPositionMs.getBytes(rfidTag, &record, sizeof(record));
+	if (record.playPosition != playPosition || record.trackLastPlayed != trackLastPlayed) {
+		return 0;
+	}
+	return record.playPositionMs;
+}
+
+void AudioPlayer_ForgetPlayPositionMs(const char *rfidTag) {
+	if (AudioPlayer_PrefsPositionMs.isKey(rfidTag)) {
+		AudioPlayer_PrefsPositionMs.remove(rfidTag);
+	}
+}
+
+// Stores where the card continues. Edits aren't stored, the card restarts with the unedited playlist: the track is
+// stored as its unedited position. A track starting anew continues with the next unedited entry; a pause within
+// an added entry isn't stored.
+void AudioPlayer_SaveLastPlayPosition(const size_t trackNumber, const uint32_t playPosition, const uint32_t playPositionMs) {
+	const Playlist *playlist = gPlayProperties.playlist;
+	const bool startOfTrack = playPosition == 0 && playPositionMs == 0;
+	const size_t track = startOfTrack ? playlist->nextUnedited(trackNumber) : trackNumber;
+	const std::optional<size_t> unedited = playlist->uneditedIndex(track);
+	if (!unedited) {
+		Log_Println("Play-position of an added entry isn't stored", LOGLEVEL_DEBUG);
+		return;
+	}
+	AudioPlayer_NvsRfidWriteWrapper(gPlayProperties.playRfidTag, playlist->at(track).c_str(), playPosition, gPlayProperties.playMode, *unedited, playlist->uneditedSize(), playPositionMs);
+}
+
 /* Wraps putString for writing settings into NVS for RFID-cards.
    Returns number of characters written. */
-size_t AudioPlayer_NvsRfidWriteWrapper(const char *_rfidCardId, const char *_track, const uint32_t _playPosition, const uint8_t _playMode, const uint16_t _trackLastPlayed, const uint16_t _numberOfTracks) {
+size_t AudioPlayer_NvsRfidWriteWrapper(const char *_rfidCardId, const char *_track, const uint32_t _playPosition, const uint8_t _playMode, const uint16_t _trackLastPlayed, const uint16_t _numberOfTracks, const uint32_t _playPositionMs) {
 	if (_playMode == NO_PLAYLIST) {
 		// writing back to NVS with NO_PLAYLIST seems to be a bug - Todo: Find the cause here
 		Log_Printf(LOGLEVEL_ERROR, modeInvalid, _playMode);
@@ -1426,8 +1916,7 @@ size_t AudioPlayer_NvsRfidWriteWrapper(const char *_rfidCardId, const char *_tra
 		return 0;
 	}
 
-	Led_SetPause(true); // Workaround to prevent exceptions due to Neopixel-signalisation while NVS-write
-	char prefBuf[275];
+	char prefBuf[290];
 	char trackBuf[255];
 	size_t trackLength = strlen(_track);
 	const char *trackToStore = _track;
@@ -1441,7 +1930,6 @@ size_t AudioPlayer_NvsRfidWriteWrapper(const char *_rfidCardId, const char *_tra
 	}
 
 	if (trackLength >= sizeof(trackBuf)) {
-		Led_SetPause(false);
 		return 0; // Filename too long!
 	}
 
@@ -1451,7 +1939,13 @@ size_t AudioPlayer_NvsRfidWriteWrapper(const char *_rfidCardId, const char *_tra
 	snprintf(prefBuf, sizeof(prefBuf) / sizeof(prefBuf[0]), "%s%s%s%" PRIu32 "%s%d%s%" PRIu16, stringDelimiter, trackBuf, stringDelimiter, _playPosition, stringDelimiter, _playMode, stringDelimiter, _trackLastPlayed);
 	Log_Printf(LOGLEVEL_INFO, wroteLastTrackToNvs, prefBuf, _rfidCardId, _playMode, _trackLastPlayed);
 	Log_Println(prefBuf, LOGLEVEL_INFO);
-	Led_SetPause(false);
+	TRACE_SCOPE(NvsWrite);
+	if (_playPositionMs > 0) {
+		const PlayPositionMsRecord record = {_playPosition, _playPositionMs, _trackLastPlayed, 0};
+		AudioPlayer_PrefsPositionMs.putBytes(_rfidCardId, &record, sizeof(record));
+	} else if (AudioPlayer_PrefsPositionMs.isKey(_rfidCardId)) {
+		AudioPlayer_PrefsPositionMs.remove(_rfidCardId);
+	}
 	return gPrefsRfid.putString(_rfidCardId, prefBuf);
 
 	// Examples for serialized RFID-actions that are stored in NVS
@@ -1492,59 +1986,93 @@ void AudioPlayer_TrackControlToQueueSender(const uint8_t trackCommand, const uin
 	xQueueSend(gTrackControlQueue, &message, 0);
 }
 
-// Knuth-Fisher-Yates-algorithm to randomize playlist
-void AudioPlayer_RandomizePlaylist(Playlist *playlist) {
-	if (playlist->size() < 2) {
-		// we can not randomize less than 2 entries
-		return;
+// Adds an edit of the current playlist to the edit-queue (path is copied)
+bool AudioPlayer_PlaylistEditToQueueSender(const PlaylistEditAction action, const char *path, const uint16_t trackNumber) {
+	PlaylistEditMessage message = {action, trackNumber, nullptr};
+	if (action != PlaylistEditAction::Remove) {
+		if (path == nullptr || !fileValid(path) || !gFSystem.exists(path)) {
+			Log_Printf(LOGLEVEL_ERROR, dirOrFileDoesNotExist, path ? path : "");
+			return false;
+		}
+		message.path = x_strdup(path);
+		if (message.path == nullptr) {
+			return false;
+		}
 	}
-
-	// randomize using the "normal" random engine and shuffle
-	std::default_random_engine rnd(millis());
-	std::shuffle(playlist->begin(), playlist->end(), rnd);
+	if (xQueueSend(gPlaylistEditQueue, &message, 0) != pdPASS) {
+		free(message.path);
+		return false;
+	}
+	return true;
 }
 
-// Helper to sort playlist - standard string comparison
-static bool AudioPlayer_ArrSortHelper_strcmp(const char *a, const char *b) {
-	return strcmp(a, b) < 0;
-}
+// Edits the playlist in place: the current track keeps playing, the web-UI gets the change as delta
+void AudioPlayer_EditPlaylist(PlaylistEditMessage &message) {
+	Playlist *playlist = gPlayProperties.playlist;
+	const uint16_t currentTrack = gPlayProperties.currentTrackNumber;
+	bool editable = playlist != nullptr && !gPlayProperties.playlistFinished && gPlayProperties.playMode != NO_PLAYLIST && gPlayProperties.playMode != WEBSTREAM && gPlayProperties.playMode != BUSY;
+	size_t index = 0;
+	if (editable) {
+		switch (message.action) {
+			case PlaylistEditAction::InsertNext:
+				index = currentTrack + 1;
+				editable = playlist->size() < UINT16_MAX;
+				break;
+			case PlaylistEditAction::Append:
+				index = playlist->size();
+				editable = playlist->size() < UINT16_MAX;
+				break;
+			case PlaylistEditAction::Remove:
+			default:
+				index = message.trackNumber;
+				editable = index < playlist->size() && index != currentTrack; // the current track is skipped instead
+				break;
+		}
+	}
+	if (!editable) {
+		free(message.path);
+		Log_Println(playlistEditNotAllowed, LOGLEVEL_ERROR);
+		System_IndicateError();
+		return;
+	}
 
-// Helper to sort playlist - natural case-sensitive
-static bool AudioPlayer_ArrSortHelper_strnatcmp(const char *a, const char *b) {
-	return strnatcmp(a, b) < 0;
+	ShuffleState_Release(playlist); // the bag refers to the unedited order
+	gPlayProperties.playlistRevision = AudioPlayer_NextPlaylistRevision(gPlayProperties.playlistRevision);
+	if (message.action == PlaylistEditAction::Remove) {
+		playlist->erase(index);
+		if (index < currentTrack) {
+			gPlayProperties.currentTrackNumber--;
+		}
+		Web_PlaylistRemoved(index, gPlayProperties.playlistRevision);
+	} else {
+		playlist->insert(index, message.path);
+		Web_PlaylistInserted(index, message.path, gPlayProperties.playlistRevision);
+	}
+	Log_Printf(LOGLEVEL_NOTICE, playlistEdited, playlist->size());
+	AudioPlayer_PublishState();
+	Web_SendWebsocketData(0, WebsocketCodeType::TrackInfo);
+	System_IndicateOk();
 }
 
-// Helper to sort playlist - natural case-insensitive
-static bool AudioPlayer_ArrSortHelper_strnatcasecmp(const char *a, const char *b) {
-	return strnatcasecmp(a, b) < 0;
+// Randomizes the playback-order with a keyed permutation (entries aren't moved, see IndexPermutation)
+void AudioPlayer_RandomizePlaylist(Playlist *playlist) {
+	if (playlist->size() < 2) {
+		// we can not randomize less than 2 entries
+		return;
+	}
+
+	TRACE_SCOPE(PlaylistShuffle);
+	playlist->shuffle(esp_random());
 }
 
 // Sort playlist
 void AudioPlayer_SortPlaylist(Playlist *playlist) {
-	std::function<bool(const char *, const char *)> cmpFunc;
-	const char *mode;
-	switch (AudioPlayer_PlaylistSortMode) {
-		case playlistSortMode::STRCMP:
-			cmpFunc = AudioPlayer_ArrSortHelper_strcmp; // standard string comparison
-			mode = "standard string compare";
-			break;
-		case playlistSortMode::STRNATCMP:
-			cmpFunc = AudioPlayer_ArrSortHelper_strnatcmp; // natural case-sensitive
-			mode = "case-sensitive natural sorting";
-			break;
-		case playlistSortMode::STRNATCASECMP:
-		default:
-			cmpFunc = AudioPlayer_ArrSortHelper_strnatcasecmp; // natural case-insensitive
-			mode = "case-insensitive natural sorting";
-			break;
-	}
-
-	Log_Printf(LOGLEVEL_INFO, "Sorting files using %s", mode);
-	std::sort(playlist->begin(), playlist->end(), cmpFunc);
+	Playlist_Sort(playlist, AudioPlayer_PlaylistSortMode);
 }
 
 // Clear cover send notification
 void AudioPlayer_ClearCover(void) {
+	CoverCache_Cancel();
 	gPlayProperties.coverFilePos = 0;
 	AudioPlayer_StationLogoUrl = "";
 	// websocket and mqtt notify cover image has changed
@@ -1581,6 +2109,14 @@ void audio_id3data(const char *info) { // id3 metadata
 
 void audio_eof_mp3(const char *info) { // end of file
 	Log_Printf(LOGLEVEL_INFO, "eof_mp3     : %s", info);
+	if (AudioPlayer_AnnouncementActive) {
+		AudioPlayer_AnnouncementActive = false;
+		gPlayProperties.currentSpeechActive = false; // like audio_eof_speech()
+		return;
+	}
+#ifdef REPLAYGAIN_ENABLE
+	Loudness_EndTrack(true);
+#endif
 	gPlayProperties.trackFinished = true;
 }
 
@@ -1658,65 +2194,8 @@ void audio_id3image(File &file, const size_t pos, const size_t size) {
 
 // encoded blockpicture cover image segments (all ogg, vorbis, opus files, some flac files)
 void audio_oggimage(File &file, std::vector<uint32_t> v) {
-	// save decoded cover in /.cache/file.path()
-	String decodedCover = "/.cache";
-	decodedCover.concat(file.path());
-	if (gFSystem.exists(decodedCover)) {
-		Log_Printf(LOGLEVEL_DEBUG, "Cover already cached in %s", decodedCover.c_str());
-	} else {
-		String tmpDecodedCover = decodedCover.substring(0, decodedCover.lastIndexOf('/') + 1); // to prevent coverFile corruption write into temporary file; fixed name since no parallel usage of audioI2S
-		tmpDecodedCover.concat(".tmp");
-		File coverFile = gFSystem.open(tmpDecodedCover, FILE_WRITE, true); // open file with create=true to make sure parent directories are created
-		if (!coverFile) {
-			return;
-		}
-
-		// write fLaC marker in order to use flac Routine, since decoded cover has METADATA_BLOCK_PICTURE like flac
-		constexpr uint8_t flacMarker[] = "fLaC";
-		coverFile.write(flacMarker, std::char_traits<uint8_t>::length(flacMarker));
-
-		const size_t chunkSize = 2048; // must be base64 compatible, i.e. a multiple of 4
-		uint8_t *encodedChunk = (uint8_t *) x_malloc(chunkSize);
-		size_t decodedLength;
-		size_t currentRemainder = 0;
-		size_t currentPosition = file.position(); // save current position in audio file otherwise playback will result in an error
-
-		for (size_t i = 0; i < v.size(); i += 2) {
-			// calculate the number of chunks needed to read the segment
-			size_t numChunks = (v[i + 1] + currentRemainder) / chunkSize;
-			size_t remainder = currentRemainder;
-
-			// read and decode the segment chunk by chunk, write decodedChunk into encodedChunk to save memory
-			file.seek(v[i]);
-			for (size_t chunk = 0; chunk < numChunks; chunk++) {
-				file.readBytes(reinterpret_cast<char *>(&encodedChunk[remainder]), chunkSize - remainder);
-				decodedLength = b64decode(encodedChunk, encodedChunk, chunkSize);
-				coverFile.write(encodedChunk, decodedLength);
-				remainder = 0;
-			}
-
-			// calculate new remainder, read it, and if it is the end of file, decode it
-			currentRemainder = (v[i + 1] + currentRemainder) % chunkSize;
-			if (currentRemainder) {
-				file.readBytes(reinterpret_cast<char *>(&encodedChunk[remainder]), currentRemainder - remainder);
-				if (i == v.size() - 2) {
-					decodedLength = b64decode(encodedChunk, encodedChunk, currentRemainder);
-					coverFile.write(encodedChunk, decodedLength);
-				}
-			}
-		}
-		free(encodedChunk);
-		coverFile.close();
-		file.seek(currentPosition);
-		gFSystem.rename(tmpDecodedCover, decodedCover);
-		Log_Printf(LOGLEVEL_DEBUG, "Cover decoded and cached in %s", decodedCover.c_str());
-	}
-	gPlayProperties.coverFilePos = 1; // flacMarker gives 4 Bytes before METADATA_BLOCK_PICTURE, whereas for flac files audioI2S points 3 Bytes before METADATA_BLOCK_PICTURE, so gPlayProperties.coverFilePos has to be set to 4-3=1
-	// websocket and mqtt notify cover image has changed
-	Web_SendWebsocketData(0, WebsocketCodeType::CoverImg);
-#ifdef MQTT_ENABLE
-	publishMqtt(topicCoverChangedState, "", false);
-#endif
+	// base64-decoding of large covers takes a while, so it's done in background (see AudioPlayer_Process())
+	CoverCache_RequestOgg(file.path(), v);
 }
 
 void audio_eof_speech(const char *info) {
@@ -1724,6 +2203,15 @@ void audio_eof_speech(const char *info) {
 }
 
 void audio_process_i2s(int16_t *outBuff, uint16_t validSamples, uint8_t bitsPerSample, uint8_t channels, bool *continueI2S) {
+	Latency_Mark(LatencyStage::FirstAudio);
+	AudioPlayer_LastPcmMs = millis();
+	if (bitsPerSample == 16) {
+#ifdef REPLAYGAIN_ENABLE
+		Loudness_ProcessTrack(outBuff, validSamples, channels, AudioPlayer_GetAudio()->getSampleRate()); // in front of equalizer and gain
+#endif
+		Equalizer_Process(outBuff, validSamples, channels);
+		AudioFade_Process(outBuff, validSamples, channels);
+	}
 
 	uint32_t sample;
 	for (int i = 0; i < validSamples; i++) {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Equalizer.h"
 #include "Playlist.h"
 
 #include <optional>
@@ -8,12 +9,6 @@
 	#define AUDIOPLAYER_PLAYLIST_SORT_MODE_DEFAULT playlistSortMode::STRNATCASECMP
 #endif
 
-enum class playlistSortMode : uint8_t {
-	STRCMP = 1,
-	STRNATCMP = 2,
-	STRNATCASECMP = 3,
-};
-
 typedef struct { // Bit field
 	uint8_t playMode; // playMode
 	Playlist *playlist; // playlist
@@ -21,8 +16,9 @@ typedef struct { // Bit field
 	char title[255]; // current title
 	bool repeatCurrentTrack		: 1; // If current track should be looped
 	bool repeatPlaylist			: 1; // If whole playlist should be looped
-	uint16_t currentTrackNumber : 9; // Current tracknumber
+	uint16_t currentTrackNumber; // Current tracknumber
 	unsigned long startAtFilePos; // Offset to start play (in bytes)
+	uint32_t startAtTimeMs; // Offset to start play (in ms); preferred over startAtFilePos if the file has a seek-table
 	double currentRelPos; // Current relative playPosition (in %)
 	bool sleepAfterCurrentTrack : 1; // If uC should go to sleep after current track
 	bool sleepAfterPlaylist		: 1; // If uC should go to sleep after whole playlist
@@ -40,19 +36,66 @@ typedef struct { // Bit field
 	uint8_t tellMode			 : 2; // Tell mode for text to speech announcments
 	bool currentSpeechActive	 : 1; // If speech-play is active
 	bool lastSpeechActive		 : 1; // If speech-play was active
-	int8_t gainLowPass = 0; // Low Pass for EQ Control
-	int8_t gainBandPass = 0; // Band Pass for EQ Control
-	int8_t gainHighPass = 0; // High Pass for EQ Control
 	size_t coverFilePos; // current cover file position
 	size_t coverFileSize; // current cover file size
 	size_t audioFileSize; // file size of current audio file
 } playProps;
 
+// Consistent copy of the playback-state for other tasks. gPlayProperties is written by the
+// audio-task; it publishes this copy (seqlocked) whenever something changed.
+typedef struct {
+	uint32_t version; // increased by every publication
+	uint8_t playMode;
+	uint16_t currentTrackNumber;
+	uint16_t numberOfTracks; // size of the playlist (0 without playlist)
+	uint32_t playlistRevision;
+	double currentRelPos; // in %
+	size_t audioFileSize;
+	bool pausePlay;
+	bool trackFinished;
+	bool playlistFinished;
+	bool isWebstream;
+	bool currentSpeechActive;
+	bool repeatCurrentTrack;
+	bool repeatPlaylist;
+	size_t coverFilePos; // 0 = no cover
+	size_t coverFileSize;
+	char title[255];
+	char trackPath[256]; // playlist-entry of the current track (empty without playlist)
+} PlaybackState;
+
+typedef struct {
+	uint32_t ingressKbps; // measured stream throughput (smoothed)
+	uint32_t codecKbps; // bitrate of the current stream
+	uint32_t bufferedBytes;
+	uint32_t prebufferTargetBytes; // buffer needed to ride out the measured throughput-deficit
+	bool rebuffering;
+	uint32_t rebufferCount;
+	uint32_t rebufferTotalMs;
+	uint32_t lastRebufferMs;
+	uint32_t maxRebufferMs;
+	uint32_t reconnects;
+	uint32_t failedReconnects;
+} AudioPlayerStreamStats;
+
 typedef struct {
 	uint8_t action;
 	uint16_t trackNumber;
 } TrackControlMessage;
 
+// Edits of the playlist that is played (applied in place by the audio-task)
+enum class PlaylistEditAction : uint8_t {
+	InsertNext = 0,
+	Append,
+	Remove
+};
+
+typedef struct {
+	PlaylistEditAction action;
+	uint16_t trackNumber; // Remove: index of the track; otherwise ignored
+	char *path; // InsertNext/Append: allocated with malloc, ownership passes with the message
+} PlaylistEditMessage;
+
 extern playProps gPlayProperties;
 
 void AudioPlayer_Init(void);
@@ -61,13 +104,17 @@ void AudioPlayer_Exit(void);
 void AudioPlayer_Cyclic(void);
 uint8_t AudioPlayer_GetRepeatMode(void);
 void AudioPlayer_VolumeToQueueSender(const int32_t _newVolume, bool reAdjustRotary);
-void AudioPlayer_EqualizerToQueueSender(const int8_t gainLowPass, const int8_t gainBandPass, const int8_t gainHighPass);
-void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _lastPlayPos, const uint32_t _playMode, const uint16_t _trackLastPlayed);
+void AudioPlayer_EqualizerToQueueSender(const EqualizerPresets &presets);
+void AudioPlayer_TrackQueueDispatcher(const char *_itemToPlay, const uint32_t _lastPlayPos, const uint32_t _playMode, const uint16_t _trackLastPlayed, const uint32_t _lastPlayPosMs = 0);
+uint32_t AudioPlayer_GetPlayPositionMs(const char *rfidTag, const uint32_t playPosition, const uint16_t trackLastPlayed);
+void AudioPlayer_ForgetPlayPositionMs(const char *rfidTag);
 void AudioPlayer_TrackControlToQueueSender(const uint8_t trackCommand);
 void AudioPlayer_TrackControlToQueueSender(const uint8_t trackCommand, const uint16_t trackNumber);
+bool AudioPlayer_PlaylistEditToQueueSender(const PlaylistEditAction action, const char *path, const uint16_t trackNumber = 0);
 void AudioPlayer_PauseOnMinVolume(const uint8_t oldVolume, const uint8_t newVolume);
 
 playlistSortMode AudioPlayer_GetPlaylistSortMode(void);
+void AudioPlayer_SortPlaylist(Playlist *playlist);
 bool AudioPlayer_SetPlaylistSortMode(playlistSortMode value);
 bool AudioPlayer_SetPlaylistSortMode(uint8_t value);
 uint8_t AudioPlayer_GetCurrentVolume(void);
@@ -90,3 +137,6 @@ uint32_t AudioPlayer_GetFileDuration(void);
 String AudioPlayer_GetStationLogoUrl(void);
 void AudioPlayer_ProcessPause(void);
 void AudioPlayer_ProcessResume(void);
+void AudioPlayer_GetStreamStats(AudioPlayerStreamStats &stats);
+void AudioPlayer_PublishState(void); // audio-task only
+void AudioPlayer_GetState(PlaybackState &state);
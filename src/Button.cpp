@@ -3,11 +3,16 @@
 
 #include "Button.h"
 
+#include "ButtonGesture.h"
 #include "Cmd.h"
 #include "Log.h"
 #include "Port.h"
 #include "System.h"
 
+#include <algorithm>
+#include <array>
+#include <esp_timer.h>
+
 bool gButtonInitComplete = false;
 
 // Only enable those buttons that are not disabled (99 or >115)
@@ -46,17 +51,73 @@ bool gButtonInitComplete = false;
 
 t_button gButtons[7]; // next + prev + pplay + rotEnc + button4 + button5 + dummy-button
 uint8_t gShutdownButton = 99; // Helper used for Neopixel: stores button-number of shutdown-button
-uint16_t gLongPressTime = 0;
 
-#ifdef PORT_EXPANDER_ENABLE
-extern bool Port_AllowReadFromPortExpander;
-#endif
+namespace {
+constexpr uint8_t Button_Count = 6; // without dummy-button
+constexpr TickType_t Button_PollTicks = pdMS_TO_TICKS(10); // while debouncing or timing a gesture
+constexpr uint8_t Button_EventQueueLength = 8;
+
+constexpr uint16_t Button_ShortCmds[Button_Count] = {BUTTON_0_SHORT, BUTTON_1_SHORT, BUTTON_2_SHORT, BUTTON_3_SHORT, BUTTON_4_SHORT, BUTTON_5_SHORT};
+constexpr uint16_t Button_LongCmds[Button_Count] = {BUTTON_0_LONG, BUTTON_1_LONG, BUTTON_2_LONG, BUTTON_3_LONG, BUTTON_4_LONG, BUTTON_5_LONG};
+constexpr uint16_t Button_DoubleCmds[Button_Count] = {BUTTON_0_DOUBLE, BUTTON_1_DOUBLE, BUTTON_2_DOUBLE, BUTTON_3_DOUBLE, BUTTON_4_DOUBLE, BUTTON_5_DOUBLE};
+constexpr uint16_t Button_MultiCmds[Button_Count][Button_Count] = {
+	// only [lower][higher] is used
+	{CMD_NOTHING, BUTTON_MULTI_01, BUTTON_MULTI_02, BUTTON_MULTI_03, BUTTON_MULTI_04, BUTTON_MULTI_05},
+	{CMD_NOTHING, CMD_NOTHING, BUTTON_MULTI_12, BUTTON_MULTI_13, BUTTON_MULTI_14, BUTTON_MULTI_15},
+	{CMD_NOTHING, CMD_NOTHING, CMD_NOTHING, BUTTON_MULTI_23, BUTTON_MULTI_24, BUTTON_MULTI_25},
+	{CMD_NOTHING, CMD_NOTHING, CMD_NOTHING, CMD_NOTHING, BUTTON_MULTI_34, BUTTON_MULTI_35},
+	{CMD_NOTHING, CMD_NOTHING, CMD_NOTHING, CMD_NOTHING, CMD_NOTHING, BUTTON_MULTI_45},
+	{CMD_NOTHING, CMD_NOTHING, CMD_NOTHING, CMD_NOTHING, CMD_NOTHING, CMD_NOTHING},
+};
+
+constexpr std::array<ButtonGestureConfig, Button_Count> Button_Configs = [] {
+	std::array<ButtonGestureConfig, Button_Count> configs {};
+	for (uint8_t i = 0; i < Button_Count; i++) {
+		const uint16_t cmdLong = Button_LongCmds[i];
+		configs[i].doubleClick = Button_DoubleCmds[i] != CMD_NOTHING;
+		if (cmdLong == CMD_VOLUMEUP || cmdLong == CMD_VOLUMEDOWN) {
+			configs[i].longPress = ButtonLongPress::Repeat;
+		} else if (cmdLong == CMD_SLEEPMODE) {
+			configs[i].longPress = ButtonLongPress::OnRelease;
+		} else {
+			configs[i].longPress = ButtonLongPress::Once;
+		}
+	}
+	return configs;
+}();
+
+struct ButtonEvent {
+	uint16_t cmd;
+	ButtonGesture gesture;
+	uint32_t inputUs;
+};
+
+const char *Button_GestureNames[] = {
+	"short",
+	"double",
+	"long",
+	"multi",
+};
+static_assert(sizeof(Button_GestureNames) / sizeof(Button_GestureNames[0]) == static_cast<uint8_t>(ButtonGesture::Count), "Button_GestureNames out of sync with ButtonGesture");
+
+void Button_OnGesture(const ButtonGestureEvent &event);
+ButtonGestures Button_Gestures(Button_Count, Button_Configs.data(), buttonDebounceInterval, intervalToLongPress, intervalToDoubleClick, Button_OnGesture);
+QueueHandle_t Button_EventQueue = NULL;
+TaskHandle_t Button_TaskHandle = NULL;
+portMUX_TYPE Button_Mux = portMUX_INITIALIZER_UNLOCKED;
+volatile uint32_t Button_EdgeUs[Button_Count]; // first edge since the last sample (0: none)
+volatile uint32_t Button_ExpanderEdgeUs = 0;
+uint32_t Button_TaskWakeups = 0;
+ButtonLatencyStats Button_LatencyStats[static_cast<uint8_t>(ButtonGesture::Count)];
+} // namespace
 
-static volatile SemaphoreHandle_t Button_TimerSemaphore;
+static void Button_Task(void *parameter);
 
-hw_timer_t *Button_Timer = NULL;
-static void IRAM_ATTR onTimer();
-static void Button_DoButtonActions(void);
+// Wraps after ~71 min; only differences are used
+static inline uint32_t IRAM_ATTR Button_NowUs(void) {
+	const uint32_t now = static_cast<uint32_t>(esp_timer_get_time());
+	return now ? now : 1;
+}
 
 void Button_Init() {
 #if (WAKEUP_BUTTON >= 0 && WAKEUP_BUTTON <= MAX_GPIO)
@@ -98,6 +159,10 @@ void Button_Init() {
 	#endif
 #endif
 
+	for (t_button &button : gButtons) {
+		button.currentState = button.lastState = true; // released (also disabled buttons)
+	}
+
 // Activate internal pullups for all enabled buttons connected to GPIOs
 #ifdef BUTTON_0_ENABLE
 	if (BUTTON_0_ACTIVE_STATE) {
@@ -142,215 +207,235 @@ void Button_Init() {
 	}
 #endif
 
-	// Create 1000Hz-HW-Timer (currently only used for buttons)
-	Button_TimerSemaphore = xSemaphoreCreateBinary();
-#if (defined(ESP_ARDUINO_VERSION_MAJOR) && (ESP_ARDUINO_VERSION_MAJOR >= 3))
-	Button_Timer = timerBegin(1000000); // Prescaler: CPU-clock in MHz
-	timerAttachInterrupt(Button_Timer, &onTimer);
-	timerAlarm(Button_Timer, 10000, true, 0); // 100 Hz
-#else
-	Button_Timer = timerBegin(0, 240, true); // Prescaler: CPU-clock in MHz
-	timerAttachInterrupt(Button_Timer, &onTimer, true);
-	timerAlarmWrite(Button_Timer, 10000, true); // 100 Hz
-	timerAlarmEnable(Button_Timer);
-#endif
+	Button_EventQueue = xQueueCreate(Button_EventQueueLength, sizeof(ButtonEvent));
+	if (Button_EventQueue == NULL) {
+		Log_Println(unableToCreateButtonQ, LOGLEVEL_ERROR);
+	}
 }
 
-// If timer-semaphore is set, read buttons (unless controls are locked)
-void Button_Cyclic() {
-	if (xSemaphoreTake(Button_TimerSemaphore, 0) == pdTRUE) {
-		unsigned long currentTimestamp = millis();
-#ifdef PORT_EXPANDER_ENABLE
-		Port_Cyclic();
+static void IRAM_ATTR Button_NotifyTaskFromISR(void) {
+	if (Button_TaskHandle == NULL) {
+		return;
+	}
+	BaseType_t higherPriorityTaskWoken = pdFALSE;
+	vTaskNotifyGiveFromISR(Button_TaskHandle, &higherPriorityTaskWoken);
+	portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+static void IRAM_ATTR Button_EdgeISR(void *arg) {
+	const uintptr_t index = reinterpret_cast<uintptr_t>(arg);
+	portENTER_CRITICAL_ISR(&Button_Mux);
+	if (!Button_EdgeUs[index]) {
+		Button_EdgeUs[index] = Button_NowUs();
+	}
+	portEXIT_CRITICAL_ISR(&Button_Mux);
+	Button_NotifyTaskFromISR();
+}
+
+// Called by the port-expander's ISR if one of its inputs changed
+void IRAM_ATTR Button_WakeFromISR(void) {
+	portENTER_CRITICAL_ISR(&Button_Mux);
+	if (!Button_ExpanderEdgeUs) {
+		Button_ExpanderEdgeUs = Button_NowUs();
+	}
+	portEXIT_CRITICAL_ISR(&Button_Mux);
+	Button_NotifyTaskFromISR();
+}
+
+static void Button_AttachGpio(const uint8_t index, const uint8_t pin) {
+	attachInterruptArg(digitalPinToInterrupt(pin), Button_EdgeISR, reinterpret_cast<void *>(static_cast<uintptr_t>(index)), CHANGE);
+}
+
+// Starts the button-task; needs the port-expander to be initialized (if used)
+void Button_Start(void) {
+	xTaskCreatePinnedToCore(
+		Button_Task, /* Function to implement the task */
+		"Button_Task", /* Name of the task */
+		2048, /* Stack size in words */
+		NULL, /* Task input parameter */
+		2 | portPRIVILEGE_BIT, /* Priority of the task */
+		&Button_TaskHandle, /* Task handle. */
+		ARDUINO_RUNNING_CORE /* Core where the task should run */
+	);
+
+#ifdef BUTTON_0_ENABLE
+	Button_AttachGpio(0, NEXT_BUTTON);
+#endif
+#ifdef BUTTON_1_ENABLE
+	Button_AttachGpio(1, PREVIOUS_BUTTON);
+#endif
+#ifdef BUTTON_2_ENABLE
+	Button_AttachGpio(2, PAUSEPLAY_BUTTON);
+#endif
+#ifdef BUTTON_3_ENABLE
+	Button_AttachGpio(3, ROTARYENCODER_BUTTON);
+#endif
+#ifdef BUTTON_4_ENABLE
+	Button_AttachGpio(4, BUTTON_4);
 #endif
+#ifdef BUTTON_5_ENABLE
+	Button_AttachGpio(5, BUTTON_5);
+#endif
+}
 
-		if (System_AreControlsLocked()) {
-			return;
+static void Button_PostEvent(const ButtonGesture gesture, const uint16_t cmd, const uint32_t inputUs) {
+	if (cmd == CMD_NOTHING) {
+		return;
+	}
+	const ButtonEvent event = {cmd, gesture, inputUs};
+	if (xQueueSend(Button_EventQueue, &event, 0) != pdTRUE) {
+		Log_Println("Button: event dropped (queue full)", LOGLEVEL_DEBUG);
+	}
+}
+
+namespace {
+void Button_OnGesture(const ButtonGestureEvent &event) {
+	uint16_t cmd = CMD_NOTHING;
+	switch (event.gesture) {
+		case ButtonGesture::Short:
+			cmd = Button_ShortCmds[event.button];
+			break;
+		case ButtonGesture::Double:
+			cmd = Button_DoubleCmds[event.button];
+			break;
+		case ButtonGesture::Long:
+			cmd = Button_LongCmds[event.button];
+			break;
+		case ButtonGesture::Multi:
+			cmd = Button_MultiCmds[event.button][event.other];
+			break;
+		default:
+			break;
+	}
+	Button_PostEvent(event.gesture, cmd, event.inputUs);
+}
+} // namespace
+
+// Feeds the gesture-detection (which debounces) and keeps gButtons up to date for the LEDs;
+// returns true if the button has to be sampled again soon
+static bool Button_Update(const uint8_t index, const uint32_t edgeUs, const uint32_t nowUs) {
+	t_button &button = gButtons[index];
+	const bool wasPressed = Button_Gestures.isPressed(index);
+	const bool busy = Button_Gestures.update(index, !button.currentState, edgeUs, nowUs);
+	const bool pressed = Button_Gestures.isPressed(index);
+	if (pressed != wasPressed) {
+		button.lastState = !pressed;
+		button.isPressed = pressed;
+		if (pressed) {
+			button.lastPressedTimestamp = millis();
+			button.firstPressedTimestamp = button.lastPressedTimestamp;
+		} else {
+			button.isReleased = true;
+			button.lastReleasedTimestamp = millis();
+			button.firstPressedTimestamp = 0;
 		}
+	}
+	return busy;
+}
+
+// Reads the current state of all buttons; returns true if they have to be sampled again soon
+static bool Button_Sample(void) {
+	// Only reads the port-expander via I2C if its interrupt fired (or if no interrupt-pin is configured)
+	const bool expanderPending = Port_Cyclic();
+
+	uint32_t edgeUs[Button_Count];
+	uint32_t expanderEdgeUs;
+	portENTER_CRITICAL(&Button_Mux);
+	for (uint8_t i = 0; i < Button_Count; i++) {
+		edgeUs[i] = Button_EdgeUs[i];
+		Button_EdgeUs[i] = 0;
+	}
+	expanderEdgeUs = Button_ExpanderEdgeUs;
+	if (!expanderPending) {
+		Button_ExpanderEdgeUs = 0; // port-expander's inputs are stable
+	}
+	portEXIT_CRITICAL(&Button_Mux);
+	const uint32_t nowUs = Button_NowUs();
+
+	if (System_AreControlsLocked()) {
+		return expanderPending;
+	}
 
 // Buttons can be mixed between GPIO and port-expander.
 // But at the same time only one of them can be for example NEXT_BUTTON
 #if defined(BUTTON_0_ENABLE) || defined(EXPANDER_0_ENABLE)
-		gButtons[0].currentState = Port_Read(NEXT_BUTTON) ^ BUTTON_0_ACTIVE_STATE;
+	gButtons[0].currentState = Port_Read(NEXT_BUTTON) ^ BUTTON_0_ACTIVE_STATE;
 #endif
 #if defined(BUTTON_1_ENABLE) || defined(EXPANDER_1_ENABLE)
-		gButtons[1].currentState = Port_Read(PREVIOUS_BUTTON) ^ BUTTON_1_ACTIVE_STATE;
+	gButtons[1].currentState = Port_Read(PREVIOUS_BUTTON) ^ BUTTON_1_ACTIVE_STATE;
 #endif
 #if defined(BUTTON_2_ENABLE) || defined(EXPANDER_2_ENABLE)
-		gButtons[2].currentState = Port_Read(PAUSEPLAY_BUTTON) ^ BUTTON_2_ACTIVE_STATE;
+	gButtons[2].currentState = Port_Read(PAUSEPLAY_BUTTON) ^ BUTTON_2_ACTIVE_STATE;
 #endif
 #if defined(BUTTON_3_ENABLE) || defined(EXPANDER_3_ENABLE)
-		gButtons[3].currentState = Port_Read(ROTARYENCODER_BUTTON) ^ BUTTON_3_ACTIVE_STATE;
+	gButtons[3].currentState = Port_Read(ROTARYENCODER_BUTTON) ^ BUTTON_3_ACTIVE_STATE;
 #endif
 #if defined(BUTTON_4_ENABLE) || defined(EXPANDER_4_ENABLE)
-		gButtons[4].currentState = Port_Read(BUTTON_4) ^ BUTTON_4_ACTIVE_STATE;
+	gButtons[4].currentState = Port_Read(BUTTON_4) ^ BUTTON_4_ACTIVE_STATE;
 #endif
 #if defined(BUTTON_5_ENABLE) || defined(EXPANDER_5_ENABLE)
-		gButtons[5].currentState = Port_Read(BUTTON_5) ^ BUTTON_5_ACTIVE_STATE;
+	gButtons[5].currentState = Port_Read(BUTTON_5) ^ BUTTON_5_ACTIVE_STATE;
 #endif
 
-		// Iterate over all buttons in struct-array
-		for (uint8_t i = 0; i < sizeof(gButtons) / sizeof(gButtons[0]); i++) {
-			if (gButtons[i].currentState != gButtons[i].lastState && currentTimestamp - gButtons[i].lastPressedTimestamp > buttonDebounceInterval) {
-				if (!gButtons[i].currentState) {
-					gButtons[i].isPressed = true;
-					gButtons[i].lastPressedTimestamp = currentTimestamp;
-					if (!gButtons[i].firstPressedTimestamp) {
-						gButtons[i].firstPressedTimestamp = currentTimestamp;
-					}
-				} else {
-					gButtons[i].isReleased = true;
-					gButtons[i].lastReleasedTimestamp = currentTimestamp;
-					gButtons[i].firstPressedTimestamp = 0;
-				}
-			}
-			gButtons[i].lastState = gButtons[i].currentState;
-		}
+	bool busy = expanderPending;
+	for (uint8_t i = 0; i < Button_Count; i++) {
+		const uint32_t inputUs = edgeUs[i] ? edgeUs[i] : (expanderEdgeUs ? expanderEdgeUs : nowUs);
+		busy |= Button_Update(i, inputUs, nowUs);
 	}
-	gButtonInitComplete = true;
-	Button_DoButtonActions();
+	return busy;
 }
 
-// Do corresponding actions for all buttons
-void Button_DoButtonActions(void) {
-	if (gButtons[0].isPressed && gButtons[1].isPressed) {
-		gButtons[0].isPressed = false;
-		gButtons[1].isPressed = false;
-		Cmd_Action(BUTTON_MULTI_01);
-	} else if (gButtons[0].isPressed && gButtons[2].isPressed) {
-		gButtons[0].isPressed = false;
-		gButtons[2].isPressed = false;
-		Cmd_Action(BUTTON_MULTI_02);
-	} else if (gButtons[0].isPressed && gButtons[3].isPressed) {
-		gButtons[0].isPressed = false;
-		gButtons[3].isPressed = false;
-		Cmd_Action(BUTTON_MULTI_03);
-	} else if (gButtons[0].isPressed && gButtons[4].isPressed) {
-		gButtons[0].isPressed = false;
-		gButtons[4].isPressed = false;
-		Cmd_Action(BUTTON_MULTI_04);
-	} else if (gButtons[0].isPressed && gButtons[5].isPressed) {
-		gButtons[0].isPressed = false;
-		gButtons[5].isPressed = false;
-		Cmd_Action(BUTTON_MULTI_05);
-	} else if (gButtons[1].isPressed && gButtons[2].isPressed) {
-		gButtons[1].isPressed = false;
-		gButtons[2].isPressed = false;
-		Cmd_Action(BUTTON_MULTI_12);
-	} else if (gButtons[1].isPressed && gButtons[3].isPressed) {
-		gButtons[1].isPressed = false;
-		gButtons[3].isPressed = false;
-		Cmd_Action(BUTTON_MULTI_13);
-	} else if (gButtons[1].isPressed && gButtons[4].isPressed) {
-		gButtons[1].isPressed = false;
-		gButtons[4].isPressed = false;
-		Cmd_Action(BUTTON_MULTI_14);
-	} else if (gButtons[1].isPressed && gButtons[5].isPressed) {
-		gButtons[1].isPressed = false;
-		gButtons[5].isPressed = false;
-		Cmd_Action(BUTTON_MULTI_15);
-	} else if (gButtons[2].isPressed && gButtons[3].isPressed) {
-		gButtons[2].isPressed = false;
-		gButtons[3].isPressed = false;
-		Cmd_Action(BUTTON_MULTI_23);
-	} else if (gButtons[2].isPressed && gButtons[4].isPressed) {
-		gButtons[2].isPressed = false;
-		gButtons[4].isPressed = false;
-		Cmd_Action(BUTTON_MULTI_24);
-	} else if (gButtons[2].isPressed && gButtons[5].isPressed) {
-		gButtons[2].isPressed = false;
-		gButtons[5].isPressed = false;
-		Cmd_Action(BUTTON_MULTI_25);
-	} else if (gButtons[3].isPressed && gButtons[4].isPressed) {
-		gButtons[3].isPressed = false;
-		gButtons[4].isPressed = false;
-		Cmd_Action(BUTTON_MULTI_34);
-	} else if (gButtons[3].isPressed && gButtons[5].isPressed) {
-		gButtons[3].isPressed = false;
-		gButtons[5].isPressed = false;
-		Cmd_Action(BUTTON_MULTI_35);
-	} else if (gButtons[4].isPressed && gButtons[5].isPressed) {
-		gButtons[4].isPressed = false;
-		gButtons[5].isPressed = false;
-		Cmd_Action(BUTTON_MULTI_45);
-	} else {
-		unsigned long currentTimestamp = millis();
-		for (uint8_t i = 0; i <= 5; i++) {
-			if (gButtons[i].isPressed) {
-				uint8_t Cmd_Short = 0;
-				uint8_t Cmd_Long = 0;
-
-				switch (i) { // Long-press-actions
-					case 0:
-						Cmd_Short = BUTTON_0_SHORT;
-						Cmd_Long = BUTTON_0_LONG;
-						break;
-
-					case 1:
-						Cmd_Short = BUTTON_1_SHORT;
-						Cmd_Long = BUTTON_1_LONG;
-						break;
-
-					case 2:
-						Cmd_Short = BUTTON_2_SHORT;
-						Cmd_Long = BUTTON_2_LONG;
-						break;
-
-					case 3:
-						Cmd_Short = BUTTON_3_SHORT;
-						Cmd_Long = BUTTON_3_LONG;
-						break;
-
-					case 4:
-						Cmd_Short = BUTTON_4_SHORT;
-						Cmd_Long = BUTTON_4_LONG;
-						break;
-
-					case 5:
-						Cmd_Short = BUTTON_5_SHORT;
-						Cmd_Long = BUTTON_5_LONG;
-						break;
-				}
-
-				if (gButtons[i].lastReleasedTimestamp > gButtons[i].lastPressedTimestamp) { // short action
-					if (gButtons[i].lastReleasedTimestamp - gButtons[i].lastPressedTimestamp < intervalToLongPress) {
-						Cmd_Action(Cmd_Short);
-					} else {
-						// sleep-mode should only be triggered on release, otherwise it will wake it up directly again
-						if (Cmd_Long == CMD_SLEEPMODE) {
-							Cmd_Action(Cmd_Long);
-						}
-					}
-
-					gButtons[i].isPressed = false;
-
-				} else if (Cmd_Long == CMD_VOLUMEUP || Cmd_Long == CMD_VOLUMEDOWN) { // volume-buttons
-					// only start action if intervalToLongPress has been reached
-					if (currentTimestamp - gButtons[i].lastPressedTimestamp > intervalToLongPress) {
-
-						// calculate remainder
-						uint16_t remainder = (currentTimestamp - gButtons[i].lastPressedTimestamp) % intervalToLongPress;
-
-						// trigger action if remainder rolled over
-						if (remainder < gLongPressTime) {
-							Cmd_Action(Cmd_Long);
-						}
-
-						gLongPressTime = remainder;
-					}
-
-				} else if (Cmd_Long != CMD_SLEEPMODE) { // long action, if not sleep-mode
-					// start action if intervalToLongPress has been reached
-					if ((currentTimestamp - gButtons[i].lastPressedTimestamp) > intervalToLongPress) {
-						gButtons[i].isPressed = false;
-						Cmd_Action(Cmd_Long);
-					}
-				}
-			}
+// Sleeps until an edge-interrupt arrives; polls only while a button is bouncing or a gesture is timed
+static void Button_Task(void *parameter) {
+	for (;;) {
+		const bool busy = Button_Sample();
+		gButtonInitComplete = true;
+		ulTaskNotifyTake(pdTRUE, busy ? Button_PollTicks : portMAX_DELAY);
+		Button_TaskWakeups++;
+	}
+}
+
+static void Button_UpdateLatencyStats(const ButtonGesture gesture, const uint32_t latencyUs) {
+	ButtonLatencyStats &stats = Button_LatencyStats[static_cast<uint8_t>(gesture)];
+	uint8_t bucket = 0;
+	while (bucket < buttonLatencyBuckets - 1 && latencyUs > buttonLatencyEdgesMs[bucket] * 1000u) {
+		bucket++;
+	}
+	stats.histogram[bucket]++;
+	stats.actions++;
+	stats.lastUs = latencyUs;
+	stats.maxUs = std::max(stats.maxUs, latencyUs);
+}
+
+// Runs the actions of the gestures detected by the button-task (in main-loop's context as before)
+void Button_Cyclic() {
+	ButtonEvent event;
+	while (Button_EventQueue && xQueueReceive(Button_EventQueue, &event, 0) == pdTRUE) {
+		if (System_AreControlsLocked()) {
+			continue;
 		}
+		Button_UpdateLatencyStats(event.gesture, Button_NowUs() - event.inputUs);
+		Cmd_Action(event.cmd);
+	}
+}
+
+void Button_GetLatencyStats(const ButtonGesture gesture, ButtonLatencyStats &stats) {
+	const uint8_t gestureIndex = static_cast<uint8_t>(gesture);
+	if (gestureIndex >= static_cast<uint8_t>(ButtonGesture::Count)) {
+		stats = {};
+		return;
 	}
+	stats = Button_LatencyStats[gestureIndex];
+}
+
+uint32_t Button_GetTaskWakeups(void) {
+	return Button_TaskWakeups;
 }
 
-void IRAM_ATTR onTimer() {
-	xSemaphoreGiveFromISR(Button_TimerSemaphore, NULL);
+const char *Button_GetGestureName(const ButtonGesture gesture) {
+	const uint8_t gestureIndex = static_cast<uint8_t>(gesture);
+	if (gestureIndex >= static_cast<uint8_t>(ButtonGesture::Count)) {
+		return "unknown";
+	}
+	return Button_GestureNames[gestureIndex];
 }
@@ -1,7 +1,9 @@
 #pragma once
 
+#include "ButtonGesture.h"
+
 typedef struct {
-	bool lastState	  : 1;
+	bool lastState	  : 1; // debounced
 	bool currentState : 1;
 	bool isPressed	  : 1;
 	bool isReleased	  : 1;
@@ -10,8 +12,24 @@ typedef struct {
 	unsigned long firstPressedTimestamp;
 } t_button;
 
+constexpr uint8_t buttonLatencyBuckets = 8;
+constexpr uint16_t buttonLatencyEdgesMs[buttonLatencyBuckets - 1] = {5, 10, 20, 50, 100, 200, 500}; // last bucket holds everything above
+
+// Time from the input completing a gesture (edge or long-press-threshold) to its action
+struct ButtonLatencyStats {
+	uint32_t actions;
+	uint32_t lastUs;
+	uint32_t maxUs;
+	uint32_t histogram[buttonLatencyBuckets];
+};
+
 extern uint8_t gShutdownButton;
 extern bool gButtonInitComplete;
 
 void Button_Init(void);
+void Button_Start(void);
 void Button_Cyclic(void);
+void Button_WakeFromISR(void);
+void Button_GetLatencyStats(const ButtonGesture gesture, ButtonLatencyStats &stats);
+uint32_t Button_GetTaskWakeups(void);
+const char *Button_GetGestureName(const ButtonGesture gesture);
@@ -0,0 +1,100 @@
+#include "ButtonGesture.h"
+
+#include <algorithm>
+
+ButtonGestures::ButtonGestures(uint8_t buttons, const ButtonGestureConfig *configs, uint32_t debounceMs, uint32_t longPressMs, uint32_t doubleClickMs, Handler handler)
+	: buttons_(std::min(buttons, maxButtons))
+	, configs_(configs)
+	, debounceUs_(debounceMs * 1000u)
+	, longPressUs_(longPressMs * 1000u)
+	, doubleClickUs_(doubleClickMs * 1000u)
+	, handler_(std::move(handler)) { }
+
+// Edges within the debounce-interval after an accepted one are ignored; the state is taken once it has settled
+bool ButtonGestures::update(uint8_t button, bool pressed, uint32_t edgeUs, uint32_t nowUs) {
+	if (button >= buttons_) {
+		return false;
+	}
+	State &state = states_[button];
+	const bool settling = (nowUs - state.changeUs) < debounceUs_;
+	if (pressed != state.pressed && !settling) {
+		state.pressed = pressed;
+		state.changeUs = edgeUs;
+		if (pressed) {
+			onPress(button, edgeUs);
+		} else {
+			onRelease(button, edgeUs);
+		}
+	}
+	onTick(button, nowUs);
+	return (nowUs - state.changeUs) < debounceUs_ || pressed != state.pressed || state.phase != Phase::Idle;
+}
+
+void ButtonGestures::onPress(uint8_t button, uint32_t edgeUs) {
+	State &state = states_[button];
+	if (state.phase == Phase::WaitDouble) { // second click
+		state.phase = Phase::Pressed;
+		state.consumed = true;
+		fire(ButtonGesture::Double, button, edgeUs);
+		return;
+	}
+	state.phase = Phase::Pressed;
+	state.consumed = false;
+	state.repeats = 0;
+	state.pressUs = edgeUs;
+
+	// Buttons pressed in parallel (before one of them fired an action)
+	for (uint8_t other = 0; other < buttons_; other++) {
+		State &otherState = states_[other];
+		if (other != button && otherState.phase == Phase::Pressed && !otherState.consumed) {
+			state.consumed = true;
+			otherState.consumed = true;
+			fire(ButtonGesture::Multi, std::min(button, other), edgeUs, std::max(button, other));
+			return;
+		}
+	}
+}
+
+void ButtonGestures::onRelease(uint8_t button, uint32_t edgeUs) {
+	State &state = states_[button];
+	if (state.phase != Phase::Pressed) {
+		return;
+	}
+	state.phase = Phase::Idle;
+	if (state.consumed) {
+		return;
+	}
+	if (edgeUs - state.pressUs < longPressUs_) {
+		if (configs_[button].doubleClick) {
+			state.phase = Phase::WaitDouble;
+			state.releaseUs = edgeUs;
+		} else {
+			fire(ButtonGesture::Short, button, edgeUs);
+		}
+	} else if (configs_[button].longPress == ButtonLongPress::OnRelease) {
+		fire(ButtonGesture::Long, button, edgeUs);
+	}
+}
+
+// Time-based gestures: long-press (repeated for volume) and expiry of the double-click-window
+void ButtonGestures::onTick(uint8_t button, uint32_t nowUs) {
+	State &state = states_[button];
+	if (state.phase == Phase::WaitDouble) {
+		if (nowUs - state.releaseUs >= doubleClickUs_) {
+			state.phase = Phase::Idle;
+			fire(ButtonGesture::Short, button, state.releaseUs);
+		}
+	} else if (state.phase == Phase::Pressed && !state.consumed) {
+		const uint32_t heldUs = nowUs - state.pressUs;
+		const ButtonLongPress longPress = configs_[button].longPress;
+		if (longPress == ButtonLongPress::Repeat) {
+			if (heldUs / longPressUs_ > state.repeats) {
+				state.repeats++;
+				fire(ButtonGesture::Long, button, state.pressUs + longPressUs_ * state.repeats);
+			}
+		} else if (longPress == ButtonLongPress::Once && heldUs >= longPressUs_) {
+			state.consumed = true;
+			fire(ButtonGesture::Long, button, state.pressUs + longPressUs_);
+		}
+	}
+}
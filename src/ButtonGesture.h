@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+// Gestures recognized by the button-task; their actions are run by Button_Cyclic()
+enum class ButtonGesture : uint8_t {
+	Short = 0,
+	Double,
+	Long,
+	Multi,
+	Count // has to be the last entry
+};
+
+enum class ButtonLongPress : uint8_t {
+	Once = 0, // fired when the press reaches the long-press-interval
+	Repeat, // fired again every interval while held (volume)
+	OnRelease // fired on release after the interval (sleep-mode would wake up again while the button is held)
+};
+
+struct ButtonGestureConfig {
+	bool doubleClick; // a second click may follow, so the short-press waits for the double-click-window
+	ButtonLongPress longPress;
+};
+
+struct ButtonGestureEvent {
+	ButtonGesture gesture;
+	uint8_t button;
+	uint8_t other; // second button of a multi-press (lower index in button)
+	uint32_t inputUs; // time of the input that completed the gesture
+};
+
+// Debouncing and gesture-detection, independent of GPIOs and tasks: fed with the raw state of a button and the
+// time of its first edge, it reports gestures to the handler. Times are in µs and may wrap (only differences are used).
+class ButtonGestures {
+public:
+	static constexpr uint8_t maxButtons = 8;
+	using Handler = std::function<void(const ButtonGestureEvent &)>;
+
+	ButtonGestures(uint8_t buttons, const ButtonGestureConfig *configs, uint32_t debounceMs, uint32_t longPressMs, uint32_t doubleClickMs, Handler handler);
+
+	// Returns true if the button has to be sampled again soon (bouncing or a gesture is timed)
+	bool update(uint8_t button, bool pressed, uint32_t edgeUs, uint32_t nowUs);
+	bool isPressed(uint8_t button) const {
+		return states_[button].pressed;
+	}
+
+private:
+	enum class Phase : uint8_t {
+		Idle = 0,
+		Pressed,
+		WaitDouble // released after a short press, a second click may follow
+	};
+
+	struct State {
+		Phase phase = Phase::Idle;
+		bool pressed = false; // debounced
+		bool consumed = false; // an action was already fired for the current press
+		uint16_t repeats = 0; // long-press-actions fired for the current press
+		uint32_t changeUs = 0; // last accepted edge
+		uint32_t pressUs = 0;
+		uint32_t releaseUs = 0;
+	};
+
+	void onPress(uint8_t button, uint32_t edgeUs);
+	void onRelease(uint8_t button, uint32_t edgeUs);
+	void onTick(uint8_t button, uint32_t nowUs);
+	void fire(ButtonGesture gesture, uint8_t button, uint32_t inputUs, uint8_t other = 0) const {
+		handler_(ButtonGestureEvent {gesture, button, other, inputUs});
+	}
+
+	const uint8_t buttons_;
+	const ButtonGestureConfig *configs_;
+	const uint32_t debounceUs_;
+	const uint32_t longPressUs_;
+	const uint32_t doubleClickUs_;
+	Handler handler_;
+	State states_[maxButtons];
+};
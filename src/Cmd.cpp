@@ -14,6 +14,13 @@
 #include "System.h"
 #include "Wlan.h"
 
+// Commands run outside of the audio-task: the play-mode is read from the published playback-state
+static bool Cmd_NoPlaylist(void) {
+	PlaybackState playbackState;
+	AudioPlayer_GetState(playbackState);
+	return playbackState.playMode == NO_PLAYLIST;
+}
+
 static void Cmd_HandleSleepAction(bool enable, const char *enLogMsg, const char *enMqttMsg) {
 	Led_SetNightmode(enable);
 	if (enable) {
@@ -90,7 +97,7 @@ void Cmd_Action(const uint16_t mod) {
 		}
 
 		case CMD_SLEEP_AFTER_END_OF_TRACK: { // Puts uC to sleep after end of current track
-			if (gPlayProperties.playMode == NO_PLAYLIST) {
+			if (Cmd_NoPlaylist()) {
 				Log_Println(modificatorNotallowedWhenIdle, LOGLEVEL_NOTICE);
 				System_IndicateError();
 				return;
@@ -106,7 +113,7 @@ void Cmd_Action(const uint16_t mod) {
 		}
 
 		case CMD_SLEEP_AFTER_END_OF_PLAYLIST: { // Puts uC to sleep after end of whole playlist (can take a while :->)
-			if (gPlayProperties.playMode == NO_PLAYLIST) {
+			if (Cmd_NoPlaylist()) {
 				Log_Println(modificatorNotallowedWhenIdle, LOGLEVEL_NOTICE);
 				System_IndicateError();
 				return;
@@ -121,7 +128,9 @@ void Cmd_Action(const uint16_t mod) {
 		}
 
 		case CMD_SLEEP_AFTER_5_TRACKS: {
-			if (gPlayProperties.playMode == NO_PLAYLIST || !gPlayProperties.playlist) {
+			PlaybackState playbackState;
+			AudioPlayer_GetState(playbackState);
+			if (playbackState.playMode == NO_PLAYLIST || playbackState.numberOfTracks == 0) {
 				Log_Println(modificatorNotallowedWhenIdle, LOGLEVEL_NOTICE);
 				System_IndicateError();
 				return;
@@ -132,7 +141,7 @@ void Cmd_Action(const uint16_t mod) {
 			gPlayProperties.sleepAfter5Tracks = !gPlayProperties.sleepAfter5Tracks;
 
 			if (gPlayProperties.sleepAfter5Tracks) {
-				if (gPlayProperties.currentTrackNumber + 5 > gPlayProperties.playlist->size()) {
+				if (playbackState.currentTrackNumber + 5 > playbackState.numberOfTracks) {
 					// execute a sleep after end of playlist
 					Cmd_Action(CMD_SLEEP_AFTER_END_OF_PLAYLIST);
 					break;
@@ -144,7 +153,7 @@ void Cmd_Action(const uint16_t mod) {
 		}
 
 		case CMD_REPEAT_PLAYLIST: {
-			if (gPlayProperties.playMode == NO_PLAYLIST) {
+			if (Cmd_NoPlaylist()) {
 				Log_Println(modificatorNotallowedWhenIdle, LOGLEVEL_NOTICE);
 				System_IndicateError();
 			} else {
@@ -163,7 +172,7 @@ void Cmd_Action(const uint16_t mod) {
 		}
 
 		case CMD_REPEAT_TRACK: { // Introduces looping for track-mode
-			if (gPlayProperties.playMode == NO_PLAYLIST) {
+			if (Cmd_NoPlaylist()) {
 				Log_Println(modificatorNotallowedWhenIdle, LOGLEVEL_NOTICE);
 				System_IndicateError();
 			} else {
@@ -262,7 +271,8 @@ void Cmd_Action(const uint16_t mod) {
 		}
 
 		case CMD_TELL_CURRENT_TIME: {
-			if (Wlan_IsConnected()) {
+			struct tm timeinfo;
+			if (Wlan_IsConnected() || getLocalTime(&timeinfo, 0)) { // clips on SD don't need a network, but the clock has to be set
 				gPlayProperties.tellMode = TTS_CURRENT_TIME;
 				gPlayProperties.currentSpeechActive = true;
 				gPlayProperties.lastSpeechActive = true;
@@ -1,40 +1,153 @@
-#include <Arduino.h>
-
 #include "Common.h"
 
-// Base64 decoder adapted from https://stackoverflow.com/a/37109258
-static const int B64index[256] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 62, 63, 62, 62, 63, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 0, 0, 0, 0, 63, 0, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51};
+#include <algorithm>
+#include <array>
+
+namespace {
+// 6 bit value of every base64-character (standard and URL-safe alphabet); other characters decode as 0
+constexpr std::array<uint8_t, 256> B64Values = [] {
+	std::array<uint8_t, 256> values {};
+	for (uint8_t i = 0; i < 26; i++) {
+		values['A' + i] = i;
+		values['a' + i] = 26 + i;
+	}
+	for (uint8_t i = 0; i < 10; i++) {
+		values['0' + i] = 52 + i;
+	}
+	values['+'] = values['-'] = values['.'] = 62;
+	values['/'] = values['_'] = values[','] = 63;
+	return values;
+}();
+
+inline uint32_t b64group(const uint8_t *in) {
+	return B64Values[in[0]] << 18 | B64Values[in[1]] << 12 | B64Values[in[2]] << 6 | B64Values[in[3]];
+}
+} // namespace
 
 /// @brief decodes a base64 string
 /// @param input_buffer pointer to the base64 string buffer
 /// @param output_buffer pointer to the output buffer (can be the same as the input buffer)
-/// @param input_length length of the base64 string (without \0 terminator byte)
-/// @return number of bytes written to the output buffer
+/// @param input_length length of the base64 string (without \0 terminator byte); padding is optional
+/// @return number of bytes written to the output buffer; 0 if the length is invalid (a single character left over)
 size_t b64decode(const void *input_buffer, void *output_buffer, const size_t input_length) {
-	if (input_length == 0) {
-		return 0;
+	const size_t tail = input_length % 4;
+	if (input_length == 0 || tail == 1) {
+		return 0; // one character doesn't make a byte (and the last group would be read beyond the input)
 	}
 
-	unsigned char *p = (unsigned char *) input_buffer;
-	size_t j = 0, pad1 = input_length % 4 || p[input_length - 1] == '=', pad2 = pad1 && (input_length % 4 > 2 || p[input_length - 2] != '=');
-	const size_t last = (input_length - pad1) / 4 << 2;
-	// size_t output_size = last / 4 * 3 + pad1 + pad2;
-	unsigned char *str = (unsigned char *) output_buffer;
+	const uint8_t *in = static_cast<const uint8_t *>(input_buffer);
+	uint8_t *out = static_cast<uint8_t *>(output_buffer);
+	uint8_t *const start = out;
+	const bool pad1 = tail || in[input_length - 1] == '='; // last group is incomplete
+	const bool pad2 = (tail == 3 && in[input_length - 1] != '=') || (!tail && in[input_length - 1] == '=' && in[input_length - 2] != '='); // ... but has two bytes
+	const uint8_t *last = in + (input_length - pad1) / 4 * 4;
 
-	for (size_t i = 0; i < last; i += 4) {
-		int n = B64index[p[i]] << 18 | B64index[p[i + 1]] << 12 | B64index[p[i + 2]] << 6 | B64index[p[i + 3]];
-		str[j++] = n >> 16;
-		str[j++] = n >> 8 & 0xFF;
-		str[j++] = n & 0xFF;
+	// two groups per round; output never overtakes the input, so decoding in place is fine
+	for (; in + 8 <= last; in += 8, out += 6) {
+		const uint32_t n0 = b64group(in);
+		const uint32_t n1 = b64group(in + 4);
+		out[0] = n0 >> 16;
+		out[1] = n0 >> 8;
+		out[2] = n0;
+		out[3] = n1 >> 16;
+		out[4] = n1 >> 8;
+		out[5] = n1;
+	}
+	for (; in < last; in += 4, out += 3) {
+		const uint32_t n = b64group(in);
+		out[0] = n >> 16;
+		out[1] = n >> 8;
+		out[2] = n;
 	}
 	if (pad1) {
-		int n = B64index[p[last]] << 18 | B64index[p[last + 1]] << 12;
-		str[j++] = n >> 16;
+		uint32_t n = B64Values[in[0]] << 18 | B64Values[in[1]] << 12;
+		*out++ = n >> 16;
 		if (pad2) {
-			n |= B64index[p[last + 2]] << 6;
-			str[j++] = n >> 8 & 0xFF;
+			n |= B64Values[in[2]] << 6;
+			*out++ = n >> 8;
 		}
 	}
 
-	return j;
+	return out - start;
+}
+
+// Check if file-type is correct
+bool fileValid(const char *_fileItem) {
+	// clang-format off
+	// all supported extension
+	constexpr std::array audioFileSufix = {
+		".mp3",
+		".aac",
+		".m4a",
+		".wav",
+		".flac",
+		".ogg",
+		".oga",
+		".opus",
+		// playlists
+		".m3u",
+		".m3u8",
+		".pls",
+		".asx"
+	};
+	// clang-format on
+	constexpr size_t maxExtLen = strlen(*std::max_element(audioFileSufix.begin(), audioFileSufix.end(), [](const char *a, const char *b) {
+		return strlen(a) < strlen(b);
+	}));
+
+	if (!_fileItem || !strlen(_fileItem)) {
+		// invalid entry
+		return false;
+	}
+
+	// check for streams
+	if (strncmp(_fileItem, "http://", strlen("http://")) == 0 || strncmp(_fileItem, "https://", strlen("https://")) == 0) {
+		// this is a stream
+		return true;
+	}
+
+	// check for files which start with "/."
+	const char *lastSlashPtr = strrchr(_fileItem, '/');
+	if (lastSlashPtr == nullptr) {
+		// we have a relative filename without any slashes...
+		// set the pointer so that it points to the first character AFTER a +1
+		lastSlashPtr = _fileItem - 1;
+	}
+	if (*(lastSlashPtr + 1) == '.') {
+		// we have a hidden file
+		// Log_Printf(LOGLEVEL_DEBUG, "File is hidden: %s", _fileItem);
+		return false;
+	}
+
+	// extract the file extension
+	const char *extStartPtr = strrchr(_fileItem, '.');
+	if (extStartPtr == nullptr) {
+		// no extension found
+		// Log_Printf(LOGLEVEL_DEBUG, "File has no extension: %s", _fileItem);
+		return false;
+	}
+	const size_t extLen = strlen(extStartPtr);
+	if (extLen > maxExtLen) {
+		// extension too long, we do not care anymore
+		// Log_Printf(LOGLEVEL_DEBUG, "File not supported (extension to long): %s", _fileItem);
+		return false;
+	}
+	char extBuffer[maxExtLen + 1] = {0};
+	memcpy(extBuffer, extStartPtr, extLen);
+
+	// make the extension lower case (without using non standard C functions)
+	for (size_t i = 0; i < extLen; i++) {
+		extBuffer[i] = tolower(extBuffer[i]);
+	}
+
+	// check extension against all supported values
+	for (const auto &e : audioFileSufix) {
+		if (strcmp(extBuffer, e) == 0) {
+			// hit we found the extension
+			return true;
+		}
+	}
+	// miss, we did not find the extension
+	// Log_Printf(LOGLEVEL_DEBUG, "File not supported: %s", _fileItem);
+	return false;
 }
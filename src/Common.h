@@ -1,5 +1,10 @@
 #pragma once
 
+// Platform-independent helpers: only the C/C++ standard library is used here (no Arduino-String, no ESP-IDF),
+// so this header and Common.cpp also compile on a host for profiling.
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -7,6 +12,7 @@ constexpr char stringDelimiter[] = "#"; // Character used to encapsulate data in
 constexpr char stringOuterDelimiter[] = "^"; // Character used to encapsulate encapsulated data along with RFID-ID in backup-file
 
 size_t b64decode(const void *input_buffer, void *output_buffer, const size_t input_length);
+bool fileValid(const char *_fileItem);
 
 inline bool copyStringToBuffer(char *dst, size_t dstSize, const char *src) {
 	if (!dst || dstSize == 0) {
@@ -32,7 +38,7 @@ inline bool copyDelimitedTokenToBuffer(const char *start, const char *end, char
 	return true;
 }
 
-inline bool parseRfidPreferenceEntry(const String &serialized, char *fileBuf, size_t fileBufSize, uint32_t &lastPlayPos, uint32_t &playMode, uint16_t &trackLastPlayed) {
+inline bool parseRfidPreferenceEntry(const char *serialized, char *fileBuf, size_t fileBufSize, uint32_t &lastPlayPos, uint32_t &playMode, uint16_t &trackLastPlayed, uint32_t &lastPlayPosMs) {
 	if (!fileBuf || fileBufSize == 0) {
 		return false;
 	}
@@ -41,9 +47,10 @@ inline bool parseRfidPreferenceEntry(const String &serialized, char *fileBuf, si
 	lastPlayPos = 0;
 	playMode = 1;
 	trackLastPlayed = 0;
+	lastPlayPosMs = 0;
 
 	const char delimiter = stringDelimiter[0];
-	const char *cursor = serialized.c_str();
+	const char *cursor = serialized;
 	uint8_t fieldCount = 0;
 	char numberBuf[16];
 
@@ -84,6 +91,12 @@ inline bool parseRfidPreferenceEntry(const String &serialized, char *fileBuf, si
 				}
 				trackLastPlayed = strtoul(numberBuf, NULL, 10);
 				break;
+			case 5: // play-position in ms, written into the entry by earlier versions (now kept beside it): still read
+				if (!copyDelimitedTokenToBuffer(fieldStart, fieldEnd, numberBuf, sizeof(numberBuf))) {
+					return false;
+				}
+				lastPlayPosMs = strtoul(numberBuf, NULL, 10);
+				break;
 			default:
 				return false;
 		}
@@ -94,7 +107,7 @@ inline bool parseRfidPreferenceEntry(const String &serialized, char *fileBuf, si
 		cursor = fieldEnd;
 	}
 
-	return fieldCount == 4;
+	return fieldCount == 4 || fieldCount == 5;
 }
 
 inline bool isNumber(const char *str) {
@@ -138,13 +151,13 @@ inline bool endsWith(const char *str, const char *suf) {
 	return b == suf && *a == *b;
 }
 
-inline void convertAsciiToUtf8(String asciiString, char *utf8String, size_t utf8StringSize) {
+inline void convertAsciiToUtf8(const char *asciiString, char *utf8String, size_t utf8StringSize) {
 
-	int k = 0;
+	size_t k = 0;
 
-	for (int i = 0; i < asciiString.length() && k < utf8StringSize - 2; i++) {
+	for (size_t i = 0; asciiString[i] != '\0' && k < utf8StringSize - 2; i++) {
 
-		switch (asciiString[i]) {
+		switch (static_cast<uint8_t>(asciiString[i])) {
 			case 0x8e:
 				utf8String[k++] = 0xc3;
 				utf8String[k++] = 0x84;
@@ -0,0 +1,171 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "CoverCache.h"
+
+#include "Common.h"
+#include "Log.h"
+#include "MemX.h"
+#include "SdCard.h"
+
+#include <freertos/semphr.h>
+
+namespace {
+constexpr size_t CoverCache_ChunkSize = 2048; // base64-characters read at once
+constexpr uint8_t CoverCache_FlacMarker[] = {'f', 'L', 'a', 'C'};
+
+struct CoverCacheJob {
+	String audioPath;
+	std::vector<uint32_t> segments;
+	uint32_t generation = 0;
+};
+
+SemaphoreHandle_t CoverCache_Mutex = nullptr;
+TaskHandle_t CoverCache_TaskHandle = nullptr;
+CoverCacheJob CoverCache_Pending;
+uint32_t CoverCache_Generation = 0; // increased by every request and cancel
+uint32_t CoverCache_ReadyGeneration = 0; // generation whose cover is cached (0: none)
+
+bool CoverCache_IsCurrent(uint32_t generation) {
+	xSemaphoreTake(CoverCache_Mutex, portMAX_DELAY);
+	const bool current = (generation == CoverCache_Generation);
+	xSemaphoreGive(CoverCache_Mutex);
+	return current;
+}
+
+void CoverCache_SetReady(uint32_t generation) {
+	xSemaphoreTake(CoverCache_Mutex, portMAX_DELAY);
+	CoverCache_ReadyGeneration = generation;
+	xSemaphoreGive(CoverCache_Mutex);
+}
+
+// Reads the segments one after another; up to three characters of a segment's end are
+// carried over to the next one, so only complete groups of four are decoded.
+bool CoverCache_Decode(const CoverCacheJob &job, File &audioFile, File &coverFile) {
+	uint8_t *buffer = static_cast<uint8_t *>(x_malloc(CoverCache_ChunkSize));
+	if (buffer == nullptr) {
+		return false;
+	}
+	size_t carried = 0;
+	bool success = coverFile.write(CoverCache_FlacMarker, sizeof(CoverCache_FlacMarker)) == sizeof(CoverCache_FlacMarker);
+	for (size_t i = 0; success && i + 1 < job.segments.size(); i += 2) {
+		uint32_t left = job.segments[i + 1];
+		success = audioFile.seek(job.segments[i]);
+		while (success && left > 0) {
+			if (!CoverCache_IsCurrent(job.generation)) {
+				success = false; // track has changed meanwhile
+				break;
+			}
+			const size_t wanted = std::min<size_t>(left, CoverCache_ChunkSize - carried);
+			if (audioFile.read(buffer + carried, wanted) != wanted) {
+				success = false;
+				break;
+			}
+			left -= wanted;
+			const size_t available = carried + wanted;
+			const size_t complete = available & ~size_t(3);
+			const size_t decoded = b64decode(buffer, buffer, complete);
+			success = coverFile.write(buffer, decoded) == decoded;
+			carried = available - complete;
+			memmove(buffer, buffer + complete, carried);
+		}
+	}
+	if (success && carried) {
+		const size_t decoded = b64decode(buffer, buffer, carried); // unpadded end; a single character is invalid
+		success = decoded > 0 && coverFile.write(buffer, decoded) == decoded;
+	}
+	free(buffer);
+	return success;
+}
+
+void CoverCache_Task(void *parameter) {
+	for (;;) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		xSemaphoreTake(CoverCache_Mutex, portMAX_DELAY);
+		CoverCacheJob job = std::move(CoverCache_Pending);
+		CoverCache_Pending = CoverCacheJob();
+		xSemaphoreGive(CoverCache_Mutex);
+		if (job.generation == 0) {
+			continue;
+		}
+
+		const uint32_t startMs = millis();
+		const String coverPath = CoverCache_GetPath(job.audioPath.c_str());
+		const String tmpPath = coverPath + ".tmp"; // the web-server mustn't find half a cover
+		File audioFile = gFSystem.open(job.audioPath.c_str(), FILE_READ);
+		File coverFile = gFSystem.open(tmpPath, FILE_WRITE, true); // create=true makes sure parent directories are created
+		bool success = audioFile && coverFile && CoverCache_Decode(job, audioFile, coverFile);
+		audioFile.close();
+		coverFile.close();
+		success = success && gFSystem.rename(tmpPath, coverPath);
+		if (!success) {
+			gFSystem.remove(tmpPath);
+			continue;
+		}
+		Log_Printf(LOGLEVEL_DEBUG, "Cover decoded and cached in %s (%lu ms)", coverPath.c_str(), millis() - startMs);
+		CoverCache_SetReady(job.generation);
+	}
+}
+} // namespace
+
+void CoverCache_Init(void) {
+	CoverCache_Mutex = xSemaphoreCreateMutex();
+	xTaskCreatePinnedToCore(
+		CoverCache_Task, /* Function to implement the task */
+		"coverCache", /* Name of the task */
+		3072, /* Stack size in words */
+		NULL, /* Task input parameter */
+		1, /* Priority of the task */
+		&CoverCache_TaskHandle, /* Task handle. */
+		ARDUINO_RUNNING_CORE /* Core where the task should run */
+	);
+}
+
+String CoverCache_GetPath(const char *audioPath) {
+	String coverPath = "/.cache";
+	coverPath.concat(audioPath);
+	return coverPath;
+}
+
+void CoverCache_RequestOgg(const char *audioPath, const std::vector<uint32_t> &segments) {
+	if (CoverCache_TaskHandle == nullptr || audioPath == nullptr) {
+		return;
+	}
+	const bool cached = gFSystem.exists(CoverCache_GetPath(audioPath));
+	xSemaphoreTake(CoverCache_Mutex, portMAX_DELAY);
+	CoverCache_Generation++;
+	if (cached) {
+		CoverCache_ReadyGeneration = CoverCache_Generation;
+	} else {
+		CoverCache_Pending.audioPath = audioPath;
+		CoverCache_Pending.segments = segments;
+		CoverCache_Pending.generation = CoverCache_Generation;
+	}
+	xSemaphoreGive(CoverCache_Mutex);
+	if (!cached) {
+		xTaskNotifyGive(CoverCache_TaskHandle);
+	}
+}
+
+void CoverCache_Cancel(void) {
+	if (CoverCache_Mutex == nullptr) {
+		return;
+	}
+	xSemaphoreTake(CoverCache_Mutex, portMAX_DELAY);
+	CoverCache_Generation++;
+	CoverCache_Pending = CoverCacheJob();
+	xSemaphoreGive(CoverCache_Mutex);
+}
+
+bool CoverCache_TakeReady(void) {
+	if (CoverCache_Mutex == nullptr) {
+		return false;
+	}
+	xSemaphoreTake(CoverCache_Mutex, portMAX_DELAY);
+	const bool ready = (CoverCache_ReadyGeneration != 0 && CoverCache_ReadyGeneration == CoverCache_Generation);
+	if (ready) {
+		CoverCache_ReadyGeneration = 0;
+	}
+	xSemaphoreGive(CoverCache_Mutex);
+	return ready;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <vector>
+
+// Covers of OGG/Opus-files are base64-encoded (METADATA_BLOCK_PICTURE) and spread over several pages.
+// A background-task decodes them with a file-handle of its own into /.cache/<path of the audio-file>,
+// prefixed by a fLaC-marker, so they can be served like flac-covers. Only the cover of the current
+// track is of interest: a new request or a cancel makes a running decode stop.
+void CoverCache_Init(void);
+String CoverCache_GetPath(const char *audioPath);
+void CoverCache_RequestOgg(const char *audioPath, const std::vector<uint32_t> &segments); // offset and length of every base64-segment
+void CoverCache_Cancel(void);
+bool CoverCache_TakeReady(void); // true once the cover of the last request is cached
@@ -0,0 +1,276 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Equalizer.h"
+
+#include "EnumUtils.h"
+#include "System.h"
+
+#include <math.h>
+
+const uint16_t equalizerFrequencies[equalizerBands] = {60, 125, 250, 500, 1000, 2000, 4000, 8000};
+
+// Biquads in direct form I with Q28-coefficients and a 64 bit accumulator. Samples carry 8 extra
+// fractional bits between the stages and the truncation-error is fed back (first order), so low
+// bands at high sample-rates don't add audible noise. Stages run one after another on blocks of
+// samples, which keeps a stage's coefficients and state in registers.
+namespace {
+constexpr char Equalizer_NvsKey[] = "eqPresets";
+constexpr uint8_t Equalizer_CoeffShift = 28; // Q28: coefficients up to +-8
+constexpr uint8_t Equalizer_GuardShift = 8;
+constexpr uint16_t Equalizer_ChunkFrames = 128;
+constexpr double Equalizer_PeakQ = 1.41; // one octave (distance of the bands)
+constexpr double Equalizer_MaxRelFrequency = 0.45; // bands too close to Nyquist are left out
+constexpr uint32_t Equalizer_CommonRates[] = {16000, 22050, 24000, 32000, 44100, 48000};
+constexpr uint8_t Equalizer_Rates = sizeof(Equalizer_CommonRates) / sizeof(Equalizer_CommonRates[0]);
+constexpr uint8_t Equalizer_Outputs = 2;
+
+struct EqualizerBiquad {
+	int32_t b0, b1, b2, a1, a2;
+};
+
+struct EqualizerStage {
+	uint8_t band;
+	EqualizerBiquad biquad;
+	int32_t x1[2], x2[2], y1[2], y2[2];
+	int32_t error[2]; // truncation-error of the last output
+};
+
+struct EqualizerTable {
+	EqualizerBiquad biquads[equalizerBands];
+	uint8_t activeMask; // bit per band that isn't flat
+};
+
+EqualizerPresets Equalizer_Presets = {};
+EqualizerTable Equalizer_Tables[Equalizer_Outputs][Equalizer_Rates]; // calculated in advance when presets change
+EqualizerOutput Equalizer_Output = EqualizerOutput::Speaker;
+uint32_t Equalizer_SampleRate = 44100;
+
+EqualizerStage Equalizer_Stages[equalizerBands]; // active bands only, ascending
+uint8_t Equalizer_ActiveStages = 0;
+int32_t Equalizer_Work[Equalizer_ChunkFrames * 2];
+
+portMUX_TYPE Equalizer_StatsMux = portMUX_INITIALIZER_UNLOCKED;
+EqualizerStats Equalizer_Stats;
+uint32_t Equalizer_CyclesPerFrame = 240000000 / 44100;
+
+const int8_t *Equalizer_Gains(EqualizerOutput output) {
+	return (output == EqualizerOutput::Headphone) ? Equalizer_Presets.headphone : Equalizer_Presets.speaker;
+}
+
+int32_t Equalizer_ToFixed(double coefficient) {
+	return lround(coefficient * (1 << Equalizer_CoeffShift));
+}
+
+// Audio-EQ-cookbook (R. Bristow-Johnson); shelves with slope 1
+bool Equalizer_Design(uint8_t band, int8_t gainDb, uint32_t sampleRate, double scale, EqualizerBiquad &biquad) {
+	const double frequency = equalizerFrequencies[band];
+	if (gainDb == 0 || frequency >= sampleRate * Equalizer_MaxRelFrequency) {
+		return false;
+	}
+	const double a = pow(10.0, gainDb / 40.0);
+	const double w0 = 2.0 * M_PI * frequency / sampleRate;
+	const double cosW0 = cos(w0);
+	double b0, b1, b2, a0, a1, a2;
+	if (band == 0 || band == equalizerBands - 1) {
+		const double twoSqrtAAlpha = sqrt(a) * sin(w0) * M_SQRT2;
+		const double sign = (band == 0) ? 1.0 : -1.0; // low- or high-shelf
+		b0 = a * ((a + 1) - sign * (a - 1) * cosW0 + twoSqrtAAlpha);
+		b1 = sign * 2.0 * a * ((a - 1) - sign * (a + 1) * cosW0);
+		b2 = a * ((a + 1) - sign * (a - 1) * cosW0 - twoSqrtAAlpha);
+		a0 = (a + 1) + sign * (a - 1) * cosW0 + twoSqrtAAlpha;
+		a1 = -sign * 2.0 * ((a - 1) + sign * (a + 1) * cosW0);
+		a2 = (a + 1) + sign * (a - 1) * cosW0 - twoSqrtAAlpha;
+	} else {
+		const double alpha = sin(w0) / (2.0 * Equalizer_PeakQ);
+		b0 = 1.0 + alpha * a;
+		b1 = -2.0 * cosW0;
+		b2 = 1.0 - alpha * a;
+		a0 = 1.0 + alpha / a;
+		a1 = -2.0 * cosW0;
+		a2 = 1.0 - alpha / a;
+	}
+	biquad = {
+		Equalizer_ToFixed(scale * b0 / a0),
+		Equalizer_ToFixed(scale * b1 / a0),
+		Equalizer_ToFixed(scale * b2 / a0),
+		Equalizer_ToFixed(a1 / a0),
+		Equalizer_ToFixed(a2 / a0),
+	};
+	return true;
+}
+
+// The largest boost is taken off in the first active band, so boosted bands don't clip
+void Equalizer_Calculate(const int8_t *gains, uint32_t sampleRate, EqualizerTable &table) {
+	int8_t maxGain = 0;
+	for (uint8_t band = 0; band < equalizerBands; band++) {
+		maxGain = std::max(maxGain, gains[band]);
+	}
+	double scale = pow(10.0, -maxGain / 20.0);
+	table.activeMask = 0;
+	for (uint8_t band = 0; band < equalizerBands; band++) {
+		if (Equalizer_Design(band, gains[band], sampleRate, scale, table.biquads[band])) {
+			table.activeMask |= 1 << band;
+			scale = 1.0;
+		}
+	}
+}
+
+// Puts the bands for the current output and sample-rate into place; filter-states of bands that stay active are kept
+void Equalizer_Activate(void) {
+	const uint8_t output = EnumUtils::underlying_value(Equalizer_Output);
+	EqualizerTable custom;
+	const EqualizerTable *table = nullptr;
+	for (uint8_t i = 0; i < Equalizer_Rates; i++) {
+		if (Equalizer_CommonRates[i] == Equalizer_SampleRate) {
+			table = &Equalizer_Tables[output][i];
+		}
+	}
+	if (table == nullptr) {
+		Equalizer_Calculate(Equalizer_Gains(Equalizer_Output), Equalizer_SampleRate, custom);
+		table = &custom;
+	}
+
+	EqualizerStage stages[equalizerBands] = {};
+	uint8_t count = 0;
+	for (uint8_t band = 0; band < equalizerBands; band++) {
+		if (!(table->activeMask & (1 << band))) {
+			continue;
+		}
+		EqualizerStage &stage = stages[count++];
+		for (uint8_t i = 0; i < Equalizer_ActiveStages; i++) {
+			if (Equalizer_Stages[i].band == band) {
+				stage = Equalizer_Stages[i];
+			}
+		}
+		stage.band = band;
+		stage.biquad = table->biquads[band];
+	}
+	memcpy(Equalizer_Stages, stages, sizeof(stages));
+	Equalizer_ActiveStages = count;
+}
+
+void Equalizer_Filter(EqualizerStage &stage, int32_t *values, uint16_t frames, uint8_t channels) {
+	const EqualizerBiquad c = stage.biquad;
+	for (uint8_t channel = 0; channel < channels; channel++) {
+		int32_t x1 = stage.x1[channel], x2 = stage.x2[channel];
+		int32_t y1 = stage.y1[channel], y2 = stage.y2[channel];
+		int32_t error = stage.error[channel];
+		for (uint32_t i = channel; i < uint32_t(frames) * channels; i += channels) {
+			const int32_t x = values[i];
+			const int64_t acc = int64_t(c.b0) * x + int64_t(c.b1) * x1 + int64_t(c.b2) * x2 - int64_t(c.a1) * y1 - int64_t(c.a2) * y2 + error;
+			const int32_t y = acc >> Equalizer_CoeffShift;
+			error = acc - (int64_t(y) << Equalizer_CoeffShift);
+			x2 = x1;
+			x1 = x;
+			y2 = y1;
+			y1 = y;
+			values[i] = y;
+		}
+		stage.x1[channel] = x1;
+		stage.x2[channel] = x2;
+		stage.y1[channel] = y1;
+		stage.y2[channel] = y2;
+		stage.error[channel] = error;
+	}
+}
+
+void Equalizer_UpdateStats(uint32_t cycles, uint16_t frames) {
+	portENTER_CRITICAL(&Equalizer_StatsMux);
+	const uint32_t blockCycles = frames * Equalizer_CyclesPerFrame;
+	EqualizerStats &stats = Equalizer_Stats;
+	stats.blocks++;
+	stats.lastCycles = cycles;
+	stats.avgCycles = (stats.blocks == 1) ? cycles : stats.avgCycles - stats.avgCycles / 16 + cycles / 16;
+	stats.maxCycles = std::max(stats.maxCycles, cycles);
+	if (blockCycles > 0) {
+		stats.loadPermille = uint64_t(stats.avgCycles) * 1000 / blockCycles;
+	}
+	portEXIT_CRITICAL(&Equalizer_StatsMux);
+}
+} // namespace
+
+void Equalizer_LoadPresets(EqualizerPresets &presets) {
+	if (gPrefsSettings.getBytesLength(Equalizer_NvsKey) == sizeof(presets)) {
+		gPrefsSettings.getBytes(Equalizer_NvsKey, &presets, sizeof(presets));
+	} else {
+		// Take over the settings of the audio-lib's tone-control (500 Hz low-shelf, 3 kHz peak, 6 kHz high-shelf)
+		const int8_t lows = gPrefsSettings.getChar("gainLowPass", 0);
+		const int8_t mids = gPrefsSettings.getChar("gainBandPass", 0);
+		const int8_t highs = gPrefsSettings.getChar("gainHighPass", 0);
+		for (uint8_t band = 0; band < equalizerBands; band++) {
+			const uint16_t frequency = equalizerFrequencies[band];
+			presets.speaker[band] = (frequency <= 250) ? lows : ((frequency <= 2000) ? mids : highs);
+			presets.headphone[band] = presets.speaker[band];
+		}
+	}
+	for (uint8_t band = 0; band < equalizerBands; band++) {
+		presets.speaker[band] = constrain(presets.speaker[band], equalizerGainMin, equalizerGainMax);
+		presets.headphone[band] = constrain(presets.headphone[band], equalizerGainMin, equalizerGainMax);
+	}
+}
+
+bool Equalizer_SavePresets(const EqualizerPresets &presets) {
+	return gPrefsSettings.putBytes(Equalizer_NvsKey, &presets, sizeof(presets)) == sizeof(presets);
+}
+
+void Equalizer_SetPresets(const EqualizerPresets &presets) {
+	Equalizer_Presets = presets;
+	for (uint8_t output = 0; output < Equalizer_Outputs; output++) {
+		const int8_t *gains = Equalizer_Gains(static_cast<EqualizerOutput>(output));
+		for (uint8_t i = 0; i < Equalizer_Rates; i++) {
+			Equalizer_Calculate(gains, Equalizer_CommonRates[i], Equalizer_Tables[output][i]);
+		}
+	}
+	Equalizer_Activate();
+}
+
+void Equalizer_SelectOutput(EqualizerOutput output) {
+	if (output != Equalizer_Output) {
+		Equalizer_Output = output;
+		Equalizer_Activate();
+	}
+}
+
+void Equalizer_SetSampleRate(uint32_t sampleRate) {
+	if (sampleRate == 0 || sampleRate == Equalizer_SampleRate) {
+		return;
+	}
+	Equalizer_SampleRate = sampleRate;
+	Equalizer_ActiveStages = 0; // states of another sample-rate don't fit
+	Equalizer_Activate();
+	portENTER_CRITICAL(&Equalizer_StatsMux);
+	Equalizer_CyclesPerFrame = ESP.getCpuFreqMHz() * 1000000u / sampleRate;
+	portEXIT_CRITICAL(&Equalizer_StatsMux);
+}
+
+// Called for every PCM-block (interleaved 16 bit samples)
+void Equalizer_Process(int16_t *samples, uint16_t frames, uint8_t channels) {
+	if (Equalizer_ActiveStages == 0 || channels == 0 || channels > 2) {
+		return;
+	}
+	const uint32_t startCycles = ESP.getCycleCount();
+	for (uint16_t offset = 0; offset < frames; offset += Equalizer_ChunkFrames) {
+		const uint16_t chunkFrames = std::min<uint16_t>(frames - offset, Equalizer_ChunkFrames);
+		const uint16_t values = chunkFrames * channels;
+		int16_t *chunk = samples + offset * channels;
+		for (uint16_t i = 0; i < values; i++) {
+			Equalizer_Work[i] = int32_t(chunk[i]) << Equalizer_GuardShift;
+		}
+		for (uint8_t i = 0; i < Equalizer_ActiveStages; i++) {
+			Equalizer_Filter(Equalizer_Stages[i], Equalizer_Work, chunkFrames, channels);
+		}
+		for (uint16_t i = 0; i < values; i++) {
+			const int32_t value = (Equalizer_Work[i] + (1 << (Equalizer_GuardShift - 1))) >> Equalizer_GuardShift;
+			chunk[i] = std::min<int32_t>(std::max<int32_t>(value, INT16_MIN), INT16_MAX);
+		}
+	}
+	Equalizer_UpdateStats(ESP.getCycleCount() - startCycles, frames);
+}
+
+void Equalizer_GetStats(EqualizerStats &stats) {
+	portENTER_CRITICAL(&Equalizer_StatsMux);
+	stats = Equalizer_Stats;
+	portEXIT_CRITICAL(&Equalizer_StatsMux);
+	stats.activeBands = Equalizer_ActiveStages;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+// Cascaded biquad-equalizer (fixed-point) in front of the gain-envelopes. Speaker and headphone
+// have presets of their own; coefficients are calculated whenever a preset changes (in advance for
+// the common sample-rates), so the PCM-path only runs the filters. Flat bands cost nothing.
+constexpr uint8_t equalizerBands = 8;
+constexpr int8_t equalizerGainMin = -6; // dB
+constexpr int8_t equalizerGainMax = 6;
+extern const uint16_t equalizerFrequencies[equalizerBands]; // Hz; low-shelf, peaks, high-shelf
+
+enum class EqualizerOutput : uint8_t {
+	Speaker = 0,
+	Headphone
+};
+
+typedef struct {
+	int8_t speaker[equalizerBands]; // gain per band in dB
+	int8_t headphone[equalizerBands];
+} EqualizerPresets;
+
+typedef struct {
+	uint32_t blocks = 0;
+	uint32_t lastCycles = 0; // CPU-cycles of the last block
+	uint32_t avgCycles = 0;
+	uint32_t maxCycles = 0;
+	uint16_t loadPermille = 0; // processing time per block relative to its playtime
+	uint8_t activeBands = 0;
+} EqualizerStats;
+
+void Equalizer_LoadPresets(EqualizerPresets &presets); // from NVS
+bool Equalizer_SavePresets(const EqualizerPresets &presets);
+
+// Only to be called by the audio-task
+void Equalizer_SetPresets(const EqualizerPresets &presets);
+void Equalizer_SelectOutput(EqualizerOutput output);
+void Equalizer_SetSampleRate(uint32_t sampleRate);
+void Equalizer_Process(int16_t *samples, uint16_t frames, uint8_t channels);
+
+void Equalizer_GetStats(EqualizerStats &stats);
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+// Keyed bijection of [0, size): a 6-round Feistel-network over the smallest even-bit-width domain that covers
+// size, values outside of [0, size) are mapped again ("cycle-walking"). Needs a few bytes of RAM regardless of
+// the number of entries, and the same (size, seed) always results in the same order, so a shuffled playlist
+// can be continued from a persisted (seed, position).
+// Up to tableSize entries a Feistel-network with 1- or 2-bit halves can't reach every order equally often
+// (with 2-bit halves, only even permutations at all), so those are shuffled by Fisher-Yates into a table.
+class IndexPermutation {
+public:
+	IndexPermutation() = default; // identity
+
+	IndexPermutation(size_t size, uint32_t seed)
+		: size_(size)
+		, seed_(seed)
+		, active_(size > 1) {
+		uint32_t state = seed;
+		if (size_ <= tableSize) {
+			for (uint8_t i = 0; i < size_; i++) {
+				table_[i] = i;
+			}
+			for (uint8_t i = active_ ? size_ - 1 : 0; i > 0; i--) {
+				std::swap(table_[i], table_[(static_cast<uint64_t>(mix(state += 0x9E3779B9u)) * (i + 1)) >> 32]);
+			}
+			return;
+		}
+		while ((1ull << (2 * halfBits_)) < size_) {
+			halfBits_++;
+		}
+		halfMask_ = (1u << halfBits_) - 1;
+		for (uint32_t &key : keys_) {
+			key = mix(state += 0x9E3779B9u);
+		}
+	}
+
+	size_t operator()(size_t index) const {
+		if (!active_ || index >= size_) {
+			return index;
+		}
+		if (size_ <= tableSize) {
+			return table_[index];
+		}
+		// the domain is less than 4 times size, so less than 4 encryptions are needed on average
+		uint32_t value = index;
+		do {
+			value = encrypt(value);
+		} while (value >= size_);
+		return value;
+	}
+
+	bool isActive() const {
+		return active_;
+	}
+	uint32_t seed() const {
+		return seed_;
+	}
+
+private:
+	static constexpr size_t tableSize = 16;
+
+	static uint32_t mix(uint32_t value) {
+		value ^= value >> 16;
+		value *= 0x7FEB352Du;
+		value ^= value >> 15;
+		value *= 0x846CA68Bu;
+		value ^= value >> 16;
+		return value;
+	}
+
+	uint32_t encrypt(uint32_t value) const {
+		uint32_t left = value >> halfBits_;
+		uint32_t right = value & halfMask_;
+		for (const uint32_t key : keys_) {
+			const uint32_t next = left ^ (mix(right ^ key) & halfMask_);
+			left = right;
+			right = next;
+		}
+		return (left << halfBits_) | right;
+	}
+
+	size_t size_ = 0;
+	uint32_t seed_ = 0;
+	bool active_ = false;
+	uint8_t halfBits_ = 1;
+	uint32_t halfMask_ = 1;
+	uint32_t keys_[6] = {};
+	uint8_t table_[tableSize] = {};
+};
@@ -0,0 +1,152 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Latency.h"
+
+#include "Log.h"
+#include "Mqtt.h"
+
+#include <algorithm>
+#include <esp_timer.h>
+
+static constexpr uint8_t Latency_HistorySize = 32u; // rolling window (number of taps)
+static constexpr uint32_t Latency_SessionTimeoutMs = 30000u; // discard sessions that never reach audible output (e.g. modification-cards)
+static constexpr uint8_t Latency_StageCount = static_cast<uint8_t>(LatencyStage::Count);
+
+struct LatencySession {
+	volatile bool active = false;
+	volatile uint8_t nextStage = 0; // stages have to be reached in order; everything else is ignored
+	int64_t timestampUs[Latency_StageCount] = {0};
+};
+
+static LatencySession Latency_Session;
+static uint32_t Latency_History[Latency_HistorySize][Latency_StageCount]; // ms since detection
+static uint8_t Latency_HistoryHead = 0;
+static uint8_t Latency_HistoryCount = 0;
+static uint32_t Latency_CompletedSessions = 0;
+static portMUX_TYPE Latency_Mux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *Latency_StageNames[] = {
+	"detected",
+	"received",
+	"playlistBuilt",
+	"playlistOrdered",
+	"enqueued",
+	"decoderConnected",
+	"firstAudio",
+};
+static_assert(sizeof(Latency_StageNames) / sizeof(Latency_StageNames[0]) == Latency_StageCount, "Latency_StageNames out of sync with LatencyStage");
+
+// Called on every stable RFID-detection; a running session is replaced
+void Latency_StartSession(void) {
+	portENTER_CRITICAL(&Latency_Mux);
+	Latency_Session.timestampUs[0] = esp_timer_get_time();
+	Latency_Session.nextStage = 1;
+	Latency_Session.active = true;
+	portEXIT_CRITICAL(&Latency_Mux);
+}
+
+// Cheap enough to be called from the audio-path: returns immediately if the stage isn't the expected one
+void Latency_Mark(const LatencyStage stage) {
+	const uint8_t stageIndex = static_cast<uint8_t>(stage);
+	if (!Latency_Session.active || Latency_Session.nextStage != stageIndex) {
+		return;
+	}
+	portENTER_CRITICAL(&Latency_Mux);
+	if (Latency_Session.active && Latency_Session.nextStage == stageIndex) {
+		Latency_Session.timestampUs[stageIndex] = esp_timer_get_time();
+		Latency_Session.nextStage = stageIndex + 1;
+	}
+	portEXIT_CRITICAL(&Latency_Mux);
+}
+
+// Moves completed sessions into the rolling window and publishes them
+void Latency_Cyclic(void) {
+	if (!Latency_Session.active) {
+		return;
+	}
+	int64_t timestampUs[Latency_StageCount];
+	bool completed = false;
+	bool expired = false;
+
+	portENTER_CRITICAL(&Latency_Mux);
+	if (Latency_Session.nextStage >= Latency_StageCount) {
+		memcpy(timestampUs, Latency_Session.timestampUs, sizeof(timestampUs));
+		Latency_Session.active = false;
+		completed = true;
+	} else if ((esp_timer_get_time() - Latency_Session.timestampUs[0]) / 1000 > Latency_SessionTimeoutMs) {
+		Latency_Session.active = false;
+		expired = true;
+	}
+	portEXIT_CRITICAL(&Latency_Mux);
+
+	if (expired) {
+		Log_Println("Latency: session discarded (no audio output)", LOGLEVEL_DEBUG);
+		return;
+	}
+	if (!completed) {
+		return;
+	}
+
+	uint32_t *entry = Latency_History[Latency_HistoryHead];
+	for (uint8_t i = 0; i < Latency_StageCount; i++) {
+		entry[i] = static_cast<uint32_t>((timestampUs[i] - timestampUs[0]) / 1000);
+	}
+	Latency_HistoryHead = (Latency_HistoryHead + 1) % Latency_HistorySize;
+	if (Latency_HistoryCount < Latency_HistorySize) {
+		Latency_HistoryCount++;
+	}
+	Latency_CompletedSessions++;
+
+	char buf[160];
+	snprintf(buf, sizeof(buf), "{\"received\":%" PRIu32 ",\"playlistBuilt\":%" PRIu32 ",\"playlistOrdered\":%" PRIu32 ",\"enqueued\":%" PRIu32 ",\"decoderConnected\":%" PRIu32 ",\"firstAudio\":%" PRIu32 "}", entry[1], entry[2], entry[3], entry[4], entry[5], entry[6]);
+	Log_Printf(LOGLEVEL_INFO, "Tap-to-audio latency (ms): %s", buf);
+#ifdef MQTT_ENABLE
+	publishMqtt(topicLatencyState, buf, false);
+#endif
+}
+
+bool Latency_GetStageStats(const LatencyStage stage, LatencyStageStats &stats) {
+	const uint8_t stageIndex = static_cast<uint8_t>(stage);
+	stats = {};
+	if (stageIndex >= Latency_StageCount || Latency_HistoryCount == 0) {
+		return false;
+	}
+
+	// History is only written by Latency_Cyclic() (main-loop); a concurrent update affects at most one sample
+	uint32_t values[Latency_HistorySize];
+	const uint8_t count = Latency_HistoryCount;
+	const uint8_t last = (Latency_HistoryHead + Latency_HistorySize - 1) % Latency_HistorySize;
+	for (uint8_t i = 0; i < count; i++) {
+		values[i] = Latency_History[i][stageIndex];
+	}
+	stats.samples = count;
+	stats.lastMs = Latency_History[last][stageIndex];
+
+	for (uint8_t i = 0; i < count; i++) {
+		uint8_t bucket = 0;
+		while (bucket < latencyHistogramBuckets - 1 && values[i] > latencyHistogramEdgesMs[bucket]) {
+			bucket++;
+		}
+		stats.histogram[bucket]++;
+	}
+
+	std::sort(values, values + count);
+	stats.minMs = values[0];
+	stats.maxMs = values[count - 1];
+	stats.p50Ms = values[(count - 1) / 2];
+	stats.p90Ms = values[((count - 1) * 9) / 10];
+	return true;
+}
+
+uint32_t Latency_GetCompletedSessions(void) {
+	return Latency_CompletedSessions;
+}
+
+const char *Latency_GetStageName(const LatencyStage stage) {
+	const uint8_t stageIndex = static_cast<uint8_t>(stage);
+	if (stageIndex >= Latency_StageCount) {
+		return "unknown";
+	}
+	return Latency_StageNames[stageIndex];
+}
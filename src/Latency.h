@@ -0,0 +1,35 @@
+#pragma once
+
+// Tap-to-first-audio latency: every RFID-tap opens a session, the stages along the
+// playback path mark their timestamp (relative to the tap) and the completed session
+// is added to a rolling window per stage.
+enum class LatencyStage : uint8_t {
+	Detected = 0, // Rfid_Task: card is stably detected
+	Received, // Rfid_PreferenceLookupHandler: tag received from queue
+	PlaylistBuilt, // playlist generated
+	PlaylistOrdered, // playlist sorted/shuffled according to playmode
+	Enqueued, // playlist sent to gTrackQueue
+	DecoderConnected, // audio-lib accepted file / stream
+	FirstAudio, // first PCM-block reached audio_process_i2s
+	Count // has to be the last entry
+};
+
+constexpr uint8_t latencyHistogramBuckets = 8;
+constexpr uint16_t latencyHistogramEdgesMs[latencyHistogramBuckets - 1] = {50, 100, 200, 400, 800, 1600, 3200}; // last bucket holds everything above
+
+struct LatencyStageStats {
+	uint8_t samples;
+	uint32_t lastMs;
+	uint32_t minMs;
+	uint32_t p50Ms;
+	uint32_t p90Ms;
+	uint32_t maxMs;
+	uint8_t histogram[latencyHistogramBuckets];
+};
+
+void Latency_StartSession(void);
+void Latency_Mark(const LatencyStage stage);
+void Latency_Cyclic(void);
+bool Latency_GetStageStats(const LatencyStage stage, LatencyStageStats &stats);
+uint32_t Latency_GetCompletedSessions(void);
+const char *Latency_GetStageName(const LatencyStage stage);
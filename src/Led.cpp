@@ -7,6 +7,7 @@
 #include "Battery.h"
 #include "Bluetooth.h"
 #include "Button.h"
+#include "EnumUtils.h"
 #include "Log.h"
 #include "Mqtt.h"
 #include "Port.h"
@@ -17,7 +18,11 @@
 #include <esp_task_wdt.h>
 
 #ifdef NEOPIXEL_ENABLE
+	#include "LedAnimation.h"
+
 	#include <FastLED.h>
+	#include <atomic>
+	#include <optional>
 
 	#define LED_INITIAL_BRIGHTNESS		 16u
 	#define LED_INITIAL_NIGHT_BRIGHTNESS 2u
@@ -36,28 +41,55 @@
 	#define LED_VOLUME_INDICATOR_RETURN_DELAY 1000U
 	#define LED_VOLUME_INDICATOR_NUM_CYCLES	  (LED_VOLUME_INDICATOR_RETURN_DELAY / 20)
 
+	// Time in milliseconds a static frame waits for a notification before the state is checked again
+	#define LED_STATIC_FRAME_POLL_MS 100U
+
 extern t_button gButtons[7]; // next + prev + pplay + rotEnc + button4 + button5 + dummy-button
 extern uint8_t gShutdownButton;
 
 static uint32_t Led_Indicators = 0u;
 
-static bool Led_Pause = false; // Used to pause Neopixel-signalisation (while NVS-writes as this leads to exceptions; don't know why)
-
 static uint8_t Led_InitialBrightness = LED_INITIAL_BRIGHTNESS;
 static uint8_t Led_Brightness = LED_INITIAL_BRIGHTNESS;
 static uint8_t Led_NightBrightness = LED_INITIAL_NIGHT_BRIGHTNESS;
 static bool Led_NightMode = false;
 static uint8_t Led_savedBrightness;
 
-constexpr uint8_t Led_IdleDotDistance = NUM_INDICATOR_LEDS / NUM_LEDS_IDLE_DOTS;
+constexpr uint8_t Led_PauseOffset = OFFSET_PAUSE_LEDS ? ((NUM_INDICATOR_LEDS / NUM_LEDS_IDLE_DOTS) / 2) - 1 : 0;
 
+static PlaybackState Led_PlaybackState; // taken once per cycle of Led_Task
 static CRGBArray<NUM_INDICATOR_LEDS + NUM_CONTROL_LEDS> leds;
 static CRGBSet indicator(leds(0, NUM_INDICATOR_LEDS - 1));
 static CRGBSet controlLeds(leds(NUM_INDICATOR_LEDS, NUM_INDICATOR_LEDS + NUM_CONTROL_LEDS - 1));
 
+// Animations draw into leds; it's only sent to the LEDs if it differs from the frame shown last
+static CRGB Led_ShownFrame[NUM_INDICATOR_LEDS + NUM_CONTROL_LEDS];
+static int16_t Led_ShownBrightness = -1; // -1: LEDs were changed outside of Led_Show()
+static LedFrameStats Led_FrameStats = {};
+
+// Animations compiled from descriptors (built-in or custom ones from SD)
+enum class LedTableAnimation : uint8_t {
+	Boot = 0,
+	BootError,
+	Error,
+	Ok,
+	VoltageWarning,
+	Idle, // tinted (see Led_RenderTinted())
+	Busy, // tinted
+	Pause, // tinted
+	Speech,
+	Count // has to be the last entry
+};
+static constexpr const char *Led_AnimationNames[] = {"boot", "bootError", "error", "ok", "voltageWarning", "idle", "busy", "pause", "speech"};
+static LedAnimationDescriptor Led_AnimationDescriptors[EnumUtils::underlying_value(LedTableAnimation::Count)];
+static LedAnimation Led_Animations[EnumUtils::underlying_value(LedTableAnimation::Count)];
+static std::optional<CRGB> Led_AnimationTints[EnumUtils::underlying_value(LedTableAnimation::Count)]; // palette-color 0 of the compiled table
+static std::atomic<bool> Led_LoadAnimationsPending {false};
+
 TaskHandle_t Led_TaskHandle;
 static void Led_Task(void *parameter);
 static uint8_t Led_Address(uint8_t number);
+static void Led_CompileAnimations(bool fromSd);
 
 // animation-functions prototypes
 AnimationReturnType Animation_PlaylistProgress(const bool startNewAnimation, CRGBSet &leds);
@@ -104,7 +136,7 @@ void Led_Init(void) {
 	xTaskCreatePinnedToCore(
 		Led_Task, /* Function to implement the task */
 		"Led_Task", /* Name of the task */
-		1512, /* Stack size in words */
+		2048, /* Stack size in words */
 		NULL, /* Task input parameter */
 		1, /* Priority of the task */
 		&Led_TaskHandle, /* Task handle. */
@@ -113,6 +145,16 @@ void Led_Init(void) {
 #endif
 }
 
+// Custom animations are loaded by the LED-task itself, so it doesn't render from a table being replaced
+void Led_LoadAnimations(void) {
+#ifdef NEOPIXEL_ENABLE
+	Led_LoadAnimationsPending = true;
+	if (Led_TaskHandle) {
+		xTaskNotifyGive(Led_TaskHandle);
+	}
+#endif
+}
+
 void Led_Exit(void) {
 #ifdef NEOPIXEL_ENABLE
 	Log_Println("shutdown LED..", LOGLEVEL_NOTICE);
@@ -128,12 +170,9 @@ void Led_Exit(void) {
 void Led_Indicate(LedIndicatorType value) {
 #ifdef NEOPIXEL_ENABLE
 	LED_INDICATOR_SET(value);
-#endif
-}
-
-void Led_SetPause(boolean value) {
-#ifdef NEOPIXEL_ENABLE
-	Led_Pause = value;
+	if (Led_TaskHandle) {
+		xTaskNotifyGive(Led_TaskHandle); // wake up if a static frame is shown
+	}
 #endif
 }
 
@@ -171,6 +210,9 @@ uint8_t Led_GetBrightness(void) {
 void Led_SetBrightness(uint8_t value) {
 #ifdef NEOPIXEL_ENABLE
 	Led_Brightness = value;
+	if (Led_TaskHandle) {
+		xTaskNotifyGive(Led_TaskHandle);
+	}
 	#ifdef BUTTONS_LED
 	Port_Write(BUTTONS_LED, value <= Led_NightBrightness ? LOW : HIGH, false);
 	#endif
@@ -278,12 +320,107 @@ CRGB::HTMLColorCode Led_GetIdleColor() {
 	return idleColor;
 }
 
-void Led_DrawIdleDots(CRGBSet &leds, uint8_t offset, CRGB::HTMLColorCode color) {
-	for (uint8_t i = 0; i < NUM_LEDS_IDLE_DOTS; i++) {
-		leds[(Led_Address(offset) + i * Led_IdleDotDistance) % leds.size()] = color;
+// Built-in animations; the single LED blinks where a ring is lit once
+LedAnimationDescriptor Led_BuiltinAnimation(LedTableAnimation animation) {
+	constexpr bool singleLed = (NUM_INDICATOR_LEDS == 1);
+	switch (animation) {
+		case LedTableAnimation::Boot:
+			return LedAnimationDescriptor {{CRGB::Orange}, {{500, LedEasing::Step, "0."}, {500, LedEasing::Step, ".0"}}, 0};
+		case LedTableAnimation::BootError:
+			return LedAnimationDescriptor {{CRGB::Red}, {{500, LedEasing::Step, "0"}, {500, LedEasing::Step, ".0"}}, 0};
+		case LedTableAnimation::Error:
+			if (singleLed) {
+				return LedAnimationDescriptor {{CRGB::Red}, {{100, LedEasing::Step, "0"}, {100, LedEasing::Step, "."}}, 3};
+			}
+			return LedAnimationDescriptor {{CRGB::Red}, {{200, LedEasing::Step, "0"}}, 1};
+		case LedTableAnimation::Ok:
+			if (singleLed) {
+				return LedAnimationDescriptor {{CRGB::Green}, {{100, LedEasing::Step, "0"}, {100, LedEasing::Step, "."}}, 3};
+			}
+			return LedAnimationDescriptor {{CRGB::Green}, {{400, LedEasing::Step, "0"}}, 1};
+		case LedTableAnimation::Idle:
+			return LedAnimation_RotatingDots(CRGB::Green, 50 * 10, NUM_INDICATOR_LEDS, NUM_LEDS_IDLE_DOTS, Led_Address);
+		case LedTableAnimation::Busy:
+			if (singleLed) {
+				return LedAnimationDescriptor {{CRGB::BlueViolet}, {{100, LedEasing::Step, "0"}, {100, LedEasing::Step, "."}}, 1};
+			}
+			return LedAnimation_RotatingDots(CRGB::Green, 50, NUM_INDICATOR_LEDS, NUM_LEDS_IDLE_DOTS, Led_Address);
+		case LedTableAnimation::Pause:
+			return LedAnimationDescriptor {{CRGB::Orange}, {{10, LedEasing::Step, LedAnimation_DotsPattern(NUM_INDICATOR_LEDS, NUM_LEDS_IDLE_DOTS, Led_PauseOffset, Led_Address)}}, 1};
+		case LedTableAnimation::Speech:
+			return LedAnimationDescriptor {{CRGB::Yellow}, {{10, LedEasing::Step, LedAnimation_DotsPattern(NUM_INDICATOR_LEDS, NUM_LEDS_IDLE_DOTS, Led_PauseOffset, Led_Address)}}, 1};
+		case LedTableAnimation::VoltageWarning:
+		default:
+			return LedAnimationDescriptor {{CRGB::Red}, {{200, LedEasing::Step, "0"}, {200, LedEasing::Step, "."}}, 3}; // flashes three times
 	}
 }
 
+// Compiles the built-in animations or replaces them by custom ones from SD (if present and valid)
+void Led_CompileAnimations(bool fromSd) {
+	for (uint8_t i = 0; i < EnumUtils::underlying_value(LedTableAnimation::Count); i++) {
+		const LedTableAnimation animation = EnumUtils::to_enum<LedTableAnimation>(i);
+		LedAnimationDescriptor descriptor;
+		if (!fromSd) {
+			descriptor = Led_BuiltinAnimation(animation);
+			Led_Animations[i].compile(descriptor, NUM_INDICATOR_LEDS, Led_Address);
+		} else if (LedAnimation_Load(Led_AnimationNames[i], descriptor)) {
+			if (descriptor.repeats == 0 && animation != LedTableAnimation::Boot && animation != LedTableAnimation::BootError) {
+				descriptor.repeats = 1; // indications have to end
+			}
+			if (!Led_Animations[i].compile(descriptor, NUM_INDICATOR_LEDS, Led_Address)) {
+				Log_Printf(LOGLEVEL_ERROR, ledAnimationInvalid, Led_AnimationNames[i]);
+				continue;
+			}
+			Log_Printf(LOGLEVEL_NOTICE, ledAnimationLoaded, Led_AnimationNames[i], Led_Animations[i].frameCount());
+		} else {
+			continue;
+		}
+		Led_AnimationDescriptors[i] = std::move(descriptor);
+		Led_AnimationTints[i].reset();
+	}
+}
+
+AnimationReturnType Led_RenderTable(LedTableAnimation animation, const bool startNewAnimation, CRGBSet &leds) {
+	uint16_t holdMs;
+	const bool active = Led_Animations[EnumUtils::underlying_value(animation)].render(startNewAnimation, leds, holdMs);
+	return AnimationReturnType(active, holdMs, true);
+}
+
+// Palette-color 0 is replaced by the color of the current state (e.g. the idle-color); the table is compiled again if it changes
+AnimationReturnType Led_RenderTinted(LedTableAnimation animation, CRGB color, const bool startNewAnimation, CRGBSet &leds) {
+	const uint8_t i = EnumUtils::underlying_value(animation);
+	if (Led_AnimationTints[i] != color) {
+		LedAnimationDescriptor descriptor = Led_AnimationDescriptors[i];
+		if (!descriptor.palette.empty()) {
+			descriptor.palette[0] = color;
+		}
+		Led_Animations[i].compile(descriptor, NUM_INDICATOR_LEDS, Led_Address);
+		Led_AnimationTints[i] = color;
+	}
+	return Led_RenderTable(animation, startNewAnimation, leds);
+}
+
+void Led_UpdateRenderStats(uint32_t cycles) {
+	LedFrameStats &stats = Led_FrameStats;
+	stats.lastRenderCycles = cycles;
+	stats.avgRenderCycles = (stats.avgRenderCycles == 0) ? cycles : stats.avgRenderCycles - stats.avgRenderCycles / 16 + cycles / 16;
+	stats.maxRenderCycles = std::max(stats.maxRenderCycles, cycles);
+}
+
+// Sends the frame to the LEDs if pixels or brightness changed since the last one; returns false if skipped
+bool Led_Show() {
+	const CRGB *frame = leds;
+	if (Led_ShownBrightness == FastLED.getBrightness() && memcmp(Led_ShownFrame, frame, sizeof(Led_ShownFrame)) == 0) {
+		Led_FrameStats.skipped++;
+		return false;
+	}
+	memcpy(Led_ShownFrame, frame, sizeof(Led_ShownFrame));
+	Led_ShownBrightness = FastLED.getBrightness();
+	FastLED.show();
+	Led_FrameStats.rendered++;
+	return true;
+}
+
 bool CheckForPowerButtonAnimation() {
 	if (gShutdownButton < (sizeof(gButtons) / sizeof(gButtons[0])) - 1) { // Only show animation, if CMD_SLEEPMODE was assigned to BUTTON_n_LONG + button is pressed
 		if (gButtons[gShutdownButton].isPressed && (millis() - gButtons[gShutdownButton].firstPressedTimestamp >= 150) && gButtonInitComplete) {
@@ -305,15 +442,15 @@ static void Led_Task(void *parameter) {
 	LedAnimationType nextAnimation = LedAnimationType::NoNewAnimation;
 	bool animationActive = false;
 	int32_t animationTimer = 0;
+	bool frameStatic = false; // last frame didn't change the LEDs
+	Led_CompileAnimations(false);
 
 	for (;;) {
-		// special handling
-		if (Led_Pause) { // Workaround to prevent exceptions while NVS-writes take place
-			vTaskDelay(portTICK_PERIOD_MS * 10);
-			continue;
+		if (Led_LoadAnimationsPending.exchange(false)) {
+			Led_CompileAnimations(true);
 		}
-
 		Led_DrawControls();
+		AudioPlayer_GetState(Led_PlaybackState);
 
 		uint32_t taskDelay = 20;
 		bool startNewAnimation = false;
@@ -342,19 +479,19 @@ static void Led_Task(void *parameter) {
 			nextAnimation = LedAnimationType::Rewind;
 		} else if (LED_INDICATOR_IS_SET(LedIndicatorType::PlaylistProgress)) {
 			nextAnimation = LedAnimationType::Playlist;
-		} else if (gPlayProperties.currentSpeechActive) {
+		} else if (Led_PlaybackState.currentSpeechActive) {
 			nextAnimation = LedAnimationType::Speech;
-		} else if (gPlayProperties.playlistFinished) {
+		} else if (Led_PlaybackState.playlistFinished) {
 			nextAnimation = LedAnimationType::Idle;
-		} else if (gPlayProperties.pausePlay && !gPlayProperties.isWebstream) {
+		} else if (Led_PlaybackState.pausePlay && !Led_PlaybackState.isWebstream) {
 			nextAnimation = LedAnimationType::Pause;
-		} else if ((gPlayProperties.playMode != BUSY) && (gPlayProperties.playMode != NO_PLAYLIST) && gPlayProperties.audioFileSize > 0) { // progress for a file/stream with known size
+		} else if ((Led_PlaybackState.playMode != BUSY) && (Led_PlaybackState.playMode != NO_PLAYLIST) && Led_PlaybackState.audioFileSize > 0) { // progress for a file/stream with known size
 			nextAnimation = LedAnimationType::Progress;
-		} else if (gPlayProperties.isWebstream) { // webstream animation (for streams with unknown size); pause animation is also handled by the webstream animation function
+		} else if (Led_PlaybackState.isWebstream) { // webstream animation (for streams with unknown size); pause animation is also handled by the webstream animation function
 			nextAnimation = LedAnimationType::Webstream;
-		} else if (gPlayProperties.playMode == NO_PLAYLIST) {
+		} else if (Led_PlaybackState.playMode == NO_PLAYLIST) {
 			nextAnimation = LedAnimationType::Idle;
-		} else if (gPlayProperties.playMode == BUSY) {
+		} else if (Led_PlaybackState.playMode == BUSY) {
 			nextAnimation = LedAnimationType::Busy;
 		} else {
 			nextAnimation = LedAnimationType::NoNewAnimation; // should not happen
@@ -380,6 +517,7 @@ static void Led_Task(void *parameter) {
 		// when there is no delay anymore we have to animate something
 		if (animationTimer <= 0) {
 			AnimationReturnType ret;
+			const uint32_t renderStart = ESP.getCycleCount();
 			// animate the current animation
 			switch (activeAnimation) {
 				case LedAnimationType::Boot:
@@ -444,19 +582,29 @@ static void Led_Task(void *parameter) {
 
 				default:
 					indicator = CRGB::Black;
-					FastLED.show();
+					ret.animationRefresh = true;
 					ret.animationActive = false;
 					ret.animationDelay = 50;
 					break;
 			}
+			Led_UpdateRenderStats(ESP.getCycleCount() - renderStart);
 			// apply delay and state from animation
 			animationActive = ret.animationActive;
 			animationTimer = ret.animationDelay;
 			if (ret.animationRefresh) {
-				FastLED.show();
+				frameStatic = !Led_Show();
 			}
 		}
 
+		// a static frame (e.g. pause or progress) waits for a notification (indicators, brightness)
+		// instead of redrawing the same frame every few ms
+		if (!animationActive && frameStatic) {
+			const TickType_t waitStart = xTaskGetTickCount();
+			ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LED_STATIC_FRAME_POLL_MS));
+			animationTimer -= pdTICKS_TO_MS(xTaskGetTickCount() - waitStart);
+			continue;
+		}
+
 		// get the time to wait and delay the task
 		if ((animationTimer > 0) && (animationTimer < taskDelay)) {
 			taskDelay = animationTimer;
@@ -483,29 +631,16 @@ static void Led_Task(void *parameter) {
 // BOOT-UP Animation
 // --------------------------------
 AnimationReturnType Animation_Boot(const bool startNewAnimation, CRGBSet &leds) {
-	(void) startNewAnimation; // start is not used
+	(void) startNewAnimation; // every step starts "new" as the animation is never active
 	// static vars
-	static bool showEvenError = false;
-
-	// 10 s without success?
-	if (millis() > 10000) {
-		leds = CRGB::Red;
-		if (showEvenError) {
-			// and then draw in the black dots
-			for (uint8_t i = 0; i < leds.size(); i += 2) {
-				leds[i] = CRGB::Black;
-			}
-		}
-	} else {
-		leds = CRGB::Black;
-		const uint8_t startLed = (showEvenError) ? 1 : 0;
-		for (uint8_t i = startLed; i < leds.size(); i += 2) {
-			leds[i] = CRGB::Orange;
-		}
-	}
-	showEvenError = !showEvenError;
+	static bool lastBootError = false;
+
+	const bool bootError = (millis() > 10000); // 10 s without success?
+	uint16_t holdMs;
+	Led_Animations[EnumUtils::underlying_value(bootError ? LedTableAnimation::BootError : LedTableAnimation::Boot)].render(bootError != lastBootError, leds, holdMs);
+	lastBootError = bootError;
 
-	return AnimationReturnType(false, 500, true); // always wait 500 ms
+	return AnimationReturnType(false, holdMs, true);
 }
 
 // --------------------------------
@@ -568,77 +703,13 @@ AnimationReturnType Animation_Shutdown(const bool startNewAnimation, CRGBSet &le
 // Error Animation
 // --------------------------------
 AnimationReturnType Animation_Error(const bool startNewAnimation, CRGBSet &leds) {
-	// return values
-	bool animationActive = true;
-	uint16_t animationDelay = 0;
-	// static vars
-	static bool singleLedStatus = false;
-	static uint16_t animationIndex = 0;
-	if (startNewAnimation) {
-		animationIndex = 0;
-	}
-
-	if constexpr (NUM_INDICATOR_LEDS == 1) {
-		leds = CRGB::Black;
-		if (singleLedStatus) {
-			leds[0] = CRGB::Red;
-		}
-		singleLedStatus = !singleLedStatus;
-
-		if (animationIndex < 5) {
-			animationIndex++;
-			animationDelay = 100;
-		} else {
-			animationActive = false;
-		}
-	} else {
-		leds = CRGB::Red;
-		if (animationIndex > 0) {
-			animationActive = false;
-		} else {
-			animationIndex++;
-			animationDelay = 200;
-		}
-	}
-	return AnimationReturnType(animationActive, animationDelay, true);
+	return Led_RenderTable(LedTableAnimation::Error, startNewAnimation, leds);
 }
 // --------------------------------
 // OK Animation
 // --------------------------------
 AnimationReturnType Animation_Ok(const bool startNewAnimation, CRGBSet &leds) {
-	// return values
-	bool animationActive = true;
-	uint16_t animationDelay = 0;
-	// static vars
-	static bool singleLedStatus = false;
-	static uint16_t animationIndex = 0;
-	if (startNewAnimation) {
-		animationIndex = 0;
-	}
-
-	if constexpr (NUM_INDICATOR_LEDS == 1) {
-		leds = CRGB::Black;
-		if (singleLedStatus) {
-			leds[0] = CRGB::Green;
-		}
-		singleLedStatus = !singleLedStatus;
-
-		if (animationIndex < 5) {
-			animationIndex++;
-			animationDelay = 100;
-		} else {
-			animationActive = false;
-		}
-	} else {
-		leds = CRGB::Green;
-		if (animationIndex > 0) {
-			animationActive = false;
-		} else {
-			animationIndex++;
-			animationDelay = 400;
-		}
-	}
-	return AnimationReturnType(animationActive, animationDelay, true);
+	return Led_RenderTable(LedTableAnimation::Ok, startNewAnimation, leds);
 }
 
 // --------------------------------
@@ -646,28 +717,7 @@ AnimationReturnType Animation_Ok(const bool startNewAnimation, CRGBSet &leds) {
 // --------------------------------
 // Single + Multiple LEDs: flashes red three times if battery-voltage is low
 AnimationReturnType Animation_VoltageWarning(const bool startNewAnimation, CRGBSet &leds) {
-	// return values
-	bool animationActive = true;
-	uint16_t animationDelay = 0;
-	// static vars
-	static uint16_t animationIndex = 0;
-
-	if (startNewAnimation) {
-		animationIndex = 0;
-	}
-
-	leds = CRGB::Black;
-	if (animationIndex % 2 == 0) {
-		leds = CRGB::Red;
-	}
-
-	if (animationIndex < 6) {
-		animationIndex++;
-		animationDelay = 200;
-	} else {
-		animationActive = false;
-	}
-	return AnimationReturnType(animationActive, animationDelay, true);
+	return Led_RenderTable(LedTableAnimation::VoltageWarning, startNewAnimation, leds);
 }
 
 // --------------------------------
@@ -685,7 +735,7 @@ AnimationReturnType Animation_Webstream(const bool startNewAnimation, CRGBSet &l
 	static uint16_t timerProgress = 0;
 
 	// pause-animation
-	if (gPlayProperties.pausePlay) {
+	if (Led_PlaybackState.pausePlay) {
 		leds = CRGB::Black;
 		CRGB::HTMLColorCode generalColor = CRGB::Orange;
 		if (OPMODE_BLUETOOTH_SINK == System_GetOperationMode()) {
@@ -771,69 +821,20 @@ AnimationReturnType Animation_Rewind(const bool startNewAnimation, CRGBSet &leds
 // Idle Animation
 // --------------------------------
 AnimationReturnType Animation_Idle(const bool startNewAnimation, CRGBSet &leds) {
-	// return values
-	int32_t animationDelay = 0;
-	bool animationActive = true;
-	bool refresh = true;
-	// static vars
-	static int16_t ledIndex = 0;
-	// this can be removed to always continue on the last position in idle
-	if (startNewAnimation) {
-		ledIndex = 0;
-	}
-
-	if (ledIndex < leds.size()) {
-		CRGB::HTMLColorCode idleColor = Led_GetIdleColor();
-		leds = CRGB::Black;
-		Led_DrawIdleDots(leds, ledIndex, idleColor);
-		if (OPMODE_BLUETOOTH_SOURCE == System_GetOperationMode()) {
-			// animate a bit faster in BT-Source to distinguish between the bluetooth modes
-			animationDelay = 30 * 10;
-		} else {
-			animationDelay = 50 * 10;
-		}
-		ledIndex++;
-	} else {
-		animationActive = false;
-		refresh = false;
-		ledIndex = 0;
+	AnimationReturnType ret = Led_RenderTinted(LedTableAnimation::Idle, Led_GetIdleColor(), startNewAnimation, leds);
+	if (OPMODE_BLUETOOTH_SOURCE == System_GetOperationMode()) {
+		// animate a bit faster in BT-Source to distinguish between the bluetooth modes
+		ret.animationDelay = ret.animationDelay * 3 / 5;
 	}
-	return AnimationReturnType(animationActive, animationDelay, refresh);
+	return ret;
 }
 
 // --------------------------------
 // Busy Animation
 // --------------------------------
 AnimationReturnType Animation_Busy(const bool startNewAnimation, CRGBSet &leds) {
-	// return values
-	bool animationActive = true;
-	int32_t animationDelay = 0;
-	// static vars
-	static bool singleLedStatus = false;
-	static uint16_t animationIndex = 0;
-	if (startNewAnimation) {
-		animationIndex = 0;
-	}
-	if constexpr (NUM_INDICATOR_LEDS == 1) {
-		leds = CRGB::Black;
-		singleLedStatus = !singleLedStatus;
-		if (singleLedStatus) {
-			leds[0] = CRGB::BlueViolet;
-		}
-		animationDelay = 100;
-		animationActive = false;
-	} else {
-		if (animationIndex < leds.size()) {
-			leds = CRGB::Black;
-			CRGB::HTMLColorCode idleColor = Led_GetIdleColor();
-			Led_DrawIdleDots(leds, animationIndex, idleColor);
-			animationDelay = 50;
-			animationIndex++;
-		} else {
-			animationActive = false;
-		}
-	}
-	return AnimationReturnType(animationActive, animationDelay, true);
+	const CRGB color = (NUM_INDICATOR_LEDS == 1) ? CRGB(CRGB::BlueViolet) : CRGB(Led_GetIdleColor());
+	return Led_RenderTinted(LedTableAnimation::Busy, color, startNewAnimation, leds);
 }
 
 // --------------------------------
@@ -841,21 +842,8 @@ AnimationReturnType Animation_Busy(const bool startNewAnimation, CRGBSet &leds)
 // --------------------------------
 // Animates the pause if no Webstream is active
 AnimationReturnType Animation_Pause(const bool startNewAnimation, CRGBSet &leds) {
-	(void) startNewAnimation; // start is not used
-
-	leds = CRGB::Black;
-	CRGB::HTMLColorCode generalColor = CRGB::Orange;
-	if (OPMODE_BLUETOOTH_SOURCE == System_GetOperationMode()) {
-		generalColor = CRGB::Blue;
-	}
-
-	uint8_t pauseOffset = 0;
-	if (OFFSET_PAUSE_LEDS) {
-		pauseOffset = ((leds.size() / NUM_LEDS_IDLE_DOTS) / 2) - 1;
-	}
-	Led_DrawIdleDots(leds, pauseOffset, generalColor);
-
-	return AnimationReturnType(false, 10, true);
+	const CRGB color = (OPMODE_BLUETOOTH_SOURCE == System_GetOperationMode()) ? CRGB::Blue : CRGB::Orange;
+	return Led_RenderTinted(LedTableAnimation::Pause, color, startNewAnimation, leds);
 }
 
 // --------------------------------
@@ -863,16 +851,7 @@ AnimationReturnType Animation_Pause(const bool startNewAnimation, CRGBSet &leds)
 // --------------------------------
 // only draw yellow pause-dots
 AnimationReturnType Animation_Speech(const bool startNewAnimation, CRGBSet &leds) {
-	(void) startNewAnimation; // start is not used
-
-	leds = CRGB::Black;
-	uint8_t pauseOffset = 0;
-	if (OFFSET_PAUSE_LEDS) {
-		pauseOffset = ((leds.size() / NUM_LEDS_IDLE_DOTS) / 2) - 1;
-	}
-	Led_DrawIdleDots(leds, pauseOffset, CRGB::Yellow);
-
-	return AnimationReturnType(false, 10, true);
+	return Led_RenderTable(LedTableAnimation::Speech, startNewAnimation, leds);
 }
 
 // --------------------------------
@@ -884,19 +863,19 @@ AnimationReturnType Animation_Progress(const bool startNewAnimation, CRGBSet &le
 	// static values
 	static double lastPos = 0.0f;
 
-	if (gPlayProperties.currentRelPos != lastPos || startNewAnimation) {
-		lastPos = gPlayProperties.currentRelPos;
+	if (Led_PlaybackState.currentRelPos != lastPos || startNewAnimation) {
+		lastPos = Led_PlaybackState.currentRelPos;
 		leds = CRGB::Black;
 		if constexpr (NUM_INDICATOR_LEDS == 1) {
-			leds[0].setHue((uint8_t) (85 - ((double) 90 / 100) * gPlayProperties.currentRelPos));
+			leds[0].setHue((uint8_t) (85 - ((double) 90 / 100) * Led_PlaybackState.currentRelPos));
 		} else {
-			const uint32_t ledValue = std::clamp<uint32_t>(map(gPlayProperties.currentRelPos, 0, 98, 0, leds.size() * DIMMABLE_STATES), 0, leds.size() * DIMMABLE_STATES);
+			const uint32_t ledValue = std::clamp<uint32_t>(map(Led_PlaybackState.currentRelPos, 0, 98, 0, leds.size() * DIMMABLE_STATES), 0, leds.size() * DIMMABLE_STATES);
 			const uint8_t fullLeds = ledValue / DIMMABLE_STATES;
 			const uint8_t lastLed = ledValue % DIMMABLE_STATES;
 			for (uint8_t led = 0; led < fullLeds; led++) {
 				if (System_AreControlsLocked()) {
 					leds[Led_Address(led)] = CRGB::Red;
-				} else if (!gPlayProperties.pausePlay) { // Hue-rainbow
+				} else if (!Led_PlaybackState.pausePlay) { // Hue-rainbow
 					leds[Led_Address(led)].setHue((uint8_t) (((float) PROGRESS_HUE_END - (float) PROGRESS_HUE_START) / (leds.size() - 1) * led + PROGRESS_HUE_START));
 				}
 			}
@@ -982,9 +961,9 @@ AnimationReturnType Animation_PlaylistProgress(const bool startNewAnimation, CRG
 	static uint32_t staticLastTrack = 0; // variable to remember the last track (for connecting animations)
 
 	if constexpr (NUM_INDICATOR_LEDS >= 4) {
-		const uint16_t currentTrack = (gPlayProperties.playlist) ? gPlayProperties.playlist->size() : 0;
-		if (currentTrack > 1 && gPlayProperties.currentTrackNumber < currentTrack) {
-			const uint32_t ledValue = std::clamp<uint32_t>(map(gPlayProperties.currentTrackNumber, 0, currentTrack - 1, 0, leds.size() * DIMMABLE_STATES), 0, leds.size() * DIMMABLE_STATES);
+		const uint16_t currentTrack = Led_PlaybackState.numberOfTracks;
+		if (currentTrack > 1 && Led_PlaybackState.currentTrackNumber < currentTrack) {
+			const uint32_t ledValue = std::clamp<uint32_t>(map(Led_PlaybackState.currentTrackNumber, 0, currentTrack - 1, 0, leds.size() * DIMMABLE_STATES), 0, leds.size() * DIMMABLE_STATES);
 			const uint8_t fullLeds = ledValue / DIMMABLE_STATES;
 			const uint8_t lastLed = ledValue % DIMMABLE_STATES;
 			static LedPlaylistProgressStates animationState = LedPlaylistProgressStates::Done; // Statemachine-variable of this animation
@@ -995,13 +974,13 @@ AnimationReturnType Animation_PlaylistProgress(const bool startNewAnimation, CRG
 				// only animate diff, if triggered again
 				if (!startNewAnimation) {
 					// forward progress
-					if (staticLastTrack < gPlayProperties.currentTrackNumber) {
+					if (staticLastTrack < Led_PlaybackState.currentTrackNumber) {
 						if (animationState > LedPlaylistProgressStates::FillBar) {
 							animationState = LedPlaylistProgressStates::FillBar;
 							animationCounter = staticLastBarLenghtPlaylist;
 						}
 						// backwards progress
-					} else if (staticLastTrack > gPlayProperties.currentTrackNumber) {
+					} else if (staticLastTrack > Led_PlaybackState.currentTrackNumber) {
 						if (staticLastBarLenghtPlaylist < fullLeds) {
 							animationState = LedPlaylistProgressStates::FillBar;
 							animationCounter = staticLastBarLenghtPlaylist;
@@ -1011,7 +990,7 @@ AnimationReturnType Animation_PlaylistProgress(const bool startNewAnimation, CRG
 						}
 					}
 				}
-				staticLastTrack = gPlayProperties.currentTrackNumber;
+				staticLastTrack = Led_PlaybackState.currentTrackNumber;
 			}
 
 			if (startNewAnimation) {
@@ -1157,6 +1136,7 @@ void Led_TaskPause(void) {
 #ifdef NEOPIXEL_ENABLE
 	vTaskSuspend(Led_TaskHandle);
 	FastLED.clear(true);
+	Led_ShownBrightness = -1; // next frame has to be sent
 #endif
 }
 
@@ -1165,3 +1145,11 @@ void Led_TaskResume(void) {
 	vTaskResume(Led_TaskHandle);
 #endif
 }
+
+void Led_GetFrameStats(LedFrameStats &stats) {
+#ifdef NEOPIXEL_ENABLE
+	stats = Led_FrameStats;
+#else
+	stats = {};
+#endif
+}
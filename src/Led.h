@@ -58,16 +58,25 @@ struct AnimationReturnType {
 		, animationRefresh(refresh) { }
 };
 
+typedef struct {
+	uint32_t rendered; // frames sent to the LEDs
+	uint32_t skipped; // frames not sent as neither pixels nor brightness changed
+	uint32_t lastRenderCycles; // CPU-cycles of the last animation-step (without sending)
+	uint32_t avgRenderCycles;
+	uint32_t maxRenderCycles;
+} LedFrameStats;
+
 void Led_Init(void);
+void Led_LoadAnimations(void); // custom animations from SD (see LedAnimation.h)
 void Led_Exit(void);
 void Led_Indicate(LedIndicatorType value);
-void Led_SetPause(boolean value);
 void Led_ResetToInitialBrightness(void);
 void Led_ResetToNightBrightness(void);
 uint8_t Led_GetBrightness(void);
 void Led_SetBrightness(uint8_t value);
 void Led_TaskPause(void);
 void Led_TaskResume(void);
+void Led_GetFrameStats(LedFrameStats &stats);
 
 void Led_SetNightmode(bool enabled);
 bool Led_GetNightmode();
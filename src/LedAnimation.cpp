@@ -0,0 +1,168 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#ifdef NEOPIXEL_ENABLE
+	#include "LedAnimation.h"
+
+	#include "Log.h"
+	#include "SdCard.h"
+
+	#include <ArduinoJson.h>
+
+namespace {
+constexpr uint16_t LedAnimation_FrameMs = 20; // frame-interval of eased transitions
+constexpr size_t LedAnimation_MaxFrames = 128;
+constexpr size_t LedAnimation_JsonSize = 2048;
+
+uint8_t LedAnimation_Ease(LedEasing easing, uint8_t amount) {
+	return (easing == LedEasing::EaseInOut) ? ease8InOutQuad(amount) : amount;
+}
+
+// Color of a (virtual) LED in a keyframe; unknown palette-indices are black
+CRGB LedAnimation_Pixel(const LedAnimationDescriptor &descriptor, const LedKeyframe &keyframe, uint8_t number) {
+	if (keyframe.pattern.length() == 0) {
+		return CRGB::Black;
+	}
+	const int index = keyframe.pattern[number % keyframe.pattern.length()] - '0';
+	if (index < 0 || static_cast<size_t>(index) >= descriptor.palette.size()) {
+		return CRGB::Black;
+	}
+	return descriptor.palette[index];
+}
+
+LedEasing LedAnimation_ParseEasing(const char *easing) {
+	if (easing == nullptr) {
+		return LedEasing::Step;
+	} else if (strcmp(easing, "linear") == 0) {
+		return LedEasing::Linear;
+	} else if (strcmp(easing, "easeInOut") == 0) {
+		return LedEasing::EaseInOut;
+	}
+	return LedEasing::Step;
+}
+} // namespace
+
+bool LedAnimation::compile(const LedAnimationDescriptor &descriptor, uint8_t numLeds, AddressFunction address) {
+	const size_t numKeyframes = descriptor.keyframes.size();
+	if (numKeyframes == 0 || numLeds == 0) {
+		return false;
+	}
+	std::vector<CRGB> frames;
+	std::vector<uint16_t> holdMs;
+	std::vector<CRGB> from(numLeds);
+	std::vector<CRGB> to(numLeds);
+	for (size_t k = 0; k < numKeyframes; k++) {
+		const LedKeyframe &keyframe = descriptor.keyframes[k];
+		const bool last = (k + 1 == numKeyframes);
+		const LedKeyframe &next = descriptor.keyframes[last ? 0 : k + 1];
+		// the last keyframe eases back to the first one only if the animation is repeated
+		const bool transition = (keyframe.easing != LedEasing::Step) && (numKeyframes > 1) && !(last && descriptor.repeats == 1);
+		const uint16_t steps = transition ? std::max<uint16_t>(1, keyframe.durationMs / LedAnimation_FrameMs) : 1;
+		if (holdMs.size() + steps > LedAnimation_MaxFrames) {
+			return false;
+		}
+		for (uint8_t i = 0; i < numLeds; i++) {
+			from[address(i)] = LedAnimation_Pixel(descriptor, keyframe, i);
+			to[address(i)] = LedAnimation_Pixel(descriptor, next, i);
+		}
+		for (uint16_t step = 0; step < steps; step++) {
+			const uint8_t amount = LedAnimation_Ease(keyframe.easing, (step * 256u) / steps);
+			for (uint8_t i = 0; i < numLeds; i++) {
+				frames.push_back(transition ? blend(from[i], to[i], amount) : from[i]);
+			}
+			holdMs.push_back(keyframe.durationMs / steps + ((step + 1 == steps) ? keyframe.durationMs % steps : 0));
+		}
+	}
+	frames_ = std::move(frames);
+	holdMs_ = std::move(holdMs);
+	numLeds_ = numLeds;
+	repeats_ = descriptor.repeats;
+	frame_ = 0;
+	repeat_ = 0;
+	return true;
+}
+
+bool LedAnimation::render(bool restart, CRGB *leds, uint16_t &holdMs) {
+	if (isEmpty()) {
+		holdMs = 0;
+		return false;
+	}
+	if (restart) {
+		frame_ = 0;
+		repeat_ = 0;
+	}
+	memcpy(leds, &frames_[frame_ * numLeds_], numLeds_ * sizeof(CRGB));
+	holdMs = holdMs_[frame_];
+	if (++frame_ < holdMs_.size()) {
+		return true;
+	}
+	frame_ = 0;
+	if (repeats_ == 0) {
+		return true;
+	}
+	if (repeat_ < repeats_) {
+		repeat_++;
+	}
+	return repeat_ < repeats_;
+}
+
+bool LedAnimation_Load(const char *name, LedAnimationDescriptor &descriptor) {
+	String path = LED_ANIMATION_DIR;
+	path.concat('/');
+	path.concat(name);
+	path.concat(".json");
+	if (!gFSystem.exists(path)) {
+		return false;
+	}
+	File file = gFSystem.open(path, FILE_READ);
+	if (!file) {
+		return false;
+	}
+	DynamicJsonDocument doc(LedAnimation_JsonSize);
+	const DeserializationError error = deserializeJson(doc, file);
+	file.close();
+	if (error) {
+		Log_Printf(LOGLEVEL_ERROR, jsonErrorMsg, error.c_str());
+		return false;
+	}
+
+	descriptor = LedAnimationDescriptor();
+	for (JsonVariant color : doc["palette"].as<JsonArray>()) {
+		const char *hex = color.as<const char *>();
+		if (hex == nullptr) {
+			return false;
+		}
+		descriptor.palette.push_back(CRGB(strtoul((hex[0] == '#') ? hex + 1 : hex, nullptr, 16)));
+	}
+	for (JsonObject keyframe : doc["keyframes"].as<JsonArray>()) {
+		descriptor.keyframes.push_back(LedKeyframe {keyframe["ms"].as<uint16_t>(), LedAnimation_ParseEasing(keyframe["ease"].as<const char *>()), keyframe["pattern"].as<const char *>()});
+	}
+	descriptor.repeats = doc["repeats"] | 0;
+	return !descriptor.keyframes.empty();
+}
+
+String LedAnimation_DotsPattern(uint8_t numLeds, uint8_t numDots, uint8_t offset, LedAnimation::AddressFunction address) {
+	const uint8_t distance = numLeds / numDots;
+	String pattern;
+	pattern.reserve(numLeds);
+	for (uint8_t i = 0; i < numLeds; i++) {
+		bool dot = false;
+		for (uint8_t d = 0; d < numDots && !dot; d++) {
+			dot = (address(i) == (address(offset) + d * distance) % numLeds);
+		}
+		pattern.concat(dot ? '0' : '.');
+	}
+	return pattern;
+}
+
+LedAnimationDescriptor LedAnimation_RotatingDots(CRGB color, uint16_t stepMs, uint8_t numLeds, uint8_t numDots, LedAnimation::AddressFunction address) {
+	// evenly spread dots look the same again after moving by their distance: the round is compiled as repeats of that part
+	const bool periodic = (numLeds % numDots == 0);
+	const uint8_t steps = periodic ? numLeds / numDots : numLeds;
+	LedAnimationDescriptor descriptor {{color}, {}, static_cast<uint8_t>(periodic ? numDots : 1)};
+	for (uint8_t step = 0; step < steps; step++) {
+		descriptor.keyframes.push_back(LedKeyframe {stepMs, LedEasing::Step, LedAnimation_DotsPattern(numLeds, numDots, step, address)});
+	}
+	return descriptor;
+}
+#endif
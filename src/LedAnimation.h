@@ -0,0 +1,58 @@
+#pragma once
+
+#include <FastLED.h>
+#include <vector>
+
+// Declarative LED-animations: a palette and keyframes, each keyframe is a pattern of palette-colors
+// tiled over the indicator-LEDs. The transition to the next keyframe is eased. An animation is
+// compiled once into a table of ready-made frames, so rendering a frame is just a copy.
+// Custom animations are loaded from LED_ANIMATION_DIR/<name>.json, e.g.:
+// {"palette": ["#ff0000"], "repeats": 3, "keyframes": [{"ms": 200, "pattern": "0"}, {"ms": 200, "ease": "linear", "pattern": "."}]}
+enum class LedEasing : uint8_t {
+	Step = 0, // keyframe is held, then the next one is shown
+	Linear,
+	EaseInOut
+};
+
+struct LedKeyframe {
+	uint16_t durationMs;
+	LedEasing easing; // transition to the next keyframe
+	String pattern; // palette-index ('0'-'9') per LED, '.' is black; repeated if shorter than the ring
+};
+
+struct LedAnimationDescriptor {
+	std::vector<CRGB> palette;
+	std::vector<LedKeyframe> keyframes;
+	uint8_t repeats; // 0: endless
+};
+
+class LedAnimation {
+public:
+	typedef uint8_t (*AddressFunction)(uint8_t number); // virtual to physical LED
+
+	// false if the descriptor is invalid or needs too many frames
+	bool compile(const LedAnimationDescriptor &descriptor, uint8_t numLeds, AddressFunction address);
+	bool isEmpty() const {
+		return holdMs_.empty();
+	}
+	size_t frameCount() const {
+		return holdMs_.size();
+	}
+	// Copies the next frame and the time to hold it; false once the last frame (of the last repeat) was rendered
+	bool render(bool restart, CRGB *leds, uint16_t &holdMs);
+
+private:
+	std::vector<CRGB> frames_; // numLeds_ per frame
+	std::vector<uint16_t> holdMs_;
+	uint8_t numLeds_ = 0;
+	uint8_t repeats_ = 1;
+	size_t frame_ = 0;
+	uint8_t repeat_ = 0;
+};
+
+bool LedAnimation_Load(const char *name, LedAnimationDescriptor &descriptor); // from LED_ANIMATION_DIR
+
+// Pattern of dots evenly spread over the ring: the first one at (virtual) LED offset, the others every numLeds / numDots physical LEDs
+String LedAnimation_DotsPattern(uint8_t numLeds, uint8_t numDots, uint8_t offset, LedAnimation::AddressFunction address);
+// Dots moving by one LED per step for one round of the ring
+LedAnimationDescriptor LedAnimation_RotatingDots(CRGB color, uint16_t stepMs, uint8_t numLeds, uint8_t numDots, LedAnimation::AddressFunction address);
@@ -33,9 +33,11 @@ const char reallocCalled[] = "Speicher reallokiert.";
 const char unableToAllocateMemForLinearPlaylist[] = "Speicher für lineare Playlist konnte nicht allokiert werden!";
 const char numberOfValidFiles[] = "Anzahl gültiger Files/Webstreams: %u";
 const char newLoudnessReceivedQueue[] = "Neue Lautstärke empfangen via Queue: %u";
-const char newEqualizerReceivedQueue[] = "Neue Equalizer-Einstellungen empfangen via Queue: %i, %i, %i";
+const char newEqualizerReceivedQueue[] = "Neue Equalizer-Einstellungen empfangen via Queue";
 const char newCntrlReceivedQueue[] = "Kontroll-Kommando empfangen via Queue: %u";
 const char newPlaylistReceived[] = "Neue Playlist mit %d Titel(n) empfangen";
+const char playlistEdited[] = "Playlist bearbeitet, jetzt %u Titel";
+const char playlistEditNotAllowed[] = "Playlist kann so nicht bearbeitet werden.";
 const char repeatTrackDueToPlaymode[] = "Wiederhole Titel aufgrund von Playmode.";
 const char repeatPlaylistDueToPlaymode[] = "Wiederhole Playlist aufgrund von Playmode.";
 const char cmndStop[] = "Kommando: Stop";
@@ -52,6 +54,7 @@ const char trackStart[] = "Titel wird von vorne gespielt.";
 const char trackChangeWebstream[] = "Im Webradio-Modus kann nicht an den Anfang gesprungen werden.";
 const char endOfPlaylistReached[] = "Ende der Playlist erreicht.";
 const char trackStartatPos[] = "Titel wird abgespielt ab Position %u";
+const char trackStartatTime[] = "Titel wird abgespielt ab %u ms (Position %u)";
 const char waitingForTaskQueues[] = "Task Queue für RFID existiert noch nicht, warte...";
 const char rfidScannerReady[] = "RFID-Tags koennen jetzt gescannt werden...";
 const char rfidTagDetected[] = "RFID-Karte erkannt: %s";
@@ -95,6 +98,8 @@ const char modificatorSleepTimer120[] = "Modifikator: Sleep-Timer per RFID aktiv
 const char ledsDimmedToNightmode[] = "LEDs wurden auf Nachtmodus gedimmt.";
 const char ledsDimmedToInitialValue[] = "LEDs wurden auf initiale Helligkeit gedimmt.";
 const char ledsBrightnessRestored[] = "LED Helligkeit wieder hergestellt.";
+const char ledAnimationLoaded[] = "LED-Animation '%s' von SD geladen (%u Frames).";
+const char ledAnimationInvalid[] = "LED-Animation '%s' auf SD ist ungültig oder zu lang, die eingebaute wird verwendet.";
 const char modificatorNotallowedWhenIdle[] = "Modifikator kann bei nicht aktivierter Playlist nicht angewendet werden.";
 const char modificatorSleepAtEOT[] = "Modifikator: Sleep-Timer am Ende des Titels aktiviert.";
 const char modificatorSleepAtEOP[] = "Modifikator: Sleep-Timer am Ende der Playlist aktiviert.";
@@ -119,6 +124,8 @@ const char unableToCreateRfidQ[] = "Konnte RFID-Queue nicht anlegen.";
 const char unableToCreateMgmtQ[] = "Konnte Play-Management-Queue nicht anlegen.";
 const char unableToCreatePlayQ[] = "Konnte Track-Queue nicht anlegen.";
 const char unableToCreateEqualizerQ[] = "Konnte Equalizer-Queue nicht anlegen.";
+const char unableToCreatePlaylistEditQ[] = "Konnte Playlist-Queue nicht anlegen.";
+const char unableToCreateButtonQ[] = "Konnte Button-Queue nicht anlegen.";
 const char initialBrightnessfromNvs[] = "Initiale LED-Helligkeit wurde aus NVS geladen: %u";
 const char wroteInitialBrightnessToNvs[] = "Initiale LED-Helligkeit wurde ins NVS geschrieben.";
 const char restoredInitialBrightnessForNmFromNvs[] = "LED-Helligkeit für Nachtmodus wurde aus NVS geladen: %u";
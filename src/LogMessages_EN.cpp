@@ -33,9 +33,11 @@ const char reallocCalled[] = "Reallocated memory.";
 const char unableToAllocateMemForLinearPlaylist[] = "Unable to allocate memory for linear playlist!";
 const char numberOfValidFiles[] = "Number of valid files/webstreams: %u";
 const char newLoudnessReceivedQueue[] = "New volume received via queue: %u";
-const char newEqualizerReceivedQueue[] = "New equalizer settings received via queue: %i, %i, %i";
+const char newEqualizerReceivedQueue[] = "New equalizer-presets received via queue";
 const char newCntrlReceivedQueue[] = "Control-command received via queue: %u";
 const char newPlaylistReceived[] = "New playlist received with %d track(s)";
+const char playlistEdited[] = "Playlist edited, now %u track(s)";
+const char playlistEditNotAllowed[] = "Playlist can't be edited this way.";
 const char repeatTrackDueToPlaymode[] = "Repeating track due to playmode configured.";
 const char repeatPlaylistDueToPlaymode[] = "Repeating playlist due to playmode configured.";
 const char cmndStop[] = "Command: stop";
@@ -52,6 +54,7 @@ const char trackStart[] = "Starting track from the very beginning.";
 const char trackChangeWebstream[] = "Playing from the very beginning is not possible while webradio-mode is active.";
 const char endOfPlaylistReached[] = "Reached end of playlist.";
 const char trackStartatPos[] = "Starting track at position %u";
+const char trackStartatTime[] = "Starting track at %u ms (position %u)";
 const char waitingForTaskQueues[] = "Task Queue for RFID does not exist yet, waiting...";
 const char rfidScannerReady[] = "RFID-tags can now be applied...";
 const char rfidTagDetected[] = "RFID-tag detected: %s";
@@ -96,6 +99,8 @@ const char modificatorSleepTimer120[] = "Modificator: sleep-Timer enabled via RF
 const char ledsDimmedToNightmode[] = "Dimmed LEDs to nightmode.";
 const char ledsDimmedToInitialValue[] = "Dimmed LEDs to initial value.";
 const char ledsBrightnessRestored[] = "LED brightness restored.";
+const char ledAnimationLoaded[] = "LED-animation '%s' loaded from SD (%u frames).";
+const char ledAnimationInvalid[] = "LED-animation '%s' on SD is invalid or too long, using the built-in one.";
 const char modificatorNotallowedWhenIdle[] = "Modificator cannot be applied while playlist is inactive.";
 const char modificatorSleepAtEOT[] = "Modificator: adjusted sleep-timer to after end of current track.";
 const char modificatorSleepAtEOP[] = "Modificator: adjusted sleep-timer to after end of playlist.";
@@ -120,6 +125,8 @@ const char unableToCreateRfidQ[] = "Unable to create RFID-queue.";
 const char unableToCreateMgmtQ[] = "Unable to play-management-queue.";
 const char unableToCreatePlayQ[] = "Unable to create track-queue.";
 const char unableToCreateEqualizerQ[] = "Unable to create equalizer-queue.";
+const char unableToCreatePlaylistEditQ[] = "Unable to create playlist-edit-queue.";
+const char unableToCreateButtonQ[] = "Unable to create button-queue.";
 const char initialBrightnessfromNvs[] = "Restoring initial LED-brightness from NVS: %u";
 const char wroteInitialBrightnessToNvs[] = "Storing initial LED-brightness to NVS.";
 const char restoredInitialBrightnessForNmFromNvs[] = "Restored LED-brightness for nightmode from NVS: %u";
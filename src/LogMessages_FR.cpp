@@ -32,9 +32,11 @@ const char reallocCalled[] = "Mémoire réallouée.";
 const char unableToAllocateMemForLinearPlaylist[] = "Impossible d'allouer de la mémoire pour la liste de lecture linéaire !";
 const char numberOfValidFiles[] = "Nombre de fichiers/webdiffusions valides : %u";
 const char newLoudnessReceivedQueue[] = "Nouveau volume reçu via la file d'attente : %u";
-const char newEqualizerReceivedQueue[] = "Nouveau paramètres d'égalisation reçus via la file d'attente: %i, %i, %i";
+const char newEqualizerReceivedQueue[] = "Nouveaux paramètres d'égalisation reçus via la file d'attente";
 const char newCntrlReceivedQueue[] = "Commande de contrôle reçue via la file d'attente : %u";
 const char newPlaylistReceived[] = "Nouvelle liste de lecture reçue avec %d piste(s)";
+const char playlistEdited[] = "Liste de lecture modifiée, maintenant %u piste(s)";
+const char playlistEditNotAllowed[] = "Impossible de modifier la liste de lecture de cette façon.";
 const char repeatTrackDueToPlaymode[] = "Piste répétée en raison du mode de lecture configuré.";
 const char repeatPlaylistDueToPlaymode[] = "Liste de lecture répétée en raison du mode de lecture configuré.";
 const char cmndStop[] = "Commande : arrêt";
@@ -51,6 +53,7 @@ const char trackStart[] = "Démarrage de la piste depuis le début.";
 const char trackChangeWebstream[] = "Le démarrage depuis le début n'est pas possible en mode webradio.";
 const char endOfPlaylistReached[] = "Fin de la liste de lecture atteinte.";
 const char trackStartatPos[] = "Démarrage de la piste à la position %u";
+const char trackStartatTime[] = "Démarrage de la piste à %u ms (position %u)";
 const char waitingForTaskQueues[] = "La file d'attente des tâches pour RFID n'existe pas encore, en attente...";
 const char rfidScannerReady[] = "Les tags RFID peuvent maintenant être appliqués...";
 const char rfidTagDetected[] = "Tag RFID détecté : %s";
@@ -94,6 +97,8 @@ const char modificatorSleepTimer120[] = "Modificateur : minuteur d'arrêt activ
 const char ledsDimmedToNightmode[] = "LEDs atténuées en mode nuit.";
 const char ledsDimmedToInitialValue[] = "LEDs atténuées à la valeur initiale.";
 const char ledsBrightnessRestored[] = "Luminosité des LED restaurée.";
+const char ledAnimationLoaded[] = "Animation LED '%s' chargée depuis la SD (%u images).";
+const char ledAnimationInvalid[] = "Animation LED '%s' sur la SD invalide ou trop longue, l'animation intégrée est utilisée.";
 const char modificatorNotallowedWhenIdle[] = "Le modificateur ne peut pas être appliqué lorsque la liste de lecture est inactive.";
 const char modificatorSleepAtEOT[] = "Modificateur : minuteur d'arrêt ajusté après la fin de la piste en cours.";
 const char modificatorSleepAtEOP[] = "Modificateur : minuteur d'arrêt ajusté après la fin de la liste de lecture.";
@@ -118,6 +123,8 @@ const char unableToCreateRfidQ[] = "Impossible de créer la file d'attente RFID.
 const char unableToCreateMgmtQ[] = "Impossible de créer la file de gestion de lecture.";
 const char unableToCreatePlayQ[] = "Impossible de créer la file d'attente de piste.";
 const char unableToCreateEqualizerQ[] = "Impossible de créer la file d'attente de equalizer.";
+const char unableToCreatePlaylistEditQ[] = "Impossible de créer la file d'attente de modification de la liste de lecture.";
+const char unableToCreateButtonQ[] = "Impossible de créer la file d'attente des boutons.";
 const char initialBrightnessfromNvs[] = "Restauration de la luminosité LED initiale depuis NVS : %u";
 const char wroteInitialBrightnessToNvs[] = "Stockage de la luminosité LED initiale dans NVS.";
 const char restoredInitialBrightnessForNmFromNvs[] = "Luminosité LED restaurée pour le mode nuit depuis NVS : %u";
@@ -0,0 +1,347 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Loudness.h"
+
+#include "Log.h"
+#include "MemX.h"
+#include "Metadata.h"
+#include "SdCard.h"
+
+#include <algorithm>
+#include <freertos/semphr.h>
+#include <math.h>
+#include <new>
+
+namespace {
+constexpr float Loudness_AbsoluteGate = -70.0f; // LUFS
+constexpr float Loudness_RelativeGate = -10.0f; // LU
+constexpr float Loudness_MaxLufs = 5.0f; // upper end of the histogram
+constexpr uint16_t Loudness_Bins = (Loudness_MaxLufs - Loudness_AbsoluteGate) * 10; // 0.1 LU each
+constexpr size_t Loudness_ReadBytes = 4096;
+
+float Loudness_FromEnergy(double energy) {
+	return -0.691f + 10.0f * log10f(energy);
+}
+} // namespace
+
+LoudnessMeter::LoudnessMeter(uint32_t sampleRate, uint8_t channels)
+	: binCounts_(Loudness_Bins, 0)
+	, binEnergies_(Loudness_Bins, 0) {
+	reset(sampleRate, channels);
+}
+
+// Coefficients of the K-weighting for any sample-rate (bilinear transform of the analog prototypes of BS.1770)
+void LoudnessMeter::reset(uint32_t sampleRate, uint8_t channels) {
+	channels_ = std::min<uint8_t>(channels, 2);
+	framesPerSubBlock_ = sampleRate / 10;
+	for (FilterState &state : state_) {
+		state = FilterState();
+	}
+	subBlockFrames_ = 0;
+	subBlockEnergy_ = 0;
+	memset(subBlocks_, 0, sizeof(subBlocks_));
+	subBlockCount_ = 0;
+	std::fill(binCounts_.begin(), binCounts_.end(), 0);
+	std::fill(binEnergies_.begin(), binEnergies_.end(), 0);
+
+	const double fs = sampleRate;
+
+	double f0 = 1681.974450955533;
+	const double gainDb = 3.999843853973347;
+	double q = 0.7071752369554196;
+	double k = tan(M_PI * f0 / fs);
+	const double vh = pow(10.0, gainDb / 20.0);
+	const double vb = pow(vh, 0.4996667741545416);
+	double a0 = 1.0 + k / q + k * k;
+	stages_[0] = {
+		float((vh + vb * k / q + k * k) / a0),
+		float(2.0 * (k * k - vh) / a0),
+		float((vh - vb * k / q + k * k) / a0),
+		float(2.0 * (k * k - 1.0) / a0),
+		float((1.0 - k / q + k * k) / a0),
+	};
+
+	f0 = 38.13547087602444;
+	q = 0.5003270373238773;
+	k = tan(M_PI * f0 / fs);
+	a0 = 1.0 + k / q + k * k;
+	stages_[1] = {1.0f, -2.0f, 1.0f, float(2.0 * (k * k - 1.0) / a0), float((1.0 - k / q + k * k) / a0)};
+}
+
+void LoudnessMeter::process(const int16_t *samples, size_t frames) {
+	const uint8_t stride = channels_;
+	for (size_t frame = 0; frame < frames; frame++) {
+		for (uint8_t channel = 0; channel < channels_; channel++) {
+			float x = samples[frame * stride + channel] / 32768.0f;
+			for (uint8_t s = 0; s < 2; s++) { // transposed direct form II
+				const Biquad &c = stages_[s];
+				float &z1 = state_[s].z1[channel];
+				float &z2 = state_[s].z2[channel];
+				const float y = c.b0 * x + z1;
+				z1 = c.b1 * x - c.a1 * y + z2;
+				z2 = c.b2 * x - c.a2 * y;
+				x = y;
+			}
+			subBlockEnergy_ += x * x; // channel-weight is 1.0 for left, right and mono
+		}
+		if (++subBlockFrames_ < framesPerSubBlock_) {
+			continue;
+		}
+
+		// every 100 ms: the block made of the last four sub-blocks is done
+		memmove(subBlocks_, subBlocks_ + 1, sizeof(subBlocks_) - sizeof(subBlocks_[0]));
+		subBlocks_[3] = subBlockEnergy_ / subBlockFrames_;
+		subBlockEnergy_ = 0;
+		subBlockFrames_ = 0;
+		if (++subBlockCount_ < 4) {
+			continue;
+		}
+		const double energy = (subBlocks_[0] + subBlocks_[1] + subBlocks_[2] + subBlocks_[3]) / 4;
+		const float lufs = (energy > 0) ? Loudness_FromEnergy(energy) : Loudness_AbsoluteGate;
+		if (lufs <= Loudness_AbsoluteGate) {
+			continue;
+		}
+		const uint16_t bin = std::min<int>((lufs - Loudness_AbsoluteGate) * 10, Loudness_Bins - 1);
+		binCounts_[bin]++;
+		binEnergies_[bin] += energy;
+	}
+}
+
+bool LoudnessMeter::integrated(float &lufs) const {
+	uint32_t count = 0;
+	double energy = 0;
+	for (uint16_t bin = 0; bin < Loudness_Bins; bin++) {
+		count += binCounts_[bin];
+		energy += binEnergies_[bin];
+	}
+	if (count == 0) {
+		return false;
+	}
+
+	// relative gate; the bin holding the threshold is counted if its center is above
+	const float threshold = Loudness_FromEnergy(energy / count) + Loudness_RelativeGate;
+	count = 0;
+	energy = 0;
+	for (uint16_t bin = 0; bin < Loudness_Bins; bin++) {
+		if (Loudness_AbsoluteGate + (bin + 0.5f) / 10 >= threshold) {
+			count += binCounts_[bin];
+			energy += binEnergies_[bin];
+		}
+	}
+	if (count == 0) {
+		return false;
+	}
+	lufs = Loudness_FromEnergy(energy / count);
+	return true;
+}
+
+namespace {
+SemaphoreHandle_t Loudness_Mutex = nullptr;
+TaskHandle_t Loudness_TaskHandle = nullptr;
+std::vector<String> Loudness_Pending;
+
+// Measurement while playing (audio-task only)
+LoudnessMeter *Loudness_TrackMeter = nullptr;
+String Loudness_TrackPath; // empty: the current track isn't measured
+uint32_t Loudness_TrackSampleRate = 0; // 0: waiting for the first PCM-block
+uint8_t Loudness_TrackChannels = 0;
+uint32_t Loudness_CyclesPerFrame = 0;
+portMUX_TYPE Loudness_StatsMux = portMUX_INITIALIZER_UNLOCKED;
+LoudnessStats Loudness_Stats;
+
+void Loudness_UpdateStats(uint32_t cycles, uint16_t frames) {
+	portENTER_CRITICAL(&Loudness_StatsMux);
+	const uint32_t blockCycles = frames * Loudness_CyclesPerFrame;
+	LoudnessStats &stats = Loudness_Stats;
+	stats.blocks++;
+	stats.lastCycles = cycles;
+	stats.avgCycles = (stats.blocks == 1) ? cycles : stats.avgCycles - stats.avgCycles / 16 + cycles / 16;
+	stats.maxCycles = std::max(stats.maxCycles, cycles);
+	if (blockCycles > 0) {
+		stats.loadPermille = uint64_t(stats.avgCycles) * 1000 / blockCycles;
+	}
+	portEXIT_CRITICAL(&Loudness_StatsMux);
+}
+
+uint16_t Loudness_Le16(const uint8_t *p) {
+	return p[0] | (p[1] << 8);
+}
+
+uint32_t Loudness_Le32(const uint8_t *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+int16_t Loudness_TrackGain(float lufs) {
+#ifdef REPLAYGAIN_ENABLE
+	return lroundf((REPLAYGAIN_TARGET_LUFS - lufs) * 100);
+#else
+	return metadataGainUnknown; // nothing is measured without REPLAYGAIN_ENABLE
+#endif
+}
+} // namespace
+
+LoudnessResult Loudness_MeasureWav(File &file, float &lufs) {
+	uint8_t chunk[24];
+	if (file.read(chunk, 12) != 12 || memcmp(chunk, "RIFF", 4) != 0 || memcmp(chunk + 8, "WAVE", 4) != 0) {
+		return LoudnessResult::Unsupported;
+	}
+	uint16_t channels = 0;
+	uint32_t sampleRate = 0;
+	uint16_t bitsPerSample = 0;
+	uint32_t dataLen = 0;
+	while (file.read(chunk, 8) == 8) {
+		const uint32_t len = Loudness_Le32(chunk + 4);
+		if (!memcmp(chunk, "fmt ", 4) && len >= 16) {
+			if (file.read(chunk, 16) != 16) {
+				return LoudnessResult::Unsupported;
+			}
+			const uint16_t format = Loudness_Le16(chunk);
+			channels = Loudness_Le16(chunk + 2);
+			sampleRate = Loudness_Le32(chunk + 4);
+			bitsPerSample = Loudness_Le16(chunk + 14);
+			if ((format != 1 && format != 0xFFFE) || bitsPerSample != 16 || channels == 0 || channels > 2 || sampleRate < 8000) {
+				return LoudnessResult::Unsupported;
+			}
+			file.seek(file.position() + len - 16 + (len & 1));
+		} else if (!memcmp(chunk, "data", 4)) {
+			dataLen = len;
+			break;
+		} else {
+			file.seek(file.position() + len + (len & 1));
+		}
+	}
+	if (!dataLen || !channels) {
+		return LoudnessResult::Unsupported;
+	}
+
+	int16_t *buf = static_cast<int16_t *>(x_malloc(Loudness_ReadBytes));
+	if (buf == nullptr) {
+		return LoudnessResult::Unsupported;
+	}
+	LoudnessMeter meter(sampleRate, channels);
+	const size_t frameBytes = channels * sizeof(int16_t);
+	while (dataLen >= frameBytes) {
+		const size_t want = std::min<size_t>(dataLen, Loudness_ReadBytes) / frameBytes * frameBytes;
+		const size_t got = file.read(reinterpret_cast<uint8_t *>(buf), want);
+		if (got < frameBytes) {
+			break;
+		}
+		meter.process(buf, got / frameBytes);
+		dataLen -= got;
+	}
+	free(buf);
+	return meter.integrated(lufs) ? LoudnessResult::Measured : LoudnessResult::Silent;
+}
+
+namespace {
+
+bool Loudness_NextPending(String &path) {
+	xSemaphoreTake(Loudness_Mutex, portMAX_DELAY);
+	const bool available = !Loudness_Pending.empty();
+	if (available) {
+		path = Loudness_Pending.front();
+		Loudness_Pending.erase(Loudness_Pending.begin());
+	}
+	xSemaphoreGive(Loudness_Mutex);
+	return available;
+}
+
+void Loudness_Task(void *) {
+	for (;;) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		String path;
+		while (Loudness_NextPending(path)) {
+			File file = gFSystem.open(path.c_str(), FILE_READ);
+			if (!file) {
+				continue;
+			}
+			const uint32_t startMs = millis();
+			float lufs;
+			const LoudnessResult result = Loudness_MeasureWav(file, lufs);
+			file.close();
+			if (result == LoudnessResult::Measured) {
+				Log_Printf(LOGLEVEL_DEBUG, "Loudness: %s: %.1f LUFS (%lu ms)", path.c_str(), lufs, millis() - startMs);
+				Metadata_SetReplayGain(path.c_str(), Loudness_TrackGain(lufs));
+			} else if (result == LoudnessResult::Silent) {
+				Metadata_SetReplayGain(path.c_str(), metadataGainUnmeasurable); // isn't tried again
+			}
+			// unsupported formats stay unknown: they are measured while being played
+		}
+	}
+}
+} // namespace
+
+void Loudness_Init(void) {
+	Loudness_Mutex = xSemaphoreCreateMutex();
+	xTaskCreatePinnedToCore(
+		Loudness_Task, /* Function to implement the task */
+		"loudness", /* Name of the task */
+		3072, /* Stack size in words */
+		NULL, /* Task input parameter */
+		tskIDLE_PRIORITY, /* Priority of the task (only runs if nothing else has to be done) */
+		&Loudness_TaskHandle, /* Task handle. */
+		ARDUINO_RUNNING_CORE /* Core where the task should run */
+	);
+}
+
+void Loudness_Request(const char *path) {
+	if (Loudness_TaskHandle == nullptr || path == nullptr) {
+		return;
+	}
+	xSemaphoreTake(Loudness_Mutex, portMAX_DELAY);
+	if (std::find(Loudness_Pending.begin(), Loudness_Pending.end(), path) == Loudness_Pending.end()) {
+		Loudness_Pending.push_back(path);
+	}
+	xSemaphoreGive(Loudness_Mutex);
+	xTaskNotifyGive(Loudness_TaskHandle);
+}
+
+void Loudness_BeginTrack(const char *path) {
+	Loudness_TrackPath = path != nullptr ? path : "";
+	Loudness_TrackSampleRate = 0;
+	if (Loudness_TrackPath.length() && Loudness_TrackMeter == nullptr) {
+		// allocated here, not in the PCM-callback; the format is set by the first block
+		Loudness_TrackMeter = new (std::nothrow) LoudnessMeter(48000, 2);
+		if (Loudness_TrackMeter == nullptr) {
+			Loudness_TrackPath = String();
+		}
+	}
+}
+
+void Loudness_ProcessTrack(const int16_t *samples, uint16_t frames, uint8_t channels, uint32_t sampleRate) {
+	if (Loudness_TrackPath.isEmpty() || sampleRate == 0) {
+		return;
+	}
+	if (Loudness_TrackSampleRate == 0) {
+		Loudness_TrackMeter->reset(sampleRate, channels);
+		Loudness_TrackSampleRate = sampleRate;
+		Loudness_TrackChannels = channels;
+		Loudness_CyclesPerFrame = ESP.getCpuFreqMHz() * 1000000u / sampleRate;
+	} else if (sampleRate != Loudness_TrackSampleRate || channels != Loudness_TrackChannels) {
+		Loudness_TrackPath = String(); // format changed within the track
+		return;
+	}
+	const uint32_t startCycles = ESP.getCycleCount();
+	Loudness_TrackMeter->process(samples, frames);
+	Loudness_UpdateStats(ESP.getCycleCount() - startCycles, frames);
+}
+
+void Loudness_EndTrack(bool completed) {
+	if (completed && Loudness_TrackPath.length() && Loudness_TrackSampleRate != 0) {
+		float lufs;
+		if (Loudness_TrackMeter->integrated(lufs)) {
+			Log_Printf(LOGLEVEL_DEBUG, "Loudness: %s: %.1f LUFS (played)", Loudness_TrackPath.c_str(), lufs);
+			Metadata_SetReplayGain(Loudness_TrackPath.c_str(), Loudness_TrackGain(lufs));
+		} else {
+			Metadata_SetReplayGain(Loudness_TrackPath.c_str(), metadataGainUnmeasurable);
+		}
+	}
+	Loudness_TrackPath = String();
+}
+
+void Loudness_GetStats(LoudnessStats &stats) {
+	portENTER_CRITICAL(&Loudness_StatsMux);
+	stats = Loudness_Stats;
+	portEXIT_CRITICAL(&Loudness_StatsMux);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "FS.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Integrated loudness of PCM-audio according to ITU-R BS.1770 / EBU R128: K-weighting, 400 ms blocks
+// with 75% overlap, absolute gate at -70 LUFS and relative gate 10 LU below the ungated loudness.
+// Blocks are collected in a histogram of 0.1 LU bins, so memory doesn't grow with the length of a file.
+class LoudnessMeter {
+public:
+	LoudnessMeter(uint32_t sampleRate, uint8_t channels);
+
+	void reset(uint32_t sampleRate, uint8_t channels); // starts a new measurement (keeps the memory)
+	void process(const int16_t *samples, size_t frames); // interleaved
+	bool integrated(float &lufs) const; // false if no block was above the absolute gate
+
+private:
+	struct Biquad {
+		float b0, b1, b2, a1, a2;
+	};
+	struct FilterState {
+		float z1[2] = {0, 0};
+		float z2[2] = {0, 0};
+	};
+
+	uint8_t channels_;
+	Biquad stages_[2]; // high-shelf ("head"), high-pass (RLB)
+	FilterState state_[2];
+	uint32_t framesPerSubBlock_; // 100 ms
+	uint32_t subBlockFrames_ = 0;
+	double subBlockEnergy_ = 0;
+	double subBlocks_[4] = {0, 0, 0, 0}; // mean-square of the last four sub-blocks
+	uint32_t subBlockCount_ = 0;
+	std::vector<uint32_t> binCounts_;
+	std::vector<double> binEnergies_;
+};
+
+enum class LoudnessResult : uint8_t {
+	Measured = 0,
+	Silent, // nothing above the gates: stored as metadataGainUnmeasurable
+	Unsupported, // not a 16 bit PCM WAV-file
+};
+
+LoudnessResult Loudness_MeasureWav(File &file, float &lufs); // 16 bit PCM, mono or stereo
+
+// Files whose loudness isn't known are measured and the result is stored as track-gain in the metadata-index:
+// - WAV-files in background (Loudness_Request())
+// - all other formats while being played: the decoded PCM is measured in front of equalizer and gain; the result is
+//   stored only if the track was played from its beginning to its end. This runs in audio_process_i2s() like the
+//   equalizer, its CPU-cost per block is reported by Loudness_GetStats().
+typedef struct {
+	uint32_t blocks = 0; // measured blocks
+	uint32_t lastCycles = 0; // CPU-cycles of the last block
+	uint32_t avgCycles = 0;
+	uint32_t maxCycles = 0;
+	uint16_t loadPermille = 0; // processing time per block relative to its playtime
+} LoudnessStats;
+
+void Loudness_Init(void);
+void Loudness_Request(const char *path);
+void Loudness_BeginTrack(const char *path); // nullptr: the track isn't measured
+void Loudness_ProcessTrack(const int16_t *samples, uint16_t frames, uint8_t channels, uint32_t sampleRate);
+void Loudness_EndTrack(bool completed); // completed: played to its end without seeking
+void Loudness_GetStats(LoudnessStats &stats);
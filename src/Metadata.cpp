@@ -0,0 +1,920 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Metadata.h"
+
+#include "Log.h"
+#include "Loudness.h"
+#include "MemX.h"
+#include "MpegFrame.h"
+#include "SdCard.h"
+#include "Web.h"
+
+#include <algorithm>
+#include <freertos/semphr.h>
+
+namespace {
+constexpr uint32_t Metadata_IndexMagic = 0x3358444D; // "MDX3"
+constexpr uint16_t Metadata_IndexEntriesWithoutPsram = 64;
+constexpr size_t Metadata_FrameBytes = 256; // max. bytes read from a single tag-frame
+constexpr size_t Metadata_CommentBytes = 4096; // max. bytes of a Vorbis-comment block
+constexpr size_t Metadata_OggHeadBytes = 8192; // OGG: beginning of file containing the header-packets
+constexpr size_t Metadata_OggTailBytes = 16384; // OGG: end of file containing the last page (granule-position)
+constexpr size_t Metadata_MpegSyncBytes = 4096; // MPEG: bytes searched for the first frame-header
+constexpr size_t Metadata_VirtualPlaylistEntries = 32;
+
+struct MetadataRecord {
+	uint32_t pathHash;
+	uint32_t fileSize; // detects replaced files
+	MetadataInfo info;
+};
+static_assert(sizeof(MetadataRecord) == 128, "MetadataRecord is stored on SD and has to keep its size");
+
+struct MetadataIndexHeader {
+	uint32_t magic;
+	uint32_t count;
+};
+
+MetadataRecord *Metadata_Records = nullptr;
+uint16_t Metadata_Capacity = 0;
+uint16_t Metadata_Count = 0;
+uint16_t Metadata_NextReplace = 0; // when full, the oldest record is replaced
+bool Metadata_Dirty = false;
+SemaphoreHandle_t Metadata_Mutex = nullptr;
+TaskHandle_t Metadata_TaskHandle = nullptr;
+std::vector<String> Metadata_Pending; // paths to be indexed by the task
+
+uint16_t Metadata_Be16(const uint8_t *p) {
+	return (p[0] << 8) | p[1];
+}
+
+uint32_t Metadata_Be32(const uint8_t *p) {
+	return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+uint32_t Metadata_Le32(const uint8_t *p) {
+	return (static_cast<uint32_t>(p[3]) << 24) | (p[2] << 16) | (p[1] << 8) | p[0];
+}
+
+uint64_t Metadata_Le64(const uint8_t *p) {
+	return (static_cast<uint64_t>(Metadata_Le32(p + 4)) << 32) | Metadata_Le32(p);
+}
+
+uint32_t Metadata_SyncSafe(const uint8_t *p) {
+	return ((p[0] & 0x7F) << 21) | ((p[1] & 0x7F) << 14) | ((p[2] & 0x7F) << 7) | (p[3] & 0x7F);
+}
+
+uint32_t Metadata_Hash(const char *path) {
+	uint32_t hash = 2166136261u; // FNV-1a
+	for (; *path; path++) {
+		hash ^= static_cast<uint8_t>(*path);
+		hash *= 16777619u;
+	}
+	return hash ? hash : 1u; // 0 marks an unused record
+}
+
+size_t Metadata_ReadAt(File &file, uint32_t pos, uint8_t *buf, size_t len) {
+	if (!file.seek(pos)) {
+		return 0;
+	}
+	return file.read(buf, len);
+}
+
+// Appends a code-point as UTF-8; never splits a character
+void Metadata_AppendUtf8(char *dst, size_t dstSize, size_t &len, uint32_t cp) {
+	char enc[4];
+	size_t n;
+	if (cp < 0x80) {
+		enc[0] = cp;
+		n = 1;
+	} else if (cp < 0x800) {
+		enc[0] = 0xC0 | (cp >> 6);
+		enc[1] = 0x80 | (cp & 0x3F);
+		n = 2;
+	} else if (cp < 0x10000) {
+		enc[0] = 0xE0 | (cp >> 12);
+		enc[1] = 0x80 | ((cp >> 6) & 0x3F);
+		enc[2] = 0x80 | (cp & 0x3F);
+		n = 3;
+	} else {
+		enc[0] = 0xF0 | (cp >> 18);
+		enc[1] = 0x80 | ((cp >> 12) & 0x3F);
+		enc[2] = 0x80 | ((cp >> 6) & 0x3F);
+		enc[3] = 0x80 | (cp & 0x3F);
+		n = 4;
+	}
+	if (len + n < dstSize) {
+		memcpy(dst + len, enc, n);
+		len += n;
+		dst[len] = '\0';
+	}
+}
+
+// Copies UTF-8 text, truncated at a character-boundary
+void Metadata_CopyUtf8(char *dst, size_t dstSize, const uint8_t *src, size_t srcLen) {
+	size_t len = 0;
+	while (len < srcLen && src[len] != '\0' && len < dstSize - 1) {
+		len++;
+	}
+	while (len > 0 && len < srcLen && (src[len] & 0xC0) == 0x80) {
+		len--; // don't cut a multibyte-sequence
+	}
+	memcpy(dst, src, len);
+	dst[len] = '\0';
+}
+
+// Copies text of an ID3v2-frame (first byte is the encoding)
+void Metadata_CopyId3Text(char *dst, size_t dstSize, const uint8_t *src, size_t srcLen) {
+	dst[0] = '\0';
+	if (srcLen < 2) {
+		return;
+	}
+	const uint8_t encoding = src[0];
+	src++;
+	srcLen--;
+	size_t len = 0;
+	switch (encoding) {
+		case 0: // ISO-8859-1
+			for (size_t i = 0; i < srcLen && src[i] != 0; i++) {
+				Metadata_AppendUtf8(dst, dstSize, len, src[i]);
+			}
+			break;
+		case 1: // UTF-16 with BOM
+		case 2: { // UTF-16BE
+			bool bigEndian = encoding == 2;
+			size_t i = 0;
+			if (encoding == 1 && srcLen >= 2) {
+				bigEndian = src[0] == 0xFE && src[1] == 0xFF;
+				i = 2;
+			}
+			for (; i + 1 < srcLen; i += 2) {
+				uint32_t cp = bigEndian ? ((src[i] << 8) | src[i + 1]) : ((src[i + 1] << 8) | src[i]);
+				if (cp == 0) {
+					break;
+				}
+				if (cp >= 0xD800 && cp < 0xDC00 && i + 3 < srcLen) { // surrogate-pair
+					const uint32_t low = bigEndian ? ((src[i + 2] << 8) | src[i + 3]) : ((src[i + 3] << 8) | src[i + 2]);
+					cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+					i += 2;
+				}
+				Metadata_AppendUtf8(dst, dstSize, len, cp);
+			}
+			break;
+		}
+		case 3: // UTF-8
+		default:
+			Metadata_CopyUtf8(dst, dstSize, src, srcLen);
+			break;
+	}
+}
+
+// Track- and disc-numbers are stored like "3" or "3/12"
+uint16_t Metadata_ParseTrackNumber(const char *text) {
+	const long number = strtol(text, nullptr, 10);
+	return (number > 0 && number <= UINT16_MAX) ? number : 0;
+}
+
+uint8_t Metadata_ParseDiscNumber(const char *text) {
+	const long number = strtol(text, nullptr, 10);
+	return (number > 0 && number <= UINT8_MAX) ? number : 0;
+}
+
+// ReplayGain-values are stored like "-6.54 dB"
+int16_t Metadata_ParseGain(const char *text) {
+	char *end;
+	const float gain = strtof(text, &end);
+	if (end == text || gain < -300.0f || gain > 300.0f) {
+		return metadataGainUnknown;
+	}
+	return lroundf(gain * 100);
+}
+
+// Handles a single "KEY=value" entry of Vorbis-comments
+void Metadata_ParseVorbisEntry(const uint8_t *entry, size_t len, MetadataInfo &info) {
+	const uint8_t *separator = static_cast<const uint8_t *>(memchr(entry, '=', len));
+	if (separator == nullptr) {
+		return;
+	}
+	const size_t keyLen = separator - entry;
+	const uint8_t *value = separator + 1;
+	const size_t valueLen = len - keyLen - 1;
+	if (keyLen == 5 && strncasecmp(reinterpret_cast<const char *>(entry), "TITLE", 5) == 0) {
+		Metadata_CopyUtf8(info.title, sizeof(info.title), value, valueLen);
+	} else if (keyLen == 6 && strncasecmp(reinterpret_cast<const char *>(entry), "ARTIST", 6) == 0 && info.artist[0] == '\0') {
+		Metadata_CopyUtf8(info.artist, sizeof(info.artist), value, valueLen);
+	} else if (keyLen == 11 && strncasecmp(reinterpret_cast<const char *>(entry), "TRACKNUMBER", 11) == 0) {
+		char number[8];
+		Metadata_CopyUtf8(number, sizeof(number), value, valueLen);
+		info.trackNumber = Metadata_ParseTrackNumber(number);
+	} else if (keyLen == 10 && strncasecmp(reinterpret_cast<const char *>(entry), "DISCNUMBER", 10) == 0) {
+		char number[8];
+		Metadata_CopyUtf8(number, sizeof(number), value, valueLen);
+		info.discNumber = Metadata_ParseDiscNumber(number);
+	} else if (keyLen == 21 && strncasecmp(reinterpret_cast<const char *>(entry), "REPLAYGAIN_TRACK_GAIN", 21) == 0) {
+		char gain[16];
+		Metadata_CopyUtf8(gain, sizeof(gain), value, valueLen);
+		info.replayGain = Metadata_ParseGain(gain);
+	} else if (keyLen == 15 && strncasecmp(reinterpret_cast<const char *>(entry), "R128_TRACK_GAIN", 15) == 0 && info.replayGain == metadataGainUnknown) {
+		// Opus: Q7.8 dB relative to -23 LUFS
+		char gain[16];
+		Metadata_CopyUtf8(gain, sizeof(gain), value, valueLen);
+		info.replayGain = strtol(gain, nullptr, 10) * 100 / 256 + 500;
+	}
+}
+
+// Vorbis-comment block (FLAC, OGG-Vorbis, Opus); a truncated block is parsed as far as available
+void Metadata_ParseVorbisComments(const uint8_t *data, size_t len, MetadataInfo &info) {
+	if (len < 8) {
+		return;
+	}
+	size_t pos = 4 + Metadata_Le32(data); // skip vendor-string
+	if (pos + 4 > len) {
+		return;
+	}
+	uint32_t count = Metadata_Le32(data + pos);
+	pos += 4;
+	while (count-- && pos + 4 <= len) {
+		const uint32_t entryLen = Metadata_Le32(data + pos);
+		pos += 4;
+		if (entryLen > len - pos) {
+			break;
+		}
+		Metadata_ParseVorbisEntry(data + pos, entryLen, info);
+		pos += entryLen;
+	}
+}
+
+// TXXX: user-defined text (description and value); only ReplayGain is of interest
+void Metadata_ParseId3UserText(const uint8_t *frame, size_t len, MetadataInfo &info) {
+	char description[24];
+	Metadata_CopyId3Text(description, sizeof(description), frame, len);
+	if (strcasecmp(description, "REPLAYGAIN_TRACK_GAIN") != 0) {
+		return;
+	}
+	// the value follows the terminator of the description (two bytes for UTF-16)
+	const size_t step = (frame[0] == 1 || frame[0] == 2) ? 2 : 1;
+	size_t pos = 1;
+	while (pos + step <= len && (frame[pos] != 0 || (step == 2 && frame[pos + 1] != 0))) {
+		pos += step;
+	}
+	pos += step;
+	if (pos >= len) {
+		return;
+	}
+	uint8_t value[32];
+	const size_t valueLen = std::min(len - pos, sizeof(value) - 1);
+	value[0] = frame[0]; // encoding
+	memcpy(value + 1, frame + pos, valueLen);
+	char gain[16];
+	Metadata_CopyId3Text(gain, sizeof(gain), value, valueLen + 1);
+	info.replayGain = Metadata_ParseGain(gain);
+}
+
+// Returns the offset of the audio-data (behind the tag)
+uint32_t Metadata_ParseId3v2(File &file, MetadataInfo &info) {
+	uint8_t header[10];
+	if (Metadata_ReadAt(file, 0, header, sizeof(header)) != sizeof(header) || memcmp(header, "ID3", 3) != 0) {
+		return 0;
+	}
+	const uint8_t version = header[3];
+	const uint8_t flags = header[5];
+	const uint32_t tagEnd = 10 + Metadata_SyncSafe(header + 6) + ((flags & 0x10) ? 10 : 0);
+	if (version < 2 || version > 4) {
+		return tagEnd;
+	}
+	const size_t frameHeaderLen = (version == 2) ? 6 : 10;
+	uint32_t pos = 10;
+	if ((flags & 0x40) && version > 2) { // extended header
+		uint8_t extSize[4];
+		if (Metadata_ReadAt(file, pos, extSize, sizeof(extSize)) != sizeof(extSize)) {
+			return tagEnd;
+		}
+		pos += (version == 4) ? Metadata_SyncSafe(extSize) : Metadata_Be32(extSize) + 4;
+	}
+
+	uint8_t frame[Metadata_FrameBytes];
+	uint32_t lengthMs = 0;
+	while (pos + frameHeaderLen <= tagEnd) {
+		uint8_t frameHeader[10];
+		if (Metadata_ReadAt(file, pos, frameHeader, frameHeaderLen) != frameHeaderLen || frameHeader[0] == 0) {
+			break; // padding
+		}
+		uint32_t frameSize;
+		char id[5] = {0};
+		bool usable = true;
+		if (version == 2) {
+			memcpy(id, frameHeader, 3);
+			frameSize = (frameHeader[3] << 16) | (frameHeader[4] << 8) | frameHeader[5];
+		} else {
+			memcpy(id, frameHeader, 4);
+			frameSize = (version == 4) ? Metadata_SyncSafe(frameHeader + 4) : Metadata_Be32(frameHeader + 4);
+			usable = (frameHeader[9] & ((version == 4) ? 0x0E : 0xC0)) == 0; // compressed, encrypted or unsynchronised
+		}
+		pos += frameHeaderLen;
+		if (frameSize == 0 || pos + frameSize > tagEnd) {
+			break;
+		}
+
+		char *target = nullptr;
+		size_t targetSize = 0;
+		char number[12] = {0};
+		if (!strcmp(id, "TIT2") || !strcmp(id, "TT2")) {
+			target = info.title;
+			targetSize = sizeof(info.title);
+		} else if (!strcmp(id, "TPE1") || !strcmp(id, "TP1")) {
+			target = info.artist;
+			targetSize = sizeof(info.artist);
+		} else if (!strcmp(id, "TRCK") || !strcmp(id, "TRK") || !strcmp(id, "TPOS") || !strcmp(id, "TPA") || !strcmp(id, "TLEN") || !strcmp(id, "TLE")) {
+			target = number;
+			targetSize = sizeof(number);
+		} else if ((!strcmp(id, "TXXX") || !strcmp(id, "TXX")) && usable) {
+			const size_t len = std::min<size_t>(frameSize, sizeof(frame));
+			if (Metadata_ReadAt(file, pos, frame, len) == len) {
+				Metadata_ParseId3UserText(frame, len, info);
+			}
+		}
+		if (target != nullptr && usable) {
+			const size_t len = std::min<size_t>(frameSize, sizeof(frame));
+			if (Metadata_ReadAt(file, pos, frame, len) == len) {
+				Metadata_CopyId3Text(target, targetSize, frame, len);
+				if (id[1] == 'R') {
+					info.trackNumber = Metadata_ParseTrackNumber(number);
+				} else if (id[1] == 'P') {
+					info.discNumber = Metadata_ParseDiscNumber(number);
+				} else if (id[1] == 'L') {
+					lengthMs = strtoul(number, nullptr, 10);
+				}
+			}
+		}
+		pos += frameSize;
+	}
+	if (lengthMs) {
+		info.durationS = (lengthMs + 500) / 1000;
+	}
+	return tagEnd;
+}
+
+// Fallback for files without ID3v2-tag
+void Metadata_ParseId3v1(File &file, MetadataInfo &info) {
+	const uint32_t size = file.size();
+	uint8_t tag[128];
+	if (size < sizeof(tag) || Metadata_ReadAt(file, size - sizeof(tag), tag, sizeof(tag)) != sizeof(tag) || memcmp(tag, "TAG", 3) != 0) {
+		return;
+	}
+	size_t len = 0;
+	for (size_t i = 3; i < 33 && tag[i]; i++) {
+		Metadata_AppendUtf8(info.title, sizeof(info.title), len, tag[i]);
+	}
+	len = 0;
+	for (size_t i = 33; i < 63 && tag[i]; i++) {
+		Metadata_AppendUtf8(info.artist, sizeof(info.artist), len, tag[i]);
+	}
+	if (tag[125] == 0 && tag[126] != 0) { // ID3v1.1
+		info.trackNumber = tag[126];
+	}
+}
+
+// Duration from the first MPEG-frame: Xing/Info/VBRI-header (VBR) or bitrate (CBR)
+void Metadata_ParseMpegDuration(File &file, uint32_t audioStart, MetadataInfo &info) {
+	uint8_t *buf = static_cast<uint8_t *>(x_malloc(Metadata_MpegSyncBytes));
+	if (buf == nullptr) {
+		return;
+	}
+	const size_t len = Metadata_ReadAt(file, audioStart, buf, Metadata_MpegSyncBytes);
+	for (size_t i = 0; i + 4 <= len; i++) {
+		MpegFrameHeader header;
+		if (!MpegFrame_Parse(buf + i, header)) {
+			continue;
+		}
+
+		uint32_t frames = 0;
+		const size_t xingPos = i + header.sideInfoOffset;
+		const size_t vbriPos = i + 4 + 32;
+		if (xingPos + 12 <= len && (!memcmp(buf + xingPos, "Xing", 4) || !memcmp(buf + xingPos, "Info", 4))) {
+			if (Metadata_Be32(buf + xingPos + 4) & 0x01) {
+				frames = Metadata_Be32(buf + xingPos + 8);
+			}
+		} else if (vbriPos + 18 <= len && !memcmp(buf + vbriPos, "VBRI", 4)) {
+			frames = Metadata_Be32(buf + vbriPos + 14);
+		}
+
+		if (frames) {
+			info.durationS = (static_cast<uint64_t>(frames) * header.samplesPerFrame + header.sampleRate / 2) / header.sampleRate;
+		} else {
+			const uint32_t audioBytes = file.size() - (audioStart + i);
+			info.durationS = (static_cast<uint64_t>(audioBytes) * 8 + header.bitrate / 2) / header.bitrate;
+		}
+		break;
+	}
+	free(buf);
+}
+
+bool Metadata_ParseFlac(File &file, uint32_t pos, MetadataInfo &info) {
+	pos += 4; // "fLaC"
+	bool last = false;
+	while (!last) {
+		uint8_t header[4];
+		if (Metadata_ReadAt(file, pos, header, sizeof(header)) != sizeof(header)) {
+			return false;
+		}
+		last = header[0] & 0x80;
+		const uint8_t type = header[0] & 0x7F;
+		const uint32_t len = (header[1] << 16) | (header[2] << 8) | header[3];
+		pos += sizeof(header);
+		if (type == 0 && len >= 18) { // STREAMINFO
+			uint8_t streamInfo[18];
+			if (Metadata_ReadAt(file, pos, streamInfo, sizeof(streamInfo)) == sizeof(streamInfo)) {
+				const uint32_t sampleRate = (streamInfo[10] << 12) | (streamInfo[11] << 4) | (streamInfo[12] >> 4);
+				const uint64_t samples = (static_cast<uint64_t>(streamInfo[13] & 0x0F) << 32) | Metadata_Be32(streamInfo + 14);
+				if (sampleRate) {
+					info.durationS = (samples + sampleRate / 2) / sampleRate;
+				}
+			}
+		} else if (type == 4) { // VORBIS_COMMENT
+			const size_t commentLen = std::min<size_t>(len, Metadata_CommentBytes);
+			uint8_t *comments = static_cast<uint8_t *>(x_malloc(commentLen));
+			if (comments != nullptr) {
+				if (Metadata_ReadAt(file, pos, comments, commentLen) == commentLen) {
+					Metadata_ParseVorbisComments(comments, commentLen, info);
+				}
+				free(comments);
+			}
+		}
+		pos += len;
+	}
+	return true;
+}
+
+bool Metadata_ParseOgg(File &file, MetadataInfo &info) {
+	const size_t headLen = std::min<size_t>(file.size(), Metadata_OggHeadBytes);
+	uint8_t *head = static_cast<uint8_t *>(x_malloc(headLen));
+	uint8_t *packet = static_cast<uint8_t *>(x_malloc(Metadata_CommentBytes));
+	if (head == nullptr || packet == nullptr) {
+		free(head);
+		free(packet);
+		return false;
+	}
+
+	// Reassemble the identification- and the comment-packet from the pages' segments
+	uint32_t sampleRate = 0;
+	uint16_t preSkip = 0;
+	bool opus = false;
+	uint8_t packetIndex = 0;
+	size_t packetLen = 0;
+	const size_t len = Metadata_ReadAt(file, 0, head, headLen);
+	size_t pos = 0;
+	while (packetIndex < 2 && pos + 27 <= len && !memcmp(head + pos, "OggS", 4)) {
+		const uint8_t segments = head[pos + 26];
+		const uint8_t *segmentTable = head + pos + 27;
+		size_t dataPos = pos + 27 + segments;
+		for (uint8_t s = 0; s < segments && packetIndex < 2 && dataPos <= len; s++) {
+			const size_t segmentLen = std::min<size_t>(segmentTable[s], len - dataPos);
+			const size_t copyLen = std::min(segmentLen, Metadata_CommentBytes - packetLen);
+			memcpy(packet + packetLen, head + dataPos, copyLen);
+			packetLen += copyLen;
+			dataPos += segmentTable[s];
+			if (segmentTable[s] == 255 && dataPos < len) {
+				continue; // packet continues
+			}
+			if (packetIndex == 0) {
+				if (packetLen >= 16 && !memcmp(packet, "\x01vorbis", 7)) {
+					sampleRate = Metadata_Le32(packet + 12);
+				} else if (packetLen >= 12 && !memcmp(packet, "OpusHead", 8)) {
+					opus = true;
+					sampleRate = 48000; // granule-positions of Opus always use 48 kHz
+					preSkip = packet[10] | (packet[11] << 8);
+				}
+			} else if (!opus && packetLen > 7 && !memcmp(packet, "\x03vorbis", 7)) {
+				Metadata_ParseVorbisComments(packet + 7, packetLen - 7, info);
+			} else if (opus && packetLen > 8 && !memcmp(packet, "OpusTags", 8)) {
+				Metadata_ParseVorbisComments(packet + 8, packetLen - 8, info);
+			}
+			packetIndex++;
+			packetLen = 0;
+		}
+		pos = dataPos;
+	}
+	free(packet);
+	free(head);
+	if (!sampleRate) {
+		return false;
+	}
+
+	// Duration: granule-position of the last page
+	const uint32_t fileSize = file.size();
+	const size_t tailLen = std::min<size_t>(fileSize, Metadata_OggTailBytes);
+	uint8_t *tail = static_cast<uint8_t *>(x_malloc(tailLen));
+	if (tail == nullptr) {
+		return true;
+	}
+	const size_t readLen = Metadata_ReadAt(file, fileSize - tailLen, tail, tailLen);
+	for (size_t i = readLen >= 14 ? readLen - 14 : 0; i-- > 0;) {
+		if (!memcmp(tail + i, "OggS", 4)) {
+			const uint64_t granule = Metadata_Le64(tail + i + 6);
+			if (granule > preSkip && granule != UINT64_MAX) {
+				info.durationS = (granule - preSkip + sampleRate / 2) / sampleRate;
+			}
+			break;
+		}
+	}
+	free(tail);
+	return true;
+}
+
+// Freeform-item ("----"): "mean"-, "name"- and "data"-atom; only ReplayGain is of interest
+void Metadata_ParseMp4Freeform(const uint8_t *item, size_t itemLen, MetadataInfo &info) {
+	bool replayGain = false;
+	for (size_t pos = 0; pos + 12 <= itemLen;) {
+		const size_t size = Metadata_Be32(item + pos);
+		if (size < 12 || size > itemLen - pos) {
+			return;
+		}
+		if (!memcmp(item + pos + 4, "name", 4)) {
+			replayGain = size - 12 == 21 && strncasecmp(reinterpret_cast<const char *>(item + pos + 12), "replaygain_track_gain", 21) == 0;
+		} else if (!memcmp(item + pos + 4, "data", 4) && replayGain && size > 16) {
+			char gain[16];
+			Metadata_CopyUtf8(gain, sizeof(gain), item + pos + 16, size - 16);
+			info.replayGain = Metadata_ParseGain(gain);
+		}
+		pos += size;
+	}
+}
+
+// Copies the payload of the "data"-atom inside an iTunes-metadata item
+void Metadata_ParseMp4Item(File &file, uint32_t pos, uint32_t len, const char *type, MetadataInfo &info) {
+	uint8_t item[Metadata_FrameBytes];
+	const size_t itemLen = std::min<size_t>(len, sizeof(item));
+	if (itemLen < 16 || Metadata_ReadAt(file, pos, item, itemLen) != itemLen) {
+		return;
+	}
+	if (!memcmp(type, "----", 4)) {
+		Metadata_ParseMp4Freeform(item, itemLen, info);
+		return;
+	}
+	if (memcmp(item + 4, "data", 4) != 0) {
+		return;
+	}
+	const uint8_t *payload = item + 16; // size, "data", type, locale
+	const size_t payloadLen = std::min<size_t>(Metadata_Be32(item), itemLen) - 16;
+	if (!memcmp(type, "\xA9nam", 4)) {
+		Metadata_CopyUtf8(info.title, sizeof(info.title), payload, payloadLen);
+	} else if (!memcmp(type, "\xA9" "ART", 4)) {
+		Metadata_CopyUtf8(info.artist, sizeof(info.artist), payload, payloadLen);
+	} else if (!memcmp(type, "trkn", 4) && payloadLen >= 4) {
+		info.trackNumber = Metadata_Be16(payload + 2);
+	} else if (!memcmp(type, "disk", 4) && payloadLen >= 4) {
+		info.discNumber = std::min<uint16_t>(Metadata_Be16(payload + 2), UINT8_MAX);
+	}
+}
+
+// Walks the atom-tree; only moov/udta/meta/ilst are entered, everything else is skipped by seeking
+void Metadata_ParseMp4Atoms(File &file, uint32_t pos, uint32_t end, uint8_t depth, bool items, MetadataInfo &info) {
+	while (pos + 8 <= end) {
+		uint8_t header[16];
+		if (Metadata_ReadAt(file, pos, header, 8) != 8) {
+			return;
+		}
+		uint64_t size = Metadata_Be32(header);
+		uint32_t headerLen = 8;
+		char type[4];
+		memcpy(type, header + 4, 4);
+		if (size == 1) { // 64-bit size
+			if (Metadata_ReadAt(file, pos + 8, header + 8, 8) != 8) {
+				return;
+			}
+			size = (static_cast<uint64_t>(Metadata_Be32(header + 8)) << 32) | Metadata_Be32(header + 12);
+			headerLen = 16;
+		} else if (size == 0) { // up to end of file
+			size = end - pos;
+		}
+		if (size < headerLen || size > end - pos) {
+			return;
+		}
+		const uint32_t dataPos = pos + headerLen;
+		const uint32_t dataEnd = pos + size;
+
+		if (items) {
+			Metadata_ParseMp4Item(file, dataPos, dataEnd - dataPos, type, info);
+		} else if (!memcmp(type, "moov", 4) || !memcmp(type, "udta", 4) || !memcmp(type, "ilst", 4)) {
+			if (depth < 4) {
+				Metadata_ParseMp4Atoms(file, dataPos, dataEnd, depth + 1, !memcmp(type, "ilst", 4), info);
+			}
+		} else if (!memcmp(type, "meta", 4)) {
+			uint8_t versionFlags[4];
+			if (depth < 4 && Metadata_ReadAt(file, dataPos, versionFlags, 4) == 4) {
+				const bool fullBox = Metadata_Be32(versionFlags) == 0; // not in QuickTime-files
+				Metadata_ParseMp4Atoms(file, dataPos + (fullBox ? 4 : 0), dataEnd, depth + 1, false, info);
+			}
+		} else if (!memcmp(type, "mvhd", 4)) {
+			uint8_t mvhd[32];
+			if (Metadata_ReadAt(file, dataPos, mvhd, sizeof(mvhd)) == sizeof(mvhd)) {
+				uint32_t timescale;
+				uint64_t duration;
+				if (mvhd[0] == 1) { // version 1: 64-bit times
+					timescale = Metadata_Be32(mvhd + 20);
+					duration = (static_cast<uint64_t>(Metadata_Be32(mvhd + 24)) << 32) | Metadata_Be32(mvhd + 28);
+				} else {
+					timescale = Metadata_Be32(mvhd + 12);
+					duration = Metadata_Be32(mvhd + 16);
+				}
+				if (timescale) {
+					info.durationS = (duration + timescale / 2) / timescale;
+				}
+			}
+		}
+		pos = dataEnd;
+	}
+}
+
+void Metadata_ParseWav(File &file, MetadataInfo &info) {
+	uint32_t pos = 12;
+	uint32_t byteRate = 0;
+	uint8_t chunk[16];
+	while (Metadata_ReadAt(file, pos, chunk, 8) == 8) {
+		const uint32_t len = Metadata_Le32(chunk + 4);
+		if (!memcmp(chunk, "fmt ", 4) && Metadata_ReadAt(file, pos + 8, chunk, 12) == 12) {
+			byteRate = Metadata_Le32(chunk + 8);
+		} else if (!memcmp(chunk, "data", 4)) {
+			if (byteRate) {
+				info.durationS = (len + byteRate / 2) / byteRate;
+			}
+			return;
+		}
+		pos += 8 + len + (len & 1);
+	}
+}
+
+bool Metadata_ParseFile(File &file, MetadataInfo &info) {
+	memset(&info, 0, sizeof(info));
+	info.replayGain = metadataGainUnknown;
+	uint8_t magic[12];
+	if (Metadata_ReadAt(file, 0, magic, sizeof(magic)) != sizeof(magic)) {
+		return false;
+	}
+	if (!memcmp(magic, "fLaC", 4)) {
+		return Metadata_ParseFlac(file, 0, info);
+	}
+	if (!memcmp(magic, "OggS", 4)) {
+		return Metadata_ParseOgg(file, info);
+	}
+	if (!memcmp(magic + 4, "ftyp", 4)) {
+		Metadata_ParseMp4Atoms(file, 0, file.size(), 0, false, info);
+		return true;
+	}
+	if (!memcmp(magic, "RIFF", 4) && !memcmp(magic + 8, "WAVE", 4)) {
+		Metadata_ParseWav(file, info);
+		return true;
+	}
+
+	const uint32_t audioStart = Metadata_ParseId3v2(file, info);
+	uint8_t inner[4];
+	if (audioStart && Metadata_ReadAt(file, audioStart, inner, sizeof(inner)) == sizeof(inner) && !memcmp(inner, "fLaC", 4)) {
+		return Metadata_ParseFlac(file, audioStart, info);
+	}
+	if (info.title[0] == '\0') {
+		Metadata_ParseId3v1(file, info);
+	}
+	if (!info.durationS) {
+		Metadata_ParseMpegDuration(file, audioStart, info);
+	}
+	return audioStart || info.title[0] || info.durationS;
+}
+
+MetadataRecord *Metadata_FindRecord(uint32_t pathHash) {
+	for (uint16_t i = 0; i < Metadata_Count; i++) {
+		if (Metadata_Records[i].pathHash == pathHash) {
+			return &Metadata_Records[i];
+		}
+	}
+	return nullptr;
+}
+
+void Metadata_Store(uint32_t pathHash, uint32_t fileSize, const MetadataInfo &info) {
+	xSemaphoreTake(Metadata_Mutex, portMAX_DELAY);
+	MetadataRecord *record = Metadata_FindRecord(pathHash);
+	if (record == nullptr) {
+		if (Metadata_Count < Metadata_Capacity) {
+			record = &Metadata_Records[Metadata_Count++];
+		} else {
+			record = &Metadata_Records[Metadata_NextReplace];
+			Metadata_NextReplace = (Metadata_NextReplace + 1) % Metadata_Capacity;
+		}
+	}
+	*record = MetadataRecord {pathHash, fileSize, info};
+	Metadata_Dirty = true;
+	xSemaphoreGive(Metadata_Mutex);
+}
+
+// Parses a file and stores the result (a file without usable tags is stored as well, so it isn't parsed again)
+bool Metadata_Index(const char *path, File &file, MetadataInfo &info) {
+	const bool parsed = Metadata_ParseFile(file, info);
+	Metadata_Store(Metadata_Hash(path), file.size(), info);
+	return parsed;
+}
+
+void Metadata_LoadIndex(void) {
+	File file = gFSystem.open(METADATA_INDEX_FILE, FILE_READ);
+	if (!file) {
+		return;
+	}
+	MetadataIndexHeader header;
+	if (file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) == sizeof(header) && header.magic == Metadata_IndexMagic) {
+		const uint16_t count = std::min<uint32_t>(header.count, Metadata_Capacity);
+		const size_t len = count * sizeof(MetadataRecord);
+		if (file.read(reinterpret_cast<uint8_t *>(Metadata_Records), len) == len) {
+			Metadata_Count = count;
+		}
+	}
+	file.close();
+	Log_Printf(LOGLEVEL_DEBUG, "Metadata: %u entries loaded from index", Metadata_Count);
+}
+
+void Metadata_SaveIndex(void) {
+	File file = gFSystem.open(METADATA_INDEX_FILE, FILE_WRITE);
+	if (!file) {
+		Log_Println("Metadata: unable to write index", LOGLEVEL_ERROR);
+		return;
+	}
+	xSemaphoreTake(Metadata_Mutex, portMAX_DELAY);
+	const MetadataIndexHeader header = {Metadata_IndexMagic, Metadata_Count};
+	file.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+	file.write(reinterpret_cast<const uint8_t *>(Metadata_Records), Metadata_Count * sizeof(MetadataRecord));
+	Metadata_Dirty = false;
+	xSemaphoreGive(Metadata_Mutex);
+	file.close();
+}
+
+bool Metadata_NextPending(String &path) {
+	xSemaphoreTake(Metadata_Mutex, portMAX_DELAY);
+	const bool available = !Metadata_Pending.empty();
+	if (available) {
+		path = Metadata_Pending.back();
+		Metadata_Pending.pop_back();
+	}
+	xSemaphoreGive(Metadata_Mutex);
+	return available;
+}
+
+// Indexes the paths of the current playlist; indexed files are re-parsed only if their size changed
+void Metadata_Task(void *) {
+	for (;;) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		uint16_t indexed = 0;
+		String path;
+		while (Metadata_NextPending(path)) {
+			File file = gFSystem.open(path.c_str(), FILE_READ);
+			if (!file || file.isDirectory()) {
+				continue;
+			}
+			const uint32_t pathHash = Metadata_Hash(path.c_str());
+			xSemaphoreTake(Metadata_Mutex, portMAX_DELAY);
+			const MetadataRecord *record = Metadata_FindRecord(pathHash);
+			const bool upToDate = record != nullptr && record->fileSize == file.size();
+			int16_t replayGain = upToDate ? record->info.replayGain : metadataGainUnknown;
+			xSemaphoreGive(Metadata_Mutex);
+			if (!upToDate) {
+				MetadataInfo info;
+				Metadata_Index(path.c_str(), file, info);
+				replayGain = info.replayGain;
+				indexed++;
+			}
+			file.close();
+			if (replayGain == metadataGainUnknown && path.length() > 4 && strcasecmp(path.c_str() + path.length() - 4, ".wav") == 0) {
+				Loudness_Request(path.c_str()); // untagged: measured in background
+			}
+		}
+		if (Metadata_Dirty) {
+			Metadata_SaveIndex();
+		}
+		if (indexed) {
+			Log_Printf(LOGLEVEL_DEBUG, "Metadata: %u files indexed", indexed);
+			Web_SendWebsocketData(0, WebsocketCodeType::PlaylistMetadata);
+		}
+	}
+}
+} // namespace
+
+void Metadata_Init(void) {
+	Metadata_Capacity = psramFound() ? METADATA_INDEX_ENTRIES : Metadata_IndexEntriesWithoutPsram;
+	Metadata_Records = static_cast<MetadataRecord *>(x_malloc(Metadata_Capacity * sizeof(MetadataRecord)));
+	if (Metadata_Records == nullptr) {
+		Log_Println("Metadata: unable to allocate index", LOGLEVEL_ERROR);
+		Metadata_Capacity = 0;
+		return;
+	}
+	Metadata_Mutex = xSemaphoreCreateMutex();
+	Metadata_LoadIndex();
+
+	xTaskCreatePinnedToCore(
+		Metadata_Task, /* Function to implement the task */
+		"metadata", /* Name of the task */
+		4096, /* Stack size in words */
+		NULL, /* Task input parameter */
+		1, /* Priority of the task */
+		&Metadata_TaskHandle, /* Task handle. */
+		ARDUINO_RUNNING_CORE /* Core where the task should run */
+	);
+}
+
+bool Metadata_Lookup(const char *path, MetadataInfo &info) {
+	if (Metadata_Records == nullptr || path == nullptr) {
+		return false;
+	}
+	xSemaphoreTake(Metadata_Mutex, portMAX_DELAY);
+	const MetadataRecord *record = Metadata_FindRecord(Metadata_Hash(path));
+	if (record != nullptr) {
+		info = record->info;
+	}
+	xSemaphoreGive(Metadata_Mutex);
+	return record != nullptr;
+}
+
+void Metadata_IndexPlaylist(const Playlist *playlist) {
+	if (Metadata_TaskHandle == nullptr || playlist == nullptr) {
+		return;
+	}
+	xSemaphoreTake(Metadata_Mutex, portMAX_DELAY);
+	Metadata_Pending.clear(); // the previous playlist isn't of interest anymore
+	// virtual playlists can be huge: just their beginning is indexed
+	const size_t count = playlist->isVirtual() ? std::min<size_t>(playlist->size(), Metadata_VirtualPlaylistEntries) : playlist->size();
+	for (size_t i = count; i-- > 0;) { // taken from the back, so the first track is indexed first
+		const String path = playlist->at(i);
+		if (!path.startsWith("http")) {
+			Metadata_Pending.push_back(path);
+		}
+	}
+	xSemaphoreGive(Metadata_Mutex);
+	xTaskNotifyGive(Metadata_TaskHandle);
+}
+
+// Sorts by disc- and track-number of the tags; ties keep the order of the filenames. Only indexed data is used, the
+// card isn't read: if any file isn't indexed yet or has no track-number, the filename-order is kept (the files are
+// indexed in background after the playlist started, so the next time the tags are used).
+void Metadata_SortByTrackNumber(Playlist *playlist) {
+	if (playlist == nullptr || playlist->size() < 2 || playlist->isVirtual() || Metadata_Records == nullptr) {
+		return;
+	}
+	struct SortKey {
+		uint8_t disc;
+		uint16_t track;
+		size_t nameRank;
+	};
+	std::vector<SortKey> keys;
+	keys.reserve(playlist->entries().size());
+	xSemaphoreTake(Metadata_Mutex, portMAX_DELAY);
+	for (const char *path : playlist->entries()) {
+		const MetadataRecord *record = Metadata_FindRecord(Metadata_Hash(path));
+		if (record == nullptr || record->info.trackNumber == 0) {
+			break;
+		}
+		const uint8_t disc = record->info.discNumber ? record->info.discNumber : 1; // untagged: single disc
+		keys.push_back(SortKey {disc, record->info.trackNumber, keys.size()});
+	}
+	xSemaphoreGive(Metadata_Mutex);
+	if (keys.size() != playlist->entries().size()) {
+		Log_Println("Metadata: track-numbers incomplete, playlist sorted by filename", LOGLEVEL_DEBUG);
+		return;
+	}
+
+	std::sort(keys.begin(), keys.end(), [](const SortKey &a, const SortKey &b) {
+		if (a.disc != b.disc) {
+			return a.disc < b.disc;
+		}
+		if (a.track != b.track) {
+			return a.track < b.track;
+		}
+		return a.nameRank < b.nameRank;
+	});
+	std::vector<char *> sorted;
+	sorted.reserve(keys.size());
+	for (const SortKey &key : keys) {
+		sorted.push_back(playlist->entries().at(key.nameRank));
+	}
+	playlist->entries().swap(sorted);
+	Log_Println("Metadata: playlist sorted by track-number of tags", LOGLEVEL_INFO);
+}
+
+void Metadata_SetReplayGain(const char *path, int16_t gain) {
+	if (Metadata_Records == nullptr || path == nullptr) {
+		return;
+	}
+	xSemaphoreTake(Metadata_Mutex, portMAX_DELAY);
+	MetadataRecord *record = Metadata_FindRecord(Metadata_Hash(path));
+	if (record != nullptr) {
+		record->info.replayGain = gain;
+		Metadata_Dirty = true;
+	}
+	xSemaphoreGive(Metadata_Mutex);
+	xTaskNotifyGive(Metadata_TaskHandle); // saves the index
+}
+
+// "Artist - Title" or just "Title"; empty if the title is unknown
+void Metadata_FormatTitle(const MetadataInfo &info, char *buf, size_t bufSize) {
+	if (info.title[0] == '\0') {
+		buf[0] = '\0';
+	} else if (info.artist[0] != '\0') {
+		snprintf(buf, bufSize, "%s - %s", info.artist, info.title);
+	} else {
+		snprintf(buf, bufSize, "%s", info.title);
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Playlist.h"
+
+// Index of tag-metadata (title, artist, disc- and track-number, duration, ReplayGain) of audio-files. Only the tag-headers are
+// parsed (ID3v1/v2 + MPEG-frame-header, FLAC STREAMINFO, Vorbis-comments of FLAC/OGG/Opus, MP4-atoms, WAV),
+// the decoder is never involved. Entries are kept in RAM (PSRAM if available) and in METADATA_INDEX_FILE.
+// The index of a new playlist is filled in background; a websocket-message tells the webgui when done.
+constexpr size_t metadataTitleLength = 64;
+constexpr size_t metadataArtistLength = 47;
+constexpr int16_t metadataGainUnknown = INT16_MIN; // neither tagged nor measured (yet)
+constexpr int16_t metadataGainUnmeasurable = INT16_MIN + 1; // measured, but silent: played unchanged
+
+typedef struct {
+	char title[metadataTitleLength]; // UTF-8, empty = unknown
+	char artist[metadataArtistLength];
+	uint8_t discNumber; // 0 = unknown
+	uint16_t trackNumber; // 0 = unknown
+	int16_t replayGain; // track-gain in 1/100 dB (reference -18 LUFS); metadataGainUnknown / metadataGainUnmeasurable
+	uint32_t durationS; // 0 = unknown
+} MetadataInfo;
+
+void Metadata_Init(void);
+bool Metadata_Lookup(const char *path, MetadataInfo &info); // index only, no SD-access
+void Metadata_IndexPlaylist(const Playlist *playlist);
+void Metadata_SortByTrackNumber(Playlist *playlist); // index only; expects the playlist sorted by filename
+void Metadata_FormatTitle(const MetadataInfo &info, char *buf, size_t bufSize);
+void Metadata_SetReplayGain(const char *path, int16_t gain); // result of the loudness-measurement
+
+inline bool Metadata_HasReplayGain(const MetadataInfo &info) {
+	return info.replayGain != metadataGainUnknown && info.replayGain != metadataGainUnmeasurable;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdint.h>
+
+// Header of an MPEG-audio frame (layer I-III, MPEG-1/2/2.5)
+typedef struct {
+	uint32_t bitrate; // bit/s
+	uint32_t sampleRate;
+	uint16_t samplesPerFrame;
+	uint16_t length; // bytes incl. header
+	uint8_t sideInfoOffset; // Xing/Info-header position relative to the frame-start
+	bool mpeg1;
+} MpegFrameHeader;
+
+inline bool MpegFrame_Parse(const uint8_t *p, MpegFrameHeader &header) {
+	static const uint16_t bitrates[2][3][15] = {
+		{
+			{0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448},
+			{0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384},
+			{0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320},
+		}, // MPEG-1: layer I, II, III
+		{
+			{0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256},
+			{0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160},
+			{0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160},
+		}, // MPEG-2/2.5
+	};
+	static const uint16_t sampleRates[3] = {44100, 48000, 32000};
+
+	if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) {
+		return false;
+	}
+	const uint8_t versionBits = (p[1] >> 3) & 0x03; // 3 = MPEG-1, 2 = MPEG-2, 0 = MPEG-2.5
+	const uint8_t layerBits = (p[1] >> 1) & 0x03; // 3 = layer I, 1 = layer III
+	const uint8_t bitrateIndex = p[2] >> 4;
+	const uint8_t sampleRateIndex = (p[2] >> 2) & 0x03;
+	if (versionBits == 1 || layerBits == 0 || bitrateIndex == 0 || bitrateIndex == 15 || sampleRateIndex == 3) {
+		return false;
+	}
+	const uint8_t layer = 3 - layerBits; // 0 = layer I
+	const bool mono = (p[3] >> 6) == 3;
+	const uint8_t padding = (p[2] >> 1) & 0x01;
+	header.mpeg1 = versionBits == 3;
+	header.sampleRate = sampleRates[sampleRateIndex] >> (header.mpeg1 ? 0 : ((versionBits == 2) ? 1 : 2));
+	header.samplesPerFrame = (layer == 0) ? 384 : ((layer == 1 || header.mpeg1) ? 1152 : 576);
+	header.bitrate = bitrates[header.mpeg1 ? 0 : 1][layer][bitrateIndex] * 1000u;
+	if (layer == 0) {
+		header.length = (12 * header.bitrate / header.sampleRate + padding) * 4;
+	} else {
+		header.length = header.samplesPerFrame / 8 * header.bitrate / header.sampleRate + padding;
+	}
+	header.sideInfoOffset = 4 + (header.mpeg1 ? (mono ? 17 : 32) : (mono ? 9 : 17));
+	return true;
+}
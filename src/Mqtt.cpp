@@ -253,6 +253,11 @@ bool Mqtt_Reconnect() {
 			// Next/previous/stop/play-track-subscription
 			Mqtt_PubSubClient.subscribe(topicTrackControlCmnd);
 
+			// Edits of the current playlist
+			Mqtt_PubSubClient.subscribe(topicPlayNextCmnd);
+			Mqtt_PubSubClient.subscribe(topicAppendTrackCmnd);
+			Mqtt_PubSubClient.subscribe(topicRemoveTrackCmnd);
+
 			// Lock controls
 			Mqtt_PubSubClient.subscribe(topicLockControlsCmnd);
 
@@ -263,13 +268,15 @@ bool Mqtt_Reconnect() {
 			Mqtt_PubSubClient.subscribe(topicLedBrightnessCmnd);
 
 			// Publish current state
+			PlaybackState playbackState;
+			AudioPlayer_GetState(playbackState);
 			publishMqtt(topicState, "Online", false);
-			publishMqtt(topicTrackState, gPlayProperties.title, false);
+			publishMqtt(topicTrackState, playbackState.title, false);
 			publishMqtt(topicCoverChangedState, "", false);
 			publishMqtt(topicLoudnessState, AudioPlayer_GetCurrentVolume(), false);
 			publishMqtt(topicSleepTimerState, System_GetSleepTimerTimeStamp(), false);
 			publishMqtt(topicLockControlsState, System_AreControlsLocked(), false);
-			publishMqtt(topicPlaymodeState, gPlayProperties.playMode, false);
+			publishMqtt(topicPlaymodeState, playbackState.playMode, false);
 			publishMqtt(topicLedBrightnessState, Led_GetBrightness(), false);
 			publishMqtt(topicCurrentIPv4IP, Wlan_GetIpAddress().c_str(), false);
 			publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
@@ -341,7 +348,9 @@ void Mqtt_ClientCallback(const char *topic, const byte *payload, uint32_t length
 	}
 	// Modify sleep-timer?
 	else if (strcmp_P(topic, topicSleepTimerCmnd) == 0) {
-		if (gPlayProperties.playMode == NO_PLAYLIST) { // Don't allow sleep-modications if no playlist is active
+		PlaybackState playbackState;
+		AudioPlayer_GetState(playbackState);
+		if (playbackState.playMode == NO_PLAYLIST) { // Don't allow sleep-modications if no playlist is active
 			Log_Println(modificatorNotallowedWhenIdle, LOGLEVEL_INFO);
 			publishMqtt(topicSleepState, 0, false);
 			System_IndicateError();
@@ -362,13 +371,13 @@ void Mqtt_ClientCallback(const char *topic, const byte *payload, uint32_t length
 			System_IndicateOk();
 			return;
 		} else if (receivedString == "EO5T") {
-			if (gPlayProperties.playMode == NO_PLAYLIST || !gPlayProperties.playlist) {
+			if (playbackState.numberOfTracks == 0) {
 				Log_Println(modificatorNotallowedWhenIdle, LOGLEVEL_NOTICE);
 				System_IndicateError();
 				return;
 			}
-			if ((gPlayProperties.playlist->size() - 1) >= (gPlayProperties.currentTrackNumber + 5)) {
-				gPlayProperties.playUntilTrackNumber = gPlayProperties.currentTrackNumber + 5;
+			if ((playbackState.numberOfTracks - 1) >= (playbackState.currentTrackNumber + 5)) {
+				gPlayProperties.playUntilTrackNumber = playbackState.currentTrackNumber + 5;
 			} else {
 				gPlayProperties.sleepAfterPlaylist = true; // If +5 tracks is > than active playlist, take end of current playlist
 			}
@@ -405,6 +414,19 @@ void Mqtt_ClientCallback(const char *topic, const byte *payload, uint32_t length
 		uint8_t controlCommand = toNumber<uint8_t>(receivedString);
 		AudioPlayer_TrackControlToQueueSender(controlCommand);
 	}
+	// Edit current playlist (path of a file to play next / to append; number of the track to remove)
+	else if (strcmp_P(topic, topicPlayNextCmnd) == 0 || strcmp_P(topic, topicAppendTrackCmnd) == 0) {
+		const std::string path {receivedString};
+		const PlaylistEditAction action = (strcmp_P(topic, topicPlayNextCmnd) == 0) ? PlaylistEditAction::InsertNext : PlaylistEditAction::Append;
+		if (!AudioPlayer_PlaylistEditToQueueSender(action, path.c_str())) {
+			System_IndicateError();
+		}
+	} else if (strcmp_P(topic, topicRemoveTrackCmnd) == 0) {
+		const uint16_t trackNumber = toNumber<uint16_t>(receivedString);
+		if (trackNumber == 0 || !AudioPlayer_PlaylistEditToQueueSender(PlaylistEditAction::Remove, nullptr, trackNumber - 1)) {
+			System_IndicateError();
+		}
+	}
 
 	// Check if controls should be locked
 	else if (strcmp_P(topic, topicLockControlsCmnd) == 0) {
@@ -425,50 +447,50 @@ void Mqtt_ClientCallback(const char *topic, const byte *payload, uint32_t length
 	else if (strcmp_P(topic, topicRepeatModeCmnd) == 0) {
 		uint8_t repeatMode = toNumber<uint8_t>(receivedString);
 		Log_Printf(LOGLEVEL_NOTICE, "Repeat: %d", repeatMode);
-		if (gPlayProperties.playMode != NO_PLAYLIST) {
-			if (gPlayProperties.playMode == NO_PLAYLIST) {
-				publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
-				Log_Println(noPlaylistNotAllowedMqtt, LOGLEVEL_ERROR);
-				System_IndicateError();
-			} else {
-				switch (repeatMode) {
-					case NO_REPEAT:
-						gPlayProperties.repeatCurrentTrack = false;
-						gPlayProperties.repeatPlaylist = false;
-						publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
-						Log_Println(modeRepeatNone, LOGLEVEL_INFO);
-						System_IndicateOk();
-						break;
-
-					case TRACK:
-						gPlayProperties.repeatCurrentTrack = true;
-						gPlayProperties.repeatPlaylist = false;
-						publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
-						Log_Println(modeRepeatTrack, LOGLEVEL_INFO);
-						System_IndicateOk();
-						break;
-
-					case PLAYLIST:
-						gPlayProperties.repeatCurrentTrack = false;
-						gPlayProperties.repeatPlaylist = true;
-						publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
-						Log_Println(modeRepeatPlaylist, LOGLEVEL_INFO);
-						System_IndicateOk();
-						break;
-
-					case TRACK_N_PLAYLIST:
-						gPlayProperties.repeatCurrentTrack = true;
-						gPlayProperties.repeatPlaylist = true;
-						publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
-						Log_Println(modeRepeatTracknPlaylist, LOGLEVEL_INFO);
-						System_IndicateOk();
-						break;
-
-					default:
-						System_IndicateError();
-						publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
-						break;
-				}
+		PlaybackState playbackState;
+		AudioPlayer_GetState(playbackState);
+		if (playbackState.playMode == NO_PLAYLIST) {
+			publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
+			Log_Println(noPlaylistNotAllowedMqtt, LOGLEVEL_ERROR);
+			System_IndicateError();
+		} else {
+			switch (repeatMode) {
+				case NO_REPEAT:
+					gPlayProperties.repeatCurrentTrack = false;
+					gPlayProperties.repeatPlaylist = false;
+					publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
+					Log_Println(modeRepeatNone, LOGLEVEL_INFO);
+					System_IndicateOk();
+					break;
+
+				case TRACK:
+					gPlayProperties.repeatCurrentTrack = true;
+					gPlayProperties.repeatPlaylist = false;
+					publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
+					Log_Println(modeRepeatTrack, LOGLEVEL_INFO);
+					System_IndicateOk();
+					break;
+
+				case PLAYLIST:
+					gPlayProperties.repeatCurrentTrack = false;
+					gPlayProperties.repeatPlaylist = true;
+					publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
+					Log_Println(modeRepeatPlaylist, LOGLEVEL_INFO);
+					System_IndicateOk();
+					break;
+
+				case TRACK_N_PLAYLIST:
+					gPlayProperties.repeatCurrentTrack = true;
+					gPlayProperties.repeatPlaylist = true;
+					publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
+					Log_Println(modeRepeatTracknPlaylist, LOGLEVEL_INFO);
+					System_IndicateOk();
+					break;
+
+				default:
+					System_IndicateError();
+					publishMqtt(topicRepeatModeState, AudioPlayer_GetRepeatMode(), false);
+					break;
 			}
 		}
 	}
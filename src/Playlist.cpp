@@ -0,0 +1,49 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Playlist.h"
+
+#include "Log.h"
+#include "Trace.h"
+#include "strnatcmp.h"
+
+#include <algorithm>
+
+// Helper to sort playlist - standard string comparison
+static bool Playlist_SortHelper_strcmp(const char *a, const char *b) {
+	return strcmp(a, b) < 0;
+}
+
+// Helper to sort playlist - natural case-sensitive
+static bool Playlist_SortHelper_strnatcmp(const char *a, const char *b) {
+	return strnatcmp(a, b) < 0;
+}
+
+// Helper to sort playlist - natural case-insensitive
+static bool Playlist_SortHelper_strnatcasecmp(const char *a, const char *b) {
+	return strnatcasecmp(a, b) < 0;
+}
+
+// The comparators are handed to std::sort as lambdas (instead of a std::function) so they can be inlined into the sort loop
+void Playlist_Sort(Playlist *playlist, playlistSortMode mode) {
+	TRACE_SCOPE(PlaylistSort);
+	if (playlist->isVirtual()) {
+		return;
+	}
+	std::vector<char *> &entries = playlist->entries();
+	switch (mode) {
+		case playlistSortMode::STRCMP:
+			Log_Println("Sorting files using standard string compare", LOGLEVEL_INFO);
+			std::sort(entries.begin(), entries.end(), [](const char *a, const char *b) { return Playlist_SortHelper_strcmp(a, b); });
+			break;
+		case playlistSortMode::STRNATCMP:
+			Log_Println("Sorting files using case-sensitive natural sorting", LOGLEVEL_INFO);
+			std::sort(entries.begin(), entries.end(), [](const char *a, const char *b) { return Playlist_SortHelper_strnatcmp(a, b); });
+			break;
+		case playlistSortMode::STRNATCASECMP:
+		default:
+			Log_Println("Sorting files using case-insensitive natural sorting", LOGLEVEL_INFO);
+			std::sort(entries.begin(), entries.end(), [](const char *a, const char *b) { return Playlist_SortHelper_strnatcasecmp(a, b); });
+			break;
+	}
+}
@@ -1,18 +1,226 @@
-#pragma once
-
-#include <stdlib.h>
-#include <vector>
-
-using Playlist = std::vector<char *>;
-
-// Release previously allocated memory
-inline void freePlaylist(Playlist *(&playlist)) {
-	if (playlist == nullptr) {
-		return;
-	}
-	for (auto e : *playlist) {
-		free(e);
-	}
-	delete playlist;
-	playlist = nullptr;
-}
+#pragma once
+
+#include "IndexPermutation.h"
+#include <WString.h>
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <stdlib.h>
+#include <vector>
+
+enum class playlistSortMode : uint8_t {
+	STRCMP = 1,
+	STRNATCMP = 2,
+	STRNATCASECMP = 3,
+};
+
+// Entries of a virtual playlist aren't kept in RAM but resolved on demand (e.g. from an index-file on SD).
+// at() returns a copy of the entry, made while the source is locked: the webserver reads entries concurrently
+// to the audio-task, so implementations have to be thread-safe.
+class PlaylistSource {
+public:
+	virtual ~PlaylistSource() = default;
+	virtual size_t size() const = 0;
+	virtual String at(size_t index) = 0;
+};
+
+// Edits of the playback-order (play next, append, remove) as a piece-table over the original order: every piece
+// is a run of consecutive original positions, added entries are numbered after the original ones. It needs RAM
+// per edit only, so virtual playlists of thousands of entries can be edited as well.
+class PlaylistEdits {
+public:
+	PlaylistEdits() = default; // unedited
+
+	explicit PlaylistEdits(size_t originalSize)
+		: originalSize_(originalSize)
+		, size_(originalSize) { }
+
+	size_t size() const {
+		return size_;
+	}
+	bool isActive() const {
+		return active_;
+	}
+	// Original position of an edited position; added entries result in originalSize + number of the added entry
+	size_t operator()(size_t index) const {
+		if (!active_) {
+			return index;
+		}
+		for (const Piece &piece : pieces_) {
+			if (index < piece.count) {
+				return piece.first + index;
+			}
+			index -= piece.count;
+		}
+		return SIZE_MAX;
+	}
+
+	void insert(size_t index, size_t addedNumber) {
+		activate();
+		const size_t piece = split(index);
+		pieces_.insert(pieces_.begin() + piece, Piece {originalSize_ + addedNumber, 1});
+		size_++;
+	}
+	void erase(size_t index) {
+		activate();
+		const size_t piece = split(index);
+		if (piece >= pieces_.size()) {
+			return;
+		}
+		if (--pieces_[piece].count == 0) {
+			pieces_.erase(pieces_.begin() + piece);
+		} else {
+			pieces_[piece].first++;
+		}
+		size_--;
+	}
+
+private:
+	struct Piece {
+		size_t first;
+		size_t count;
+	};
+
+	void activate() {
+		if (!active_) {
+			active_ = true;
+			if (originalSize_ > 0) {
+				pieces_.push_back(Piece {0, originalSize_});
+			}
+		}
+	}
+
+	// Makes index the beginning of a piece and returns that piece
+	size_t split(size_t index) {
+		for (size_t i = 0; i < pieces_.size(); i++) {
+			Piece &piece = pieces_[i];
+			if (index == 0) {
+				return i;
+			}
+			if (index < piece.count) {
+				pieces_.insert(pieces_.begin() + i + 1, Piece {piece.first + index, piece.count - index});
+				pieces_[i].count = index;
+				return i + 1;
+			}
+			index -= piece.count;
+		}
+		return pieces_.size();
+	}
+
+	size_t originalSize_ = 0;
+	size_t size_ = 0;
+	bool active_ = false;
+	std::vector<Piece> pieces_;
+};
+
+class Playlist {
+public:
+	Playlist() = default;
+	explicit Playlist(std::shared_ptr<PlaylistSource> source)
+		: source_(source) { }
+	~Playlist() {
+		for (auto e : entries_) {
+			free(e);
+		}
+		for (auto e : added_) {
+			free(e);
+		}
+	}
+	Playlist(const Playlist &) = delete;
+	Playlist &operator=(const Playlist &) = delete;
+
+	size_t size() const {
+		return edits_.isActive() ? edits_.size() : originalSize();
+	}
+	// index is the position in playback-order (which differs from the stored order when shuffled or edited)
+	String at(size_t index) const {
+		const size_t original = edits_(index);
+		if (original >= originalSize()) {
+			return added_.at(original - originalSize());
+		}
+		const size_t position = order_(original);
+		return source_ ? source_->at(position) : String(entries_.at(position));
+	}
+	// Shuffling doesn't move entries, it only sets the permutation between playback- and stored order
+	void shuffle(uint32_t seed) {
+		order_ = IndexPermutation(originalSize(), seed);
+	}
+	const IndexPermutation &order() const {
+		return order_;
+	}
+	bool isVirtual() const {
+		return source_ != nullptr;
+	}
+	std::shared_ptr<PlaylistSource> source() const {
+		return source_;
+	}
+
+	// Entries of a materialised playlist in stored order (allocated with malloc, owned by the playlist)
+	std::vector<char *> &entries() {
+		return entries_;
+	}
+	void push_back(char *entry) {
+		entries_.push_back(entry);
+	}
+
+	// Edits in playback-order while the playlist is played (entry is allocated with malloc, owned by the playlist)
+	void insert(size_t index, char *entry) {
+		if (!edits_.isActive()) {
+			edits_ = PlaylistEdits(originalSize());
+		}
+		edits_.insert(index, added_.size());
+		added_.push_back(entry);
+	}
+	void erase(size_t index) {
+		if (!edits_.isActive()) {
+			edits_ = PlaylistEdits(originalSize());
+		}
+		edits_.erase(index);
+	}
+	const PlaylistEdits &edits() const {
+		return edits_;
+	}
+	const std::vector<char *> &added() const {
+		return added_;
+	}
+
+	// A card restarts with the unedited playlist, so positions to resume at are stored unedited: none for added entries
+	std::optional<size_t> uneditedIndex(size_t index) const {
+		const size_t original = edits_(index);
+		if (original >= originalSize()) {
+			return std::nullopt;
+		}
+		return original;
+	}
+	// First position from index on that isn't an added entry (size() if there's none)
+	size_t nextUnedited(size_t index) const {
+		while (index < size() && !uneditedIndex(index)) {
+			index++;
+		}
+		return std::min(index, size());
+	}
+	size_t uneditedSize() const {
+		return originalSize();
+	}
+
+private:
+	size_t originalSize() const {
+		return source_ ? source_->size() : entries_.size();
+	}
+
+	std::vector<char *> entries_;
+	std::shared_ptr<PlaylistSource> source_;
+	IndexPermutation order_;
+	PlaylistEdits edits_;
+	std::vector<char *> added_; // entries inserted by edits (removed ones are kept until the playlist is freed)
+};
+
+
+// Sorts the entries of a materialised playlist (virtual playlists are sorted per directory while being generated)
+void Playlist_Sort(Playlist *playlist, playlistSortMode mode);
+
+// Release previously allocated memory
+inline void freePlaylist(Playlist *(&playlist)) {
+	delete playlist;
+	playlist = nullptr;
+}
@@ -3,6 +3,7 @@
 
 #include "Port.h"
 
+#include "Button.h"
 #include "Log.h"
 
 #include <Wire.h>
@@ -28,7 +29,8 @@ extern TwoWire i2cBusTwo;
 
 uint8_t Port_ExpanderPortsInputChannelStatus[2];
 static uint8_t Port_ExpanderPortsOutputChannelStatus[2]; // Stores current configuration of output-channels locally
-void Port_ExpanderHandler(void);
+static uint32_t Port_ExpanderReads = 0; // I2C-reads of the input-registers
+bool Port_ExpanderHandler(void);
 uint8_t Port_ChannelToBit(const uint8_t _channel);
 void Port_WriteInitMaskForOutputChannels(void);
 void Port_Test(void);
@@ -60,9 +62,20 @@ void Port_Init(void) {
 #endif
 }
 
-void Port_Cyclic(void) {
+// Returns true if the port-expander has to be read again soon (inputs not stable yet or no interrupt-pin)
+bool Port_Cyclic(void) {
 #ifdef PORT_EXPANDER_ENABLE
-	Port_ExpanderHandler();
+	return Port_ExpanderHandler();
+#else
+	return false;
+#endif
+}
+
+uint32_t Port_GetExpanderReads(void) {
+#ifdef PORT_EXPANDER_ENABLE
+	return Port_ExpanderReads;
+#else
+	return 0;
 #endif
 }
 
@@ -356,8 +369,9 @@ void Port_MakeSomeChannelsOutputForShutdown(void) {
 }
 
 // Reads input-registers from port-expander and writes output into global cache-array
+// Returns true if it has to be called again soon
 // Datasheet: https://www.nxp.com/docs/en/data-sheet/PCA9555.pdf
-void Port_ExpanderHandler(void) {
+bool Port_ExpanderHandler(void) {
 	static uint32_t inputChanged = 0; // Used to debounce once in case of register-change
 	static uint32_t inputPrev = 0;
 
@@ -367,9 +381,10 @@ void Port_ExpanderHandler(void) {
 	if (Port_AllowReadFromPortExpander) {
 		Port_AllowReadFromPortExpander = false;
 	} else if (!inputChanged) {
-		return;
+		return false;
 	}
 	#endif
+	Port_ExpanderReads++;
 
 	#ifdef PORT_EXPANDER_TYPE_PCA9555
 	i2cBusTwo.beginTransmission(expanderI2cAddress);
@@ -383,7 +398,7 @@ void Port_ExpanderHandler(void) {
 		Port_AllowReadFromPortExpander = true;
 		#endif
 
-		return;
+		return true;
 	}
 	i2cBusTwo.requestFrom(expanderI2cAddress, 2u); // ...and read its bytes
 	#endif
@@ -424,6 +439,9 @@ void Port_ExpanderHandler(void) {
 	if (!inputChanged) {
 		attachInterrupt(digitalPinToInterrupt(PE_INTERRUPT_PIN), PORT_ExpanderISR, ONLOW);
 	}
+	return inputChanged != 0;
+	#else
+	return true; // no interrupt: poll
 	#endif
 }
 
@@ -466,6 +484,7 @@ void IRAM_ATTR PORT_ExpanderISR(void) {
 	// until the interrupt is handled we don't need any more ISR calls
 	if (Port_AllowReadFromPortExpander) {
 		detachInterrupt(digitalPinToInterrupt(PE_INTERRUPT_PIN));
+		Button_WakeFromISR();
 	}
 }
 	#endif
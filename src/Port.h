@@ -7,7 +7,8 @@
 #endif
 
 void Port_Init(void);
-void Port_Cyclic(void);
+bool Port_Cyclic(void);
+uint32_t Port_GetExpanderReads(void);
 bool Port_Read(const uint8_t _channel);
 void Port_Write(const uint8_t _channel, const bool _newState, const bool _initGpio);
 void Port_Exit(void);
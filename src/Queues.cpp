@@ -11,6 +11,7 @@ QueueHandle_t gTrackQueue;
 QueueHandle_t gTrackControlQueue;
 QueueHandle_t gRfidCardQueue;
 QueueHandle_t gEqualizerQueue;
+QueueHandle_t gPlaylistEditQueue;
 
 void Queues_Init(void) {
 	// Create queues
@@ -34,8 +35,13 @@ void Queues_Init(void) {
 		Log_Println(unableToCreatePlayQ, LOGLEVEL_ERROR);
 	}
 
-	gEqualizerQueue = xQueueCreate(1, sizeof(int8_t[3]));
+	gEqualizerQueue = xQueueCreate(1, sizeof(EqualizerPresets));
 	if (gEqualizerQueue == NULL) {
 		Log_Println(unableToCreateEqualizerQ, LOGLEVEL_ERROR);
 	}
+
+	gPlaylistEditQueue = xQueueCreate(4, sizeof(PlaylistEditMessage)); // a few edits may be sent in a row
+	if (gPlaylistEditQueue == NULL) {
+		Log_Println(unableToCreatePlaylistEditQ, LOGLEVEL_ERROR);
+	}
 }
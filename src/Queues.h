@@ -5,5 +5,6 @@ extern QueueHandle_t gTrackQueue;
 extern QueueHandle_t gTrackControlQueue;
 extern QueueHandle_t gRfidCardQueue;
 extern QueueHandle_t gEqualizerQueue;
+extern QueueHandle_t gPlaylistEditQueue;
 
 void Queues_Init(void);
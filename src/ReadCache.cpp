@@ -0,0 +1,328 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "ReadCache.h"
+
+#include "Log.h"
+#include "SdCard.h"
+
+#include <FSImpl.h>
+#include <algorithm>
+
+namespace {
+constexpr uint32_t ReadCache_InvalidBlock = UINT32_MAX;
+
+struct ReadCacheBlock {
+	uint32_t index = ReadCache_InvalidBlock;
+	uint32_t length = 0;
+	uint32_t lastUse = 0;
+};
+
+class ReadCacheFileImpl;
+
+uint8_t *ReadCache_Pool = nullptr;
+ReadCacheBlock ReadCache_Blocks[READ_CACHE_BLOCKS];
+ReadCacheFileImpl *ReadCache_Owner = nullptr; // file the blocks belong to
+uint32_t ReadCache_UseCounter = 0;
+ReadCacheStats ReadCache_Stats;
+
+void ReadCache_InvalidateBlocks(void) {
+	for (ReadCacheBlock &block : ReadCache_Blocks) {
+		block = ReadCacheBlock {};
+	}
+}
+
+// Wraps a File of the underlying filesystem. Reads of the pool-owner are served from
+// block-aligned cache-blocks as soon as the access-pattern is sequential.
+class ReadCacheFileImpl : public fs::FileImpl {
+public:
+	ReadCacheFileImpl(File file, bool cached)
+		: file_(file) {
+		size_ = file_ ? file_.size() : 0;
+		if (cached && file_ && ReadCache_Pool != nullptr) {
+			ReadCache_Owner = this;
+			ReadCache_InvalidateBlocks();
+		}
+	}
+
+	~ReadCacheFileImpl() override {
+		releasePool();
+	}
+
+	size_t write(const uint8_t *buf, size_t size) override {
+		releasePool();
+		if (!file_.seek(position_)) {
+			return 0;
+		}
+		const size_t written = file_.write(buf, size);
+		position_ += written;
+		filePosition_ = position_;
+		size_ = file_.size();
+		return written;
+	}
+
+	size_t read(uint8_t *buf, size_t size) override {
+		if (!ownsPool()) {
+			return readDirect(buf, size, false);
+		}
+		ReadCache_Stats.bytesRequested += size;
+
+		// Open and continuing reads count as sequential; a seek has to be followed by a continuing read first
+		const bool sequential = position_ == expectedPosition_;
+		bool fromCard = false;
+		size_t done = 0;
+		while (done < size && position_ < size_) {
+			const uint32_t blockIndex = position_ / READ_CACHE_BLOCK_SIZE;
+			const uint32_t blockOffset = position_ % READ_CACHE_BLOCK_SIZE;
+			ReadCacheBlock *block = findBlock(blockIndex);
+			if (block == nullptr) {
+				if (!sequential) {
+					ReadCache_Stats.bypassReads++;
+					done += readDirect(buf + done, size - done, true);
+					fromCard = true;
+					break;
+				}
+				block = loadBlock(blockIndex);
+				fromCard = true;
+				if (block == nullptr) {
+					break;
+				}
+			}
+			if (blockOffset >= block->length) {
+				break;
+			}
+			const size_t bytesThisRound = std::min<size_t>(size - done, block->length - blockOffset);
+			memcpy(buf + done, blockData(*block) + blockOffset, bytesThisRound);
+			block->lastUse = ++ReadCache_UseCounter;
+			done += bytesThisRound;
+			position_ += bytesThisRound;
+		}
+
+		if (fromCard) {
+			ReadCache_Stats.misses++;
+		} else if (done > 0) {
+			ReadCache_Stats.hits++;
+		}
+		expectedPosition_ = position_;
+		return done;
+	}
+
+	void flush() override {
+		file_.flush();
+	}
+
+	bool seek(uint32_t pos, SeekMode mode) override {
+		int64_t target;
+		switch (mode) {
+			case SeekCur: // offset is signed (like fseek() gets it from the vfs-implementation)
+				target = static_cast<int64_t>(position_) + static_cast<int32_t>(pos);
+				break;
+			case SeekEnd:
+				target = static_cast<int64_t>(size_) + static_cast<int32_t>(pos);
+				break;
+			case SeekSet:
+			default:
+				target = pos;
+				break;
+		}
+		if (target < 0 || target > static_cast<int64_t>(size_)) {
+			return false;
+		}
+		position_ = static_cast<uint32_t>(target); // the underlying file is positioned lazily
+		return true;
+	}
+
+	size_t position() const override {
+		return position_;
+	}
+
+	size_t size() const override {
+		return size_;
+	}
+
+	bool setBufferSize(size_t size) override {
+		return file_.setBufferSize(size);
+	}
+
+	void close() override {
+		releasePool();
+		file_.close();
+	}
+
+	time_t getLastWrite() override {
+		return file_.getLastWrite();
+	}
+
+	const char *path() const override {
+		return file_.path();
+	}
+
+	const char *name() const override {
+		return file_.name();
+	}
+
+	boolean isDirectory(void) override {
+		return file_.isDirectory();
+	}
+
+	fs::FileImplPtr openNextFile(const char *mode) override {
+		return std::make_shared<ReadCacheFileImpl>(file_.openNextFile(mode), false);
+	}
+
+	boolean seekDir(long position) override {
+		return file_.seekDir(position);
+	}
+
+	String getNextFileName(void) override {
+		return file_.getNextFileName();
+	}
+
+	String getNextFileName(bool *isDir) override {
+		return file_.getNextFileName(isDir);
+	}
+
+	void rewindDirectory(void) override {
+		file_.rewindDirectory();
+	}
+
+	operator bool() override {
+		return static_cast<bool>(file_);
+	}
+
+private:
+	bool ownsPool() const {
+		return ReadCache_Owner == this;
+	}
+
+	void releasePool() {
+		if (ownsPool()) {
+			ReadCache_Owner = nullptr;
+			ReadCache_InvalidateBlocks();
+		}
+	}
+
+	static uint8_t *blockData(const ReadCacheBlock &block) {
+		return ReadCache_Pool + (&block - ReadCache_Blocks) * READ_CACHE_BLOCK_SIZE;
+	}
+
+	static ReadCacheBlock *findBlock(uint32_t blockIndex) {
+		for (ReadCacheBlock &block : ReadCache_Blocks) {
+			if (block.index == blockIndex) {
+				return &block;
+			}
+		}
+		return nullptr;
+	}
+
+	// One aligned read of a whole block into the least recently used slot
+	ReadCacheBlock *loadBlock(uint32_t blockIndex) {
+		ReadCacheBlock *victim = &ReadCache_Blocks[0];
+		for (ReadCacheBlock &block : ReadCache_Blocks) {
+			if (block.index == ReadCache_InvalidBlock) {
+				victim = &block;
+				break;
+			}
+			if (block.lastUse < victim->lastUse) {
+				victim = &block;
+			}
+		}
+
+		const uint32_t blockStart = blockIndex * READ_CACHE_BLOCK_SIZE;
+		*victim = ReadCacheBlock {};
+		if (filePosition_ != blockStart && !file_.seek(blockStart)) {
+			return nullptr;
+		}
+		const size_t bytesRead = file_.read(blockData(*victim), std::min<uint32_t>(READ_CACHE_BLOCK_SIZE, size_ - blockStart));
+		filePosition_ = blockStart + bytesRead;
+		ReadCache_Stats.bytesFromCard += bytesRead;
+		ReadCache_Stats.blockLoads++;
+		if (bytesRead == 0) {
+			return nullptr;
+		}
+		victim->index = blockIndex;
+		victim->length = bytesRead;
+		return victim;
+	}
+
+	size_t readDirect(uint8_t *buf, size_t size, bool countStats) {
+		if (filePosition_ != position_ && !file_.seek(position_)) {
+			return 0;
+		}
+		const size_t bytesRead = file_.read(buf, size);
+		position_ += bytesRead;
+		filePosition_ = position_;
+		if (countStats) {
+			ReadCache_Stats.bytesFromCard += bytesRead;
+		}
+		return bytesRead;
+	}
+
+	File file_;
+	uint32_t size_ = 0;
+	uint32_t position_ = 0; // position seen by the caller
+	uint32_t filePosition_ = 0; // position of the underlying file
+	uint32_t expectedPosition_ = 0; // where a sequential read would continue
+};
+
+class ReadCacheFSImpl : public fs::FSImpl {
+public:
+	explicit ReadCacheFSImpl(fs::FS &base)
+		: base_(base) { }
+
+	fs::FileImplPtr open(const char *path, const char *mode, const bool create) override {
+		File file = base_.open(path, mode, create);
+		if (!file) {
+			return fs::FileImplPtr();
+		}
+		const bool cached = strcmp(mode, FILE_READ) == 0 && !file.isDirectory();
+		return std::make_shared<ReadCacheFileImpl>(file, cached);
+	}
+
+	bool exists(const char *path) override {
+		return base_.exists(path);
+	}
+
+	bool rename(const char *pathFrom, const char *pathTo) override {
+		return base_.rename(pathFrom, pathTo);
+	}
+
+	bool remove(const char *path) override {
+		return base_.remove(path);
+	}
+
+	bool mkdir(const char *path) override {
+		return base_.mkdir(path);
+	}
+
+	bool rmdir(const char *path) override {
+		return base_.rmdir(path);
+	}
+
+private:
+	fs::FS &base_;
+};
+} // namespace
+
+// Only to be used by the audio-task (the pool is not locked)
+fs::FS gFSystemAudio = fs::FS(std::make_shared<ReadCacheFSImpl>(gFSystem));
+
+void ReadCache_Init(void) {
+	if (!psramFound()) {
+		Log_Println("Read-cache: no PSRAM, audio-files are read uncached", LOGLEVEL_DEBUG);
+		return;
+	}
+	ReadCache_Pool = static_cast<uint8_t *>(ps_malloc(READ_CACHE_BLOCK_SIZE * READ_CACHE_BLOCKS));
+	if (ReadCache_Pool == nullptr) {
+		Log_Println("Read-cache: unable to allocate blocks", LOGLEVEL_ERROR);
+		return;
+	}
+	Log_Printf(LOGLEVEL_DEBUG, "Read-cache: %u blocks of %lu bytes", READ_CACHE_BLOCKS, READ_CACHE_BLOCK_SIZE);
+}
+
+bool ReadCache_IsEnabled(void) {
+	return ReadCache_Pool != nullptr;
+}
+
+void ReadCache_GetStats(ReadCacheStats &stats) {
+	stats = ReadCache_Stats;
+}
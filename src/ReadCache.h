@@ -0,0 +1,22 @@
+#pragma once
+#include <FS.h>
+
+// Read-ahead block cache for the decoder: files opened (read-only) via gFSystemAudio are read
+// from gFSystem in large, block-aligned chunks into a PSRAM-pool. Only the most recently opened
+// file owns the pool, so cover-art or explorer reads (which use gFSystem directly) never evict
+// the decoder's blocks. Without PSRAM gFSystemAudio just passes everything through.
+
+typedef struct {
+	uint32_t hits = 0; // reads completely served from cache
+	uint32_t misses = 0; // reads that needed at least one block from card
+	uint32_t bypassReads = 0; // non-sequential reads that were passed through without caching
+	uint32_t blockLoads = 0;
+	uint32_t bytesRequested = 0;
+	uint32_t bytesFromCard = 0;
+} ReadCacheStats;
+
+extern fs::FS gFSystemAudio;
+
+void ReadCache_Init(void);
+bool ReadCache_IsEnabled(void);
+void ReadCache_GetStats(ReadCacheStats &stats);
@@ -3,11 +3,13 @@
 
 #include "AudioPlayer.h"
 #include "HallEffectSensor.h"
+#include "Latency.h"
 #include "Log.h"
 #include "MemX.h"
 #include "Queues.h"
 #include "Rfid.h"
 #include "System.h"
+#include "Trace.h"
 
 #include <esp_task_wdt.h>
 
@@ -107,7 +109,9 @@ void Rfid_Task(void *parameter) {
 
 			Rfid_LastRfidCheckTimestamp = millis();
 			byte cardId[cardIdSize];
+			TRACE_BEGIN(RfidPoll);
 			const bool observedCard = Rfid_ReadObservedCard(cardId, presenceTracker);
+			TRACE_END(RfidPoll);
 
 			if (observedCard) {
 	#ifdef HALLEFFECT_SENSOR_ENABLE
@@ -121,7 +125,9 @@ void Rfid_Task(void *parameter) {
 			}
 			if (RfidPresenceTracker_ShouldPause(presenceTracker, Rfid_LastRfidCheckTimestamp)) {
 				Log_Println(rfidTagRemoved, LOGLEVEL_NOTICE);
-				if (!gPlayProperties.pausePlay && System_GetOperationMode() != OPMODE_BLUETOOTH_SINK && gPlayProperties.playMode != BUSY && gPlayProperties.playMode != NO_PLAYLIST) {
+				PlaybackState playbackState;
+				AudioPlayer_GetState(playbackState);
+				if (!playbackState.pausePlay && System_GetOperationMode() != OPMODE_BLUETOOTH_SINK && playbackState.playMode != BUSY && playbackState.playMode != NO_PLAYLIST) {
 					AudioPlayer_TrackControlToQueueSender(PAUSEPLAY);
 				}
 			}
@@ -147,16 +153,20 @@ void Rfid_Task(void *parameter) {
 			Log_Printf(LOGLEVEL_NOTICE, rfidTagDetected, hexString);
 
 	#ifdef PAUSE_WHEN_RFID_REMOVED
+			PlaybackState playbackState;
+			AudioPlayer_GetState(playbackState);
 		#ifdef ACCEPT_SAME_RFID_AFTER_TRACK_END
-			if (!sameCardReapplied || gPlayProperties.trackFinished || gPlayProperties.playlistFinished) {
+			if (!sameCardReapplied || playbackState.trackFinished || playbackState.playlistFinished) {
 		#else
 			if (!sameCardReapplied) {
 		#endif
+				Latency_StartSession();
 				xQueueSend(gRfidCardQueue, cardIdString, 0);
-			} else if (gPlayProperties.pausePlay && System_GetOperationMode() != OPMODE_BLUETOOTH_SINK) {
+			} else if (playbackState.pausePlay && System_GetOperationMode() != OPMODE_BLUETOOTH_SINK) {
 				AudioPlayer_TrackControlToQueueSender(PAUSEPLAY);
 			}
 	#else
+			Latency_StartSession();
 			xQueueSend(gRfidCardQueue, cardIdString, 0);
 	#endif
 
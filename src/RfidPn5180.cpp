@@ -3,12 +3,14 @@
 
 #include "AudioPlayer.h"
 #include "HallEffectSensor.h"
+#include "Latency.h"
 #include "Log.h"
 #include "MemX.h"
 #include "Port.h"
 #include "Queues.h"
 #include "Rfid.h"
 #include "System.h"
+#include "Trace.h"
 
 #include <Wire.h>
 #include <driver/gpio.h>
@@ -142,6 +144,7 @@ void Rfid_Task(void *parameter) {
 	#endif
 		bool cardReceived = false;
 
+		TRACE_BEGIN(RfidPoll);
 		if (RFID_PN5180_STATE_INIT == stateMachine) {
 			nfc14443.begin();
 			nfc14443.reset();
@@ -216,6 +219,7 @@ void Rfid_Task(void *parameter) {
 				}
 			}
 		}
+		TRACE_END(RfidPoll);
 
 		if (cardReceived) {
 			memcpy(cardId, uid, cardIdSize);
@@ -232,7 +236,9 @@ void Rfid_Task(void *parameter) {
 		}
 		if (RfidPresenceTracker_ShouldPause(presenceTracker, millis())) {
 			Log_Println(rfidTagRemoved, LOGLEVEL_NOTICE);
-			if (!gPlayProperties.pausePlay && System_GetOperationMode() != OPMODE_BLUETOOTH_SINK && gPlayProperties.playMode != BUSY && gPlayProperties.playMode != NO_PLAYLIST) {
+			PlaybackState playbackState;
+			AudioPlayer_GetState(playbackState);
+			if (!playbackState.pausePlay && System_GetOperationMode() != OPMODE_BLUETOOTH_SINK && playbackState.playMode != BUSY && playbackState.playMode != NO_PLAYLIST) {
 				AudioPlayer_TrackControlToQueueSender(PAUSEPLAY);
 			}
 		}
@@ -256,17 +262,21 @@ void Rfid_Task(void *parameter) {
 			Log_Printf(LOGLEVEL_NOTICE, "Card type: %s", lastDetectedWas14443 ? "ISO-14443" : "ISO-15693");
 
 	#ifdef PAUSE_WHEN_RFID_REMOVED
+			PlaybackState playbackState;
+			AudioPlayer_GetState(playbackState);
 		#ifdef ACCEPT_SAME_RFID_AFTER_TRACK_END
-			if (!sameCardReapplied || gPlayProperties.trackFinished || gPlayProperties.playlistFinished) {
+			if (!sameCardReapplied || playbackState.trackFinished || playbackState.playlistFinished) {
 		#else
 			if (!sameCardReapplied) {
 		#endif
+				Latency_StartSession();
 				xQueueSend(gRfidCardQueue, cardIdString, 0);
-			} else if (gPlayProperties.pausePlay && System_GetOperationMode() != OPMODE_BLUETOOTH_SINK) {
+			} else if (playbackState.pausePlay && System_GetOperationMode() != OPMODE_BLUETOOTH_SINK) {
 				AudioPlayer_TrackControlToQueueSender(PAUSEPLAY);
 				Log_Println(rfidTagReapplied, LOGLEVEL_NOTICE);
 			}
 	#else
+			Latency_StartSession();
 			xQueueSend(gRfidCardQueue, cardIdString, 0);
 	#endif
 
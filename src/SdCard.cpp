@@ -3,13 +3,16 @@
 
 #include "SdCard.h"
 
+#include "AudioPlayer.h"
 #include "Common.h"
 #include "Led.h"
 #include "Log.h"
 #include "MemX.h"
 #include "System.h"
+#include "Trace.h"
 
 #include <esp_random.h>
+#include <esp_task_wdt.h>
 #include <esp_timer.h>
 
 #ifdef SD_MMC_1BIT_MODE
@@ -19,6 +22,7 @@
 #include <algorithm>
 #include <cstdio>
 #include <cstring>
+#include <functional>
 
 #ifdef SD_MMC_1BIT_MODE
 fs::FS gFSystem = (fs::FS) SD_MMC;
@@ -113,8 +117,9 @@ bool benchmarkSetSdCardFrequency(uint32_t frequencyKHz, char *messageBuffer, siz
 bool benchmarkRunSingle(const SdCardBenchmarkConfig &config, uint32_t frequencyKHz, uint32_t progressBaseBytes, uint32_t progressTotalBytes, SdCardBenchmarkSweepEntry &entry) {
 	entry = SdCardBenchmarkSweepEntry {};
 	entry.frequencyKHz = frequencyKHz;
+	fs::FS &fileSystem = config.fileSystem ? *config.fileSystem : gFSystem;
 
-	if (gFSystem.exists(benchmarkFilePath) && !gFSystem.remove(benchmarkFilePath)) {
+	if (fileSystem.exists(benchmarkFilePath) && !fileSystem.remove(benchmarkFilePath)) {
 		benchmarkSetMessage(entry, "Failed to delete previous benchmark file.");
 		return false;
 	}
@@ -133,7 +138,7 @@ bool benchmarkRunSingle(const SdCardBenchmarkConfig &config, uint32_t frequencyK
 
 	bool cleanupOkay = true;
 	bool benchmarkOkay = false;
-	File benchmarkFile = gFSystem.open(benchmarkFilePath, FILE_WRITE);
+	File benchmarkFile = fileSystem.open(benchmarkFilePath, FILE_WRITE);
 	if (!benchmarkFile) {
 		benchmarkSetMessage(entry, "Failed to open benchmark file for writing.");
 		goto cleanup;
@@ -169,7 +174,7 @@ bool benchmarkRunSingle(const SdCardBenchmarkConfig &config, uint32_t frequencyK
 	}
 	benchmarkFile.close();
 
-	benchmarkFile = gFSystem.open(benchmarkFilePath, FILE_READ);
+	benchmarkFile = fileSystem.open(benchmarkFilePath, FILE_READ);
 	if (!benchmarkFile) {
 		benchmarkSetMessage(entry, "Failed to open benchmark file for reading.");
 		goto cleanup;
@@ -223,7 +228,7 @@ cleanup:
 	if (benchmarkFile) {
 		benchmarkFile.close();
 	}
-	if (gFSystem.exists(benchmarkFilePath) && !gFSystem.remove(benchmarkFilePath)) {
+	if (fileSystem.exists(benchmarkFilePath) && !fileSystem.remove(benchmarkFilePath)) {
 		cleanupOkay = false;
 		if (benchmarkOkay) {
 			entry.success = false;
@@ -234,6 +239,319 @@ cleanup:
 	free(readBuffer);
 	return benchmarkOkay && cleanupOkay && entry.success;
 }
+
+// Access-pattern phases: closer to what the player actually does than the large sequential transfers above
+constexpr char benchmarkPatternFilePath[] = "/.sdtest-pattern.bin";
+constexpr char benchmarkPatternDirPath[] = "/.sdtest";
+constexpr char benchmarkUploadFilePath[] = "/.sdtest-upload.bin";
+constexpr size_t benchmarkMaxLatencySamples = 2048; // percentiles are computed from the first n samples of a phase
+constexpr uint32_t benchmarkChunkReadBytes = 1024 * 1024; // bytes read per chunk-size
+constexpr uint32_t benchmarkDecoderChunkSize = 4096; // read-size used while a concurrent write is running
+constexpr size_t benchmarkUploadChunkSize = 4096;
+constexpr std::array<uint32_t, 4> benchmarkDefaultChunkSizes = {512, 2048, 4096, 16384};
+
+struct BenchmarkUploadState {
+	fs::FS *fileSystem;
+	volatile bool stop;
+	volatile bool finished;
+	volatile uint32_t writtenBytes;
+};
+
+void benchmarkComputeLatency(uint32_t *samples, size_t count, SdCardBenchmarkLatency &latency) {
+	latency = SdCardBenchmarkLatency {};
+	if (count == 0) {
+		return;
+	}
+	std::sort(samples, samples + count);
+	latency.p50Us = samples[(count - 1) / 2];
+	latency.p90Us = samples[((count - 1) * 90) / 100];
+	latency.p99Us = samples[((count - 1) * 99) / 100];
+	latency.maxUs = samples[count - 1];
+}
+
+uint32_t benchmarkElapsedUs(int64_t startUs) {
+	return static_cast<uint32_t>(std::max<int64_t>(0, esp_timer_get_time() - startUs));
+}
+
+// Simulates a web-upload: writes 4 KiB-chunks (paced by one tick) until stopped
+void benchmarkUploadTask(void *parameter) {
+	BenchmarkUploadState *state = static_cast<BenchmarkUploadState *>(parameter);
+	uint8_t *buffer = static_cast<uint8_t *>(malloc(benchmarkUploadChunkSize));
+	File uploadFile = state->fileSystem->open(benchmarkUploadFilePath, FILE_WRITE);
+	if (buffer && uploadFile) {
+		uint32_t randomState = benchmarkRandomSeed;
+		benchmarkFillBuffer(buffer, benchmarkUploadChunkSize, randomState);
+		while (!state->stop) {
+			const size_t bytesWritten = uploadFile.write(buffer, benchmarkUploadChunkSize);
+			if (bytesWritten != benchmarkUploadChunkSize) {
+				break;
+			}
+			state->writtenBytes = state->writtenBytes + bytesWritten;
+			vTaskDelay(1);
+		}
+	}
+	if (uploadFile) {
+		uploadFile.close();
+	}
+	state->fileSystem->remove(benchmarkUploadFilePath);
+	free(buffer);
+	state->finished = true;
+	vTaskDelete(NULL);
+}
+
+// Creates n empty files in a temporary directory and measures how long it takes to enumerate them
+bool benchmarkRunDirectoryEnumeration(fs::FS &fileSystem, uint16_t entryCount, uint32_t *samples, SdCardBenchmarkPatternResult &patterns) {
+	if (!fileSystem.exists(benchmarkPatternDirPath) && !fileSystem.mkdir(benchmarkPatternDirPath)) {
+		benchmarkSetMessage(patterns, "Failed to create directory for enumeration test.");
+		return false;
+	}
+
+	char path[32];
+	bool okay = true;
+	uint16_t createdEntries = 0;
+	const int64_t createStartUs = esp_timer_get_time();
+	for (; createdEntries < entryCount; createdEntries++) {
+		snprintf(path, sizeof(path), "%s/f%05u.bin", benchmarkPatternDirPath, createdEntries);
+		File entryFile = fileSystem.open(path, FILE_WRITE);
+		if (!entryFile) {
+			benchmarkSetMessage(patterns, "Failed to create files for enumeration test.");
+			okay = false;
+			break;
+		}
+		entryFile.close();
+	}
+	patterns.directoryCreateDurationMs = benchmarkDurationMs(esp_timer_get_time() - createStartUs);
+
+	if (okay) {
+		File directory = fileSystem.open(benchmarkPatternDirPath);
+		if (!directory) {
+			benchmarkSetMessage(patterns, "Failed to open directory for enumeration test.");
+			okay = false;
+		} else {
+			size_t sampleCount = 0;
+			uint16_t foundEntries = 0;
+			const int64_t enumerationStartUs = esp_timer_get_time();
+			while (true) {
+				bool isDir = false;
+				const int64_t entryStartUs = esp_timer_get_time();
+				const String name = directory.getNextFileName(&isDir);
+				const uint32_t entryUs = benchmarkElapsedUs(entryStartUs);
+				if (name.isEmpty()) {
+					break;
+				}
+				if (sampleCount < benchmarkMaxLatencySamples) {
+					samples[sampleCount++] = entryUs;
+				}
+				foundEntries++;
+			}
+			patterns.directoryEnumerationDurationMs = benchmarkDurationMs(esp_timer_get_time() - enumerationStartUs);
+			directory.close();
+
+			patterns.directoryEntries = foundEntries;
+			if (patterns.directoryEnumerationDurationMs > 0) {
+				patterns.directoryEntriesPerSecond = foundEntries * 1000.f / patterns.directoryEnumerationDurationMs;
+			}
+			benchmarkComputeLatency(samples, sampleCount, patterns.directoryLatency);
+		}
+	}
+
+	for (uint16_t i = 0; i < createdEntries; i++) {
+		snprintf(path, sizeof(path), "%s/f%05u.bin", benchmarkPatternDirPath, i);
+		fileSystem.remove(path);
+	}
+	if (!fileSystem.rmdir(benchmarkPatternDirPath) && okay) {
+		benchmarkSetMessage(patterns, "Directory for enumeration test could not be deleted.");
+		okay = false;
+	}
+	return okay;
+}
+
+// Small reads at random (read-size aligned) offsets, like seeking or reading tags / covers
+bool benchmarkRunRandomRead(File &patternFile, uint32_t fileSize, uint16_t readCount, uint16_t readSize, uint8_t *buffer, uint32_t *samples, SdCardBenchmarkPatternResult &patterns) {
+	const uint32_t slots = fileSize / readSize;
+	if (slots == 0) {
+		benchmarkSetMessage(patterns, "Random-read size exceeds benchmark file.");
+		return false;
+	}
+
+	uint32_t randomState = benchmarkRandomSeed ^ fileSize;
+	size_t sampleCount = 0;
+	int64_t totalUs = 0;
+	for (uint16_t i = 0; i < readCount; i++) {
+		const uint32_t offset = (benchmarkNextRandom(randomState) % slots) * readSize;
+		const int64_t readStartUs = esp_timer_get_time();
+		const bool seekOkay = patternFile.seek(offset);
+		const size_t bytesRead = seekOkay ? patternFile.read(buffer, readSize) : 0;
+		const uint32_t readUs = benchmarkElapsedUs(readStartUs);
+		if (bytesRead != readSize) {
+			benchmarkSetMessage(patterns, "Short read during random-read test.");
+			return false;
+		}
+		totalUs += readUs;
+		if (sampleCount < benchmarkMaxLatencySamples) {
+			samples[sampleCount++] = readUs;
+		}
+	}
+
+	patterns.randomReadCount = readCount;
+	patterns.randomReadSize = readSize;
+	if (totalUs > 0) {
+		patterns.randomReadIops = readCount * 1000000.f / totalUs;
+	}
+	benchmarkComputeLatency(samples, sampleCount, patterns.randomReadLatency);
+	return true;
+}
+
+// Sequential reads with a fixed chunk-size (the decoder reads its input like this)
+bool benchmarkRunChunkRead(File &patternFile, uint32_t fileSize, uint32_t chunkSize, uint8_t *buffer, uint32_t *samples, SdCardBenchmarkChunkEntry &entry, SdCardBenchmarkPatternResult &patterns) {
+	const uint32_t bytesToRead = std::min(fileSize, benchmarkChunkReadBytes);
+	if (!patternFile.seek(0)) {
+		benchmarkSetMessage(patterns, "Seek failed during chunk-read test.");
+		return false;
+	}
+
+	entry.chunkSize = chunkSize;
+	size_t sampleCount = 0;
+	uint32_t readBytesTotal = 0;
+	int64_t totalUs = 0;
+	while (readBytesTotal < bytesToRead) {
+		const size_t bytesThisRound = std::min<size_t>(chunkSize, bytesToRead - readBytesTotal);
+		const int64_t readStartUs = esp_timer_get_time();
+		const size_t bytesRead = patternFile.read(buffer, bytesThisRound);
+		const uint32_t readUs = benchmarkElapsedUs(readStartUs);
+		if (bytesRead != bytesThisRound) {
+			benchmarkSetMessage(patterns, "Short read during chunk-read test.");
+			return false;
+		}
+		totalUs += readUs;
+		readBytesTotal += bytesRead;
+		entry.readCount++;
+		if (sampleCount < benchmarkMaxLatencySamples) {
+			samples[sampleCount++] = readUs;
+		}
+	}
+
+	entry.speedKiBs = benchmarkRateKiBs(readBytesTotal, benchmarkDurationMs(totalUs));
+	benchmarkComputeLatency(samples, sampleCount, entry.latency);
+	return true;
+}
+
+bool benchmarkWritePatternFile(fs::FS &fileSystem, uint32_t fileSize, uint8_t *buffer, size_t bufferSize) {
+	File patternFile = fileSystem.open(benchmarkPatternFilePath, FILE_WRITE);
+	if (!patternFile) {
+		return false;
+	}
+	uint32_t randomState = benchmarkRandomSeed;
+	benchmarkFillBuffer(buffer, bufferSize, randomState);
+	uint32_t writtenBytes = 0;
+	while (writtenBytes < fileSize) {
+		const size_t bytesThisRound = std::min<size_t>(bufferSize, fileSize - writtenBytes);
+		if (patternFile.write(buffer, bytesThisRound) != bytesThisRound) {
+			patternFile.close();
+			return false;
+		}
+		writtenBytes += bytesThisRound;
+	}
+	patternFile.close();
+	return true;
+}
+
+bool benchmarkRunAccessPatterns(const SdCardBenchmarkConfig &config, uint32_t progressBytes, uint32_t frequencyKHz, SdCardBenchmarkPatternResult &patterns) {
+	patterns = SdCardBenchmarkPatternResult {};
+	patterns.run = true;
+	fs::FS &fileSystem = config.fileSystem ? *config.fileSystem : gFSystem;
+
+	uint32_t chunkSizes[sdCardBenchmarkMaxChunkSizes];
+	size_t chunkSizeCount = 0;
+	if (config.chunkSizeCount > 0) {
+		chunkSizeCount = std::min<size_t>(config.chunkSizeCount, sdCardBenchmarkMaxChunkSizes);
+		std::copy(config.chunkSizes, config.chunkSizes + chunkSizeCount, chunkSizes);
+	} else {
+		chunkSizeCount = benchmarkDefaultChunkSizes.size();
+		std::copy(benchmarkDefaultChunkSizes.begin(), benchmarkDefaultChunkSizes.end(), chunkSizes);
+	}
+	size_t bufferSize = std::max<size_t>({benchmarkChunkSize, benchmarkDecoderChunkSize, config.randomReadSize});
+	for (size_t i = 0; i < chunkSizeCount; i++) {
+		bufferSize = std::max<size_t>(bufferSize, chunkSizes[i]);
+	}
+
+	uint8_t *buffer = static_cast<uint8_t *>(x_malloc(bufferSize));
+	uint32_t *samples = static_cast<uint32_t *>(x_malloc(sizeof(uint32_t) * benchmarkMaxLatencySamples));
+	if (!buffer || !samples) {
+		free(buffer);
+		free(samples);
+		benchmarkSetMessage(patterns, "Failed to allocate buffers for access-pattern tests.");
+		return false;
+	}
+
+	bool okay = false;
+	File patternFile;
+
+	benchmarkReportProgress(config, SdCardBenchmarkPhase::DirectoryEnumeration, progressBytes, progressBytes, frequencyKHz);
+	if (!benchmarkRunDirectoryEnumeration(fileSystem, config.directoryEntries, samples, patterns)) {
+		goto cleanup;
+	}
+
+	if (!benchmarkWritePatternFile(fileSystem, config.sizeBytes, buffer, bufferSize)) {
+		benchmarkSetMessage(patterns, "Failed to write file for access-pattern tests.");
+		goto cleanup;
+	}
+	patternFile = fileSystem.open(benchmarkPatternFilePath, FILE_READ);
+	if (!patternFile) {
+		benchmarkSetMessage(patterns, "Failed to open file for access-pattern tests.");
+		goto cleanup;
+	}
+
+	benchmarkReportProgress(config, SdCardBenchmarkPhase::RandomRead, progressBytes, progressBytes, frequencyKHz);
+	if (!benchmarkRunRandomRead(patternFile, config.sizeBytes, config.randomReadCount, config.randomReadSize, buffer, samples, patterns)) {
+		goto cleanup;
+	}
+
+	benchmarkReportProgress(config, SdCardBenchmarkPhase::ChunkRead, progressBytes, progressBytes, frequencyKHz);
+	for (size_t i = 0; i < chunkSizeCount; i++) {
+		SdCardBenchmarkChunkEntry &entry = patterns.chunkEntries[patterns.chunkEntryCount++];
+		if (!benchmarkRunChunkRead(patternFile, config.sizeBytes, chunkSizes[i], buffer, samples, entry, patterns)) {
+			goto cleanup;
+		}
+	}
+
+	// Decoder-sized reads while another task writes to the card
+	{
+		BenchmarkUploadState uploadState = {&fileSystem, false, false, 0};
+		if (xTaskCreatePinnedToCore(benchmarkUploadTask, "sdTestUpload", 3072, &uploadState, 2 | portPRIVILEGE_BIT, NULL, ARDUINO_RUNNING_CORE) != pdPASS) {
+			benchmarkSetMessage(patterns, "Failed to start concurrent write for chunk-read test.");
+			goto cleanup;
+		}
+		SdCardBenchmarkChunkEntry &entry = patterns.chunkEntries[patterns.chunkEntryCount++];
+		entry.concurrentWrite = true;
+		const bool readOkay = benchmarkRunChunkRead(patternFile, config.sizeBytes, benchmarkDecoderChunkSize, buffer, samples, entry, patterns);
+		uploadState.stop = true;
+		while (!uploadState.finished) {
+			vTaskDelay(portTICK_PERIOD_MS * 10);
+		}
+		patterns.concurrentWrittenBytes = uploadState.writtenBytes;
+		if (!readOkay) {
+			goto cleanup;
+		}
+	}
+
+	patterns.success = true;
+	benchmarkSetMessage(patterns, "Access-pattern tests completed successfully.");
+	okay = true;
+
+cleanup:
+	if (patternFile) {
+		patternFile.close();
+	}
+	if (fileSystem.exists(benchmarkPatternFilePath) && !fileSystem.remove(benchmarkPatternFilePath) && okay) {
+		patterns.success = false;
+		benchmarkSetMessage(patterns, "Access-pattern file could not be deleted after the test.");
+		okay = false;
+	}
+	free(buffer);
+	free(samples);
+	return okay;
+}
 } // namespace
 
 void SdCard_Init(void) {
@@ -408,6 +726,18 @@ bool SdCard_RunBenchmark(const SdCardBenchmarkConfig &config, SdCardBenchmarkRes
 	result.processedBytes = result.totalBytes;
 	result.success = successfulEntryCount > 0;
 
+	// Access-patterns run once at the restored clock (they describe the card as it is used for playback)
+	if (config.runAccessPatterns && restoreOkay && bestEntryIndex >= 0) {
+#ifdef SD_MMC_1BIT_MODE
+		const uint32_t patternFrequencyKHz = restoredFrequencyKHz;
+#else
+		const uint32_t patternFrequencyKHz = 0;
+#endif
+		if (!benchmarkRunAccessPatterns(config, result.totalBytes, patternFrequencyKHz, result.patterns)) {
+			Log_Printf(LOGLEVEL_ERROR, "SD benchmark: %s", result.patterns.message);
+		}
+	}
+
 	if (bestEntryIndex >= 0) {
 		benchmarkCopyEntryToResult(result.sweepEntries[bestEntryIndex], result);
 	}
@@ -445,87 +775,6 @@ bool SdCard_RunBenchmark(const SdCardBenchmarkConfig &config, SdCardBenchmarkRes
 	return false;
 }
 
-// Check if file-type is correct
-bool fileValid(const char *_fileItem) {
-	// clang-format off
-	// all supported extension
-	constexpr std::array audioFileSufix = {
-		".mp3",
-		".aac",
-		".m4a",
-		".wav",
-		".flac",
-		".ogg",
-		".oga",
-		".opus",
-		// playlists
-		".m3u",
-		".m3u8",
-		".pls",
-		".asx"
-	};
-	// clang-format on
-	constexpr size_t maxExtLen = strlen(*std::max_element(audioFileSufix.begin(), audioFileSufix.end(), [](const char *a, const char *b) {
-		return strlen(a) < strlen(b);
-	}));
-
-	if (!_fileItem || !strlen(_fileItem)) {
-		// invalid entry
-		return false;
-	}
-
-	// check for streams
-	if (strncmp(_fileItem, "http://", strlen("http://")) == 0 || strncmp(_fileItem, "https://", strlen("https://")) == 0) {
-		// this is a stream
-		return true;
-	}
-
-	// check for files which start with "/."
-	const char *lastSlashPtr = strrchr(_fileItem, '/');
-	if (lastSlashPtr == nullptr) {
-		// we have a relative filename without any slashes...
-		// set the pointer so that it points to the first character AFTER a +1
-		lastSlashPtr = _fileItem - 1;
-	}
-	if (*(lastSlashPtr + 1) == '.') {
-		// we have a hidden file
-		// Log_Printf(LOGLEVEL_DEBUG, "File is hidden: %s", _fileItem);
-		return false;
-	}
-
-	// extract the file extension
-	const char *extStartPtr = strrchr(_fileItem, '.');
-	if (extStartPtr == nullptr) {
-		// no extension found
-		// Log_Printf(LOGLEVEL_DEBUG, "File has no extension: %s", _fileItem);
-		return false;
-	}
-	const size_t extLen = strlen(extStartPtr);
-	if (extLen > maxExtLen) {
-		// extension too long, we do not care anymore
-		// Log_Printf(LOGLEVEL_DEBUG, "File not supported (extension to long): %s", _fileItem);
-		return false;
-	}
-	char extBuffer[maxExtLen + 1] = {0};
-	memcpy(extBuffer, extStartPtr, extLen);
-
-	// make the extension lower case (without using non standard C functions)
-	for (size_t i = 0; i < extLen; i++) {
-		extBuffer[i] = tolower(extBuffer[i]);
-	}
-
-	// check extension against all supported values
-	for (const auto &e : audioFileSufix) {
-		if (strcmp(extBuffer, e) == 0) {
-			// hit we found the extension
-			return true;
-		}
-	}
-	// miss, we did not find the extension
-	// Log_Printf(LOGLEVEL_DEBUG, "File not supported: %s", _fileItem);
-	return false;
-}
-
 // Takes a directory as input and returns a random subdirectory from it
 const String SdCard_pickRandomSubdirectory(const char *_directory) {
 	// Look if folder requested really exists and is a folder. If not => break.
@@ -594,7 +843,7 @@ static std::optional<Playlist *> SdCard_ParseM3UPlaylist(File f, bool forceExten
 	Playlist *playlist = new Playlist();
 
 	// reserve a sane amount of memory to reduce heap fragmentation
-	playlist->reserve(64);
+	playlist->entries().reserve(64);
 	if (extended) {
 		// extended m3u file format
 		// ignore all lines starting with '#'
@@ -611,7 +860,7 @@ static std::optional<Playlist *> SdCard_ParseM3UPlaylist(File f, bool forceExten
 			}
 		}
 		// resize std::vector memory to fit our count
-		playlist->shrink_to_fit();
+		playlist->entries().shrink_to_fit();
 		return playlist;
 	}
 
@@ -625,15 +874,214 @@ static std::optional<Playlist *> SdCard_ParseM3UPlaylist(File f, bool forceExten
 		}
 	}
 	// resize memory to fit our count
-	playlist->shrink_to_fit();
+	playlist->entries().shrink_to_fit();
 	return playlist;
 }
 
+namespace {
+// Paths of a virtual playlist are stored '\n'-separated in an index-file, their offsets in a second file.
+// A set of files (slot) belongs to the playlist reading it: the next playlist is generated into a slot no playlist
+// uses anymore, as the previous one is still played (and the next one may be queued) meanwhile.
+constexpr uint8_t playlistIndexSlots = 3;
+constexpr const char *playlistIndexPathFiles[playlistIndexSlots] = {"/.playlistIndex0", "/.playlistIndex1", "/.playlistIndex2"};
+constexpr const char *playlistIndexOffsetFiles[playlistIndexSlots] = {"/.playlistOffsets0", "/.playlistOffsets1", "/.playlistOffsets2"};
+constexpr uint8_t playlistIndexWindow = 8; // resolved paths kept in RAM
+
+class SdCardPlaylistIndex : public PlaylistSource {
+public:
+	SdCardPlaylistIndex(fs::FS &fileSystem, uint8_t slot, size_t count)
+		: fileSystem_(fileSystem)
+		, slot_(slot)
+		, count_(count) {
+		mutex_ = xSemaphoreCreateMutex();
+	}
+
+	~SdCardPlaylistIndex() override {
+		vSemaphoreDelete(mutex_);
+	}
+
+	size_t size() const override {
+		return count_;
+	}
+
+	String at(size_t index) override {
+		if (index >= count_) {
+			return String();
+		}
+		xSemaphoreTake(mutex_, portMAX_DELAY);
+		WindowEntry *entry = &window_[0];
+		for (WindowEntry &candidate : window_) {
+			if (candidate.index == index) {
+				entry = &candidate;
+				break;
+			}
+			if (candidate.lastUse < entry->lastUse) {
+				entry = &candidate;
+			}
+		}
+		if (entry->index != index) {
+			entry->index = index;
+			resolve(index, entry->path, sizeof(entry->path));
+		}
+		entry->lastUse = ++useCounter_;
+		String path(entry->path); // the window-entry may be reused as soon as the mutex is given
+		xSemaphoreGive(mutex_);
+		return path;
+	}
+
+private:
+	struct WindowEntry {
+		size_t index = SIZE_MAX;
+		uint32_t lastUse = 0;
+		char path[256] = {0};
+	};
+
+	// Files are only opened while reading, as the number of open files is limited
+	void resolve(size_t position, char *path, size_t pathSize) {
+		path[0] = '\0';
+		uint8_t offsetBytes[4];
+		File offsets = fileSystem_.open(playlistIndexOffsetFiles[slot_], FILE_READ);
+		if (!offsets || !offsets.seek(position * sizeof(offsetBytes)) || offsets.read(offsetBytes, sizeof(offsetBytes)) != sizeof(offsetBytes)) {
+			Log_Printf(LOGLEVEL_ERROR, "Playlist-index: unable to read entry %u", position);
+			return;
+		}
+		offsets.close();
+		const uint32_t offset = offsetBytes[0] | (offsetBytes[1] << 8) | (offsetBytes[2] << 16) | (static_cast<uint32_t>(offsetBytes[3]) << 24);
+		File paths = fileSystem_.open(playlistIndexPathFiles[slot_], FILE_READ);
+		if (!paths || !paths.seek(offset)) {
+			Log_Printf(LOGLEVEL_ERROR, "Playlist-index: unable to read entry %u", position);
+			return;
+		}
+		const size_t len = paths.readBytesUntil('\n', path, pathSize - 1);
+		path[len] = '\0';
+		paths.close();
+	}
+
+	fs::FS &fileSystem_;
+	const uint8_t slot_;
+	const size_t count_;
+	SemaphoreHandle_t mutex_;
+	WindowEntry window_[playlistIndexWindow];
+	uint32_t useCounter_ = 0;
+};
+
+// Owners of the slots; only playlist-generation assigns them, playlists release them from any task
+std::weak_ptr<SdCardPlaylistIndex> playlistIndexOwners[playlistIndexSlots];
+
+std::optional<uint8_t> SdCard_FreePlaylistIndexSlot() {
+	for (uint8_t slot = 0; slot < playlistIndexSlots; slot++) {
+		if (playlistIndexOwners[slot].expired()) {
+			return slot;
+		}
+	}
+	return std::nullopt;
+}
+} // namespace
+
+// Whole directory-trees can contain thousands of files: instead of RAM their paths are written to an index-file,
+// the playlist resolves entries on demand. Directories are sorted one at a time, so only the entries of a single
+// directory are held in RAM. The index is generated anew for every playlist: FatFs doesn't update the modification-
+// time of a directory when its content changes, so it's no reliable key to reuse an index.
+static std::optional<Playlist *> SdCard_ReturnVirtualPlaylist(fs::FS &fileSystem, const char *dirName, bool sorted) {
+	const std::optional<uint8_t> freeSlot = SdCard_FreePlaylistIndexSlot();
+	if (!freeSlot) {
+		Log_Println("Playlist-index: all index-files are in use", LOGLEVEL_ERROR);
+		return std::nullopt;
+	}
+	const uint8_t slot = *freeSlot;
+	File paths = fileSystem.open(playlistIndexPathFiles[slot], FILE_WRITE);
+	File offsets = fileSystem.open(playlistIndexOffsetFiles[slot], FILE_WRITE);
+	if (!paths || !offsets) {
+		Log_Println("Playlist-index: unable to create index-files", LOGLEVEL_ERROR);
+		return std::nullopt;
+	}
+
+	size_t count = 0;
+	size_t scannedEntries = 0;
+	uint32_t pathsPos = 0;
+	std::function<bool(const String &)> scanDir = [&](const String &dirPath) {
+		File dir = fileSystem.open(dirPath);
+		if (!dir || !dir.isDirectory()) {
+			Log_Printf(LOGLEVEL_ERROR, "Cannot open directory %s", dirPath.c_str());
+			return false;
+		}
+		Playlist children; // files and subdirectories (with a trailing '/') of this directory
+		while (true) {
+			bool isDir;
+			String name = dir.getNextFileName(&isDir);
+			if (name.isEmpty()) {
+				break;
+			}
+			scannedEntries++;
+			if (isDir) {
+				if (name.substring(name.lastIndexOf('/') + 1).startsWith(".")) {
+					continue; // hidden directory
+				}
+				name += '/';
+			} else if (!fileValid(name.c_str())) {
+				continue;
+			}
+			char *entry = x_strdup(name.c_str());
+			if (!entry) {
+				Log_Println(unableToAllocateMemForLinearPlaylist, LOGLEVEL_ERROR);
+				return false;
+			}
+			children.push_back(entry);
+		}
+		dir.close(); // the number of open files is limited
+		if (sorted) {
+			AudioPlayer_SortPlaylist(&children);
+		}
+
+		for (const char *child : children.entries()) {
+			const size_t len = strlen(child);
+			if (child[len - 1] == '/') {
+				if (!scanDir(String(child).substring(0, len - 1))) {
+					return false;
+				}
+				continue;
+			}
+			const uint8_t offsetBytes[4] = {static_cast<uint8_t>(pathsPos), static_cast<uint8_t>(pathsPos >> 8), static_cast<uint8_t>(pathsPos >> 16), static_cast<uint8_t>(pathsPos >> 24)};
+			if (offsets.write(offsetBytes, sizeof(offsetBytes)) != sizeof(offsetBytes) || paths.write(reinterpret_cast<const uint8_t *>(child), len) != len || paths.write('\n') != 1) {
+				Log_Println("Playlist-index: unable to write index-files", LOGLEVEL_ERROR);
+				return false;
+			}
+			pathsPos += len + 1;
+			count++;
+		}
+		return true;
+	};
+
+	const int64_t scanStartUs = esp_timer_get_time();
+	const bool success = scanDir(dirName);
+	paths.close();
+	offsets.close();
+	if (!success) {
+		return std::nullopt;
+	}
+	const uint32_t scanDurationUs = static_cast<uint32_t>(esp_timer_get_time() - scanStartUs);
+	Log_Printf(LOGLEVEL_DEBUG, "Scanned %u entries in %" PRIu32 " ms (%" PRIu32 " us/entry)", scannedEntries, scanDurationUs / 1000u, scannedEntries ? scanDurationUs / scannedEntries : 0u);
+	Log_Printf(LOGLEVEL_NOTICE, numberOfValidFiles, count);
+
+	if (count == 0) {
+		return new Playlist();
+	}
+	std::shared_ptr<SdCardPlaylistIndex> index = std::make_shared<SdCardPlaylistIndex>(fileSystem, slot, count);
+	playlistIndexOwners[slot] = index;
+	return new Playlist(index);
+}
+
 /* Puts SD-file(s) or directory into a playlist
 	First element of array always contains the number of payload-items. */
 std::optional<Playlist *> SdCard_ReturnPlaylist(const char *fileName, const uint32_t _playMode) {
+	return SdCard_ReturnPlaylist(gFSystem, fileName, _playMode);
+}
+
+// Same as above, but on an arbitrary filesystem (e.g. to compare playlist-generation on different media)
+std::optional<Playlist *> SdCard_ReturnPlaylist(fs::FS &fileSystem, const char *fileName, const uint32_t _playMode) {
+	TRACE_SCOPE(PlaylistGenerate);
 	// Look if file/folder requested really exists. If not => break.
-	File fileOrDirectory = gFSystem.open(fileName);
+	File fileOrDirectory = fileSystem.open(fileName);
 	if (!fileOrDirectory) {
 		Log_Printf(LOGLEVEL_ERROR, dirOrFileDoesNotExist, fileName);
 		return std::nullopt;
@@ -651,14 +1099,24 @@ std::optional<Playlist *> SdCard_ReturnPlaylist(const char *fileName, const uint
 
 	// if we reach here, this was not a m3u
 	Log_Println(playlistGen, LOGLEVEL_NOTICE);
-	Playlist *playlist = new Playlist;
 
-	bool recurse = (_playMode == ALL_TRACKS_OF_ALL_SUBDIRS_SORTED || _playMode == ALL_TRACKS_OF_ALL_SUBDIRS_RANDOM);
-	size_t hiddenFiles = 0;
+	const bool recurse = (_playMode == ALL_TRACKS_OF_ALL_SUBDIRS_SORTED || _playMode == ALL_TRACKS_OF_ALL_SUBDIRS_RANDOM);
+	if (recurse && fileOrDirectory.isDirectory()) {
+		fileOrDirectory.close();
+		return SdCard_ReturnVirtualPlaylist(fileSystem, fileName, _playMode == ALL_TRACKS_OF_ALL_SUBDIRS_SORTED);
+	}
 
-	// (recursive) directory scanning function
-	std::function<bool(const String &)> scanDir = [&](const String &dirPath) {
-		File dir = gFSystem.open(dirPath);
+	Playlist *playlist = new Playlist;
+	size_t hiddenFiles = 0;
+	size_t scannedEntries = 0;
+	// SINGLE_TRACK_OF_DIR_RANDOM: pick one file while scanning (reservoir-sampling) instead of collecting all of them
+	const bool pickSingle = (_playMode == SINGLE_TRACK_OF_DIR_RANDOM);
+	size_t validFiles = 0;
+	String pickedFile;
+
+	// directory scanning function
+	auto scanDir = [&](const String &dirPath) {
+		File dir = fileSystem.open(dirPath);
 		if (!dir || !dir.isDirectory()) {
 			Log_Printf(LOGLEVEL_ERROR, "Cannot open directory %s", dirPath.c_str());
 			return false;
@@ -669,11 +1127,17 @@ std::optional<Playlist *> SdCard_ReturnPlaylist(const char *fileName, const uint
 			if (name.isEmpty()) {
 				break;
 			}
+			scannedEntries++;
 			if (isDir) {
-				if (recurse && !scanDir(name)) {
-					return false;
+				continue; // subdirectories are only played by the recursive modes
+			}
+			if (fileValid(name.c_str())) {
+				if (pickSingle) {
+					if (esp_random() % ++validFiles == 0) {
+						pickedFile = name;
+					}
+					continue;
 				}
-			} else if (fileValid(name.c_str())) {
 				if (!SdCard_allocAndSave(playlist, name)) {
 					// OOM, function already took care of house cleaning
 					return false;
@@ -694,16 +1158,75 @@ std::optional<Playlist *> SdCard_ReturnPlaylist(const char *fileName, const uint
 	}
 	// Directory-mode (linear-playlist)
 	else {
-		playlist->reserve(64); // reserve a sane amount of memory to reduce the number of reallocs
+		playlist->entries().reserve(64); // reserve a sane amount of memory to reduce the number of reallocs
+		const int64_t scanStartUs = esp_timer_get_time();
 		if (!scanDir(fileName)) {
 			// OOM, function already took care of house cleaning
 			return std::nullopt;
 		}
+		if (pickSingle && !pickedFile.isEmpty() && !SdCard_allocAndSave(playlist, pickedFile)) {
+			return std::nullopt;
+		}
+		// directory-enumeration cost is what dominates playlist-generation on SD
+		const uint32_t scanDurationUs = static_cast<uint32_t>(esp_timer_get_time() - scanStartUs);
+		Log_Printf(LOGLEVEL_DEBUG, "Scanned %u entries in %" PRIu32 " ms (%" PRIu32 " us/entry)", scannedEntries, scanDurationUs / 1000u, scannedEntries ? scanDurationUs / scannedEntries : 0u);
 	}
 
-	playlist->shrink_to_fit();
+	playlist->entries().shrink_to_fit();
 
 	Log_Printf(LOGLEVEL_NOTICE, numberOfValidFiles, playlist->size());
 	Log_Printf(LOGLEVEL_DEBUG, "Hidden files: %u", hiddenFiles);
 	return playlist;
 }
+
+// Calls callback for every entry of a directory (name without path); used by the explorer of the web-interface
+bool SdCard_ListDirectory(fs::FS &fileSystem, const char *path, const std::function<void(const String &name, bool isDir)> &callback) {
+	File root = fileSystem.open(path);
+	if (!root) {
+		Log_Println(failedToOpenDirectory, LOGLEVEL_DEBUG);
+		return false;
+	}
+	if (!root.isDirectory()) {
+		Log_Println(notADirectory, LOGLEVEL_DEBUG);
+		return false;
+	}
+
+	bool isDir = false;
+	String fileName = root.getNextFileName(&isDir);
+	while (fileName != "") {
+		// ignore hidden folders, e.g. MacOS spotlight files
+		if (!fileName.startsWith("/.")) {
+			callback(fileName.substring(fileName.lastIndexOf('/') + 1), isDir);
+		}
+		fileName = root.getNextFileName(&isDir);
+	}
+	root.close();
+	return true;
+}
+
+static bool SdCard_DeleteDirectory(fs::FS &fileSystem, File dir) {
+	File file = dir.openNextFile();
+	while (file) {
+		if (file.isDirectory()) {
+			SdCard_DeleteDirectory(fileSystem, file);
+		} else {
+			fileSystem.remove(file.path());
+		}
+		file = dir.openNextFile();
+		esp_task_wdt_reset();
+	}
+	return fileSystem.rmdir(dir.path());
+}
+
+// Deletes a file or a directory including everything in it
+bool SdCard_DeletePath(fs::FS &fileSystem, const char *path) {
+	File file = fileSystem.open(path);
+	if (!file) {
+		return false;
+	}
+	if (file.isDirectory()) {
+		return SdCard_DeleteDirectory(fileSystem, file);
+	}
+	file.close();
+	return fileSystem.remove(path);
+}
@@ -11,14 +11,19 @@ extern fs::FS gFSystem;
 
 #include "Playlist.h"
 
+#include <functional>
 #include <optional>
 
 enum class SdCardBenchmarkPhase : uint8_t {
 	Write = 0,
 	Read = 1,
+	DirectoryEnumeration = 2,
+	RandomRead = 3,
+	ChunkRead = 4,
 };
 
 constexpr size_t sdCardBenchmarkMaxSweepEntries = 3;
+constexpr size_t sdCardBenchmarkMaxChunkSizes = 5;
 
 typedef void (*SdCardBenchmarkProgressCallback)(SdCardBenchmarkPhase phase, uint32_t processedBytes, uint32_t totalBytes, uint32_t frequencyKHz, void *userData);
 
@@ -27,8 +32,48 @@ typedef struct {
 	bool runFrequencySweep = false;
 	SdCardBenchmarkProgressCallback progressCallback = nullptr;
 	void *progressUserData = nullptr;
+	fs::FS *fileSystem = nullptr; // filesystem to run against; nullptr = gFSystem
+	bool runAccessPatterns = false; // additionally run directory-enumeration, random-read and chunk-read phases
+	uint16_t directoryEntries = 128; // number of files created for the directory-enumeration phase
+	uint16_t randomReadCount = 256; // number of random reads
+	uint16_t randomReadSize = 512; // bytes per random read
+	uint8_t chunkSizeCount = 0; // 0 = use default chunk-sizes
+	uint32_t chunkSizes[sdCardBenchmarkMaxChunkSizes] = {0};
 } SdCardBenchmarkConfig;
 
+typedef struct {
+	uint32_t p50Us = 0;
+	uint32_t p90Us = 0;
+	uint32_t p99Us = 0;
+	uint32_t maxUs = 0;
+} SdCardBenchmarkLatency;
+
+typedef struct {
+	uint32_t chunkSize = 0;
+	bool concurrentWrite = false; // measured while another task writes to the card (like a web-upload does)
+	uint32_t readCount = 0;
+	float speedKiBs = 0.f;
+	SdCardBenchmarkLatency latency;
+} SdCardBenchmarkChunkEntry;
+
+typedef struct {
+	bool run = false;
+	bool success = false;
+	uint16_t directoryEntries = 0;
+	uint32_t directoryCreateDurationMs = 0;
+	uint32_t directoryEnumerationDurationMs = 0;
+	float directoryEntriesPerSecond = 0.f;
+	SdCardBenchmarkLatency directoryLatency;
+	uint16_t randomReadCount = 0;
+	uint16_t randomReadSize = 0;
+	float randomReadIops = 0.f;
+	SdCardBenchmarkLatency randomReadLatency;
+	uint8_t chunkEntryCount = 0;
+	SdCardBenchmarkChunkEntry chunkEntries[sdCardBenchmarkMaxChunkSizes + 1] = {}; // +1: decoder-sized reads during concurrent write
+	uint32_t concurrentWrittenBytes = 0;
+	char message[96] = {0};
+} SdCardBenchmarkPatternResult;
+
 typedef struct {
 	uint32_t frequencyKHz = 0;
 	uint32_t writeDurationMs = 0;
@@ -61,6 +106,7 @@ typedef struct {
 	uint32_t verifyErrors = 0;
 	bool success = false;
 	char message[128] = {0};
+	SdCardBenchmarkPatternResult patterns;
 } SdCardBenchmarkResult;
 
 void SdCard_Init(void);
@@ -71,4 +117,7 @@ uint64_t SdCard_GetFreeSize();
 void SdCard_PrintInfo();
 bool SdCard_RunBenchmark(const SdCardBenchmarkConfig &config, SdCardBenchmarkResult &result);
 std::optional<Playlist *> SdCard_ReturnPlaylist(const char *fileName, const uint32_t _playMode);
+std::optional<Playlist *> SdCard_ReturnPlaylist(fs::FS &fileSystem, const char *fileName, const uint32_t _playMode);
 const String SdCard_pickRandomSubdirectory(const char *_directory);
+bool SdCard_ListDirectory(fs::FS &fileSystem, const char *path, const std::function<void(const String &name, bool isDir)> &callback);
+bool SdCard_DeletePath(fs::FS &fileSystem, const char *path);
@@ -0,0 +1,554 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "SeekTable.h"
+
+#include "Log.h"
+#include "MemX.h"
+#include "MpegFrame.h"
+#include "SdCard.h"
+
+#include <algorithm>
+#include <freertos/semphr.h>
+
+namespace {
+constexpr uint32_t SeekTable_Magic = 0x314B4553; // "SEK1"
+constexpr size_t SeekTable_ScanBlockBytes = 4096; // MP3 frame-scan
+constexpr size_t SeekTable_Mp4BlockBytes = 512; // per MP4 sample-table
+constexpr uint32_t SeekTable_FirstIntervalMs = 1000; // distance of points; doubled whenever the table is full
+
+struct SeekPoint {
+	uint32_t timeMs;
+	uint32_t offset;
+};
+
+struct SeekTableHeader {
+	uint32_t magic;
+	uint32_t fileSize; // detects replaced files
+	uint32_t durationMs;
+	uint32_t count;
+};
+
+struct SeekTableData {
+	uint32_t pathHash;
+	uint32_t durationMs;
+	uint16_t count; // 0 = no table (yet)
+	uint32_t intervalMs; // only used while building
+	SeekPoint points[SEEK_TABLE_POINTS];
+};
+
+// Sequential reads through a small buffer (frame-headers and MP4-table-entries are only a few bytes each)
+struct SeekTableReader {
+	File &file;
+	uint8_t *buf;
+	size_t bufSize;
+	uint32_t bufStart = 0;
+	size_t bufLen = 0;
+	uint32_t refills = 0;
+
+	const uint8_t *peek(uint32_t pos, size_t len) {
+		if (pos < bufStart || pos + len > bufStart + bufLen) {
+			if (!file.seek(pos)) {
+				return nullptr;
+			}
+			bufStart = pos;
+			bufLen = file.read(buf, bufSize);
+			refills++;
+			if (len > bufLen) {
+				return nullptr;
+			}
+		}
+		return buf + (pos - bufStart);
+	}
+};
+
+SeekTableData *SeekTable_Current = nullptr; // table of the selected file
+SeekTableData *SeekTable_Building = nullptr;
+SemaphoreHandle_t SeekTable_Mutex = nullptr;
+TaskHandle_t SeekTable_TaskHandle = nullptr;
+String SeekTable_PendingPath; // file to be built by the task
+
+uint32_t SeekTable_Be16(const uint8_t *p) {
+	return (p[0] << 8) | p[1];
+}
+
+uint32_t SeekTable_Be32(const uint8_t *p) {
+	return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+uint32_t SeekTable_Hash(const char *path) {
+	uint32_t hash = 2166136261u; // FNV-1a
+	for (; *path; path++) {
+		hash ^= static_cast<uint8_t>(*path);
+		hash *= 16777619u;
+	}
+	return hash ? hash : 1u; // 0 = no file selected
+}
+
+String SeekTable_CachePath(uint32_t pathHash) {
+	char name[24];
+	snprintf(name, sizeof(name), "/%08" PRIx32 ".sk", pathHash);
+	return String(SEEK_TABLE_DIR) + name;
+}
+
+void SeekTable_Reset(SeekTableData &table, uint32_t pathHash) {
+	table.pathHash = pathHash;
+	table.durationMs = 0;
+	table.count = 0;
+	table.intervalMs = SeekTable_FirstIntervalMs;
+}
+
+// Adds a point if it's at least intervalMs after the last one; a full table drops every second point
+void SeekTable_AddPoint(SeekTableData &table, uint32_t timeMs, uint32_t offset) {
+	if (table.count && timeMs < table.points[table.count - 1].timeMs + table.intervalMs) {
+		return;
+	}
+	if (table.count == SEEK_TABLE_POINTS) {
+		for (uint16_t i = 0; i < SEEK_TABLE_POINTS / 2; i++) {
+			table.points[i] = table.points[i * 2];
+		}
+		table.count = SEEK_TABLE_POINTS / 2;
+		table.intervalMs = std::max<uint32_t>(table.intervalMs * 2, 1);
+		if (timeMs < table.points[table.count - 1].timeMs + table.intervalMs) {
+			return;
+		}
+	}
+	table.points[table.count++] = SeekPoint {timeMs, offset};
+}
+
+// The last point (end of audio-data or start of the last MP4-chunk) is always kept
+void SeekTable_Finish(SeekTableData &table, uint32_t durationMs, const SeekPoint &last) {
+	table.durationMs = durationMs;
+	if (table.count == SEEK_TABLE_POINTS) {
+		table.count--;
+	}
+	if (table.count && table.points[table.count - 1].timeMs >= last.timeMs) {
+		table.count--;
+	}
+	table.points[table.count++] = last;
+}
+
+uint32_t SeekTable_SkipId3v2(File &file) {
+	uint8_t header[10];
+	if (!file.seek(0) || file.read(header, sizeof(header)) != sizeof(header) || memcmp(header, "ID3", 3) != 0) {
+		return 0;
+	}
+	const uint32_t size = ((header[6] & 0x7F) << 21) | ((header[7] & 0x7F) << 14) | ((header[8] & 0x7F) << 7) | (header[9] & 0x7F);
+	return 10 + size + ((header[5] & 0x10) ? 10 : 0);
+}
+
+bool SeekTable_BuildMpeg(File &file, SeekTableData &table) {
+	uint8_t *buf = static_cast<uint8_t *>(x_malloc(SeekTable_ScanBlockBytes));
+	if (buf == nullptr) {
+		return false;
+	}
+	SeekTableReader reader {file, buf, SeekTable_ScanBlockBytes};
+	const uint32_t fileSize = file.size();
+	const uint32_t audioStart = SeekTable_SkipId3v2(file);
+
+	// first frame: a valid header that is followed by another one
+	uint32_t pos = audioStart;
+	MpegFrameHeader header;
+	bool found = false;
+	while (!found && pos < audioStart + SeekTable_ScanBlockBytes) {
+		const uint8_t *p = reader.peek(pos, 4);
+		MpegFrameHeader next;
+		if (p && MpegFrame_Parse(p, header)) {
+			const uint8_t *n = reader.peek(pos + header.length, 4);
+			found = n && MpegFrame_Parse(n, next);
+		}
+		pos += found ? 0 : 1;
+	}
+	if (!found) {
+		free(buf);
+		return false;
+	}
+
+	const uint8_t *xing = reader.peek(pos + header.sideInfoOffset, 120);
+	const uint8_t *vbri = reader.peek(pos + 36, 26);
+	if (xing && (!memcmp(xing, "Xing", 4) || !memcmp(xing, "Info", 4)) && (SeekTable_Be32(xing + 4) & 0x05) == 0x05) {
+		// Xing-TOC: 100 entries, byte-position (in 1/256 of the audio-data) of every percent of the duration
+		xing = reader.peek(pos + header.sideInfoOffset, 120); // vbri-peek may have moved the buffer
+		const uint32_t flags = SeekTable_Be32(xing + 4);
+		const uint32_t frames = SeekTable_Be32(xing + 8);
+		const uint32_t bytes = (flags & 0x02) ? SeekTable_Be32(xing + 12) : fileSize - pos;
+		const uint8_t *toc = xing + ((flags & 0x02) ? 16 : 12);
+		const uint32_t durationMs = static_cast<uint64_t>(frames) * header.samplesPerFrame * 1000 / header.sampleRate;
+		table.intervalMs = 0;
+		for (uint8_t i = 0; i < 100; i++) {
+			SeekTable_AddPoint(table, static_cast<uint64_t>(durationMs) * i / 100, pos + static_cast<uint64_t>(toc[i]) * bytes / 256);
+		}
+		SeekTable_Finish(table, durationMs, SeekPoint {durationMs, std::min(pos + bytes, fileSize)});
+	} else if (vbri && !memcmp(vbri, "VBRI", 4)) {
+		// VBRI-TOC: byte-size of every framesPerEntry frames
+		const uint32_t frames = SeekTable_Be32(vbri + 14);
+		const uint32_t entries = SeekTable_Be16(vbri + 18);
+		const uint32_t scale = SeekTable_Be16(vbri + 20);
+		const uint32_t entrySize = SeekTable_Be16(vbri + 22);
+		const uint32_t framesPerEntry = SeekTable_Be16(vbri + 24);
+		uint32_t offset = pos;
+		uint64_t samples = 0;
+		table.intervalMs = static_cast<uint64_t>(frames) * header.samplesPerFrame * 1000 / header.sampleRate / (SEEK_TABLE_POINTS - 1);
+		for (uint32_t i = 0; i < entries && entrySize >= 1 && entrySize <= 4; i++) {
+			SeekTable_AddPoint(table, samples * 1000 / header.sampleRate, offset);
+			const uint8_t *entry = reader.peek(pos + 36 + 26 + i * entrySize, entrySize);
+			if (entry == nullptr) {
+				break;
+			}
+			uint32_t value = 0;
+			for (uint32_t b = 0; b < entrySize; b++) {
+				value = (value << 8) | entry[b];
+			}
+			offset += value * scale;
+			samples += static_cast<uint64_t>(framesPerEntry) * header.samplesPerFrame;
+		}
+		const uint32_t durationMs = static_cast<uint64_t>(frames) * header.samplesPerFrame * 1000 / header.sampleRate;
+		SeekTable_Finish(table, durationMs, SeekPoint {durationMs, std::min(offset, fileSize)});
+	} else {
+		// No TOC: walk all frame-headers. Reads are spread out, so the decoder isn't starved.
+		uint64_t timeUs = 0;
+		uint32_t lastRefills = reader.refills;
+		while (pos + 4 <= fileSize) {
+			const uint8_t *p = reader.peek(pos, 4);
+			if (p == nullptr) {
+				break;
+			}
+			if (!MpegFrame_Parse(p, header) || header.length < 4) {
+				pos++; // lost sync (e.g. ID3v1-tag or garbage)
+				continue;
+			}
+			SeekTable_AddPoint(table, timeUs / 1000, pos);
+			timeUs += static_cast<uint64_t>(header.samplesPerFrame) * 1000000 / header.sampleRate;
+			pos += header.length;
+			if (reader.refills != lastRefills) {
+				lastRefills = reader.refills;
+				vTaskDelay(1);
+			}
+		}
+		SeekTable_Finish(table, timeUs / 1000, SeekPoint {static_cast<uint32_t>(timeUs / 1000), std::min(pos, fileSize)});
+	}
+	free(buf);
+	return table.count > 1 && table.durationMs > 0;
+}
+
+struct Mp4Track {
+	bool audio;
+	uint32_t timescale;
+	uint32_t stts, stsc, stco; // position of the atom-data, 0 = missing
+	bool co64;
+};
+
+// Collects the sample-tables of the first audio-track
+void SeekTable_WalkMp4(File &file, uint32_t pos, uint32_t end, uint8_t depth, Mp4Track &track, Mp4Track &audio) {
+	while (pos + 8 <= end && depth < 6) {
+		uint8_t header[16];
+		if (!file.seek(pos) || file.read(header, 8) != 8) {
+			return;
+		}
+		uint64_t size = SeekTable_Be32(header);
+		uint32_t headerLen = 8;
+		if (size == 1) {
+			if (file.read(header + 8, 8) != 8) {
+				return;
+			}
+			size = (static_cast<uint64_t>(SeekTable_Be32(header + 8)) << 32) | SeekTable_Be32(header + 12);
+			headerLen = 16;
+		} else if (size == 0) {
+			size = end - pos;
+		}
+		if (size < headerLen || size > end - pos) {
+			return;
+		}
+		const char *type = reinterpret_cast<const char *>(header + 4);
+		const uint32_t dataPos = pos + headerLen;
+		const uint32_t dataEnd = pos + size;
+		uint8_t data[24];
+
+		if (!memcmp(type, "trak", 4)) {
+			Mp4Track trak = {};
+			SeekTable_WalkMp4(file, dataPos, dataEnd, depth + 1, trak, audio);
+			if (trak.audio && trak.timescale && trak.stts && trak.stsc && trak.stco && !audio.audio) {
+				audio = trak;
+			}
+		} else if (!memcmp(type, "moov", 4) || !memcmp(type, "mdia", 4) || !memcmp(type, "minf", 4) || !memcmp(type, "stbl", 4)) {
+			SeekTable_WalkMp4(file, dataPos, dataEnd, depth + 1, track, audio);
+		} else if (!memcmp(type, "mdhd", 4) && file.seek(dataPos) && file.read(data, sizeof(data)) == sizeof(data)) {
+			track.timescale = SeekTable_Be32(data + ((data[0] == 1) ? 20 : 12));
+		} else if (!memcmp(type, "hdlr", 4) && file.seek(dataPos) && file.read(data, 12) == 12) {
+			track.audio = !memcmp(data + 8, "soun", 4);
+		} else if (!memcmp(type, "stts", 4)) {
+			track.stts = dataPos;
+		} else if (!memcmp(type, "stsc", 4)) {
+			track.stsc = dataPos;
+		} else if (!memcmp(type, "stco", 4) || !memcmp(type, "co64", 4)) {
+			track.stco = dataPos;
+			track.co64 = type[0] == 'c';
+		}
+		pos = dataEnd;
+	}
+}
+
+// Points are chunk-offsets at their start-time (stco + stsc: samples per chunk, stts: duration of samples)
+bool SeekTable_BuildMp4(File &file, SeekTableData &table) {
+	Mp4Track track = {};
+	Mp4Track audio = {};
+	SeekTable_WalkMp4(file, 0, file.size(), 0, track, audio);
+	if (!audio.audio) {
+		return false;
+	}
+	uint8_t *buf = static_cast<uint8_t *>(x_malloc(3 * SeekTable_Mp4BlockBytes));
+	if (buf == nullptr) {
+		return false;
+	}
+	SeekTableReader stts {file, buf, SeekTable_Mp4BlockBytes};
+	SeekTableReader stsc {file, buf + SeekTable_Mp4BlockBytes, SeekTable_Mp4BlockBytes};
+	SeekTableReader stco {file, buf + 2 * SeekTable_Mp4BlockBytes, SeekTable_Mp4BlockBytes};
+	const uint8_t *p;
+	const uint32_t sttsCount = (p = stts.peek(audio.stts + 4, 4)) ? SeekTable_Be32(p) : 0;
+	const uint32_t stscCount = (p = stsc.peek(audio.stsc + 4, 4)) ? SeekTable_Be32(p) : 0;
+	const uint32_t chunkCount = (p = stco.peek(audio.stco + 4, 4)) ? SeekTable_Be32(p) : 0;
+	const uint32_t chunkSize = audio.co64 ? 8 : 4;
+
+	uint32_t sttsIndex = 0, sttsLeft = 0, sttsDelta = 0;
+	uint32_t stscIndex = 0, samplesPerChunk = 0, nextFirstChunk = 1;
+	uint64_t time = 0; // in timescale-units
+	SeekPoint last = {};
+	for (uint32_t chunk = 1; chunk <= chunkCount; chunk++) {
+		while (chunk == nextFirstChunk && stscIndex < stscCount) { // next run of chunks
+			p = stsc.peek(audio.stsc + 8 + stscIndex * 12, 12);
+			if (p == nullptr) {
+				break;
+			}
+			samplesPerChunk = SeekTable_Be32(p + 4);
+			stscIndex++;
+			nextFirstChunk = UINT32_MAX;
+			if (stscIndex < stscCount && (p = stsc.peek(audio.stsc + 8 + stscIndex * 12, 4)) != nullptr) {
+				nextFirstChunk = SeekTable_Be32(p);
+			}
+		}
+		if ((p = stco.peek(audio.stco + 8 + (chunk - 1) * chunkSize, chunkSize)) == nullptr) {
+			break;
+		}
+		const uint32_t offset = audio.co64 ? SeekTable_Be32(p + 4) : SeekTable_Be32(p); // files > 4 GB aren't supported anyway
+		last = SeekPoint {static_cast<uint32_t>(time * 1000 / audio.timescale), offset};
+		SeekTable_AddPoint(table, last.timeMs, last.offset);
+
+		for (uint32_t samples = samplesPerChunk; samples > 0;) {
+			if (sttsLeft == 0) {
+				if (sttsIndex >= sttsCount || (p = stts.peek(audio.stts + 8 + sttsIndex * 8, 8)) == nullptr) {
+					break;
+				}
+				sttsLeft = SeekTable_Be32(p);
+				sttsDelta = SeekTable_Be32(p + 4);
+				sttsIndex++;
+				continue;
+			}
+			const uint32_t take = std::min(samples, sttsLeft);
+			time += static_cast<uint64_t>(take) * sttsDelta;
+			samples -= take;
+			sttsLeft -= take;
+		}
+	}
+	free(buf);
+	if (chunkCount == 0) {
+		return false;
+	}
+	SeekTable_Finish(table, time * 1000 / audio.timescale, last);
+	return table.count > 1 && table.durationMs > 0;
+}
+
+bool SeekTable_Build(File &file, SeekTableData &table) {
+	uint8_t magic[8];
+	if (!file.seek(0) || file.read(magic, sizeof(magic)) != sizeof(magic)) {
+		return false;
+	}
+	if (!memcmp(magic + 4, "ftyp", 4)) {
+		return SeekTable_BuildMp4(file, table);
+	}
+	if (!memcmp(magic, "fLaC", 4) || !memcmp(magic, "OggS", 4) || !memcmp(magic, "RIFF", 4)) {
+		return false;
+	}
+	return SeekTable_BuildMpeg(file, table);
+}
+
+bool SeekTable_LoadCache(uint32_t pathHash, uint32_t fileSize, SeekTableData &table) {
+	File cache = gFSystem.open(SeekTable_CachePath(pathHash), FILE_READ);
+	if (!cache) {
+		return false;
+	}
+	SeekTableHeader header;
+	if (cache.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) != sizeof(header) || header.magic != SeekTable_Magic || header.fileSize != fileSize || header.count < 2 || header.count > SEEK_TABLE_POINTS) {
+		return false;
+	}
+	const size_t len = header.count * sizeof(SeekPoint);
+	if (cache.read(reinterpret_cast<uint8_t *>(table.points), len) != len) {
+		return false;
+	}
+	table.durationMs = header.durationMs;
+	table.count = header.count;
+	return true;
+}
+
+void SeekTable_SaveCache(uint32_t fileSize, const SeekTableData &table) {
+	if (!gFSystem.exists(SEEK_TABLE_DIR)) {
+		gFSystem.mkdir(SEEK_TABLE_DIR);
+	}
+	File cache = gFSystem.open(SeekTable_CachePath(table.pathHash), FILE_WRITE);
+	if (!cache) {
+		return;
+	}
+	const SeekTableHeader header = {SeekTable_Magic, fileSize, table.durationMs, table.count};
+	cache.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+	cache.write(reinterpret_cast<const uint8_t *>(table.points), table.count * sizeof(SeekPoint));
+}
+
+void SeekTable_Task(void *) {
+	for (;;) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		xSemaphoreTake(SeekTable_Mutex, portMAX_DELAY);
+		const String path = SeekTable_PendingPath;
+		SeekTable_PendingPath = String();
+		xSemaphoreGive(SeekTable_Mutex);
+		if (path.isEmpty()) {
+			continue;
+		}
+
+		File file = gFSystem.open(path.c_str(), FILE_READ);
+		if (!file || file.isDirectory()) {
+			continue;
+		}
+		const uint32_t startMs = millis();
+		SeekTable_Reset(*SeekTable_Building, SeekTable_Hash(path.c_str()));
+		const bool built = SeekTable_Build(file, *SeekTable_Building);
+		const uint32_t fileSize = file.size();
+		file.close();
+		if (!built) {
+			continue;
+		}
+		Log_Printf(LOGLEVEL_DEBUG, "Seek-table of %s: %u points, %u ms (built in %u ms)", path.c_str(), SeekTable_Building->count, SeekTable_Building->durationMs, millis() - startMs);
+		SeekTable_SaveCache(fileSize, *SeekTable_Building);
+
+		xSemaphoreTake(SeekTable_Mutex, portMAX_DELAY);
+		if (SeekTable_Current->pathHash == SeekTable_Building->pathHash) { // still playing
+			std::swap(SeekTable_Current, SeekTable_Building);
+		}
+		xSemaphoreGive(SeekTable_Mutex);
+	}
+}
+} // namespace
+
+void SeekTable_Init(void) {
+	SeekTable_Current = static_cast<SeekTableData *>(x_malloc(sizeof(SeekTableData)));
+	SeekTable_Building = static_cast<SeekTableData *>(x_malloc(sizeof(SeekTableData)));
+	if (SeekTable_Current == nullptr || SeekTable_Building == nullptr) {
+		Log_Println("Seek-table: unable to allocate memory", LOGLEVEL_ERROR);
+		free(SeekTable_Current);
+		free(SeekTable_Building);
+		SeekTable_Current = SeekTable_Building = nullptr;
+		return;
+	}
+	SeekTable_Reset(*SeekTable_Current, 0);
+	SeekTable_Mutex = xSemaphoreCreateMutex();
+
+	xTaskCreatePinnedToCore(
+		SeekTable_Task, /* Function to implement the task */
+		"seekTable", /* Name of the task */
+		3072, /* Stack size in words */
+		NULL, /* Task input parameter */
+		1, /* Priority of the task */
+		&SeekTable_TaskHandle, /* Task handle. */
+		ARDUINO_RUNNING_CORE /* Core where the task should run */
+	);
+}
+
+void SeekTable_Select(const char *path) {
+	if (SeekTable_Current == nullptr) {
+		return;
+	}
+	const uint32_t pathHash = path ? SeekTable_Hash(path) : 0;
+	xSemaphoreTake(SeekTable_Mutex, portMAX_DELAY);
+	const bool unchanged = SeekTable_Current->pathHash == pathHash;
+	if (!unchanged) {
+		SeekTable_Reset(*SeekTable_Current, pathHash);
+	}
+	xSemaphoreGive(SeekTable_Mutex);
+	if (unchanged || path == nullptr) {
+		return;
+	}
+
+	// Cached tables are small and loaded right away, so resuming can use them
+	File file = gFSystem.open(path, FILE_READ);
+	if (!file || file.isDirectory()) {
+		return;
+	}
+	const uint32_t fileSize = file.size();
+	file.close();
+	xSemaphoreTake(SeekTable_Mutex, portMAX_DELAY);
+	const bool cached = SeekTable_LoadCache(pathHash, fileSize, *SeekTable_Current);
+	if (!cached) {
+		SeekTable_PendingPath = path;
+	}
+	xSemaphoreGive(SeekTable_Mutex);
+	if (!cached) {
+		xTaskNotifyGive(SeekTable_TaskHandle);
+	}
+}
+
+bool SeekTable_GetDurationMs(uint32_t &durationMs) {
+	if (SeekTable_Current == nullptr) {
+		return false;
+	}
+	xSemaphoreTake(SeekTable_Mutex, portMAX_DELAY);
+	const bool valid = SeekTable_Current->count > 1;
+	durationMs = SeekTable_Current->durationMs;
+	xSemaphoreGive(SeekTable_Mutex);
+	return valid;
+}
+
+bool SeekTable_OffsetForTime(uint32_t timeMs, uint32_t &offset) {
+	if (SeekTable_Current == nullptr) {
+		return false;
+	}
+	xSemaphoreTake(SeekTable_Mutex, portMAX_DELAY);
+	const SeekTableData &table = *SeekTable_Current;
+	const bool valid = table.count > 1;
+	if (valid) {
+		const SeekPoint *next = std::upper_bound(table.points, table.points + table.count, timeMs, [](uint32_t time, const SeekPoint &point) {
+			return time < point.timeMs;
+		});
+		if (next == table.points) {
+			offset = next->offset;
+		} else if (next == table.points + table.count) {
+			offset = table.points[table.count - 1].offset;
+		} else {
+			const SeekPoint &prev = *(next - 1);
+			offset = prev.offset + static_cast<uint64_t>(timeMs - prev.timeMs) * (next->offset - prev.offset) / (next->timeMs - prev.timeMs);
+		}
+	}
+	xSemaphoreGive(SeekTable_Mutex);
+	return valid;
+}
+
+bool SeekTable_TimeForOffset(uint32_t offset, uint32_t &timeMs) {
+	if (SeekTable_Current == nullptr) {
+		return false;
+	}
+	xSemaphoreTake(SeekTable_Mutex, portMAX_DELAY);
+	const SeekTableData &table = *SeekTable_Current;
+	const bool valid = table.count > 1;
+	if (valid) {
+		const SeekPoint *next = std::upper_bound(table.points, table.points + table.count, offset, [](uint32_t pos, const SeekPoint &point) {
+			return pos < point.offset;
+		});
+		if (next == table.points) {
+			timeMs = 0;
+		} else if (next == table.points + table.count) {
+			timeMs = table.points[table.count - 1].timeMs;
+		} else {
+			const SeekPoint &prev = *(next - 1);
+			timeMs = prev.timeMs + static_cast<uint64_t>(offset - prev.offset) * (next->timeMs - prev.timeMs) / (next->offset - prev.offset);
+		}
+	}
+	xSemaphoreGive(SeekTable_Mutex);
+	return valid;
+}
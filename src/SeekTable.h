@@ -0,0 +1,11 @@
+#pragma once
+
+// Time <-> byte-offset table of the playing file. For VBR-files the bitrate-based position of the audio-lib
+// is off by minutes (MP3) or not available at all (M4A); the table is taken from the Xing/VBRI-TOC, the MP4
+// sample-tables or a frame-scan (MP3 without TOC) and cached in SEEK_TABLE_DIR. Cache-hits are loaded at once,
+// everything else is built in background. Files without table (FLAC, OGG, WAV, ...) use the audio-lib's positions.
+void SeekTable_Init(void);
+void SeekTable_Select(const char *path); // nullptr: no file
+bool SeekTable_GetDurationMs(uint32_t &durationMs);
+bool SeekTable_OffsetForTime(uint32_t timeMs, uint32_t &offset);
+bool SeekTable_TimeForOffset(uint32_t offset, uint32_t &timeMs);
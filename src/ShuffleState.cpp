@@ -0,0 +1,264 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "ShuffleState.h"
+
+#include "Common.h"
+#include "Log.h"
+#include "Rfid.h"
+
+#include <Preferences.h>
+#include <esp_random.h>
+#include <freertos/semphr.h>
+#include <vector>
+
+namespace {
+constexpr char ShuffleState_Namespace[] = "shuffleState"; // own namespace, as rfidTags only holds assignments
+constexpr char ShuffleState_LruKey[] = "lru"; // tags with a stored state, most recently used first
+constexpr uint8_t ShuffleState_SaveInterval = 5; // finished tracks are saved in batches (and on pause, stop, card-change and shutdown)
+
+struct ShuffleRecord {
+	uint32_t folderHash;
+	uint32_t size; // number of tracks the permutation was made for
+	uint32_t seed;
+	uint32_t nextTrack; // position in playback-order; size = end of the order reached (tracks may have been left out)
+};
+static_assert(sizeof(ShuffleRecord) == 16, "ShuffleRecord is stored in NVS and has to keep its size");
+
+struct ShuffleBag {
+	const Playlist *playlist = nullptr;
+	char rfidTag[cardIdStringSize] = {0};
+	ShuffleRecord record = {};
+	std::vector<uint8_t> played; // bit per stored entry; empty if the playlist exceeds SHUFFLE_STATE_MAX_TRACKS
+	uint8_t unsaved = 0; // finished tracks not yet saved to NVS
+};
+
+Preferences ShuffleState_Prefs;
+SemaphoreHandle_t ShuffleState_Mutex = nullptr;
+ShuffleBag ShuffleState_Pending; // prepared by the dispatcher
+ShuffleBag ShuffleState_Active; // playlist of the audio-task
+
+uint32_t ShuffleState_Hash(const char *folder) {
+	uint32_t hash = 2166136261u; // FNV-1a
+	for (; *folder; folder++) {
+		hash ^= static_cast<uint8_t>(*folder);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+bool ShuffleState_IsPlayed(const ShuffleBag &bag, size_t trackNumber) {
+	if (bag.played.empty()) {
+		return false;
+	}
+	const size_t position = bag.playlist->order()(trackNumber);
+	return bag.played[position / 8] & (1u << (position % 8));
+}
+
+size_t ShuffleState_SkipPlayed(const ShuffleBag &bag, size_t trackNumber) {
+	while (trackNumber < bag.record.size && ShuffleState_IsPlayed(bag, trackNumber)) {
+		trackNumber++;
+	}
+	return trackNumber;
+}
+
+// All tracks were played, wherever they are in the order (e.g. some were left out by jumping to the last track)
+bool ShuffleState_IsComplete(const ShuffleBag &bag) {
+	if (bag.played.empty()) {
+		return bag.record.nextTrack >= bag.record.size; // without bitmap only the position is known
+	}
+	const size_t fullBytes = bag.record.size / 8;
+	for (size_t i = 0; i < fullBytes; i++) {
+		if (bag.played[i] != 0xFF) {
+			return false;
+		}
+	}
+	const uint8_t lastMask = (1u << (bag.record.size % 8)) - 1;
+	return (bag.record.size % 8 == 0) || (bag.played[fullBytes] & lastMask) == lastMask;
+}
+
+void ShuffleState_Touch(const char *rfidTag) {
+	char lru[SHUFFLE_STATE_CARDS][cardIdStringSize] = {};
+	if (ShuffleState_Prefs.getBytesLength(ShuffleState_LruKey) == sizeof(lru)) {
+		ShuffleState_Prefs.getBytes(ShuffleState_LruKey, lru, sizeof(lru));
+	}
+	if (strncmp(lru[0], rfidTag, cardIdStringSize) == 0) {
+		return;
+	}
+	// move the tag to the front; the last one is dropped if the tag is new
+	size_t last = SHUFFLE_STATE_CARDS - 1;
+	for (size_t i = 0; i < SHUFFLE_STATE_CARDS; i++) {
+		if (strncmp(lru[i], rfidTag, cardIdStringSize) == 0) {
+			last = i;
+			break;
+		}
+	}
+	if (last == SHUFFLE_STATE_CARDS - 1 && lru[last][0] != '\0' && strncmp(lru[last], rfidTag, cardIdStringSize) != 0) {
+		ShuffleState_Prefs.remove(lru[last]);
+	}
+	memmove(lru[1], lru[0], last * cardIdStringSize);
+	copyStringToBuffer(lru[0], cardIdStringSize, rfidTag);
+	ShuffleState_Prefs.putBytes(ShuffleState_LruKey, lru, sizeof(lru));
+}
+
+void ShuffleState_Save(ShuffleBag &bag) {
+	std::vector<uint8_t> blob(sizeof(ShuffleRecord) + bag.played.size());
+	memcpy(blob.data(), &bag.record, sizeof(ShuffleRecord));
+	std::copy(bag.played.begin(), bag.played.end(), blob.begin() + sizeof(ShuffleRecord));
+	ShuffleState_Prefs.putBytes(bag.rfidTag, blob.data(), blob.size());
+	ShuffleState_Touch(bag.rfidTag);
+	bag.unsaved = 0;
+}
+
+void ShuffleState_SaveIfChanged(ShuffleBag &bag) {
+	if (bag.playlist != nullptr && bag.unsaved > 0) {
+		ShuffleState_Save(bag);
+	}
+}
+
+void ShuffleState_Reset(ShuffleBag &bag, uint32_t folderHash, size_t size) {
+	bag.record = ShuffleRecord {folderHash, static_cast<uint32_t>(size), esp_random(), 0};
+	bag.played.assign(size <= SHUFFLE_STATE_MAX_TRACKS ? (size + 7) / 8 : 0, 0);
+}
+} // namespace
+
+void ShuffleState_Init(void) {
+	ShuffleState_Mutex = xSemaphoreCreateMutex();
+	ShuffleState_Prefs.begin(ShuffleState_Namespace);
+}
+
+size_t ShuffleState_Restore(const char *rfidTag, const char *folder, Playlist *playlist) {
+	const size_t size = playlist->size();
+	if (rfidTag == nullptr || rfidTag[0] == '\0' || size < 2) {
+		// not started by a card: nothing to continue
+		if (size >= 2) {
+			playlist->shuffle(esp_random());
+		}
+		return 0;
+	}
+
+	ShuffleBag bag;
+	bag.playlist = playlist;
+	copyStringToBuffer(bag.rfidTag, sizeof(bag.rfidTag), rfidTag);
+	const uint32_t folderHash = ShuffleState_Hash(folder);
+
+	xSemaphoreTake(ShuffleState_Mutex, portMAX_DELAY);
+	ShuffleState_SaveIfChanged(ShuffleState_Active); // the card might be the one that's playing
+	const size_t length = ShuffleState_Prefs.getBytesLength(rfidTag);
+	bool restored = false;
+	if (length >= sizeof(ShuffleRecord)) {
+		std::vector<uint8_t> blob(length);
+		ShuffleState_Prefs.getBytes(rfidTag, blob.data(), length);
+		memcpy(&bag.record, blob.data(), sizeof(ShuffleRecord));
+		bag.played.assign(blob.begin() + sizeof(ShuffleRecord), blob.end());
+		const size_t bitmapSize = (size <= SHUFFLE_STATE_MAX_TRACKS) ? (size + 7) / 8 : 0;
+		restored = bag.record.folderHash == folderHash && bag.record.size == size && bag.played.size() == bitmapSize && !ShuffleState_IsComplete(bag);
+	}
+	if (!restored) {
+		ShuffleState_Reset(bag, folderHash, size);
+		Log_Printf(LOGLEVEL_NOTICE, "Shuffle: new bag for %s", rfidTag);
+	}
+	playlist->shuffle(bag.record.seed);
+	if (restored) {
+		// at the interrupted track, or the first one that was left out (after the end of the order was reached)
+		bag.record.nextTrack = ShuffleState_SkipPlayed(bag, bag.record.nextTrack);
+		if (bag.record.nextTrack >= size) {
+			bag.record.nextTrack = ShuffleState_SkipPlayed(bag, 0);
+		}
+		Log_Printf(LOGLEVEL_NOTICE, "Shuffle: continuing bag of %s at track %u/%u", rfidTag, bag.record.nextTrack + 1, size);
+	}
+	const size_t startTrack = bag.record.nextTrack;
+	ShuffleState_Pending = std::move(bag);
+	xSemaphoreGive(ShuffleState_Mutex);
+	return startTrack;
+}
+
+void ShuffleState_Discard(const Playlist *playlist) {
+	xSemaphoreTake(ShuffleState_Mutex, portMAX_DELAY);
+	if (ShuffleState_Pending.playlist == playlist) {
+		ShuffleState_Pending = ShuffleBag {};
+	}
+	xSemaphoreGive(ShuffleState_Mutex);
+}
+
+void ShuffleState_Activate(const Playlist *playlist) {
+	xSemaphoreTake(ShuffleState_Mutex, portMAX_DELAY);
+	ShuffleState_SaveIfChanged(ShuffleState_Active);
+	if (ShuffleState_Pending.playlist == playlist) {
+		ShuffleState_Active = std::move(ShuffleState_Pending);
+		ShuffleState_Pending = ShuffleBag {};
+		ShuffleState_Save(ShuffleState_Active);
+	} else {
+		ShuffleState_Active = ShuffleBag {};
+	}
+	xSemaphoreGive(ShuffleState_Mutex);
+}
+
+void ShuffleState_TrackFinished(const Playlist *playlist, size_t trackNumber) {
+	xSemaphoreTake(ShuffleState_Mutex, portMAX_DELAY);
+	ShuffleBag &bag = ShuffleState_Active;
+	if (bag.playlist == playlist && playlist != nullptr && trackNumber < bag.record.size) {
+		if (!bag.played.empty()) {
+			const size_t position = playlist->order()(trackNumber);
+			bag.played[position / 8] |= 1u << (position % 8);
+		}
+		bag.record.nextTrack = ShuffleState_SkipPlayed(bag, trackNumber + 1);
+		if (++bag.unsaved >= ShuffleState_SaveInterval) {
+			ShuffleState_Save(bag);
+		}
+	}
+	xSemaphoreGive(ShuffleState_Mutex);
+}
+
+size_t ShuffleState_NextTrack(const Playlist *playlist, size_t trackNumber) {
+	xSemaphoreTake(ShuffleState_Mutex, portMAX_DELAY);
+	if (ShuffleState_Active.playlist == playlist && playlist != nullptr) {
+		trackNumber = ShuffleState_SkipPlayed(ShuffleState_Active, trackNumber);
+	}
+	xSemaphoreGive(ShuffleState_Mutex);
+	return trackNumber;
+}
+
+// The playlist repeats: a new order is drawn if all tracks were played, otherwise the bag goes on with the ones left out
+bool ShuffleState_NewBag(Playlist *playlist) {
+	xSemaphoreTake(ShuffleState_Mutex, portMAX_DELAY);
+	ShuffleBag &bag = ShuffleState_Active;
+	const bool active = bag.playlist == playlist && playlist != nullptr && ShuffleState_IsComplete(bag);
+	if (active) {
+		ShuffleState_Reset(bag, bag.record.folderHash, playlist->size());
+		playlist->shuffle(bag.record.seed);
+		ShuffleState_Save(bag);
+		Log_Printf(LOGLEVEL_NOTICE, "Shuffle: new bag for %s", bag.rfidTag);
+	}
+	xSemaphoreGive(ShuffleState_Mutex);
+	return active;
+}
+
+void ShuffleState_Flush(void) {
+	xSemaphoreTake(ShuffleState_Mutex, portMAX_DELAY);
+	ShuffleState_SaveIfChanged(ShuffleState_Active);
+	xSemaphoreGive(ShuffleState_Mutex);
+}
+
+void ShuffleState_Release(const Playlist *playlist) {
+	xSemaphoreTake(ShuffleState_Mutex, portMAX_DELAY);
+	if (ShuffleState_Active.playlist == playlist) {
+		ShuffleState_SaveIfChanged(ShuffleState_Active);
+		ShuffleState_Active = ShuffleBag {};
+	}
+	xSemaphoreGive(ShuffleState_Mutex);
+}
+
+void ShuffleState_Forget(const char *rfidTag) {
+	xSemaphoreTake(ShuffleState_Mutex, portMAX_DELAY);
+	if (ShuffleState_Prefs.isKey(rfidTag)) {
+		ShuffleState_Prefs.remove(rfidTag);
+	}
+	if (strncmp(ShuffleState_Active.rfidTag, rfidTag, cardIdStringSize) == 0) {
+		ShuffleState_Active = ShuffleBag {};
+	}
+	if (strncmp(ShuffleState_Pending.rfidTag, rfidTag, cardIdStringSize) == 0) {
+		ShuffleState_Pending = ShuffleBag {};
+	}
+	xSemaphoreGive(ShuffleState_Mutex);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Playlist.h"
+
+// Shuffle-state of random-mode cards ("no repeat until all played"): seed of the playlist's permutation, the
+// next track and a bitmap of played entries are kept per RFID-tag in NVS. Tapping the card again continues
+// the bag; a new order is drawn only when all tracks were played (or the directory changed).
+// The state is prepared by the dispatcher and becomes active once the playlist reaches the audio-task.
+// Finished tracks are written to NVS in batches; ShuffleState_Flush() writes what's left (pause, stop, shutdown).
+void ShuffleState_Init(void);
+size_t ShuffleState_Restore(const char *rfidTag, const char *folder, Playlist *playlist); // shuffles playlist, returns the track to start with
+void ShuffleState_Discard(const Playlist *playlist); // playlist was dropped before reaching the audio-task
+void ShuffleState_Activate(const Playlist *playlist);
+void ShuffleState_TrackFinished(const Playlist *playlist, size_t trackNumber);
+size_t ShuffleState_NextTrack(const Playlist *playlist, size_t trackNumber); // skips tracks that were already played
+bool ShuffleState_NewBag(Playlist *playlist); // true if a new order was drawn (all tracks played)
+void ShuffleState_Flush(void);
+void ShuffleState_Release(const Playlist *playlist); // playlist was edited: the bag keeps the state it had up to the edit
+void ShuffleState_Forget(const char *rfidTag);
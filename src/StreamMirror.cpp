@@ -0,0 +1,399 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "StreamMirror.h"
+
+#include "Audio.h"
+#include "Log.h"
+#include "System.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <freertos/semphr.h>
+#include <lwip/netdb.h>
+#include <lwip/sockets.h>
+#include <vector>
+
+namespace {
+constexpr char StreamMirror_NvsKey[] = "mirrorStats";
+constexpr uint16_t StreamMirror_UnknownConnectMs = AUDIO_CONNECTION_TIMEOUT_MS / 2; // assumed connect-time of mirrors without history
+constexpr uint32_t StreamMirror_NotMeasured = UINT32_MAX; // connect of the audio-lib: counts as success, its time isn't a TCP-connect
+constexpr uint16_t StreamMirror_SaveDeltaMs = 50; // smaller changes of a connect-time aren't worth a write to NVS
+constexpr uint32_t StreamMirror_ConnectBudgetMs = 2 * AUDIO_CONNECTION_TIMEOUT_SSL_MS; // no further mirror is tried after this
+constexpr uint32_t StreamMirror_RecentFailureMs = 10 * 60 * 1000; // a mirror that failed within this time is tried last
+constexpr uint32_t StreamMirror_RecentFailurePenalty = 100000; // behind every score of a mirror that didn't fail recently
+
+struct MirrorRecord {
+	uint32_t urlHash;
+	uint16_t avgConnectMs; // smoothed TCP connect-time
+	uint8_t successes;
+	uint8_t failures;
+};
+static_assert(sizeof(MirrorRecord) == 8, "MirrorRecord is stored in NVS and has to keep its size");
+
+struct MirrorCandidate {
+	String url;
+	uint32_t urlHash;
+	uint32_t score; // lower is better
+	int sock;
+	bool connected;
+	bool failed; // not resolvable, connect refused / reset or timed out
+	uint32_t connectMs;
+};
+
+MirrorRecord StreamMirror_Records[streamMirrorStatsEntries] = {};
+MirrorRecord StreamMirror_Persisted[streamMirrorStatsEntries] = {}; // as stored in NVS
+uint32_t StreamMirror_FailedAtMs[streamMirrorStatsEntries] = {}; // last failure of a record since boot (0 = none); not persisted
+StreamMirrorStats StreamMirror_Stats;
+SemaphoreHandle_t StreamMirror_Mutex = nullptr; // records and probe-request (audio- and probe-task)
+TaskHandle_t StreamMirror_ProbeTaskHandle = nullptr;
+String StreamMirror_ProbeEntry; // mirrors to be probed
+uint32_t StreamMirror_ProbeSkipHash = 0; // the mirror the audio-lib is connected to
+
+uint32_t StreamMirror_Hash(const String &url) {
+	uint32_t hash = 2166136261u; // FNV-1a
+	for (size_t i = 0; i < url.length(); i++) {
+		hash ^= static_cast<uint8_t>(url[i]);
+		hash *= 16777619u;
+	}
+	return hash ? hash : 1u; // 0 marks an unused record
+}
+
+MirrorRecord *StreamMirror_FindRecord(uint32_t urlHash) {
+	for (MirrorRecord &record : StreamMirror_Records) {
+		if (record.urlHash == urlHash) {
+			return &record;
+		}
+	}
+	return nullptr;
+}
+
+uint32_t StreamMirror_Score(uint32_t urlHash) {
+	xSemaphoreTake(StreamMirror_Mutex, portMAX_DELAY);
+	const MirrorRecord *record = StreamMirror_FindRecord(urlHash);
+	uint32_t score = StreamMirror_UnknownConnectMs;
+	if (record != nullptr) {
+		// every failure (relative to all attempts) weighs like a second of connect-time
+		const uint32_t attempts = record->successes + record->failures;
+		score = record->avgConnectMs + (attempts ? (record->failures * 1000u) / attempts : 0);
+		const uint32_t failedAtMs = StreamMirror_FailedAtMs[record - StreamMirror_Records];
+		if (failedAtMs != 0 && (millis() - failedAtMs) < StreamMirror_RecentFailureMs) {
+			score += StreamMirror_RecentFailurePenalty;
+		}
+	}
+	xSemaphoreGive(StreamMirror_Mutex);
+	return score;
+}
+
+// Counting another success is no reason to write to flash: only new records, failures and noticeable changes of the
+// connect-time are persisted (successes are written along with the next of those)
+bool StreamMirror_ChangedNoticeably(const MirrorRecord &stored, const MirrorRecord &current) {
+	return stored.urlHash != current.urlHash || stored.failures != current.failures || abs(static_cast<int32_t>(stored.avgConnectMs) - static_cast<int32_t>(current.avgConnectMs)) >= StreamMirror_SaveDeltaMs;
+}
+
+void StreamMirror_SaveIfChanged(void) {
+	MirrorRecord records[streamMirrorStatsEntries];
+	bool changed = false;
+	xSemaphoreTake(StreamMirror_Mutex, portMAX_DELAY);
+	for (uint8_t i = 0; i < streamMirrorStatsEntries; i++) {
+		changed |= StreamMirror_ChangedNoticeably(StreamMirror_Persisted[i], StreamMirror_Records[i]);
+	}
+	if (changed) {
+		memcpy(records, StreamMirror_Records, sizeof(records));
+		memcpy(StreamMirror_Persisted, StreamMirror_Records, sizeof(StreamMirror_Persisted));
+	}
+	xSemaphoreGive(StreamMirror_Mutex);
+	if (changed) {
+		gPrefsSettings.putBytes(StreamMirror_NvsKey, records, sizeof(records));
+	}
+}
+
+// connectMs is StreamMirror_NotMeasured for connects of the audio-lib
+void StreamMirror_Remember(uint32_t urlHash, bool success, uint32_t connectMs) {
+	xSemaphoreTake(StreamMirror_Mutex, portMAX_DELAY);
+	MirrorRecord *record = StreamMirror_FindRecord(urlHash);
+	if (record == nullptr) {
+		// replace an unused or the least used record
+		record = &StreamMirror_Records[0];
+		for (MirrorRecord &candidate : StreamMirror_Records) {
+			if (candidate.urlHash == 0) {
+				record = &candidate;
+				break;
+			}
+			if ((candidate.successes + candidate.failures) < (record->successes + record->failures)) {
+				record = &candidate;
+			}
+		}
+		*record = MirrorRecord {urlHash, StreamMirror_UnknownConnectMs, 0, 0};
+		StreamMirror_FailedAtMs[record - StreamMirror_Records] = 0;
+	}
+
+	if (success) {
+		if (connectMs != StreamMirror_NotMeasured) {
+			record->avgConnectMs = (record->avgConnectMs * 3 + std::min<uint32_t>(connectMs, UINT16_MAX)) / 4;
+		}
+		if (record->successes == UINT8_MAX) {
+			record->successes /= 2; // keep the ratio, forget old history
+			record->failures /= 2;
+		}
+		record->successes++;
+		StreamMirror_FailedAtMs[record - StreamMirror_Records] = 0;
+	} else {
+		if (record->failures == UINT8_MAX) {
+			record->successes /= 2;
+			record->failures /= 2;
+		}
+		record->failures++;
+		StreamMirror_FailedAtMs[record - StreamMirror_Records] = std::max<uint32_t>(millis(), 1);
+	}
+	xSemaphoreGive(StreamMirror_Mutex);
+}
+
+// Splits "http://host[:port]/path" into host and port
+bool StreamMirror_ParseHost(const String &url, String &host, uint16_t &port) {
+	const bool tls = url.startsWith("https://");
+	const int hostStart = url.indexOf("://");
+	if (hostStart < 0) {
+		return false;
+	}
+	int hostEnd = url.indexOf('/', hostStart + 3);
+	if (hostEnd < 0) {
+		hostEnd = url.length();
+	}
+	host = url.substring(hostStart + 3, hostEnd);
+	const int at = host.lastIndexOf('@'); // user:password@host
+	if (at >= 0) {
+		host = host.substring(at + 1);
+	}
+	port = tls ? 443 : 80;
+	const int colon = host.indexOf(':');
+	if (colon >= 0) {
+		port = host.substring(colon + 1).toInt();
+		host = host.substring(0, colon);
+	}
+	return host.length() > 0 && port > 0;
+}
+
+// Starts a non-blocking TCP-connect; returns the socket or -1
+int StreamMirror_StartConnect(const String &url) {
+	String host;
+	uint16_t port;
+	if (!StreamMirror_ParseHost(url, host, port)) {
+		return -1;
+	}
+
+	struct addrinfo hints = {};
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	struct addrinfo *result = nullptr;
+	if (lwip_getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || result == nullptr) {
+		Log_Printf(LOGLEVEL_DEBUG, "Mirror: unable to resolve %s", host.c_str());
+		return -1;
+	}
+	struct sockaddr_in address = *reinterpret_cast<struct sockaddr_in *>(result->ai_addr);
+	lwip_freeaddrinfo(result);
+	address.sin_port = htons(port);
+
+	const int sock = lwip_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (sock < 0) {
+		return -1;
+	}
+	lwip_fcntl(sock, F_SETFL, lwip_fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+	if (lwip_connect(sock, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) < 0 && errno != EINPROGRESS) {
+		lwip_close(sock);
+		return -1;
+	}
+	return sock;
+}
+
+// Starts TCP-connects to all candidates at once and waits until each one is established or failed; a mirror that
+// doesn't answer within the timeout counts as failed. Sockets are closed right after the connect.
+void StreamMirror_Probe(std::vector<MirrorCandidate> &candidates) {
+	const uint32_t startMs = millis();
+	for (MirrorCandidate &candidate : candidates) {
+		candidate.sock = StreamMirror_StartConnect(candidate.url);
+		candidate.failed = candidate.sock < 0;
+	}
+
+	const uint32_t timeoutMs = AUDIO_CONNECTION_TIMEOUT_SSL_MS;
+	while ((millis() - startMs) < timeoutMs) {
+		fd_set writeSet;
+		FD_ZERO(&writeSet);
+		int maxSock = -1;
+		for (const MirrorCandidate &candidate : candidates) {
+			if (candidate.sock >= 0) {
+				FD_SET(candidate.sock, &writeSet);
+				maxSock = std::max(maxSock, candidate.sock);
+			}
+		}
+		if (maxSock < 0) {
+			break; // all connects are done
+		}
+		struct timeval tv = {0, 50 * 1000};
+		if (lwip_select(maxSock + 1, nullptr, &writeSet, nullptr, &tv) <= 0) {
+			continue;
+		}
+		for (MirrorCandidate &candidate : candidates) {
+			if (candidate.sock < 0 || !FD_ISSET(candidate.sock, &writeSet)) {
+				continue;
+			}
+			int error = 0;
+			socklen_t len = sizeof(error);
+			lwip_getsockopt(candidate.sock, SOL_SOCKET, SO_ERROR, &error, &len);
+			if (error == 0) {
+				candidate.connected = true;
+				candidate.connectMs = millis() - startMs;
+			} else {
+				candidate.failed = true;
+			}
+			lwip_close(candidate.sock);
+			candidate.sock = -1;
+		}
+	}
+
+	for (MirrorCandidate &candidate : candidates) {
+		if (candidate.sock >= 0) {
+			lwip_close(candidate.sock);
+			candidate.sock = -1;
+			candidate.failed = true;
+		}
+	}
+}
+
+// Splits an entry into its mirrors (up to streamMirrorMax), ordered by score
+void StreamMirror_ParseEntry(const char *entry, std::vector<MirrorCandidate> &candidates) {
+	const String mirrors = entry;
+	int start = 0;
+	while (start <= (int) mirrors.length() && candidates.size() < streamMirrorMax) {
+		int end = mirrors.indexOf(streamMirrorSeparator, start);
+		if (end < 0) {
+			end = mirrors.length();
+		}
+		String url = mirrors.substring(start, end);
+		url.trim();
+		if (url.length()) {
+			const uint32_t urlHash = StreamMirror_Hash(url);
+			candidates.push_back(MirrorCandidate {url, urlHash, StreamMirror_Score(urlHash), -1, false, false, 0});
+		}
+		start = end + 1;
+	}
+	std::stable_sort(candidates.begin(), candidates.end(), [](const MirrorCandidate &a, const MirrorCandidate &b) {
+		return a.score < b.score;
+	});
+}
+
+// Measures the connect-time of the mirrors of the entry connected last, beside playback: the audio-task never waits
+// for mirrors. The mirror the audio-lib is connected to is left out, it just answered and connecting it again would
+// cost another handshake.
+void StreamMirror_ProbeTask(void *parameter) {
+	for (;;) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		xSemaphoreTake(StreamMirror_Mutex, portMAX_DELAY);
+		const String entry = StreamMirror_ProbeEntry;
+		const uint32_t skipHash = StreamMirror_ProbeSkipHash;
+		xSemaphoreGive(StreamMirror_Mutex);
+
+		std::vector<MirrorCandidate> candidates;
+		StreamMirror_ParseEntry(entry.c_str(), candidates);
+		candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [skipHash](const MirrorCandidate &candidate) {
+			return candidate.urlHash == skipHash;
+		}),
+			candidates.end());
+		if (candidates.empty()) {
+			continue;
+		}
+		StreamMirror_Probe(candidates);
+		for (const MirrorCandidate &candidate : candidates) {
+			StreamMirror_Remember(candidate.urlHash, candidate.connected, candidate.connectMs);
+		}
+		StreamMirror_Stats.probes++;
+		StreamMirror_SaveIfChanged();
+	}
+}
+
+void StreamMirror_RequestProbe(const char *entry, uint32_t skipHash) {
+	if (StreamMirror_ProbeTaskHandle == nullptr) {
+		return;
+	}
+	xSemaphoreTake(StreamMirror_Mutex, portMAX_DELAY);
+	StreamMirror_ProbeEntry = entry;
+	StreamMirror_ProbeSkipHash = skipHash;
+	xSemaphoreGive(StreamMirror_Mutex);
+	xTaskNotifyGive(StreamMirror_ProbeTaskHandle);
+}
+
+// Every connect of the audio-lib to a stream-host; https means a full TLS-handshake (the lib can't resume sessions)
+bool StreamMirror_ConnectHost(Audio *audio, const char *url) {
+	const uint32_t startMs = millis();
+	const bool connected = audio->connecttohost(url);
+	StreamMirror_Stats.connects++;
+	if (strncmp(url, "https", 5) == 0) {
+		StreamMirror_Stats.tlsHandshakes++;
+	}
+	StreamMirror_Stats.lastConnectMs = millis() - startMs;
+	return connected;
+}
+} // namespace
+
+void StreamMirror_Init(void) {
+	StreamMirror_Mutex = xSemaphoreCreateMutex();
+	if (gPrefsSettings.getBytesLength(StreamMirror_NvsKey) == sizeof(StreamMirror_Records)) {
+		gPrefsSettings.getBytes(StreamMirror_NvsKey, StreamMirror_Records, sizeof(StreamMirror_Records));
+	}
+	memcpy(StreamMirror_Persisted, StreamMirror_Records, sizeof(StreamMirror_Persisted));
+
+	xTaskCreatePinnedToCore(
+		StreamMirror_ProbeTask, /* Function to implement the task */
+		"mirrorProbe", /* Name of the task */
+		3072, /* Stack size in words */
+		NULL, /* Task input parameter */
+		1, /* Priority of the task */
+		&StreamMirror_ProbeTaskHandle, /* Task handle. */
+		ARDUINO_RUNNING_CORE /* Core where the task should run */
+	);
+}
+
+bool StreamMirror_HasMirrors(const char *entry) {
+	return entry != nullptr && strchr(entry, streamMirrorSeparator) != nullptr;
+}
+
+// Connects the audio-lib to the best mirror of an entry (by the stats of earlier connects and probes); if that one
+// fails, the next ones are tried until StreamMirror_ConnectBudgetMs is used up. Entries without mirrors are connected
+// directly.
+bool StreamMirror_Connect(Audio *audio, const char *entry) {
+	if (!StreamMirror_HasMirrors(entry)) {
+		return StreamMirror_ConnectHost(audio, entry);
+	}
+
+	std::vector<MirrorCandidate> candidates;
+	StreamMirror_ParseEntry(entry, candidates);
+	bool connected = false;
+	uint32_t connectedHash = 0;
+	const uint32_t startMs = millis();
+	for (size_t i = 0; i < candidates.size() && !connected; i++) {
+		if (i > 0 && (millis() - startMs) >= StreamMirror_ConnectBudgetMs) {
+			Log_Printf(LOGLEVEL_NOTICE, "Mirror: %u mirror(s) left untried after %u ms", static_cast<unsigned>(candidates.size() - i), static_cast<unsigned>(millis() - startMs));
+			break;
+		}
+		const MirrorCandidate &candidate = candidates[i];
+		Log_Printf(LOGLEVEL_INFO, "Mirror: %s", candidate.url.c_str());
+		connected = StreamMirror_ConnectHost(audio, candidate.url.c_str());
+		StreamMirror_Remember(candidate.urlHash, connected, StreamMirror_NotMeasured);
+		if (connected) {
+			connectedHash = candidate.urlHash;
+			if (i > 0) {
+				StreamMirror_Stats.fallbacks++;
+			}
+		}
+	}
+	if (!connected) {
+		StreamMirror_Stats.failures++;
+	}
+	StreamMirror_SaveIfChanged();
+	StreamMirror_RequestProbe(entry, connectedHash);
+	return connected;
+}
+
+void StreamMirror_GetStats(StreamMirrorStats &stats) {
+	stats = StreamMirror_Stats;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+class Audio;
+
+// Webstream entries (RFID-assignment or m3u-line) may contain several mirror-URLs of the same
+// station, separated by '|'. The audio-lib is connected to the mirror with the best stats; after
+// that, the other mirrors are probed (TCP-connect) in background. Per-mirror success and
+// connect-time are kept in NVS so the fastest mirror is preferred next time.
+constexpr char streamMirrorSeparator = '|';
+constexpr uint8_t streamMirrorMax = 4; // mirrors per entry that are taken into account
+constexpr uint8_t streamMirrorStatsEntries = 16; // mirrors remembered in NVS
+
+typedef struct {
+	uint32_t probes = 0; // background-measurements of the other mirrors
+	uint32_t fallbacks = 0; // best mirror failed in audio-lib, the next one was used
+	uint32_t failures = 0; // no mirror could be connected
+	uint32_t connects = 0; // connects of the audio-lib to stream-hosts
+	uint32_t tlsHandshakes = 0; // https-connects: each one is a full handshake
+	uint32_t lastConnectMs = 0;
+} StreamMirrorStats;
+
+void StreamMirror_Init(void);
+bool StreamMirror_HasMirrors(const char *entry);
+bool StreamMirror_Connect(Audio *audio, const char *entry);
+void StreamMirror_GetStats(StreamMirrorStats &stats);
@@ -4,6 +4,7 @@
 #include "System.h"
 
 #include "Audio.h"
+#include "AudioFade.h"
 #include "AudioPlayer.h"
 #include "Bluetooth.h"
 #include "Ftp.h"
@@ -33,12 +34,14 @@ bool System_Sleeping = false; // Flag for turning into deepsleep is in progress
 bool System_LockControls = false; // Flag if buttons and rotary encoder is locked
 uint8_t System_MaxInactivityTime = 10u; // Time in minutes, after uC is put to deep sleep because of inactivity (and modified later via GUI)
 uint8_t System_SleepTimer = 30u; // Sleep timer in minutes that can be optionally used (and modified later via MQTT or RFID)
+bool System_SleepFadeActive = false; // Flag if audio is faded out because the sleep-timer is about to expire
 
 // Operation Mode
 volatile uint8_t System_OperationMode;
 
 void System_SleepHandler(void);
 void System_DeepSleepManager(void);
+static void System_CancelSleepFade(void);
 static void System_SetInputIfGpio(int16_t gpio);
 static void System_ReleasePeripheralPinsForDeepSleep(void);
 
@@ -112,6 +115,7 @@ void System_RequestSleep(void) {
 bool System_SetSleepTimer(uint8_t minutes) {
 	bool sleepTimerEnabled = false;
 
+	System_CancelSleepFade();
 	if (System_SleepTimerStartTimestamp && (System_SleepTimer == minutes)) {
 		System_SleepTimerStartTimestamp = 0u;
 		System_SleepTimer = 0u;
@@ -143,6 +147,7 @@ bool System_SetSleepTimer(uint8_t minutes) {
 
 void System_DisableSleepTimer(void) {
 	System_SleepTimerStartTimestamp = 0u;
+	System_CancelSleepFade();
 	Led_SetNightmode(false);
 }
 
@@ -208,13 +213,26 @@ void System_SleepHandler(void) {
 		Log_Println(goToSleepDueToIdle, LOGLEVEL_INFO);
 		System_RequestSleep();
 	} else if (System_SleepTimerStartTimestamp > 00) {
-		if (m - System_SleepTimerStartTimestamp >= (System_SleepTimer * 1000u * 60u)) {
+		const uint32_t sleepTimerMs = System_SleepTimer * 1000u * 60u;
+		const uint32_t elapsedMs = m - System_SleepTimerStartTimestamp;
+		if (elapsedMs >= sleepTimerMs) {
 			Log_Println(goToSleepDueToTimer, LOGLEVEL_INFO);
 			System_RequestSleep();
+		} else if (!System_SleepFadeActive && sleepTimerMs - elapsedMs <= AUDIO_SLEEP_FADE_MS) {
+			// fade out slowly, so the timer ends in silence
+			System_SleepFadeActive = true;
+			AudioFade_To(AudioFadeEnvelope::Sleep, 0, sleepTimerMs - elapsedMs);
 		}
 	}
 }
 
+static void System_CancelSleepFade(void) {
+	if (System_SleepFadeActive) {
+		System_SleepFadeActive = false;
+		AudioFade_To(AudioFadeEnvelope::Sleep, audioFadeUnity, AUDIO_FADE_PAUSE_MS);
+	}
+}
+
 // prepare power down
 void System_PreparePowerDown(void) {
 
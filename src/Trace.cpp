@@ -0,0 +1,113 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Trace.h"
+
+#include "Log.h"
+#include "MemX.h"
+
+#include <esp_timer.h>
+#include <freertos/task.h>
+
+#ifdef TRACE_ENABLE
+
+// One ring per core: writers only mask interrupts on their own core and never contend with each other.
+struct TraceRing {
+	TraceEvent *events = nullptr;
+	uint32_t head = 0; // total number of events written (wraps at TRACE_EVENTS_PER_CORE for indexing)
+};
+
+static TraceRing Trace_Rings[portNUM_PROCESSORS];
+static volatile bool Trace_Active = false;
+
+static const char *Trace_EventNames[] = {
+	"playlistGenerate",
+	"playlistSort",
+	"playlistShuffle",
+	"audioConnect",
+	"nvsWrite",
+	"sdUploadWrite",
+	"rfidPoll",
+	"websocketSend",
+};
+static_assert(sizeof(Trace_EventNames) / sizeof(Trace_EventNames[0]) == static_cast<size_t>(TraceEventId::Count), "Trace_EventNames out of sync with TraceEventId");
+
+void Trace_Init(void) {
+	for (uint8_t core = 0; core < portNUM_PROCESSORS; core++) {
+		// events are only touched by the CPU, so PSRAM is fine (and saves internal RAM)
+		Trace_Rings[core].events = static_cast<TraceEvent *>(x_malloc(sizeof(TraceEvent) * TRACE_EVENTS_PER_CORE));
+		if (Trace_Rings[core].events == nullptr) {
+			Log_Println("Trace: unable to allocate ring-buffer", LOGLEVEL_ERROR);
+			return;
+		}
+		Trace_Rings[core].head = 0;
+	}
+	Trace_Active = true;
+	Log_Printf(LOGLEVEL_DEBUG, "Trace: %u events per core enabled", TRACE_EVENTS_PER_CORE);
+}
+
+void Trace_Record(TraceEventId id, TraceEventPhase phase) {
+	if (!Trace_Active) {
+		return;
+	}
+	// Masking interrupts on the local core prevents preemption (and migration) while the slot is claimed
+	const UBaseType_t irqState = portSET_INTERRUPT_MASK_FROM_ISR();
+	const uint8_t core = xPortGetCoreID();
+	TraceRing &ring = Trace_Rings[core];
+	TraceEvent &event = ring.events[ring.head % TRACE_EVENTS_PER_CORE];
+	ring.head++;
+	event.timestampUs = esp_timer_get_time();
+	memcpy(event.task, pcTaskGetName(NULL), sizeof(event.task));
+	event.id = id;
+	event.phase = phase;
+	event.core = core;
+	event.reserved = 0;
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(irqState);
+}
+
+// Copies the buffered events (oldest first per core) into dest. Recording is suspended meanwhile.
+size_t Trace_Snapshot(TraceEvent *dest, size_t maxEvents) {
+	if (dest == nullptr || Trace_Rings[0].events == nullptr) {
+		return 0;
+	}
+	const bool wasActive = Trace_Active;
+	Trace_Active = false;
+	vTaskDelay(1); // let a writer on the other core finish its slot
+
+	size_t count = 0;
+	for (uint8_t core = 0; core < portNUM_PROCESSORS; core++) {
+		const TraceRing &ring = Trace_Rings[core];
+		const uint32_t available = std::min<uint32_t>(ring.head, TRACE_EVENTS_PER_CORE);
+		const uint32_t first = ring.head - available;
+		for (uint32_t i = 0; i < available && count < maxEvents; i++) {
+			dest[count++] = ring.events[(first + i) % TRACE_EVENTS_PER_CORE];
+		}
+	}
+
+	Trace_Active = wasActive;
+	return count;
+}
+
+size_t Trace_GetCapacity(void) {
+	return TRACE_EVENTS_PER_CORE * portNUM_PROCESSORS;
+}
+
+void Trace_Clear(void) {
+	const bool wasActive = Trace_Active;
+	Trace_Active = false;
+	vTaskDelay(1);
+	for (uint8_t core = 0; core < portNUM_PROCESSORS; core++) {
+		Trace_Rings[core].head = 0;
+	}
+	Trace_Active = wasActive;
+}
+
+const char *Trace_GetEventName(TraceEventId id) {
+	const size_t index = static_cast<size_t>(id);
+	if (index >= static_cast<size_t>(TraceEventId::Count)) {
+		return "unknown";
+	}
+	return Trace_EventNames[index];
+}
+
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+// Lightweight binary trace of hot paths (enable via TRACE_ENABLE in settings.h).
+// Every event is a fixed-size record (begin/end + id + esp_timer timestamp) that is
+// written into a ring-buffer of the core the caller is running on. Export happens
+// via /trace in Chrome trace-event format (open with chrome://tracing or ui.perfetto.dev).
+
+enum class TraceEventId : uint8_t {
+	PlaylistGenerate = 0,
+	PlaylistSort,
+	PlaylistShuffle,
+	AudioConnect,
+	NvsWrite,
+	SdUploadWrite,
+	RfidPoll,
+	WebsocketSend,
+	Count // has to be the last entry
+};
+
+enum class TraceEventPhase : uint8_t {
+	Begin = 0,
+	End
+};
+
+struct TraceEvent {
+	int64_t timestampUs; // esp_timer_get_time()
+	char task[4]; // first characters of the recording task's name (not null-terminated)
+	TraceEventId id;
+	TraceEventPhase phase;
+	uint8_t core;
+	uint8_t reserved;
+};
+static_assert(sizeof(TraceEvent) == 16, "TraceEvent is expected to be 16 bytes");
+
+#ifdef TRACE_ENABLE
+void Trace_Init(void);
+void Trace_Record(TraceEventId id, TraceEventPhase phase);
+size_t Trace_Snapshot(TraceEvent *dest, size_t maxEvents);
+size_t Trace_GetCapacity(void);
+void Trace_Clear(void);
+const char *Trace_GetEventName(TraceEventId id);
+
+// Records begin on construction and end on destruction
+class TraceScope {
+public:
+	explicit TraceScope(TraceEventId id)
+		: id_(id) {
+		Trace_Record(id_, TraceEventPhase::Begin);
+	}
+	~TraceScope() {
+		Trace_Record(id_, TraceEventPhase::End);
+	}
+	TraceScope(const TraceScope &) = delete;
+	TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+	TraceEventId id_;
+};
+
+	#define TRACE_CONCAT_INNER(a, b) a##b
+	#define TRACE_CONCAT(a, b)		 TRACE_CONCAT_INNER(a, b)
+	#define TRACE_BEGIN(id)			 Trace_Record(TraceEventId::id, TraceEventPhase::Begin)
+	#define TRACE_END(id)			 Trace_Record(TraceEventId::id, TraceEventPhase::End)
+	#define TRACE_SCOPE(id)			 TraceScope TRACE_CONCAT(traceScope_, __LINE__)(TraceEventId::id)
+#else
+	#define TRACE_BEGIN(id)
+	#define TRACE_END(id)
+	#define TRACE_SCOPE(id)
+#endif
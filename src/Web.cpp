@@ -5,22 +5,34 @@
 
 #include "ArduinoJson.h"
 #include "AsyncJson.h"
+#include "AudioFade.h"
 #include "AudioPlayer.h"
 #include "Battery.h"
+#include "Button.h"
 #include "Cmd.h"
 #include "Common.h"
+#include "CoverCache.h"
 #include "ESPAsyncWebServer.h"
 #include "EnumUtils.h"
+#include "Equalizer.h"
 #include "Ftp.h"
 #include "HTMLbinary.h"
 #include "HallEffectSensor.h"
+#include "Latency.h"
 #include "Led.h"
 #include "Log.h"
+#include "Loudness.h"
 #include "MemX.h"
+#include "Metadata.h"
 #include "Mqtt.h"
+#include "Port.h"
+#include "ReadCache.h"
 #include "Rfid.h"
 #include "SdCard.h"
+#include "ShuffleState.h"
+#include "StreamMirror.h"
 #include "System.h"
+#include "Trace.h"
 #include "Wlan.h"
 #include "freertos/ringbuf.h"
 #include "freertos/semphr.h"
@@ -31,6 +43,7 @@
 
 #include <Update.h>
 #include <WiFi.h>
+#include <algorithm>
 #include <cstring>
 #include <esp_task_wdt.h>
 #include <memory>
@@ -55,6 +68,8 @@ AsyncWebSocket ws("/ws");
 AsyncEventSource events("/events");
 
 static bool webserverStarted = false;
+// Filesystem the explorer works on; its file-operations are in SdCard.cpp, where they run against any fs::FS
+static fs::FS &explorerFileSystem = gFSystem;
 
 #ifdef BOARD_HAS_PSRAM
 static const uint32_t start_chunk_size = 16384; // bigger chunks increase write-performance to SD-Card
@@ -136,6 +151,14 @@ typedef struct {
 	String path;
 } playlistSnapshotEntry_t;
 
+typedef struct {
+	uint32_t baseRevision; // revision the delta applies to
+	uint32_t revision;
+	uint16_t trackNumber;
+	bool inserted; // otherwise removed
+	String path;
+} playlistSnapshotDelta_t;
+
 enum class SdCardTestState : uint8_t {
 	Idle = 0,
 	Running,
@@ -164,14 +187,24 @@ typedef struct {
 	uint32_t verifyErrors = 0;
 	bool success = false;
 	char message[160] = {0};
+	SdCardBenchmarkPatternResult patterns;
 } sdCardTestStatus_t;
 
 typedef struct {
 	uint32_t sizeBytes;
+	bool accessPatterns;
+	uint8_t chunkSizeCount;
+	uint32_t chunkSizes[sdCardBenchmarkMaxChunkSizes];
 } sdCardTestTaskArgs_t;
 
 static uint32_t playlistSnapshotRevision = 0;
 static std::vector<playlistSnapshotEntry_t> playlistSnapshotEntries;
+static std::shared_ptr<PlaylistSource> playlistSnapshotSource; // virtual playlists: entries are resolved on request
+static IndexPermutation playlistSnapshotOrder; // playback-order of playlistSnapshotSource
+static PlaylistEdits playlistSnapshotEdits; // edits of playlistSnapshotSource
+static std::vector<String> playlistSnapshotAdded; // entries added by edits of playlistSnapshotSource
+static playlistSnapshotDelta_t playlistSnapshotDelta; // last edit (sent to the clients via websocket)
+static constexpr size_t playlistVirtualPageSize = 25; // entries of a virtual playlist sent at once
 static sdCardTestStatus_t sdCardTestStatus;
 
 void Web_DumpSdToNvs(const char *_filename);
@@ -185,6 +218,8 @@ static void explorerHandleCreateRequest(AsyncWebServerRequest *request);
 static void explorerHandleRenameRequest(AsyncWebServerRequest *request);
 static void explorerHandleAudioRequest(AsyncWebServerRequest *request);
 static void handlePlaylistRequest(AsyncWebServerRequest *request);
+static void handlePlaylistEditRequest(AsyncWebServerRequest *request);
+static bool queuePlaylistEdit(const char *action, const char *path, int32_t trackNumber);
 static void handleTrackProgressRequest(AsyncWebServerRequest *request);
 static void handleGetSavedSSIDs(AsyncWebServerRequest *request);
 static void handlePostSavedSSIDs(AsyncWebServerRequest *request, JsonVariant &json);
@@ -203,6 +238,9 @@ static void handleGetInfo(AsyncWebServerRequest *request);
 static void handleGetSettings(AsyncWebServerRequest *request);
 static void handlePostSettings(AsyncWebServerRequest *request, JsonVariant &json);
 static void handleDebugRequest(AsyncWebServerRequest *request);
+#ifdef TRACE_ENABLE
+static void handleTraceRequest(AsyncWebServerRequest *request);
+#endif
 
 static void onWebsocketEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len);
 static void settingsToJSON(JsonObject obj, const String section);
@@ -212,10 +250,14 @@ static bool processJsonRequest(char *_serialJson, uint32_t clientId);
 static bool lockPlaylistSnapshot(void);
 static void unlockPlaylistSnapshot(void);
 static String getPlaylistDisplayName(const char *path);
+static size_t getVirtualPlaylistSnapshotCount(void);
 static size_t getPlaylistSnapshotCount(void);
+static String getVirtualPlaylistSnapshotPath(size_t index);
+static void sendPlaylistDelta(size_t index, const char *path, uint32_t revision);
 static bool lockSdCardTestStatus(void);
 static void unlockSdCardTestStatus(void);
 static const char *sdCardTestStateToString(SdCardTestState state);
+static void sdCardTestLatencyToJson(JsonObject obj, const SdCardBenchmarkLatency &latency);
 static void sdCardTestStatusToJson(JsonObject obj);
 static void sendSdCardTestResponse(AsyncWebServerRequest *request, int statusCode);
 static void sdCardTestProgressCallback(SdCardBenchmarkPhase phase, uint32_t processedBytes, uint32_t totalBytes, uint32_t frequencyKHz, void *userData);
@@ -278,15 +320,29 @@ static String getPlaylistDisplayName(const char *path) {
 	return fullPath;
 }
 
+// Snapshot has to be locked
+static size_t getVirtualPlaylistSnapshotCount(void) {
+	return playlistSnapshotEdits.isActive() ? playlistSnapshotEdits.size() : playlistSnapshotSource->size();
+}
+
 static size_t getPlaylistSnapshotCount(void) {
 	size_t count = 0;
 	if (lockPlaylistSnapshot()) {
-		count = playlistSnapshotEntries.size();
+		count = playlistSnapshotSource ? getVirtualPlaylistSnapshotCount() : playlistSnapshotEntries.size();
 		unlockPlaylistSnapshot();
 	}
 	return count;
 }
 
+// Path of an entry (in playback-order) of a virtual playlist; snapshot has to be locked
+static String getVirtualPlaylistSnapshotPath(size_t index) {
+	const size_t original = playlistSnapshotEdits(index);
+	if (original >= playlistSnapshotSource->size()) {
+		return playlistSnapshotAdded.at(original - playlistSnapshotSource->size());
+	}
+	return playlistSnapshotSource->at(playlistSnapshotOrder(original));
+}
+
 static bool lockSdCardTestStatus(void) {
 	if (!sdCardTestStatusMutex) {
 		sdCardTestStatusMutex = xSemaphoreCreateMutex();
@@ -316,6 +372,13 @@ static const char *sdCardTestStateToString(SdCardTestState state) {
 	}
 }
 
+static void sdCardTestLatencyToJson(JsonObject obj, const SdCardBenchmarkLatency &latency) {
+	obj["p50Us"] = latency.p50Us;
+	obj["p90Us"] = latency.p90Us;
+	obj["p99Us"] = latency.p99Us;
+	obj["maxUs"] = latency.maxUs;
+}
+
 static void sdCardTestStatusToJson(JsonObject obj) {
 	if (!lockSdCardTestStatus()) {
 		obj["state"] = "error";
@@ -360,11 +423,40 @@ static void sdCardTestStatusToJson(JsonObject obj) {
 		item["success"] = entry.success;
 		item["message"] = entry.message;
 	}
+
+	const SdCardBenchmarkPatternResult &patterns = sdCardTestStatus.patterns;
+	if (patterns.run) {
+		JsonObject patternsObj = obj.createNestedObject("patterns");
+		patternsObj["success"] = patterns.success;
+		patternsObj["message"] = patterns.message;
+		JsonObject directoryObj = patternsObj.createNestedObject("directory");
+		directoryObj["entries"] = patterns.directoryEntries;
+		directoryObj["createDurationMs"] = patterns.directoryCreateDurationMs;
+		directoryObj["enumerationDurationMs"] = patterns.directoryEnumerationDurationMs;
+		directoryObj["entriesPerSecond"] = patterns.directoryEntriesPerSecond;
+		sdCardTestLatencyToJson(directoryObj.createNestedObject("latency"), patterns.directoryLatency);
+		JsonObject randomReadObj = patternsObj.createNestedObject("randomRead");
+		randomReadObj["count"] = patterns.randomReadCount;
+		randomReadObj["size"] = patterns.randomReadSize;
+		randomReadObj["iops"] = patterns.randomReadIops;
+		sdCardTestLatencyToJson(randomReadObj.createNestedObject("latency"), patterns.randomReadLatency);
+		patternsObj["concurrentWrittenBytes"] = patterns.concurrentWrittenBytes;
+		JsonArray chunkEntries = patternsObj.createNestedArray("chunkReads");
+		for (uint8_t i = 0; i < patterns.chunkEntryCount && i < sdCardBenchmarkMaxChunkSizes + 1; ++i) {
+			const SdCardBenchmarkChunkEntry &entry = patterns.chunkEntries[i];
+			JsonObject item = chunkEntries.createNestedObject();
+			item["chunkSize"] = entry.chunkSize;
+			item["concurrentWrite"] = entry.concurrentWrite;
+			item["readCount"] = entry.readCount;
+			item["speedKiBs"] = entry.speedKiBs;
+			sdCardTestLatencyToJson(item.createNestedObject("latency"), entry.latency);
+		}
+	}
 	unlockSdCardTestStatus();
 }
 
 static void sendSdCardTestResponse(AsyncWebServerRequest *request, int statusCode) {
-	AsyncJsonResponse *response = new AsyncJsonResponse(false, 3072);
+	AsyncJsonResponse *response = new AsyncJsonResponse(false, 5120);
 	sdCardTestStatusToJson(response->getRoot());
 	if (response->overflowed()) {
 		delete response;
@@ -386,7 +478,26 @@ static void sdCardTestProgressCallback(SdCardBenchmarkPhase phase, uint32_t proc
 	sdCardTestStatus.frequencyKHz = frequencyKHz;
 	sdCardTestStatus.processedBytes = processedBytes;
 	sdCardTestStatus.totalBytes = totalBytes;
-	snprintf(sdCardTestStatus.message, sizeof(sdCardTestStatus.message), "%s %lu MHz: %s", "Testing", frequencyKHz / 1000UL, phase == SdCardBenchmarkPhase::Read ? "reading and verifying benchmark data..." : "writing benchmark data...");
+	const char *phaseMessage;
+	switch (phase) {
+		case SdCardBenchmarkPhase::Read:
+			phaseMessage = "reading and verifying benchmark data...";
+			break;
+		case SdCardBenchmarkPhase::DirectoryEnumeration:
+			phaseMessage = "enumerating directory entries...";
+			break;
+		case SdCardBenchmarkPhase::RandomRead:
+			phaseMessage = "reading at random offsets...";
+			break;
+		case SdCardBenchmarkPhase::ChunkRead:
+			phaseMessage = "reading with different chunk-sizes...";
+			break;
+		case SdCardBenchmarkPhase::Write:
+		default:
+			phaseMessage = "writing benchmark data...";
+			break;
+	}
+	snprintf(sdCardTestStatus.message, sizeof(sdCardTestStatus.message), "%s %lu MHz: %s", "Testing", frequencyKHz / 1000UL, phaseMessage);
 	unlockSdCardTestStatus();
 }
 
@@ -397,6 +508,11 @@ static void sdCardTestTask(void *parameter) {
 	config.runFrequencySweep = true;
 	config.progressCallback = sdCardTestProgressCallback;
 	config.progressUserData = nullptr;
+	if (args) {
+		config.runAccessPatterns = args->accessPatterns;
+		config.chunkSizeCount = args->chunkSizeCount;
+		std::copy(args->chunkSizes, args->chunkSizes + args->chunkSizeCount, config.chunkSizes);
+	}
 
 	SdCardBenchmarkResult result;
 	const bool benchmarkOk = SdCard_RunBenchmark(config, result);
@@ -420,6 +536,7 @@ static void sdCardTestTask(void *parameter) {
 		sdCardTestStatus.readErrors = result.readErrors;
 		sdCardTestStatus.verifyErrors = result.verifyErrors;
 		sdCardTestStatus.success = result.success;
+		sdCardTestStatus.patterns = result.patterns;
 		sdCardTestStatus.running = false;
 		sdCardTestStatus.state = benchmarkOk ? SdCardTestState::Done : SdCardTestState::Error;
 		snprintf(sdCardTestStatus.message, sizeof(sdCardTestStatus.message), "%s", result.message);
@@ -832,6 +949,11 @@ void webserverStart(void) {
 		// debug info
 		wServer.on("/debug", HTTP_GET, handleDebugRequest);
 
+#ifdef TRACE_ENABLE
+		// hot-path trace (Chrome trace-event format)
+		wServer.on("/trace", HTTP_GET, handleTraceRequest);
+#endif
+
 		// SD card benchmark
 		wServer.on("/sdtest", HTTP_GET, handleGetSdCardTestRequest);
 		wServer.addHandler(new AsyncCallbackJsonWebHandler("/sdtest", handlePostSdCardTestRequest));
@@ -884,6 +1006,7 @@ void webserverStart(void) {
 		wServer.on("/exploreraudio", HTTP_POST, explorerHandleAudioRequest);
 
 		wServer.on("/playlist", HTTP_GET, handlePlaylistRequest);
+		wServer.on("/playlist", HTTP_POST, handlePlaylistEditRequest);
 		wServer.on("/trackprogress", HTTP_GET, handleTrackProgressRequest);
 
 		wServer.on("/savedSSIDs", HTTP_GET, handleGetSavedSSIDs);
@@ -968,16 +1091,24 @@ bool JSONToSettings(JsonObject doc) {
 		}
 	}
 	if (doc.containsKey("equalizer")) {
-		int8_t _gainLowPass = doc["equalizer"]["gainLowPass"].as<int8_t>();
-		int8_t _gainBandPass = doc["equalizer"]["gainBandPass"].as<int8_t>();
-		int8_t _gainHighPass = doc["equalizer"]["gainHighPass"].as<int8_t>();
-		// equalizer settings
-		if (
-			gPrefsSettings.putChar("gainLowPass", _gainLowPass) == 0 || gPrefsSettings.putChar("gainBandPass", _gainBandPass) == 0 || gPrefsSettings.putChar("gainHighPass", _gainHighPass) == 0) {
+		// equalizer settings (gain per band; outputs that aren't sent keep their preset)
+		EqualizerPresets presets;
+		Equalizer_LoadPresets(presets);
+		JsonArray speakerArr = doc["equalizer"]["speaker"];
+		JsonArray headphoneArr = doc["equalizer"]["headphone"];
+		for (uint8_t band = 0; band < equalizerBands; band++) {
+			if (band < speakerArr.size()) {
+				presets.speaker[band] = constrain(speakerArr[band].as<int8_t>(), equalizerGainMin, equalizerGainMax);
+			}
+			if (band < headphoneArr.size()) {
+				presets.headphone[band] = constrain(headphoneArr[band].as<int8_t>(), equalizerGainMin, equalizerGainMax);
+			}
+		}
+		if (!Equalizer_SavePresets(presets)) {
 			Log_Printf(LOGLEVEL_ERROR, webSaveSettingsError, "equalizer");
 			return false;
 		} else {
-			AudioPlayer_EqualizerToQueueSender(_gainLowPass, _gainBandPass, _gainHighPass);
+			AudioPlayer_EqualizerToQueueSender(presets);
 		}
 	}
 	if (doc.containsKey("wifi")) {
@@ -1153,10 +1284,17 @@ static void settingsToJSON(JsonObject obj, const String section) {
 	}
 	if ((section == "") || (section == "equalizer")) {
 		// equalizer settings
+		EqualizerPresets presets;
+		Equalizer_LoadPresets(presets);
 		JsonObject equalizerObj = obj.createNestedObject("equalizer");
-		equalizerObj["gainLowPass"].set(gPrefsSettings.getChar("gainLowPass", 0));
-		equalizerObj["gainBandPass"].set(gPrefsSettings.getChar("gainBandPass", 0));
-		equalizerObj["gainHighPass"].set(gPrefsSettings.getChar("gainHighPass", 0));
+		JsonArray bandsArr = equalizerObj.createNestedArray("bands"); // Hz
+		JsonArray speakerArr = equalizerObj.createNestedArray("speaker"); // dB
+		JsonArray headphoneArr = equalizerObj.createNestedArray("headphone");
+		for (uint8_t band = 0; band < equalizerBands; band++) {
+			bandsArr.add(equalizerFrequencies[band]);
+			speakerArr.add(presets.speaker[band]);
+			headphoneArr.add(presets.headphone[band]);
+		}
 	}
 	if ((section == "") || (section == "wifi")) {
 		// WiFi settings
@@ -1213,9 +1351,7 @@ static void settingsToJSON(JsonObject obj, const String section) {
 		defaultsObj["maxVolumeSp"].set(21u); // AUDIOPLAYER_VOLUME_MAX
 		defaultsObj["maxVolumeHp"].set(18u); // gPrefsSettings.getUInt("maxVolumeHp", 0));
 		defaultsObj["sleepInactivity"].set(10u); // System_MaxInactivityTime
-		defaultsObj["gainHighPass"].set(0);
-		defaultsObj["gainBandPass"].set(0);
-		defaultsObj["gainLowPass"].set(0);
+		defaultsObj["equalizerGain"].set(0); // every band of both outputs
 #ifdef NEOPIXEL_ENABLE
 		defaultsObj["initBrightness"].set(16u); // LED_INITIAL_BRIGHTNESS
 		defaultsObj["nightBrightness"].set(2u); // LED_INITIAL_NIGHT_BRIGHTNESS
@@ -1285,7 +1421,8 @@ void handleGetInfo(AsyncWebServerRequest *request) {
 	if (request->hasParam("section")) {
 		section = request->getParam("section")->value();
 	}
-	AsyncJsonResponse *response = new AsyncJsonResponse(false, 768);
+	const size_t jsonSize = (section == "") ? 6144 : (((section == "latency") || (section == "buttons")) ? 4096 : 768); // latency histograms need some more space
+	AsyncJsonResponse *response = new AsyncJsonResponse(false, jsonSize);
 	JsonObject infoObj = response->getRoot();
 	// software
 	if ((section == "") || (section == "software")) {
@@ -1325,6 +1462,139 @@ void handleGetInfo(AsyncWebServerRequest *request) {
 		audioObj["playtimeTotal"] = AudioPlayer_GetPlayTimeAllTime();
 		audioObj["playtimeSinceStart"] = AudioPlayer_GetPlayTimeSinceStart();
 		audioObj["firstStart"] = gPrefsSettings.getULong("firstStart", 0);
+		AudioFadeStats fadeStats;
+		AudioFade_GetStats(fadeStats);
+		JsonObject fadeObj = audioObj.createNestedObject("fade"); // CPU-cost of the gain-envelope per PCM-block
+		fadeObj["blocks"] = fadeStats.blocks;
+		fadeObj["lastCycles"] = fadeStats.lastCycles;
+		fadeObj["avgCycles"] = fadeStats.avgCycles;
+		fadeObj["maxCycles"] = fadeStats.maxCycles;
+		fadeObj["loadPermille"] = fadeStats.loadPermille;
+		EqualizerStats equalizerStats;
+		Equalizer_GetStats(equalizerStats);
+		JsonObject equalizerObj = audioObj.createNestedObject("equalizer"); // CPU-cost of the biquad-cascade per PCM-block
+		equalizerObj["activeBands"] = equalizerStats.activeBands;
+		equalizerObj["blocks"] = equalizerStats.blocks;
+		equalizerObj["lastCycles"] = equalizerStats.lastCycles;
+		equalizerObj["avgCycles"] = equalizerStats.avgCycles;
+		equalizerObj["maxCycles"] = equalizerStats.maxCycles;
+		equalizerObj["loadPermille"] = equalizerStats.loadPermille;
+#ifdef REPLAYGAIN_ENABLE
+		LoudnessStats loudnessStats;
+		Loudness_GetStats(loudnessStats);
+		JsonObject loudnessObj = audioObj.createNestedObject("loudness"); // CPU-cost of the R128-meter per PCM-block (tracks being measured)
+		loudnessObj["blocks"] = loudnessStats.blocks;
+		loudnessObj["lastCycles"] = loudnessStats.lastCycles;
+		loudnessObj["avgCycles"] = loudnessStats.avgCycles;
+		loudnessObj["maxCycles"] = loudnessStats.maxCycles;
+		loudnessObj["loadPermille"] = loudnessStats.loadPermille;
+#endif
+	}
+	// tap-to-first-audio latency (ms since RFID-detection)
+	if ((section == "") || (section == "latency")) {
+		JsonObject latencyObj = infoObj.createNestedObject("latency");
+		latencyObj["sessions"] = Latency_GetCompletedSessions();
+		JsonArray bucketsArr = latencyObj.createNestedArray("bucketsMs");
+		for (uint8_t i = 0; i < latencyHistogramBuckets - 1; i++) {
+			bucketsArr.add(latencyHistogramEdgesMs[i]);
+		}
+		JsonObject stagesObj = latencyObj.createNestedObject("stages");
+		for (uint8_t i = 1; i < EnumUtils::underlying_value(LatencyStage::Count); i++) {
+			const LatencyStage stage = EnumUtils::to_enum<LatencyStage>(i);
+			LatencyStageStats stats;
+			if (!Latency_GetStageStats(stage, stats)) {
+				continue;
+			}
+			JsonObject stageObj = stagesObj.createNestedObject(Latency_GetStageName(stage));
+			stageObj["samples"] = stats.samples;
+			stageObj["last"] = stats.lastMs;
+			stageObj["min"] = stats.minMs;
+			stageObj["p50"] = stats.p50Ms;
+			stageObj["p90"] = stats.p90Ms;
+			stageObj["max"] = stats.maxMs;
+			JsonArray histogramArr = stageObj.createNestedArray("histogram");
+			for (uint8_t bucket = 0; bucket < latencyHistogramBuckets; bucket++) {
+				histogramArr.add(stats.histogram[bucket]);
+			}
+		}
+	}
+	// webstream buffering
+	if ((section == "") || (section == "stream")) {
+		JsonObject streamObj = infoObj.createNestedObject("stream");
+		AudioPlayerStreamStats stats;
+		AudioPlayer_GetStreamStats(stats);
+		streamObj["throughputKbps"] = stats.ingressKbps;
+		streamObj["bitrateKbps"] = stats.codecKbps;
+		streamObj["buffered"] = stats.bufferedBytes;
+		streamObj["prebufferTarget"] = stats.prebufferTargetBytes;
+		streamObj["rebuffering"] = stats.rebuffering;
+		streamObj["rebuffers"] = stats.rebufferCount;
+		streamObj["rebufferTotalMs"] = stats.rebufferTotalMs;
+		streamObj["rebufferLastMs"] = stats.lastRebufferMs;
+		streamObj["rebufferMaxMs"] = stats.maxRebufferMs;
+		streamObj["reconnects"] = stats.reconnects;
+		streamObj["failedReconnects"] = stats.failedReconnects;
+		StreamMirrorStats mirrorStats;
+		StreamMirror_GetStats(mirrorStats);
+		JsonObject mirrorObj = streamObj.createNestedObject("mirrors");
+		mirrorObj["probes"] = mirrorStats.probes;
+		mirrorObj["fallbacks"] = mirrorStats.fallbacks;
+		mirrorObj["failures"] = mirrorStats.failures;
+		streamObj["connects"] = mirrorStats.connects;
+		streamObj["tlsHandshakes"] = mirrorStats.tlsHandshakes;
+		streamObj["lastConnectMs"] = mirrorStats.lastConnectMs;
+	}
+	// read-ahead cache of audio-files
+	if ((section == "") || (section == "readcache")) {
+		JsonObject readCacheObj = infoObj.createNestedObject("readcache");
+		ReadCacheStats stats;
+		ReadCache_GetStats(stats);
+		const uint32_t reads = stats.hits + stats.misses;
+		readCacheObj["enabled"] = ReadCache_IsEnabled();
+		readCacheObj["blockSize"] = READ_CACHE_BLOCK_SIZE;
+		readCacheObj["blocks"] = READ_CACHE_BLOCKS;
+		readCacheObj["hits"] = stats.hits;
+		readCacheObj["misses"] = stats.misses;
+		readCacheObj["hitRate"] = reads ? (float) stats.hits / reads : 0.f;
+		readCacheObj["bypassReads"] = stats.bypassReads;
+		readCacheObj["blockLoads"] = stats.blockLoads;
+		readCacheObj["bytesRequested"] = stats.bytesRequested;
+		readCacheObj["bytesFromCard"] = stats.bytesFromCard;
+	}
+	// LED-renderer
+	if ((section == "") || (section == "led")) {
+		JsonObject ledObj = infoObj.createNestedObject("led");
+		LedFrameStats stats;
+		Led_GetFrameStats(stats);
+		ledObj["framesRendered"] = stats.rendered;
+		ledObj["framesSkipped"] = stats.skipped;
+		ledObj["lastRenderCycles"] = stats.lastRenderCycles;
+		ledObj["avgRenderCycles"] = stats.avgRenderCycles;
+		ledObj["maxRenderCycles"] = stats.maxRenderCycles;
+	}
+	// buttons: input-to-action latency per gesture
+	if ((section == "") || (section == "buttons")) {
+		JsonObject buttonsObj = infoObj.createNestedObject("buttons");
+		buttonsObj["taskWakeups"] = Button_GetTaskWakeups();
+		buttonsObj["expanderReads"] = Port_GetExpanderReads();
+		JsonArray bucketsArr = buttonsObj.createNestedArray("bucketsMs");
+		for (uint8_t i = 0; i < buttonLatencyBuckets - 1; i++) {
+			bucketsArr.add(buttonLatencyEdgesMs[i]);
+		}
+		JsonObject gesturesObj = buttonsObj.createNestedObject("gestures");
+		for (uint8_t i = 0; i < EnumUtils::underlying_value(ButtonGesture::Count); i++) {
+			const ButtonGesture gesture = EnumUtils::to_enum<ButtonGesture>(i);
+			ButtonLatencyStats stats;
+			Button_GetLatencyStats(gesture, stats);
+			JsonObject gestureObj = gesturesObj.createNestedObject(Button_GetGestureName(gesture));
+			gestureObj["actions"] = stats.actions;
+			gestureObj["lastUs"] = stats.lastUs;
+			gestureObj["maxUs"] = stats.maxUs;
+			JsonArray histogramArr = gestureObj.createNestedArray("histogram");
+			for (uint8_t bucket = 0; bucket < buttonLatencyBuckets; bucket++) {
+				histogramArr.add(stats.histogram[bucket]);
+			}
+		}
 	}
 #ifdef BATTERY_MEASURE_ENABLE
 	// battery
@@ -1369,7 +1639,7 @@ void handleGetSettings(AsyncWebServerRequest *request) {
 		section = request->getParam("section")->value();
 	}
 
-	AsyncJsonResponse *response = new AsyncJsonResponse(false, 2048);
+	AsyncJsonResponse *response = new AsyncJsonResponse(false, 2560); // equalizer-presets need some more space
 	JsonObject settingsObj = response->getRoot();
 	settingsToJSON(settingsObj, section);
 	if (response->overflowed()) {
@@ -1436,6 +1706,119 @@ void handleDebugRequest(AsyncWebServerRequest *request) {
 	request->send(response);
 }
 
+#ifdef TRACE_ENABLE
+// Snapshot of the trace rings, streamed as Chrome trace-event JSON
+struct TraceExport {
+	TraceEvent *events = nullptr;
+	size_t count = 0;
+	std::vector<uint32_t> threads; // (core << 24) | index into events of the first event of a task
+	size_t index = 0;
+	uint8_t stage = 0; // 0 = header, 1 = metadata, 2 = events, 3 = trailer, 4 = done
+
+	~TraceExport() {
+		free(events);
+	}
+};
+
+static uint32_t traceTaskId(const TraceEvent &event) {
+	uint32_t id;
+	memcpy(&id, event.task, sizeof(id));
+	return id;
+}
+
+static void traceTaskName(const TraceEvent &event, char *name) {
+	for (size_t i = 0; i < sizeof(event.task); i++) {
+		const char c = event.task[i];
+		name[i] = (c >= 0x20 && c < 0x7f && c != '"' && c != '\\') ? c : '\0';
+		if (name[i] == '\0') {
+			return;
+		}
+	}
+	name[sizeof(event.task)] = '\0';
+}
+
+// handle trace request
+// returns the buffered hot-path events as Chrome trace-event JSON (add ?clear=true to reset the buffer afterwards)
+void handleTraceRequest(AsyncWebServerRequest *request) {
+	auto exportState = std::make_shared<TraceExport>();
+	exportState->events = static_cast<TraceEvent *>(x_malloc(sizeof(TraceEvent) * Trace_GetCapacity()));
+	if (exportState->events == nullptr) {
+		Log_Println(unableToAllocateMem, LOGLEVEL_ERROR);
+		request->send(500, "text/plain; charset=utf-8", "unable to allocate trace buffer");
+		return;
+	}
+	exportState->count = Trace_Snapshot(exportState->events, Trace_GetCapacity());
+	if (request->hasParam("clear") && request->getParam("clear")->value() == "true") {
+		Trace_Clear();
+	}
+	// collect every (core, task) once to emit its name as metadata
+	for (size_t i = 0; i < exportState->count; i++) {
+		const TraceEvent &event = exportState->events[i];
+		const bool known = std::any_of(exportState->threads.begin(), exportState->threads.end(), [&](uint32_t thread) {
+			const TraceEvent &other = exportState->events[thread & 0xFFFFFF];
+			return (other.core == event.core) && (traceTaskId(other) == traceTaskId(event));
+		});
+		if (!known) {
+			exportState->threads.push_back((static_cast<uint32_t>(event.core) << 24) | i);
+		}
+	}
+
+	AsyncWebServerResponse *response = request->beginChunkedResponse("application/json",
+		[exportState](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+			maxLen = maxLen >> 1; // some sort of bug with actual size available, reduce the len
+			TraceExport &state = *exportState;
+			size_t len = 0;
+			char line[160];
+			while (state.stage < 4) {
+				int lineLen = 0;
+				switch (state.stage) {
+					case 0:
+						lineLen = snprintf(line, sizeof(line), "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+						break;
+					case 1: {
+						if (state.index >= state.threads.size()) {
+							state.stage++;
+							state.index = 0;
+							continue;
+						}
+						const TraceEvent &event = state.events[state.threads[state.index] & 0xFFFFFF];
+						char name[sizeof(event.task) + 1];
+						traceTaskName(event, name);
+						lineLen = snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%" PRIu32 ",\"args\":{\"name\":\"%s\"}}", (state.index > 0) ? "," : "", event.core, traceTaskId(event), name);
+						break;
+					}
+					case 2: {
+						if (state.index >= state.count) {
+							state.stage++;
+							continue;
+						}
+						const TraceEvent &event = state.events[state.index];
+						const bool first = (state.index == 0) && state.threads.empty();
+						lineLen = snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lld,\"pid\":%u,\"tid\":%" PRIu32 "}", first ? "" : ",", Trace_GetEventName(event.id), (event.phase == TraceEventPhase::Begin) ? 'B' : 'E', event.timestampUs, event.core, traceTaskId(event));
+						break;
+					}
+					default:
+						lineLen = snprintf(line, sizeof(line), "]}");
+						break;
+				}
+				if ((lineLen < 0) || (static_cast<size_t>(lineLen) > (maxLen - len))) {
+					break;
+				}
+				memcpy(buffer + len, line, lineLen);
+				len += lineLen;
+				if (state.stage == 0 || state.stage == 3) {
+					state.stage++;
+					state.index = 0;
+				} else {
+					state.index++;
+				}
+			}
+			return len;
+		});
+	request->send(response);
+}
+#endif
+
 static void handleGetSdCardTestRequest(AsyncWebServerRequest *request) {
 #ifdef NO_SDCARD
 	if (lockSdCardTestStatus()) {
@@ -1477,6 +1860,34 @@ static void handlePostSdCardTestRequest(AsyncWebServerRequest *request, JsonVari
 		return;
 	}
 
+	const bool accessPatterns = jsonObj["accessPatterns"] | false;
+	uint8_t chunkSizeCount = 0;
+	uint32_t chunkSizes[sdCardBenchmarkMaxChunkSizes] = {0};
+	bool chunkSizesValid = true;
+	if (jsonObj.containsKey("chunkSizes")) {
+		const JsonArray chunkSizeArray = jsonObj["chunkSizes"].as<JsonArray>();
+		chunkSizesValid = !chunkSizeArray.isNull() && chunkSizeArray.size() > 0 && chunkSizeArray.size() <= sdCardBenchmarkMaxChunkSizes;
+		for (JsonVariant value : chunkSizeArray) {
+			const uint32_t chunkSize = value | 0;
+			if (!chunkSizesValid || chunkSize < 512 || chunkSize > 32768) {
+				chunkSizesValid = false;
+				break;
+			}
+			chunkSizes[chunkSizeCount++] = chunkSize;
+		}
+	}
+	if (!chunkSizesValid) {
+		if (lockSdCardTestStatus()) {
+			sdCardTestStatus.state = SdCardTestState::Error;
+			sdCardTestStatus.running = false;
+			sdCardTestStatus.success = false;
+			snprintf(sdCardTestStatus.message, sizeof(sdCardTestStatus.message), "Invalid chunk-sizes. Up to %u values between 512 and 32768 bytes are allowed.", static_cast<unsigned>(sdCardBenchmarkMaxChunkSizes));
+			unlockSdCardTestStatus();
+		}
+		sendSdCardTestResponse(request, 400);
+		return;
+	}
+
 	if (!lockSdCardTestStatus()) {
 		request->send(500, "text/plain; charset=utf-8", "failed to lock sd card benchmark status");
 		return;
@@ -1492,7 +1903,9 @@ static void handlePostSdCardTestRequest(AsyncWebServerRequest *request, JsonVari
 		return;
 	}
 
-	if (gPlayProperties.playMode != NO_PLAYLIST) {
+	PlaybackState playbackState;
+	AudioPlayer_GetState(playbackState);
+	if (playbackState.playMode != NO_PLAYLIST) {
 		sdCardTestStatus.state = SdCardTestState::Error;
 		sdCardTestStatus.running = false;
 		sdCardTestStatus.success = false;
@@ -1527,7 +1940,7 @@ static void handlePostSdCardTestRequest(AsyncWebServerRequest *request, JsonVari
 	#endif
 	unlockSdCardTestStatus();
 
-	std::unique_ptr<sdCardTestTaskArgs_t> args(new (std::nothrow) sdCardTestTaskArgs_t {sizeBytes});
+	std::unique_ptr<sdCardTestTaskArgs_t> args(new (std::nothrow) sdCardTestTaskArgs_t {sizeBytes, accessPatterns, chunkSizeCount, {0}});
 	if (!args) {
 		if (lockSdCardTestStatus()) {
 			sdCardTestStatus.state = SdCardTestState::Error;
@@ -1538,6 +1951,7 @@ static void handlePostSdCardTestRequest(AsyncWebServerRequest *request, JsonVari
 		sendSdCardTestResponse(request, 500);
 		return;
 	}
+	std::copy(chunkSizes, chunkSizes + chunkSizeCount, args->chunkSizes);
 
 	if (xTaskCreatePinnedToCore(
 			sdCardTestTask,
@@ -1594,6 +2008,13 @@ static bool processJsonRequest(char *_serialJson, uint32_t clientId) {
 		}
 		AudioPlayer_TrackControlToQueueSender(JUMPTRACK, jumpToTrackNumber - 1);
 	}
+	if (obj.containsKey("controls") && obj["controls"].containsKey("playlistEdit")) {
+		JsonObject edit = obj["controls"]["playlistEdit"];
+		if (!queuePlaylistEdit(edit["action"] | "", edit["path"] | "", edit["trackNumber"] | 0)) {
+			Web_SendWebsocketData(clientId, WebsocketCodeType::Error);
+			return false;
+		}
+	}
 
 	return JSONToSettings(obj);
 }
@@ -1629,15 +2050,17 @@ void Web_SendWebsocketData(uint32_t client, WebsocketCodeType code) {
 		// todo: battery percent + loading status +++
 		// object["battery"] = Battery_GetVoltage();
 	} else if (code == WebsocketCodeType::TrackInfo) {
+		PlaybackState playbackState;
+		AudioPlayer_GetState(playbackState);
 		JsonObject entry = object.createNestedObject("trackinfo");
-		entry["pausePlay"] = gPlayProperties.pausePlay;
-		entry["currentTrackNumber"] = gPlayProperties.currentTrackNumber + 1;
-		entry["numberOfTracks"] = (gPlayProperties.playlist) ? gPlayProperties.playlist->size() : 0;
-		entry["playlistRevision"] = gPlayProperties.playlistRevision;
+		entry["pausePlay"] = playbackState.pausePlay;
+		entry["currentTrackNumber"] = playbackState.currentTrackNumber + 1;
+		entry["numberOfTracks"] = playbackState.numberOfTracks;
+		entry["playlistRevision"] = playbackState.playlistRevision;
 		entry["volume"] = AudioPlayer_GetCurrentVolume();
-		entry["name"] = gPlayProperties.title;
-		entry["posPercent"] = gPlayProperties.currentRelPos;
-		entry["playMode"] = gPlayProperties.playMode;
+		entry["name"] = playbackState.title; // copied by ArduinoJson as it's a char-array
+		entry["posPercent"] = playbackState.currentRelPos;
+		entry["playMode"] = playbackState.playMode;
 	} else if (code == WebsocketCodeType::CoverImg) {
 		object["coverimg"] = "coverimg";
 	} else if (code == WebsocketCodeType::Volume) {
@@ -1649,10 +2072,30 @@ void Web_SendWebsocketData(uint32_t client, WebsocketCodeType code) {
 		JsonObject entry = object.createNestedObject("settings");
 		settingsToJSON(entry, "ssids");
 	} else if (code == WebsocketCodeType::TrackProgress) {
+		PlaybackState playbackState;
+		AudioPlayer_GetState(playbackState);
 		JsonObject entry = object.createNestedObject("trackProgress");
-		entry["posPercent"] = gPlayProperties.currentRelPos;
+		entry["posPercent"] = playbackState.currentRelPos;
 		entry["time"] = AudioPlayer_GetCurrentTime();
 		entry["duration"] = AudioPlayer_GetFileDuration();
+	} else if (code == WebsocketCodeType::PlaylistMetadata) {
+		PlaybackState playbackState;
+		AudioPlayer_GetState(playbackState);
+		object["playlistMetadata"] = playbackState.playlistRevision;
+	} else if (code == WebsocketCodeType::PlaylistDelta) {
+		if (lockPlaylistSnapshot()) {
+			// clients that know baseRevision apply the delta, others fetch the playlist again
+			JsonObject entry = object.createNestedObject("playlistDelta");
+			entry["baseRevision"] = playlistSnapshotDelta.baseRevision;
+			entry["revision"] = playlistSnapshotDelta.revision;
+			entry["action"] = playlistSnapshotDelta.inserted ? "insert" : "remove";
+			entry["trackNumber"] = playlistSnapshotDelta.trackNumber;
+			if (playlistSnapshotDelta.inserted) {
+				entry["path"] = playlistSnapshotDelta.path;
+				entry["displayName"] = getPlaylistDisplayName(playlistSnapshotDelta.path.c_str());
+			}
+			unlockPlaylistSnapshot();
+		}
 	};
 
 	if (doc.overflowed()) {
@@ -1668,6 +2111,7 @@ void Web_SendWebsocketData(uint32_t client, WebsocketCodeType code) {
 		Log_Println(unableToAllocateMem, LOGLEVEL_ERROR);
 		return;
 	}
+	TRACE_SCOPE(WebsocketSend);
 	serializeJson(doc, jsonBuffer->get(), len);
 	if (client == 0) {
 		ws.textAll(jsonBuffer);
@@ -1898,7 +2342,7 @@ void explorerHandleFileStorageTask(void *parameter) {
 
 	BaseType_t uploadFileNotification;
 	uint32_t uploadFileNotificationValue;
-	uploadFile = gFSystem.open(filePath, "w", true); // open file with create=true to make sure parent directories are created
+	uploadFile = explorerFileSystem.open(filePath, "w", true); // open file with create=true to make sure parent directories are created
 	uploadFile.setBufferSize(chunk_size);
 
 	// pause some tasks to get more free CPU time for the upload
@@ -1914,7 +2358,10 @@ void explorerHandleFileStorageTask(void *parameter) {
 			while (buffer_full[index_buffer_read]) {
 				chunkCount++;
 				size_t item_size = size_in_buffer[index_buffer_read];
-				if (!uploadFile.write(buffer[index_buffer_read], item_size)) {
+				TRACE_BEGIN(SdUploadWrite);
+				const size_t bytesWritten = uploadFile.write(buffer[index_buffer_read], item_size);
+				TRACE_END(SdUploadWrite);
+				if (!bytesWritten) {
 					bytesNok += item_size;
 					feedTheDog();
 				} else {
@@ -1975,24 +2422,11 @@ void explorerHandleListRequest(AsyncWebServerRequest *request) {
 	return;
 #endif
 
-	File root;
+	const char *filePath = "/";
 	if (request->hasParam("path")) {
 		const AsyncWebParameter *param;
 		param = request->getParam("path");
-		const char *filePath = param->value().c_str();
-		root = gFSystem.open(filePath);
-	} else {
-		root = gFSystem.open("/");
-	}
-
-	if (!root) {
-		Log_Println(failedToOpenDirectory, LOGLEVEL_DEBUG);
-		return;
-	}
-
-	if (!root.isDirectory()) {
-		Log_Println(notADirectory, LOGLEVEL_DEBUG);
-		return;
+		filePath = param->value().c_str();
 	}
 
 #ifdef BOARD_HAS_PSRAM
@@ -2003,20 +2437,17 @@ void explorerHandleListRequest(AsyncWebServerRequest *request) {
 	AsyncJsonResponse *response = new AsyncJsonResponse(true, buffSize);
 
 	JsonArray obj = response->getRoot();
-	bool isDir = false;
-	String MyfileName = root.getNextFileName(&isDir);
-	while (MyfileName != "") {
-		// ignore hidden folders, e.g. MacOS spotlight files
-		if (!MyfileName.startsWith("/.")) {
-			JsonObject entry = obj.createNestedObject();
-			entry["name"] = MyfileName.substring(MyfileName.lastIndexOf('/') + 1);
-			if (isDir) {
-				entry["dir"].set(true);
-			}
+	const bool listed = SdCard_ListDirectory(explorerFileSystem, filePath, [&obj](const String &name, bool isDir) {
+		JsonObject entry = obj.createNestedObject();
+		entry["name"] = name;
+		if (isDir) {
+			entry["dir"].set(true);
 		}
-		MyfileName = root.getNextFileName(&isDir);
+	});
+	if (!listed) {
+		delete response;
+		return;
 	}
-	root.close();
 
 	if (response->overflowed()) {
 		// JSON buffer too small for data
@@ -2028,25 +2459,6 @@ void explorerHandleListRequest(AsyncWebServerRequest *request) {
 	request->send(response);
 }
 
-bool explorerDeleteDirectory(File dir) {
-
-	File file = dir.openNextFile();
-	while (file) {
-
-		if (file.isDirectory()) {
-			explorerDeleteDirectory(file);
-		} else {
-			gFSystem.remove(file.path());
-		}
-
-		file = dir.openNextFile();
-
-		esp_task_wdt_reset();
-	}
-
-	return gFSystem.rmdir(dir.path());
-}
-
 // Handles download request of a file
 // requires a GET parameter path to the file
 void explorerHandleDownloadRequest(AsyncWebServerRequest *request) {
@@ -2061,13 +2473,13 @@ void explorerHandleDownloadRequest(AsyncWebServerRequest *request) {
 	// check file exists on SD card
 	param = request->getParam("path");
 	const char *filePath = param->value().c_str();
-	if (!gFSystem.exists(filePath)) {
+	if (!explorerFileSystem.exists(filePath)) {
 		Log_Printf(LOGLEVEL_ERROR, "DOWNLOAD:  File not found on SD card: %s", filePath);
 		request->send(404);
 		return;
 	}
 	// check is file and not a directory
-	file = gFSystem.open(filePath);
+	file = explorerFileSystem.open(filePath);
 	if (file.isDirectory()) {
 		Log_Printf(LOGLEVEL_ERROR, "DOWNLOAD:  Cannot download a directory %s", filePath);
 		request->send(404);
@@ -2102,27 +2514,17 @@ void explorerHandleDownloadRequest(AsyncWebServerRequest *request) {
 // Handles delete request of a file or directory
 // requires a GET parameter path to the file or directory
 void explorerHandleDeleteRequest(AsyncWebServerRequest *request) {
-	File file;
 	if (request->hasParam("path")) {
 		const AsyncWebParameter *param;
 		param = request->getParam("path");
 		const char *filePath = param->value().c_str();
-		if (gFSystem.exists(filePath)) {
+		if (explorerFileSystem.exists(filePath)) {
 			// stop playback, file to delete might be in use
 			Cmd_Action(CMD_STOP);
-			file = gFSystem.open(filePath);
-			if (file.isDirectory()) {
-				if (explorerDeleteDirectory(file)) {
-					Log_Printf(LOGLEVEL_INFO, "DELETE:  %s deleted", filePath);
-				} else {
-					Log_Printf(LOGLEVEL_ERROR, "DELETE:  Cannot delete %s", filePath);
-				}
+			if (SdCard_DeletePath(explorerFileSystem, filePath)) {
+				Log_Printf(LOGLEVEL_INFO, "DELETE:  %s deleted", filePath);
 			} else {
-				if (gFSystem.remove(filePath)) {
-					Log_Printf(LOGLEVEL_INFO, "DELETE:  %s deleted", filePath);
-				} else {
-					Log_Printf(LOGLEVEL_ERROR, "DELETE:  Cannot delete %s", filePath);
-				}
+				Log_Printf(LOGLEVEL_ERROR, "DELETE:  Cannot delete %s", filePath);
 			}
 		} else {
 			Log_Printf(LOGLEVEL_ERROR, "DELETE:  Path %s does not exist", filePath);
@@ -2141,7 +2543,7 @@ void explorerHandleCreateRequest(AsyncWebServerRequest *request) {
 		const AsyncWebParameter *param;
 		param = request->getParam("path");
 		const char *filePath = param->value().c_str();
-		if (gFSystem.mkdir(filePath)) {
+		if (explorerFileSystem.mkdir(filePath)) {
 			Log_Printf(LOGLEVEL_INFO, "CREATE:  %s created", filePath);
 		} else {
 			Log_Printf(LOGLEVEL_ERROR, "CREATE:  Cannot create %s", filePath);
@@ -2163,8 +2565,8 @@ void explorerHandleRenameRequest(AsyncWebServerRequest *request) {
 		dstPath = request->getParam("dstpath");
 		const char *srcFullFilePath = srcPath->value().c_str();
 		const char *dstFullFilePath = dstPath->value().c_str();
-		if (gFSystem.exists(srcFullFilePath)) {
-			if (gFSystem.rename(srcFullFilePath, dstFullFilePath)) {
+		if (explorerFileSystem.exists(srcFullFilePath)) {
+			if (explorerFileSystem.rename(srcFullFilePath, dstFullFilePath)) {
 				Log_Printf(LOGLEVEL_INFO, "RENAME:  %s renamed to %s", srcFullFilePath, dstFullFilePath);
 			} else {
 				Log_Printf(LOGLEVEL_ERROR, "RENAME:  Cannot rename %s", srcFullFilePath);
@@ -2206,23 +2608,72 @@ void explorerHandleAudioRequest(AsyncWebServerRequest *request) {
 
 void handlePlaylistRequest(AsyncWebServerRequest *request) {
 	if (lockPlaylistSnapshot()) {
-		size_t capacity = JSON_OBJECT_SIZE(1) + JSON_OBJECT_SIZE(3) + JSON_ARRAY_SIZE(playlistSnapshotEntries.size());
-		for (const auto &entrySnapshot : playlistSnapshotEntries) {
-			capacity += JSON_OBJECT_SIZE(3) + entrySnapshot.displayName.length() + entrySnapshot.path.length() + 64;
+		// Virtual playlists are sent page-wise (around the current track if no offset is requested)
+		std::vector<playlistSnapshotEntry_t> pageEntries;
+		size_t numberOfTracks = playlistSnapshotEntries.size();
+		size_t offset = 0;
+		if (playlistSnapshotSource) {
+			numberOfTracks = getVirtualPlaylistSnapshotCount();
+			if (request->hasParam("offset")) {
+				offset = std::max<long>(request->getParam("offset")->value().toInt(), 0);
+			} else {
+				PlaybackState playbackState;
+				AudioPlayer_GetState(playbackState);
+				if (playbackState.currentTrackNumber > 2) {
+					offset = playbackState.currentTrackNumber - 2;
+				}
+			}
+			for (size_t i = offset; i < numberOfTracks && pageEntries.size() < playlistVirtualPageSize; i++) {
+				const String path = getVirtualPlaylistSnapshotPath(i);
+				pageEntries.push_back(playlistSnapshotEntry_t {static_cast<uint16_t>(i + 1), getPlaylistDisplayName(path.c_str()), path});
+			}
+		}
+		const std::vector<playlistSnapshotEntry_t> &snapshotEntries = playlistSnapshotSource ? pageEntries : playlistSnapshotEntries;
+
+		size_t capacity = JSON_OBJECT_SIZE(1) + JSON_OBJECT_SIZE(7) + JSON_ARRAY_SIZE(snapshotEntries.size());
+		for (const auto &entrySnapshot : snapshotEntries) {
+			capacity += JSON_OBJECT_SIZE(6) + entrySnapshot.displayName.length() + entrySnapshot.path.length() + metadataTitleLength + metadataArtistLength + 64;
 		}
 
 		AsyncJsonResponse *response = new AsyncJsonResponse(false, capacity);
 		JsonObject root = response->getRoot();
 		JsonObject playlistObj = root.createNestedObject("playlist");
 		playlistObj["revision"] = playlistSnapshotRevision;
-		playlistObj["numberOfTracks"] = playlistSnapshotEntries.size();
+		playlistObj["numberOfTracks"] = numberOfTracks;
+		if (playlistSnapshotSource) {
+			playlistObj["virtual"] = true;
+			playlistObj["offset"] = offset;
+		}
 		JsonArray entries = playlistObj.createNestedArray("entries");
-		for (const auto &entrySnapshot : playlistSnapshotEntries) {
+		uint32_t totalDuration = 0;
+		bool durationComplete = !playlistSnapshotSource; // only a page of a virtual playlist is known
+		for (const auto &entrySnapshot : snapshotEntries) {
 			JsonObject entry = entries.createNestedObject();
 			entry["trackNumber"] = entrySnapshot.trackNumber;
-			entry["displayName"] = entrySnapshot.displayName;
 			entry["path"] = entrySnapshot.path;
+			// tag-metadata is filled in background (websocket "playlistMetadata" is sent when done)
+			MetadataInfo metadata = {};
+			char title[metadataTitleLength + metadataArtistLength + 3] = {0};
+			if (Metadata_Lookup(entrySnapshot.path.c_str(), metadata)) {
+				Metadata_FormatTitle(metadata, title, sizeof(title));
+				if (metadata.title[0] != '\0') {
+					entry["title"] = metadata.title;
+				}
+				if (metadata.artist[0] != '\0') {
+					entry["artist"] = metadata.artist;
+				}
+				entry["duration"] = metadata.durationS;
+			}
+			if (title[0] != '\0') {
+				entry["displayName"] = title;
+			} else {
+				entry["displayName"] = entrySnapshot.displayName;
+			}
+			totalDuration += metadata.durationS;
+			durationComplete &= metadata.durationS != 0;
 		}
+		playlistObj["duration"] = totalDuration;
+		playlistObj["durationComplete"] = durationComplete;
 		unlockPlaylistSnapshot();
 
 		if (response->overflowed()) {
@@ -2245,10 +2696,38 @@ void handlePlaylistRequest(AsyncWebServerRequest *request) {
 	request->send(response);
 }
 
+// Edits the current playlist: action is "next" (insert after the current track), "append" or "remove"
+// (trackNumber starts with 1)
+static bool queuePlaylistEdit(const char *action, const char *path, int32_t trackNumber) {
+	if (strcmp(action, "next") == 0) {
+		return AudioPlayer_PlaylistEditToQueueSender(PlaylistEditAction::InsertNext, path);
+	}
+	if (strcmp(action, "append") == 0) {
+		return AudioPlayer_PlaylistEditToQueueSender(PlaylistEditAction::Append, path);
+	}
+	if (strcmp(action, "remove") == 0 && trackNumber > 0 && trackNumber <= (int32_t) getPlaylistSnapshotCount()) {
+		return AudioPlayer_PlaylistEditToQueueSender(PlaylistEditAction::Remove, nullptr, trackNumber - 1);
+	}
+	return false;
+}
+
+void handlePlaylistEditRequest(AsyncWebServerRequest *request) {
+	if (!request->hasParam("action")) {
+		request->send(400);
+		return;
+	}
+	const String action = request->getParam("action")->value();
+	const String path = request->hasParam("path") ? request->getParam("path")->value() : String();
+	const int32_t trackNumber = request->hasParam("trackNumber") ? request->getParam("trackNumber")->value().toInt() : 0;
+	request->send(queuePlaylistEdit(action.c_str(), path.c_str(), trackNumber) ? 200 : 400);
+}
+
 // Handles track progress requests
 void handleTrackProgressRequest(AsyncWebServerRequest *request) {
+	PlaybackState playbackState;
+	AudioPlayer_GetState(playbackState);
 	String json = "{\"trackProgress\":{";
-	json += "\"posPercent\":" + String(gPlayProperties.currentRelPos);
+	json += "\"posPercent\":" + String(playbackState.currentRelPos);
 	json += ",\"time\":" + String(AudioPlayer_GetCurrentTime());
 	json += ",\"duration\":" + String(AudioPlayer_GetFileDuration());
 	json += "}}";
@@ -2262,14 +2741,23 @@ void Web_UpdatePlaylistSnapshot(const Playlist *playlist, uint32_t revision) {
 
 	playlistSnapshotRevision = revision;
 	playlistSnapshotEntries.clear();
-	if (playlist) {
+	playlistSnapshotSource.reset();
+	playlistSnapshotAdded.clear();
+	if (playlist && playlist->isVirtual()) {
+		playlistSnapshotSource = playlist->source();
+		playlistSnapshotOrder = playlist->order();
+		playlistSnapshotEdits = playlist->edits();
+		for (const char *path : playlist->added()) {
+			playlistSnapshotAdded.push_back(path);
+		}
+	} else if (playlist) {
 		playlistSnapshotEntries.reserve(playlist->size());
 		for (size_t i = 0; i < playlist->size(); i++) {
-			const char *path = playlist->at(i);
+			const String path = playlist->at(i);
 			playlistSnapshotEntry_t entrySnapshot;
 			entrySnapshot.trackNumber = static_cast<uint16_t>(i + 1);
-			entrySnapshot.displayName = getPlaylistDisplayName(path);
-			entrySnapshot.path = path ? String(path) : String("");
+			entrySnapshot.displayName = getPlaylistDisplayName(path.c_str());
+			entrySnapshot.path = path;
 			playlistSnapshotEntries.push_back(entrySnapshot);
 		}
 	}
@@ -2284,7 +2772,60 @@ void Web_ClearPlaylistSnapshot(uint32_t revision) {
 
 	playlistSnapshotRevision = revision;
 	playlistSnapshotEntries.clear();
+	playlistSnapshotSource.reset();
+	playlistSnapshotAdded.clear();
+	unlockPlaylistSnapshot();
+}
+
+// Edits only move the following entries of the snapshot (instead of copying the whole playlist again)
+void Web_PlaylistInserted(size_t index, const char *path, uint32_t revision) {
+	if (!lockPlaylistSnapshot()) {
+		return;
+	}
+	if (playlistSnapshotSource) {
+		if (!playlistSnapshotEdits.isActive()) {
+			playlistSnapshotEdits = PlaylistEdits(playlistSnapshotSource->size());
+		}
+		playlistSnapshotEdits.insert(index, playlistSnapshotAdded.size());
+		playlistSnapshotAdded.push_back(path);
+	} else {
+		index = std::min(index, playlistSnapshotEntries.size());
+		playlistSnapshotEntries.insert(playlistSnapshotEntries.begin() + index, playlistSnapshotEntry_t {static_cast<uint16_t>(index + 1), getPlaylistDisplayName(path), path});
+		for (size_t i = index + 1; i < playlistSnapshotEntries.size(); i++) {
+			playlistSnapshotEntries[i].trackNumber = static_cast<uint16_t>(i + 1);
+		}
+	}
+	sendPlaylistDelta(index, path, revision);
+}
+
+void Web_PlaylistRemoved(size_t index, uint32_t revision) {
+	if (!lockPlaylistSnapshot()) {
+		return;
+	}
+	if (playlistSnapshotSource) {
+		if (!playlistSnapshotEdits.isActive()) {
+			playlistSnapshotEdits = PlaylistEdits(playlistSnapshotSource->size());
+		}
+		playlistSnapshotEdits.erase(index);
+	} else if (index < playlistSnapshotEntries.size()) {
+		playlistSnapshotEntries.erase(playlistSnapshotEntries.begin() + index);
+		for (size_t i = index; i < playlistSnapshotEntries.size(); i++) {
+			playlistSnapshotEntries[i].trackNumber = static_cast<uint16_t>(i + 1);
+		}
+	}
+	sendPlaylistDelta(index, nullptr, revision);
+}
+
+// Called with locked snapshot (unlocks it); path is nullptr for removed entries
+static void sendPlaylistDelta(size_t index, const char *path, uint32_t revision) {
+	playlistSnapshotDelta.baseRevision = playlistSnapshotRevision;
+	playlistSnapshotDelta.revision = revision;
+	playlistSnapshotDelta.trackNumber = index + 1;
+	playlistSnapshotDelta.inserted = path != nullptr;
+	playlistSnapshotDelta.path = path ? path : "";
+	playlistSnapshotRevision = revision;
 	unlockPlaylistSnapshot();
+	Web_SendWebsocketData(0, WebsocketCodeType::PlaylistDelta);
 }
 
 void handleGetSavedSSIDs(AsyncWebServerRequest *request) {
@@ -2398,7 +2939,8 @@ static bool tagIdToJSON(const String tagId, JsonObject entry) {
 	uint32_t _lastPlayPos = 0;
 	uint16_t _trackLastPlayed = 0;
 	uint32_t _mode = 1;
-	if (!parseRfidPreferenceEntry(s, _file, sizeof(_file), _lastPlayPos, _mode, _trackLastPlayed)) {
+	uint32_t _lastPlayPosMs = 0;
+	if (!parseRfidPreferenceEntry(s.c_str(), _file, sizeof(_file), _lastPlayPos, _mode, _trackLastPlayed, _lastPlayPosMs)) {
 		return false;
 	}
 	entry["id"] = tagId;
@@ -2409,6 +2951,12 @@ static bool tagIdToJSON(const String tagId, JsonObject entry) {
 		entry["playMode"] = _mode;
 		entry["lastPlayPos"] = _lastPlayPos;
 		entry["trackLastPlayed"] = _trackLastPlayed;
+		if (_lastPlayPosMs == 0) {
+			_lastPlayPosMs = AudioPlayer_GetPlayPositionMs(tagId.c_str(), _lastPlayPos, _trackLastPlayed);
+		}
+		if (_lastPlayPosMs > 0) {
+			entry["lastPlayPosMs"] = _lastPlayPosMs;
+		}
 	}
 	return true;
 }
@@ -2573,6 +3121,8 @@ static void handleDeleteRFIDRequest(AsyncWebServerRequest *request) {
 			Cmd_Action(CMD_STOP);
 		}
 		if (gPrefsRfid.remove(tagId.c_str())) {
+			ShuffleState_Forget(tagId.c_str());
+			AudioPlayer_ForgetPlayPositionMs(tagId.c_str());
 			Log_Printf(LOGLEVEL_INFO, "/rfid (DELETE): tag %s removed successfuly", tagId);
 			request->send(200, "text/plain; charset=utf-8", tagId + " removed successfuly");
 		} else {
@@ -2655,7 +3205,6 @@ void Web_DumpSdToNvs(const char *_filename) {
 		return;
 	}
 
-	Led_SetPause(true);
 	// try to read UTF-8 BOM marker
 	bool isUtf8 = (tmpFile.read() == 0xEF) && (tmpFile.read() == 0xBB) && (tmpFile.read() == 0xBF);
 	if (!isUtf8) {
@@ -2666,7 +3215,6 @@ void Web_DumpSdToNvs(const char *_filename) {
 	while (tmpFile.available() > 0) {
 		if (j >= sizeof(ebuf)) {
 			Log_Println(errorReadingTmpfile, LOGLEVEL_ERROR);
-			Led_SetPause(false);
 			return;
 		}
 		char buf = tmpFile.read();
@@ -2687,7 +3235,7 @@ void Web_DumpSdToNvs(const char *_filename) {
 					if (isUtf8) {
 						lineValid = copyStringToBuffer(parsedEntry.nvsEntry, sizeof(parsedEntry.nvsEntry), token);
 					} else {
-						convertAsciiToUtf8(String(token), parsedEntry.nvsEntry, sizeof(parsedEntry.nvsEntry));
+						convertAsciiToUtf8(token, parsedEntry.nvsEntry, sizeof(parsedEntry.nvsEntry));
 					}
 				} else {
 					lineValid = false;
@@ -2707,7 +3255,6 @@ void Web_DumpSdToNvs(const char *_filename) {
 		}
 	}
 
-	Led_SetPause(false);
 	Log_Printf(LOGLEVEL_NOTICE, importCountNokNvs, invalidCount);
 	tmpFile.close();
 	gFSystem.remove(_filename);
@@ -2715,8 +3262,10 @@ void Web_DumpSdToNvs(const char *_filename) {
 
 // handle album cover image request
 static void handleCoverImageRequest(AsyncWebServerRequest *request) {
+	PlaybackState playbackState;
+	AudioPlayer_GetState(playbackState);
 
-	if (!gPlayProperties.coverFilePos || !gPlayProperties.playlist) {
+	if (!playbackState.coverFilePos || !playbackState.trackPath[0]) {
 		String stationLogoUrl = AudioPlayer_GetStationLogoUrl();
 		if (stationLogoUrl != "") {
 			// serve station logo
@@ -2726,22 +3275,21 @@ static void handleCoverImageRequest(AsyncWebServerRequest *request) {
 		} else
 			// empty image:
 			// request->send(200, "image/svg+xml", "<?xml version=\"1.0\"?><svg xmlns=\"http://www.w3.org/2000/svg\"/>");
-			if (gPlayProperties.playMode == WEBSTREAM || (gPlayProperties.playMode == LOCAL_M3U && gPlayProperties.isWebstream)) {
+			if (playbackState.playMode == WEBSTREAM || (playbackState.playMode == LOCAL_M3U && playbackState.isWebstream)) {
 				// no cover -> send placeholder icon for webstream (fa-soundcloud)
 				Log_Println("no cover image for webstream", LOGLEVEL_NOTICE);
 				request->send(200, "image/svg+xml", "<?xml version=\"1.0\" encoding=\"UTF-8\"?><svg width=\"2304\" height=\"1792\" viewBox=\"0 0 2304 1792\" transform=\"scale (0.6)\" xmlns=\"http://www.w3.org/2000/svg\"><path d=\"M784 1372l16-241-16-523q-1-10-7.5-17t-16.5-7q-9 0-16 7t-7 17l-14 523 14 241q1 10 7.5 16.5t15.5 6.5q22 0 24-23zm296-29l11-211-12-586q0-16-13-24-8-5-16-5t-16 5q-13 8-13 24l-1 6-10 579q0 1 11 236v1q0 10 6 17 9 11 23 11 11 0 20-9 9-7 9-20zm-1045-340l20 128-20 126q-2 9-9 9t-9-9l-17-126 17-128q2-9 9-9t9 9zm86-79l26 207-26 203q-2 9-10 9-9 0-9-10l-23-202 23-207q0-9 9-9 8 0 10 9zm280 453zm-188-491l25 245-25 237q0 11-11 11-10 0-12-11l-21-237 21-245q2-12 12-12 11 0 11 12zm94-7l23 252-23 244q-2 13-14 13-13 0-13-13l-21-244 21-252q0-13 13-13 12 0 14 13zm94 18l21 234-21 246q-2 16-16 16-6 0-10.5-4.5t-4.5-11.5l-20-246 20-234q0-6 4.5-10.5t10.5-4.5q14 0 16 15zm383 475zm-289-621l21 380-21 246q0 7-5 12.5t-12 5.5q-16 0-18-18l-18-246 18-380q2-18 18-18 7 0 12 5.5t5 12.5zm94-86l19 468-19 244q0 8-5.5 13.5t-13.5 5.5q-18 0-20-19l-16-244 16-468q2-19 20-19 8 0 13.5 5.5t5.5 13.5zm98-40l18 506-18 242q-2 21-22 21-19 0-21-21l-16-242 16-506q0-9 6.5-15.5t14.5-6.5q9 0 15 6.5t7 15.5zm392 742zm-198-746l15 510-15 239q0 10-7.5 17.5t-17.5 7.5-17-7-8-18l-14-239 14-510q0-11 7.5-18t17.5-7 17.5 7 7.5 18zm99 19l14 492-14 236q0 11-8 19t-19 8-19-8-9-19l-12-236 12-492q1-12 9-20t19-8 18.5 8 8.5 20zm212 492l-14 231q0 13-9 22t-22 9-22-9-10-22l-6-114-6-117 12-636v-3q2-15 12-24 9-7 20-7 8 0 15 5 14 8 16 26zm1112-19q0 117-83 199.5t-200 82.5h-786q-13-2-22-11t-9-22v-899q0-23 28-33 85-34 181-34 195 0 338 131.5t160 323.5q53-22 110-22 117 0 200 83t83 201z\"/></svg>");
 			} else {
 				// no cover -> send placeholder icon for playing music from SD-card (fa-music)
-				if (gPlayProperties.playMode != NO_PLAYLIST) {
+				if (playbackState.playMode != NO_PLAYLIST) {
 					Log_Println("no cover image for SD-card audio", LOGLEVEL_DEBUG);
 				}
 				request->send(200, "image/svg+xml", "<?xml version=\"1.0\" encoding=\"UTF-8\"?><svg width=\"1792\" height=\"1792\" viewBox=\"0 0 1792 1792\" transform=\"scale (0.6)\" xmlns=\"http://www.w3.org/2000/svg\"><path d=\"M1664 224v1120q0 50-34 89t-86 60.5-103.5 32-96.5 10.5-96.5-10.5-103.5-32-86-60.5-34-89 34-89 86-60.5 103.5-32 96.5-10.5q105 0 192 39v-537l-768 237v709q0 50-34 89t-86 60.5-103.5 32-96.5 10.5-96.5-10.5-103.5-32-86-60.5-34-89 34-89 86-60.5 103.5-32 96.5-10.5q105 0 192 39v-967q0-31 19-56.5t49-35.5l832-256q12-4 28-4 40 0 68 28t28 68z\"/></svg>");
 			}
 		return;
 	}
-	const char *coverFileName = gPlayProperties.playlist->at(gPlayProperties.currentTrackNumber);
-	String decodedCover = "/.cache";
-	decodedCover.concat(coverFileName);
+	const char *coverFileName = playbackState.trackPath;
+	const String decodedCover = CoverCache_GetPath(coverFileName);
 
 	File coverFile;
 	if (gFSystem.exists(decodedCover)) {
@@ -2749,12 +3297,13 @@ static void handleCoverImageRequest(AsyncWebServerRequest *request) {
 	} else {
 		coverFile = gFSystem.open(coverFileName, FILE_READ);
 	}
+	size_t imageSize = playbackState.coverFileSize;
 	char mimeType[255] {0};
 	char fileType[4];
 	coverFile.readBytes(fileType, 4);
 	if (strncmp(fileType, "ID3", 3) == 0) { // mp3 (ID3v2) Routine
 		// seek to start position
-		coverFile.seek(gPlayProperties.coverFilePos);
+		coverFile.seek(playbackState.coverFilePos);
 		uint8_t encoding = coverFile.read();
 		// mime-type (null terminated)
 		for (uint8_t i = 0u; i < 255; i++) {
@@ -2777,7 +3326,7 @@ static void handleCoverImageRequest(AsyncWebServerRequest *request) {
 		}
 	} else if (strncmp(fileType, "fLaC", 4) == 0) { // flac Routine
 		uint32_t length = 0; // length of strings: MIME type, description of the picture, binary picture data
-		coverFile.seek(gPlayProperties.coverFilePos + 7); // pass cover filesize (3 Bytes) and picture type (4 Bytes)
+		coverFile.seek(playbackState.coverFilePos + 7); // pass cover filesize (3 Bytes) and picture type (4 Bytes)
 		for (int i = 0; i < 4; ++i) { // length of mime type string
 			length = (length << 8) | coverFile.read();
 		}
@@ -2796,19 +3345,18 @@ static void handleCoverImageRequest(AsyncWebServerRequest *request) {
 		for (int i = 0; i < 4; ++i) { // length of picture data
 			length = (length << 8) | coverFile.read();
 		}
-		gPlayProperties.coverFileSize = length;
+		imageSize = length;
 	} else {
 		// test for M4A header
 		coverFile.seek(8);
 		coverFile.readBytes(fileType, 3);
 		if (strncmp(fileType, "M4A", 3) == 0) {
 			// M4A header found, seek to image start position. Image length adjustment seems to be not needed, every browser shows cover image correct!
-			coverFile.seek(gPlayProperties.coverFilePos + 8);
+			coverFile.seek(playbackState.coverFilePos + 8);
 		}
 	}
 	Log_Printf(LOGLEVEL_NOTICE, "serve cover image (%s): %s", mimeType, coverFile.name());
 
-	int imageSize = gPlayProperties.coverFileSize;
 	AsyncWebServerResponse *response = request->beginChunkedResponse(mimeType, [coverFile, imageSize](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
 		// some kind of webserver bug with actual size available, reduce the len
 		if (maxLen > 1024) {
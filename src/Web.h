@@ -13,10 +13,14 @@ typedef enum class WebsocketCode {
 	Volume,
 	Settings,
 	Ssid,
-	TrackProgress
+	TrackProgress,
+	PlaylistMetadata,
+	PlaylistDelta
 } WebsocketCodeType;
 
 void Web_Cyclic(void);
 void Web_SendWebsocketData(uint32_t client, WebsocketCodeType code);
 void Web_UpdatePlaylistSnapshot(const Playlist *playlist, uint32_t revision);
 void Web_ClearPlaylistSnapshot(uint32_t revision);
+void Web_PlaylistInserted(size_t index, const char *path, uint32_t revision); // edits are applied to the snapshot and sent as delta
+void Web_PlaylistRemoved(size_t index, uint32_t revision);
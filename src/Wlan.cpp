@@ -760,7 +760,9 @@ void writeWifiStatusToNVS(bool wifiStatus) {
 		Log_Println(wifiEnabledMsg, LOGLEVEL_NOTICE);
 	} else {
 		Log_Println(wifiDisabledMsg, LOGLEVEL_NOTICE);
-		if (gPlayProperties.isWebstream) {
+		PlaybackState playbackState;
+		AudioPlayer_GetState(playbackState);
+		if (playbackState.isWebstream) {
 			AudioPlayer_TrackControlToQueueSender(STOP);
 		}
 	}
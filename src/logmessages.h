@@ -32,6 +32,8 @@ extern const char newLoudnessReceivedQueue[];
 extern const char newEqualizerReceivedQueue[];
 extern const char newCntrlReceivedQueue[];
 extern const char newPlaylistReceived[];
+extern const char playlistEdited[];
+extern const char playlistEditNotAllowed[];
 extern const char repeatTrackDueToPlaymode[];
 extern const char repeatPlaylistDueToPlaymode[];
 extern const char cmndStop[];
@@ -48,6 +50,7 @@ extern const char trackStart[];
 extern const char trackChangeWebstream[];
 extern const char endOfPlaylistReached[];
 extern const char trackStartatPos[];
+extern const char trackStartatTime[];
 extern const char waitingForTaskQueues[];
 extern const char rfidScannerReady[];
 extern const char rfidTagDetected[];
@@ -91,6 +94,8 @@ extern const char modificatorSleepTimer120[];
 extern const char ledsDimmedToNightmode[];
 extern const char ledsDimmedToInitialValue[];
 extern const char ledsBrightnessRestored[];
+extern const char ledAnimationLoaded[];
+extern const char ledAnimationInvalid[];
 extern const char modificatorNotallowedWhenIdle[];
 extern const char modificatorSleepAtEOT[];
 extern const char modificatorSleepAtEOP[];
@@ -117,6 +122,8 @@ extern const char unableToCreateRfidQ[];
 extern const char unableToCreateMgmtQ[];
 extern const char unableToCreatePlayQ[];
 extern const char unableToCreateEqualizerQ[];
+extern const char unableToCreatePlaylistEditQ[];
+extern const char unableToCreateButtonQ[];
 extern const char initialBrightnessfromNvs[];
 extern const char wroteInitialBrightnessToNvs[];
 extern const char restoredInitialBrightnessForNmFromNvs[];
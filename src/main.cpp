@@ -10,20 +10,26 @@
 #include "Button.h"
 #include "Cmd.h"
 #include "Common.h"
+#include "CoverCache.h"
 #include "Ftp.h"
 #include "HallEffectSensor.h"
 #include "IrReceiver.h"
+#include "Latency.h"
 #include "Led.h"
 #include "Log.h"
+#include "Loudness.h"
 #include "MemX.h"
+#include "Metadata.h"
 #include "Mqtt.h"
 #include "Port.h"
 #include "Power.h"
 #include "Queues.h"
+#include "ReadCache.h"
 #include "Rfid.h"
 #include "RotaryEncoder.h"
 #include "SdCard.h"
 #include "System.h"
+#include "Trace.h"
 #include "Web.h"
 #include "Wlan.h"
 #include "revision.h"
@@ -129,6 +135,9 @@ void recoverLastRfidPlayedFromNvs(bool force) {
 
 void setup() {
 	Log_Init();
+#ifdef TRACE_ENABLE
+	Trace_Init();
+#endif
 	Queues_Init();
 
 	// Make sure all wakeups can be enabled *before* initializing RFID, which can enter sleep immediately
@@ -152,6 +161,7 @@ void setup() {
 
 	// Needs i2c first if port-expander is used
 	Port_Init();
+	Button_Start(); // reads the port-expander on interrupts
 
 	// If port-expander is used, port_init has to be called first, as power can be (possibly) done by port-expander
 	Power_Init();
@@ -183,6 +193,13 @@ void setup() {
 
 	// Needs power first
 	SdCard_Init();
+	Led_LoadAnimations();
+	ReadCache_Init();
+	Metadata_Init();
+	CoverCache_Init();
+#ifdef REPLAYGAIN_ENABLE
+	Loudness_Init();
+#endif
 
 	// welcome message
 	Serial.print(logo);
@@ -263,11 +280,11 @@ void loop() {
 	}
 	vTaskDelay(portTICK_PERIOD_MS * 1u);
 	Battery_Cyclic();
-	// Port_Cyclic(); // called by button (controlled via hw-timer)
-	Button_Cyclic();
+	Button_Cyclic(); // runs actions of buttons (read by button-task)
 	vTaskDelay(portTICK_PERIOD_MS * 1u);
 	System_Cyclic();
 	Rfid_PreferenceLookupHandler();
+	Latency_Cyclic();
 
 #ifdef PLAY_LAST_RFID_AFTER_REBOOT
 	recoverBootCountFromNvs();
@@ -59,6 +59,8 @@
 	//#define SAVE_PLAYPOS_BEFORE_SHUTDOWN  // When playback is active and mode audiobook was selected, last play-position is saved automatically when shutdown is initiated
 	//#define SAVE_PLAYPOS_WHEN_RFID_CHANGE // When playback is active and mode audiobook was selected, last play-position is saved automatically for old playlist when new RFID-tag is applied
 	//#define HALLEFFECT_SENSOR_ENABLE      // Support for hallsensor. For fine-tuning please adjust HallEffectSensor.h Please note: only user-support provided (https://forum.espuino.de/t/magnetische-hockey-tags/1449/35)
+	#define REPLAYGAIN_ENABLE               // Levels the loudness of tracks via ReplayGain-tags; untagged files are measured (EBU R128): WAV in background, others while played
+	//#define TRACE_ENABLE                  // Records begin/end timestamps of hot paths (playlist, SD, NVS, RFID, websocket) into a ring-buffer. Export via http://ESPuino.local/trace (Chrome trace-event format)
 	#define VOLUMECURVE 0 					// 0=square, 1=logarithmic (1 is more flatten at lower volume)
 
 	//################## set PAUSE_WHEN_RFID_REMOVED behaviour #############################
@@ -116,6 +118,10 @@
 		BUTTON_3_SHORT => Button 3 (ROTARYENCODER_BUTTON) pressed shortly
 		BUTTON_4_LONG => Button 4 (BUTTON_4) pressed long
 
+	Double-click [optional, CMD_NOTHING disables it] (examples):
+		BUTTON_2_DOUBLE => Button 2 (PAUSEPLAY_BUTTON) pressed shortly twice
+		Hint: a button with double-click enabled fires its short action only after intervalToDoubleClick passed
+
 	Multi-buttons [short only] (examples):
 		BUTTON_MULTI_01 => Buttons 0+1 (NEXT_BUTTON + PREVIOUS_BUTTON) pressed in parallel
 		BUTTON_MULTI_12 => Buttons 1+2 (PREV_BUTTON + PAUSEPLAY_BUTTON) pressed in parallel
@@ -140,6 +146,13 @@
 	#define BUTTON_4_LONG     CMD_VOLUMEUP
 	#define BUTTON_5_LONG     CMD_VOLUMEDOWN
 
+	#define BUTTON_0_DOUBLE   CMD_NOTHING
+	#define BUTTON_1_DOUBLE   CMD_NOTHING
+	#define BUTTON_2_DOUBLE   CMD_NOTHING
+	#define BUTTON_3_DOUBLE   CMD_NOTHING
+	#define BUTTON_4_DOUBLE   CMD_NOTHING
+	#define BUTTON_5_DOUBLE   CMD_NOTHING
+
 	#define BUTTON_MULTI_01   CMD_NOTHING   //CMD_TOGGLE_WIFI_STATUS (disabled now to prevent children from unwanted WiFi-disable)
 	#define BUTTON_MULTI_02   CMD_ENABLE_FTP_SERVER
 	#define BUTTON_MULTI_03   CMD_NOTHING
@@ -174,6 +187,7 @@
 	// Buttons (better leave unchanged if in doubts :-))
 	constexpr uint8_t buttonDebounceInterval = 50;                // Interval in ms to software-debounce buttons
 	constexpr uint16_t intervalToLongPress = 700;                 // Interval in ms to distinguish between short and long press of buttons
+	constexpr uint16_t intervalToDoubleClick = 300;               // Interval in ms the second click of a double-click has to follow (only for buttons with BUTTON_n_DOUBLE)
 
 	// Buttons active state: Default 0 for active LOW, 1 for active HIGH e.g. for TTP223 Capacitive Touch Switch Button (FinnBox)
 	#define BUTTON_0_ACTIVE_STATE 0
@@ -201,9 +215,51 @@
 	constexpr uint16_t AUDIO_STREAM_STARTUP_TIMEOUT_MS = 12000;  // Grace period for webstreams to fill buffers and start playback
 	constexpr uint16_t AUDIO_STREAM_STALL_TIMEOUT_MS = 15000;    // Maximum time without observable stream progress before recovery kicks in
 	constexpr uint8_t AUDIO_STREAM_LOW_BUFFER_PERCENT = 12;      // Input buffer threshold below which a webstream is considered low on buffered data
+	constexpr uint16_t AUDIO_STREAM_PREBUFFER_MIN_MS = 2000;     // Prebuffer target (ms of audio) for streams with enough throughput-headroom
+	constexpr uint16_t AUDIO_STREAM_PREBUFFER_MAX_MS = 20000;    // Prebuffer target for streams whose throughput is at (or below) their bitrate
+	constexpr uint16_t AUDIO_STREAM_UNDERRUN_MS = 500;           // Rebuffer if less audio than this is buffered while throughput is below bitrate
+	constexpr uint16_t AUDIO_STREAM_RECONNECT_BASE_MS = 1000;    // Delay after the first failed reconnect; doubled for every further failure
+	constexpr uint16_t AUDIO_STREAM_RECONNECT_MAX_MS = 30000;    // Upper limit for the reconnect delay
+	constexpr uint8_t AUDIO_STREAM_RECONNECT_MAX_ATTEMPTS = 8;   // Skip the stream after this number of failed reconnects
 	constexpr uint32_t AUDIO_INPUT_BUFFER_RAM_BYTES = 1600 * 10 * 2;    // Keep internal RAM usage modest
 	constexpr uint32_t AUDIO_INPUT_BUFFER_PSRAM_BYTES = __UINT16_MAX__ * 12; // Use PSRAM to provide more reserve for streams when available
 
+	// Fades (gain-envelope of the PCM-output)
+	constexpr uint16_t AUDIO_FADE_PAUSE_MS = 300;                // Fade-out before pause/stop/track-change and fade-in on resume (0 = cut)
+	constexpr uint16_t AUDIO_CROSSFADE_MS = 1500;                // Fade-out at the end of a track and fade-in of the next one within a playlist (0 = off)
+	constexpr uint32_t AUDIO_SLEEP_FADE_MS = 30000;              // Fade-out of the last seconds before the sleep-timer expires
+
+	// Loudness-levelling (REPLAYGAIN_ENABLE)
+	#ifdef REPLAYGAIN_ENABLE
+		constexpr int8_t REPLAYGAIN_TARGET_LUFS = -18;           // Loudness measured files are levelled to (reference of ReplayGain 2.0)
+		constexpr int16_t REPLAYGAIN_PREAMP_CB = 0;              // Added to every track-gain (in 1/100 dB)
+		constexpr int16_t REPLAYGAIN_MAX_BOOST_CB = 600;         // Quiet tracks are raised by 6 dB at most (peaks are clipped)
+	#endif
+
+	// Read-ahead cache for audio-files (only used if PSRAM is available)
+	constexpr uint32_t READ_CACHE_BLOCK_SIZE = 32768;            // Bytes read from SD at once (aligned to file-offset; keep it a multiple of the FAT cluster-size)
+	constexpr uint8_t READ_CACHE_BLOCKS = 4;                     // Number of cached blocks (READ_CACHE_BLOCK_SIZE each)
+
+	// Index of tag-metadata (title, artist, track-number, duration) of audio-files
+	constexpr uint16_t METADATA_INDEX_ENTRIES = 1024;            // Number of indexed files (128 bytes each; only 64 without PSRAM)
+	constexpr const char METADATA_INDEX_FILE[] = "/.metadataIndex"; // Index is kept on SD between reboots
+
+	// Shuffle-state of random-mode cards ("no repeat until all played", kept in NVS)
+	constexpr uint8_t SHUFFLE_STATE_CARDS = 8;                   // Number of cards whose state is kept; the least recently used one is dropped
+	constexpr uint16_t SHUFFLE_STATE_MAX_TRACKS = 1024;          // Played tracks are only tracked up to this playlist-size (1 bit each); bigger playlists just keep their order and position
+
+	// Seek-tables (time <-> byte-offset) of VBR audio-files
+	constexpr uint16_t SEEK_TABLE_POINTS = 256;                  // Points per file; long files get a coarser interval
+	constexpr const char SEEK_TABLE_DIR[] = "/.cache";           // Tables are cached on SD (8 bytes per point)
+
+	// Announcements of IP-address and time (pre-recorded wav-clips instead of online text-to-speech)
+	constexpr const char ANNOUNCEMENT_CLIP_DIR[] = "/.speech";  // Clips are expected in <dir>/<de|en|fr>/; online speech is only used if one is missing
+
+	// Tracing
+	#ifdef TRACE_ENABLE
+		constexpr uint16_t TRACE_EVENTS_PER_CORE = 1024;        // Number of events kept per core (16 bytes each; allocated in PSRAM if available)
+	#endif
+
 	// Automatic restart
 	#ifdef SHUTDOWN_IF_SD_BOOT_FAILS
 		constexpr uint32_t deepsleepTimeAfterBootFails = 20;      // Automatic restart takes place if boot was not successful after this period (in seconds)
@@ -243,6 +299,7 @@
 		#define PROGRESS_HUE_END		-1
 		#define DIMMABLE_STATES			50		// Number of dimmed values between two full LEDs (https://forum.espuino.de/t/led-verbesserungen-rework/1739)
 		//#define LED_OFFSET                		0           	// shifts the starting LED in the original direction of the neopixel ring
+		constexpr const char LED_ANIMATION_DIR[] = "/.leds";	// Custom animations (boot, bootError, error, ok, voltageWarning, idle, busy, pause, speech) as <dir>/<name>.json; idle, busy and pause get palette-color 0 from the state
 	#endif
 
 	#if defined(MEASURE_BATTERY_VOLTAGE) || defined(MEASURE_BATTERY_MAX17055)
@@ -294,6 +351,9 @@
 		constexpr const char topicRfidState[] = "State/ESPuino/Rfid";
 		constexpr const char topicTrackState[] = "State/ESPuino/Track";
 		constexpr const char topicTrackControlCmnd[] = "Cmnd/ESPuino/TrackControl";
+		constexpr const char topicPlayNextCmnd[] = "Cmnd/ESPuino/PlayNext";
+		constexpr const char topicAppendTrackCmnd[] = "Cmnd/ESPuino/AppendTrack";
+		constexpr const char topicRemoveTrackCmnd[] = "Cmnd/ESPuino/RemoveTrack";
 		constexpr const char topicCoverChangedState[] = "State/ESPuino/CoverChanged";
 		constexpr const char topicLoudnessCmnd[] = "Cmnd/ESPuino/Loudness";
 		constexpr const char topicLoudnessState[] = "State/ESPuino/Loudness";
@@ -310,6 +370,7 @@
 		constexpr const char topicLedBrightnessState[] = "State/ESPuino/LedBrightness";
 		constexpr const char topicWiFiRssiState[] = "State/ESPuino/WifiRssi";
 		constexpr const char topicSRevisionState[] = "State/ESPuino/SoftwareRevision";
+		constexpr const char topicLatencyState[] = "State/ESPuino/Latency";
 		#ifdef BATTERY_MEASURE_ENABLE
 		constexpr const char topicBatteryVoltage[] = "State/ESPuino/Voltage";
 		constexpr const char topicBatterySOC[]     = "State/ESPuino/Battery";
@@ -0,0 +1,60 @@
+#include "Common.h"
+
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <vector>
+
+// Base64-decoding of cover-data in chunks of 2 KiB (CoverCache_ChunkSize), in place like CoverCache does:
+// b64decode() vs. the former decoder (int-table, one group per round). Both include copying the chunk.
+namespace {
+constexpr size_t chunkSize = 2048;
+
+const int referenceIndex[256] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 62, 63, 62, 62, 63, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 0, 0, 0, 0, 63, 0, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51};
+
+// Complete groups only, as CoverCache decodes them
+size_t referenceDecode(const uint8_t *in, uint8_t *out, size_t length) {
+	size_t j = 0;
+	for (size_t i = 0; i + 4 <= length; i += 4) {
+		const int n = referenceIndex[in[i]] << 18 | referenceIndex[in[i + 1]] << 12 | referenceIndex[in[i + 2]] << 6 | referenceIndex[in[i + 3]];
+		out[j++] = n >> 16;
+		out[j++] = n >> 8 & 0xFF;
+		out[j++] = n & 0xFF;
+	}
+	return j;
+}
+
+std::vector<uint8_t> encodedChunk() {
+	constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	std::vector<uint8_t> chunk(chunkSize);
+	uint32_t state = 0x12345678u;
+	for (uint8_t &c : chunk) {
+		state = state * 1664525u + 1013904223u;
+		c = alphabet[state >> 26];
+	}
+	return chunk;
+}
+
+void BM_B64DecodeReference(benchmark::State &state) {
+	const std::vector<uint8_t> input = encodedChunk();
+	std::vector<uint8_t> buffer(chunkSize);
+	for (auto _ : state) {
+		memcpy(buffer.data(), input.data(), chunkSize);
+		benchmark::DoNotOptimize(referenceDecode(buffer.data(), buffer.data(), chunkSize));
+		benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * chunkSize);
+}
+BENCHMARK(BM_B64DecodeReference);
+
+void BM_B64Decode(benchmark::State &state) {
+	const std::vector<uint8_t> input = encodedChunk();
+	std::vector<uint8_t> buffer(chunkSize);
+	for (auto _ : state) {
+		memcpy(buffer.data(), input.data(), chunkSize);
+		benchmark::DoNotOptimize(b64decode(buffer.data(), buffer.data(), chunkSize));
+		benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * chunkSize);
+}
+BENCHMARK(BM_B64Decode);
+} // namespace
@@ -0,0 +1,54 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Equalizer.h"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <vector>
+
+// Equalizer on blocks of 1152 stereo frames (one MP3-frame) at 44.1 kHz with 0, 1, 4 and 8 active bands.
+// "cycles/block" is what Equalizer_Process() measures itself (as reported by /info on the target); on the host
+// these are TSC-cycles, so compare them between changes, not with the ESP32's 240 MHz.
+namespace {
+constexpr uint16_t blockFrames = 1152;
+constexpr uint8_t channels = 2;
+
+std::vector<int16_t> music() {
+	std::vector<int16_t> samples(blockFrames * channels);
+	for (size_t frame = 0; frame < blockFrames; frame++) {
+		const double t = frame / 44100.0;
+		const double value = 6000 * sin(2 * M_PI * 110 * t) + 3000 * sin(2 * M_PI * 1000 * t) + 1500 * sin(2 * M_PI * 6000 * t);
+		samples[frame * channels] = static_cast<int16_t>(value);
+		samples[frame * channels + 1] = static_cast<int16_t>(-value);
+	}
+	return samples;
+}
+
+void BM_EqualizerBlock(benchmark::State &state) {
+	const uint8_t activeBands = state.range(0);
+	EqualizerPresets presets = {};
+	for (uint8_t band = 0; band < activeBands; band++) {
+		presets.speaker[band] = (band % 2) ? -4 : 5;
+	}
+	Equalizer_SetSampleRate(44100);
+	Equalizer_SelectOutput(EqualizerOutput::Speaker);
+	Equalizer_SetPresets(presets);
+
+	const std::vector<int16_t> input = music();
+	std::vector<int16_t> block(input.size());
+	uint64_t cycles = 0;
+	for (auto _ : state) {
+		block = input;
+		Equalizer_Process(block.data(), blockFrames, channels);
+		EqualizerStats stats;
+		Equalizer_GetStats(stats);
+		cycles += (activeBands > 0) ? stats.lastCycles : 0;
+		benchmark::DoNotOptimize(block.data());
+		benchmark::ClobberMemory();
+	}
+	state.counters["cycles/block"] = benchmark::Counter(static_cast<double>(cycles) / state.iterations());
+	state.SetItemsProcessed(state.iterations() * blockFrames);
+}
+BENCHMARK(BM_EqualizerBlock)->Arg(0)->Arg(1)->Arg(4)->Arg(8);
+} // namespace
@@ -0,0 +1,85 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "LedAnimation.h"
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+// Cost of one frame of an LED-animation on a ring of 24 LEDs: drawn by code every frame (as before the frame-tables)
+// vs. copied from the compiled table. Host-timings, so only the ratio carries over to the ESP32.
+namespace {
+constexpr uint8_t numLeds = 24;
+constexpr uint8_t numDots = 4;
+
+uint8_t address(uint8_t number) {
+	return numLeds - 1 - number; // NEOPIXEL_REVERSE_ROTATION
+}
+
+// Idle/busy: black ring with rotating dots (Led_DrawIdleDots())
+void BM_IdleDrawnByCode(benchmark::State &state) {
+	std::vector<CRGB> leds(numLeds);
+	uint8_t step = 0;
+	for (auto _ : state) {
+		for (CRGB &led : leds) {
+			led = CRGB::Black;
+		}
+		for (uint8_t i = 0; i < numDots; i++) {
+			leds[(address(step) + i * (numLeds / numDots)) % numLeds] = CRGB::White;
+		}
+		step = (step + 1) % numLeds;
+		benchmark::DoNotOptimize(leds.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IdleDrawnByCode);
+
+void BM_IdleFromTable(benchmark::State &state) {
+	LedAnimation animation;
+	animation.compile(LedAnimation_RotatingDots(CRGB::White, 500, numLeds, numDots, address), numLeds, address);
+	std::vector<CRGB> leds(numLeds);
+	uint16_t holdMs;
+	for (auto _ : state) {
+		animation.render(false, leds.data(), holdMs);
+		benchmark::DoNotOptimize(leds.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IdleFromTable);
+
+// Eased transition between two colors: blended every frame vs. taken from the table
+void BM_FadeBlendedByCode(benchmark::State &state) {
+	constexpr uint16_t steps = 25; // 500 ms in frames of 20 ms
+	const CRGB from = CRGB::Red;
+	const CRGB to = CRGB::Blue;
+	std::vector<CRGB> leds(numLeds);
+	uint16_t step = 0;
+	for (auto _ : state) {
+		const uint8_t amount = ease8InOutQuad((step * 256u) / steps);
+		for (uint8_t i = 0; i < numLeds; i++) {
+			leds[address(i)] = blend(from, to, amount);
+		}
+		step = (step + 1) % steps;
+		benchmark::DoNotOptimize(leds.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FadeBlendedByCode);
+
+void BM_FadeFromTable(benchmark::State &state) {
+	LedAnimation animation;
+	animation.compile(LedAnimationDescriptor {{CRGB::Red, CRGB::Blue}, {{500, LedEasing::EaseInOut, "0"}, {500, LedEasing::EaseInOut, "1"}}, 0}, numLeds, address);
+	std::vector<CRGB> leds(numLeds);
+	uint16_t holdMs;
+	for (auto _ : state) {
+		animation.render(false, leds.data(), holdMs);
+		benchmark::DoNotOptimize(leds.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FadeFromTable);
+} // namespace
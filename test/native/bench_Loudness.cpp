@@ -0,0 +1,38 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Loudness.h"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <vector>
+
+// R128-metering of a played track on blocks of 1152 stereo frames (one MP3-frame) at 44.1 kHz, as it runs in
+// audio_process_i2s(). "cycles/block" is what Loudness_ProcessTrack() measures itself (/info, "audio" -> "loudness");
+// on the host these are TSC-cycles: compare them with BM_EqualizerBlock, not with the ESP32's 240 MHz.
+namespace {
+constexpr uint16_t blockFrames = 1152;
+constexpr uint8_t channels = 2;
+
+void BM_LoudnessTrackBlock(benchmark::State &state) {
+	std::vector<int16_t> block(blockFrames * channels);
+	for (size_t frame = 0; frame < blockFrames; frame++) {
+		const double value = 6000 * sin(2 * M_PI * 110 * frame / 44100.0) + 3000 * sin(2 * M_PI * 1000 * frame / 44100.0);
+		block[frame * channels] = static_cast<int16_t>(value);
+		block[frame * channels + 1] = static_cast<int16_t>(-value);
+	}
+	Loudness_BeginTrack("/bench/track.mp3"); // never ended: nothing is stored
+	uint64_t cycles = 0;
+	for (auto _ : state) {
+		Loudness_ProcessTrack(block.data(), blockFrames, channels, 44100);
+		LoudnessStats stats;
+		Loudness_GetStats(stats);
+		cycles += stats.lastCycles;
+		benchmark::ClobberMemory();
+	}
+	Loudness_BeginTrack(nullptr);
+	state.counters["cycles/block"] = benchmark::Counter(static_cast<double>(cycles) / state.iterations());
+	state.SetItemsProcessed(state.iterations() * blockFrames);
+}
+BENCHMARK(BM_LoudnessTrackBlock);
+} // namespace
@@ -0,0 +1,149 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Common.h"
+#include "SdCard.h"
+
+#include "HostFS.h"
+
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+// Playlist build, sort and parse over synthetic trees of 10k files (created once in a temporary directory)
+namespace {
+constexpr size_t treeFiles = 10000;
+constexpr size_t treeDirectories = 100;
+
+std::string trackName(size_t i) {
+	char name[64];
+	snprintf(name, sizeof(name), "%02zu - Track %zu of Album %zu.mp3", i % 100 + 1, i, i / 100);
+	return name;
+}
+
+class SyntheticCard {
+public:
+	SyntheticCard() {
+		std::string extendedM3u = "#EXTM3U\n";
+		std::string plainM3u;
+		for (size_t i = 0; i < treeFiles; i++) {
+			const std::string name = trackName(i);
+			dir_.writeFile("flat/" + name);
+			dir_.writeFile("tree/Album " + std::to_string(i / (treeFiles / treeDirectories)) + "/" + name);
+			extendedM3u += "#EXTINF:215,Artist - Title " + std::to_string(i) + "\n/flat/" + name + "\n";
+			plainM3u += "/flat/" + name + "\n";
+			names_.push_back("/flat/" + name);
+		}
+		for (size_t i = 0; i < treeFiles / 10; i++) { // not everything on a card is audio
+			dir_.writeFile("flat/cover" + std::to_string(i) + ".jpg");
+		}
+		dir_.writeFile("extended.m3u", extendedM3u);
+		dir_.writeFile("plain.m3u", plainM3u);
+		HostFS_Mount(HostFS_CreateImpl(dir_.path()));
+	}
+
+	const std::vector<std::string> &names() const {
+		return names_;
+	}
+
+private:
+	HostTempDir dir_;
+	std::vector<std::string> names_;
+};
+
+const SyntheticCard &card() {
+	static SyntheticCard card;
+	return card;
+}
+
+void buildPlaylist(benchmark::State &state, const char *path, uint32_t playMode) {
+	card();
+	size_t entries = 0;
+	for (auto _ : state) {
+		std::optional<Playlist *> playlist = SdCard_ReturnPlaylist(path, playMode);
+		if (!playlist) {
+			state.SkipWithError("no playlist");
+			break;
+		}
+		entries = (*playlist)->size();
+		freePlaylist(*playlist);
+	}
+	state.counters["entries"] = entries;
+	state.SetItemsProcessed(state.iterations() * entries);
+}
+
+void BM_PlaylistBuildDirectory(benchmark::State &state) {
+	buildPlaylist(state, "/flat", ALL_TRACKS_OF_DIR_SORTED);
+}
+BENCHMARK(BM_PlaylistBuildDirectory)->Unit(benchmark::kMillisecond);
+
+// Virtual playlist: recursive scan, per-directory sort and writing the index-files
+void BM_PlaylistBuildRecursive(benchmark::State &state) {
+	buildPlaylist(state, "/tree", ALL_TRACKS_OF_ALL_SUBDIRS_SORTED);
+}
+BENCHMARK(BM_PlaylistBuildRecursive)->Unit(benchmark::kMillisecond);
+
+void BM_PlaylistParseExtendedM3u(benchmark::State &state) {
+	buildPlaylist(state, "/extended.m3u", LOCAL_M3U);
+}
+BENCHMARK(BM_PlaylistParseExtendedM3u)->Unit(benchmark::kMillisecond);
+
+void BM_PlaylistParsePlainM3u(benchmark::State &state) {
+	buildPlaylist(state, "/plain.m3u", LOCAL_M3U);
+}
+BENCHMARK(BM_PlaylistParsePlainM3u)->Unit(benchmark::kMillisecond);
+
+// Sorts the entries of a 10k-playlist, starting from enumeration-order (which is unsorted on FAT)
+void BM_PlaylistSort(benchmark::State &state) {
+	const playlistSortMode mode = static_cast<playlistSortMode>(state.range(0));
+	std::vector<std::string> names = card().names();
+	uint32_t seed = 1;
+	for (size_t i = names.size() - 1; i > 0; i--) {
+		seed = seed * 1664525u + 1013904223u;
+		std::swap(names[i], names[seed % (i + 1)]);
+	}
+	for (auto _ : state) {
+		state.PauseTiming();
+		Playlist *playlist = new Playlist();
+		for (const std::string &name : names) {
+			playlist->push_back(strdup(name.c_str()));
+		}
+		state.ResumeTiming();
+		Playlist_Sort(playlist, mode);
+		benchmark::DoNotOptimize(playlist->entries().data());
+		state.PauseTiming();
+		freePlaylist(playlist);
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * names.size());
+}
+BENCHMARK(BM_PlaylistSort)
+	->ArgName("mode")
+	->Arg(static_cast<int>(playlistSortMode::STRCMP))
+	->Arg(static_cast<int>(playlistSortMode::STRNATCMP))
+	->Arg(static_cast<int>(playlistSortMode::STRNATCASECMP))
+	->Unit(benchmark::kMillisecond);
+
+void BM_FileValid(benchmark::State &state) {
+	const std::vector<std::string> &names = card().names();
+	for (auto _ : state) {
+		size_t valid = 0;
+		for (const std::string &name : names) {
+			valid += fileValid(name.c_str());
+		}
+		benchmark::DoNotOptimize(valid);
+	}
+	state.SetItemsProcessed(state.iterations() * names.size());
+}
+BENCHMARK(BM_FileValid);
+
+void BM_ParseRfidPreferenceEntry(benchmark::State &state) {
+	char file[255];
+	uint32_t lastPlayPos, playMode, lastPlayPosMs;
+	uint16_t trackLastPlayed;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(parseRfidPreferenceEntry("#/Hoerspiele/Folge 123 - Der Titel#123456#3#17#654321", file, sizeof(file), lastPlayPos, playMode, trackLastPlayed, lastPlayPosMs));
+	}
+}
+BENCHMARK(BM_ParseRfidPreferenceEntry);
+} // namespace
@@ -0,0 +1,103 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "ReadCache.h"
+#include "SdCard.h"
+
+#include "HostClock.h"
+#include "HostFS.h"
+#include "HostSdCard.h"
+#include "driver/sdmmc_host.h"
+
+#include <benchmark/benchmark.h>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Playback of a 1 MiB track in decoder-sized reads on the simulated card (HostSdCard.h): through the read-cache
+// (gFSystemAudio) vs. directly (gFSystem). Times are those of the model (manual time), the clock is frozen meanwhile.
+namespace {
+constexpr uint32_t trackBytes = 1024 * 1024;
+constexpr size_t decoderChunks[] = {1600, 4096, 417, 2880, 1044};
+
+enum Bus : int64_t {
+	Spi = 0,
+	Sdmmc = 1,
+};
+
+class SimulatedCards {
+public:
+	SimulatedCards() {
+		dir_.writeFile("track.mp3", std::string(trackBytes, '\x55'));
+		spi_ = HostSdCard_CreateImpl(HostFS_CreateImpl(dir_.path()), HostSdCard_SpiModel());
+		sdmmc_ = HostSdCard_CreateImpl(HostFS_CreateImpl(dir_.path()), HostSdCard_Sdmmc1BitModel());
+		ReadCache_Init();
+	}
+
+	fs::FSImplPtr impl(Bus bus) const {
+		return bus == Spi ? spi_ : sdmmc_;
+	}
+
+private:
+	HostTempDir dir_;
+	fs::FSImplPtr spi_;
+	fs::FSImplPtr sdmmc_;
+};
+
+const SimulatedCards &cards() {
+	static SimulatedCards cards;
+	return cards;
+}
+
+void playTrack(benchmark::State &state, fs::FS &fileSystem) {
+	const Bus bus = static_cast<Bus>(state.range(0));
+	fs::FSImplPtr impl = cards().impl(bus);
+	HostFS_Mount(impl);
+	state.SetLabel(bus == Spi ? "SPI 4 MHz" : "SDMMC 1-bit 26 MHz");
+	HostClock_Freeze(true);
+	sdmmc_host_set_card_clk(SDMMC_HOST_SLOT_1, SDMMC_FREQ_26M);
+	std::vector<uint8_t> buf(4096);
+	ReadCacheStats before, after;
+	fileSystem.exists("/track.mp3"); // same directory-window for both variants, whichever runs first
+	ReadCache_GetStats(before);
+	HostSdCardStats stats;
+	for (auto _ : state) {
+		HostSdCard_ResetStats(impl);
+		File file = fileSystem.open("/track.mp3", FILE_READ);
+		uint32_t done = 0;
+		for (size_t i = 0; file && done < trackBytes; i++) {
+			const size_t bytesRead = file.read(buf.data(), decoderChunks[i % std::size(decoderChunks)]);
+			if (bytesRead == 0) {
+				break;
+			}
+			done += bytesRead;
+		}
+		file.close();
+		if (done != trackBytes) {
+			state.SkipWithError("failed");
+			break;
+		}
+		stats = HostSdCard_GetStats(impl);
+		state.SetIterationTime(stats.simulatedUs / 1e6);
+	}
+	HostClock_Freeze(false);
+	HostFS_Mount(nullptr);
+	ReadCache_GetStats(after);
+	state.SetBytesProcessed(state.iterations() * trackBytes);
+	state.counters["commands"] = stats.commands;
+	state.counters["blocksRead"] = stats.blocksRead;
+	const uint32_t hits = after.hits - before.hits;
+	const uint32_t misses = after.misses - before.misses;
+	state.counters["hitRate"] = hits + misses ? double(hits) / (hits + misses) : 0.0;
+}
+
+void BM_SimulatedTrackReadCached(benchmark::State &state) {
+	playTrack(state, gFSystemAudio);
+}
+BENCHMARK(BM_SimulatedTrackReadCached)->ArgName("bus")->Arg(Spi)->Arg(Sdmmc)->UseManualTime()->Iterations(1)->Unit(benchmark::kMillisecond);
+
+void BM_SimulatedTrackReadDirect(benchmark::State &state) {
+	playTrack(state, gFSystem);
+}
+BENCHMARK(BM_SimulatedTrackReadDirect)->ArgName("bus")->Arg(Spi)->Arg(Sdmmc)->UseManualTime()->Iterations(1)->Unit(benchmark::kMillisecond);
+} // namespace
@@ -0,0 +1,163 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "SdCard.h"
+
+#include "HostClock.h"
+#include "HostFS.h"
+#include "HostSdCard.h"
+#include "driver/sdmmc_host.h"
+
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+// SD-card access on the simulated card (HostSdCard.h), SPI vs. SDMMC 1-bit. Times are those of the model (manual time),
+// not of the host; the clock is frozen while a benchmark runs, so SdCard_RunBenchmark() measures the model, too.
+namespace {
+constexpr size_t treeFiles = 10000;
+constexpr size_t treeDirectories = 100;
+
+enum Bus : int64_t {
+	Spi = 0,
+	Sdmmc = 1,
+};
+
+class SimulatedCards {
+public:
+	SimulatedCards() {
+		for (size_t i = 0; i < treeFiles; i++) {
+			char name[64];
+			snprintf(name, sizeof(name), "%02zu - Track %zu of Album %zu.mp3", i % 100 + 1, i, i / 100);
+			dir_.writeFile(std::string("flat/") + name);
+			dir_.writeFile("tree/Album " + std::to_string(i / (treeFiles / treeDirectories)) + "/" + name);
+		}
+		spi_ = HostSdCard_CreateImpl(HostFS_CreateImpl(dir_.path()), HostSdCard_SpiModel());
+		sdmmc_ = HostSdCard_CreateImpl(HostFS_CreateImpl(dir_.path()), HostSdCard_Sdmmc1BitModel());
+	}
+
+	fs::FSImplPtr impl(Bus bus) const {
+		return bus == Spi ? spi_ : sdmmc_;
+	}
+
+private:
+	HostTempDir dir_;
+	fs::FSImplPtr spi_;
+	fs::FSImplPtr sdmmc_;
+};
+
+const SimulatedCards &cards() {
+	static SimulatedCards cards;
+	return cards;
+}
+
+const char *busName(Bus bus) {
+	return bus == Spi ? "SPI 4 MHz" : "SDMMC 1-bit 26 MHz";
+}
+
+// Runs f once per iteration on the card of the benchmark's bus and reports the simulated time
+template <typename F>
+void runSimulated(benchmark::State &state, F &&f) {
+	const Bus bus = static_cast<Bus>(state.range(0));
+	fs::FSImplPtr impl = cards().impl(bus);
+	fs::FS fileSystem(impl);
+	state.SetLabel(busName(bus));
+	HostClock_Freeze(true);
+	sdmmc_host_set_card_clk(SDMMC_HOST_SLOT_1, SDMMC_FREQ_26M);
+	HostSdCardStats stats;
+	for (auto _ : state) {
+		HostSdCard_ResetStats(impl);
+		if (!f(fileSystem)) {
+			state.SkipWithError("failed");
+			break;
+		}
+		stats = HostSdCard_GetStats(impl);
+		state.SetIterationTime(stats.simulatedUs / 1e6);
+	}
+	HostClock_Freeze(false);
+	state.counters["commands"] = stats.commands;
+	state.counters["blocksRead"] = stats.blocksRead;
+	state.counters["blocksWritten"] = stats.blocksWritten;
+	state.counters["dirEntries"] = stats.directoryEntriesScanned;
+}
+
+// Playlist of a directory with 10k files: enumeration only
+void BM_SimulatedPlaylistBuildDirectory(benchmark::State &state) {
+	size_t entries = 0;
+	runSimulated(state, [&entries](fs::FS &fileSystem) {
+		std::optional<Playlist *> playlist = SdCard_ReturnPlaylist(fileSystem, "/flat", ALL_TRACKS_OF_DIR_SORTED);
+		entries = playlist ? (*playlist)->size() : 0;
+		if (playlist) {
+			freePlaylist(*playlist);
+		}
+		return entries > 0;
+	});
+	state.SetItemsProcessed(state.iterations() * entries);
+}
+BENCHMARK(BM_SimulatedPlaylistBuildDirectory)->ArgName("bus")->Arg(Spi)->Arg(Sdmmc)->UseManualTime()->Iterations(1)->Unit(benchmark::kMillisecond);
+
+// Virtual playlist of 100 directories with 100 files each: enumeration, path-lookups and writing the index-files
+void BM_SimulatedPlaylistBuildRecursive(benchmark::State &state) {
+	size_t entries = 0;
+	runSimulated(state, [&entries](fs::FS &fileSystem) {
+		std::optional<Playlist *> playlist = SdCard_ReturnPlaylist(fileSystem, "/tree", ALL_TRACKS_OF_ALL_SUBDIRS_SORTED);
+		entries = playlist ? (*playlist)->size() : 0;
+		if (playlist) {
+			freePlaylist(*playlist);
+		}
+		return entries > 0;
+	});
+	state.SetItemsProcessed(state.iterations() * entries);
+}
+BENCHMARK(BM_SimulatedPlaylistBuildRecursive)->ArgName("bus")->Arg(Spi)->Arg(Sdmmc)->UseManualTime()->Iterations(1)->Unit(benchmark::kMillisecond);
+
+// What the explorer of the web-interface does to list a directory with 10k files
+void BM_SimulatedExplorerList(benchmark::State &state) {
+	size_t entries = 0;
+	runSimulated(state, [&entries](fs::FS &fileSystem) {
+		entries = 0;
+		return SdCard_ListDirectory(fileSystem, "/flat", [&entries](const String &, bool) { entries++; });
+	});
+	state.SetItemsProcessed(state.iterations() * entries);
+}
+BENCHMARK(BM_SimulatedExplorerList)->ArgName("bus")->Arg(Spi)->Arg(Sdmmc)->UseManualTime()->Iterations(1)->Unit(benchmark::kMillisecond);
+
+// Explorer-upload of 1 MiB in 16 KiB-chunks (the chunk-size of the upload with PSRAM), deleted afterwards
+void BM_SimulatedExplorerUpload(benchmark::State &state) {
+	constexpr size_t uploadBytes = 1024 * 1024;
+	const std::vector<uint8_t> chunk(16 * 1024, 0x5a);
+	runSimulated(state, [&chunk](fs::FS &fileSystem) {
+		File file = fileSystem.open("/upload/file.bin", "w", true);
+		size_t written = 0;
+		while (file && written < uploadBytes) {
+			written += file.write(chunk.data(), chunk.size());
+		}
+		file.close();
+		return written == uploadBytes && SdCard_DeletePath(fileSystem, "/upload");
+	});
+	state.SetBytesProcessed(state.iterations() * uploadBytes);
+}
+BENCHMARK(BM_SimulatedExplorerUpload)->ArgName("bus")->Arg(Spi)->Arg(Sdmmc)->UseManualTime()->Iterations(1)->Unit(benchmark::kMillisecond);
+
+// The benchmark of the web-interface (/sdtest) on the simulated card; its own results are reported as counters
+// (the upload-task of its concurrent-write phase is paced by the host's scheduler, not by the model)
+void BM_SimulatedSdCardBenchmark(benchmark::State &state) {
+	SdCardBenchmarkResult result;
+	runSimulated(state, [&result](fs::FS &fileSystem) {
+		SdCardBenchmarkConfig config;
+		config.sizeBytes = 1024 * 1024;
+		config.fileSystem = &fileSystem;
+		config.runAccessPatterns = true;
+		return SdCard_RunBenchmark(config, result);
+	});
+	state.counters["writeKiBs"] = result.writeSpeedKiBs;
+	state.counters["readKiBs"] = result.readSpeedKiBs;
+	state.counters["dirEntriesPerSecond"] = result.patterns.directoryEntriesPerSecond;
+	state.counters["randomReadIops"] = result.patterns.randomReadIops;
+	for (uint8_t i = 0; i < result.patterns.chunkEntryCount; i++) {
+		const SdCardBenchmarkChunkEntry &entry = result.patterns.chunkEntries[i];
+		state.counters["chunk" + std::to_string(entry.chunkSize) + (entry.concurrentWrite ? "ConcurrentKiBs" : "KiBs")] = entry.speedKiBs;
+	}
+}
+BENCHMARK(BM_SimulatedSdCardBenchmark)->ArgName("bus")->Arg(Spi)->Arg(Sdmmc)->UseManualTime()->Iterations(1)->Unit(benchmark::kMillisecond);
+} // namespace
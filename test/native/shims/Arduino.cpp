@@ -0,0 +1,172 @@
+#include <Arduino.h>
+
+#include "HostClock.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+
+EspClass ESP;
+
+namespace {
+const auto startTime = std::chrono::steady_clock::now();
+std::atomic<int64_t> simulatedUs {0};
+std::atomic<bool> frozen {false};
+
+std::mutex randomMutex;
+std::mt19937 randomEngine(0x45535055u);
+
+std::mutex pinMutex;
+std::map<uint8_t, int> pinLevels;
+} // namespace
+
+void HostClock_Advance(int64_t us) {
+	simulatedUs += us;
+}
+
+void HostClock_Freeze(bool freeze) {
+	frozen = freeze;
+}
+
+int64_t HostClock_SimulatedUs(void) {
+	return simulatedUs;
+}
+
+int64_t esp_timer_get_time(void) {
+	const int64_t realUs = frozen ? 0 : std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+	return realUs + simulatedUs;
+}
+
+unsigned long millis(void) {
+	return static_cast<unsigned long>(esp_timer_get_time() / 1000);
+}
+
+unsigned long micros(void) {
+	return static_cast<unsigned long>(esp_timer_get_time());
+}
+
+void delay(uint32_t ms) {
+	if (frozen) {
+		HostClock_Advance(static_cast<int64_t>(ms) * 1000);
+	} else {
+		std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+	}
+}
+
+void HostRandom_Seed(uint32_t seed) {
+	std::lock_guard<std::mutex> lock(randomMutex);
+	randomEngine.seed(seed);
+}
+
+uint32_t esp_random(void) {
+	std::lock_guard<std::mutex> lock(randomMutex);
+	return randomEngine();
+}
+
+void pinMode(uint8_t, uint8_t) {
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+	std::lock_guard<std::mutex> lock(pinMutex);
+	pinLevels[pin] = value;
+}
+
+int digitalRead(uint8_t pin) {
+	std::lock_guard<std::mutex> lock(pinMutex);
+	const auto it = pinLevels.find(pin);
+	return it == pinLevels.end() ? HIGH : it->second;
+}
+
+void attachInterruptArg(uint8_t, void (*)(void *), void *, int) {
+}
+
+void detachInterrupt(uint8_t) {
+}
+
+bool psramInit(void) {
+	return true;
+}
+
+bool psramFound(void) {
+	return true;
+}
+
+void *ps_malloc(size_t size) {
+	return malloc(size);
+}
+
+void *ps_calloc(size_t n, size_t size) {
+	return calloc(n, size);
+}
+
+void *ps_realloc(void *ptr, size_t size) {
+	return realloc(ptr, size);
+}
+
+void *heap_caps_malloc(size_t size, uint32_t) {
+	return malloc(size);
+}
+
+void *heap_caps_malloc_prefer(size_t size, size_t, ...) {
+	return malloc(size);
+}
+
+void heap_caps_free(void *ptr) {
+	free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t) {
+	return 4 * 1024 * 1024;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t) {
+	return 4 * 1024 * 1024;
+}
+
+uint32_t EspClass::getFreeHeap(void) {
+	return 200 * 1024;
+}
+
+uint32_t EspClass::getMinFreeHeap(void) {
+	return 200 * 1024;
+}
+
+uint32_t EspClass::getMaxAllocHeap(void) {
+	return 100 * 1024;
+}
+
+uint32_t EspClass::getHeapSize(void) {
+	return 300 * 1024;
+}
+
+uint32_t EspClass::getFreePsram(void) {
+	return 4 * 1024 * 1024;
+}
+
+uint32_t EspClass::getPsramSize(void) {
+	return 4 * 1024 * 1024;
+}
+
+uint32_t EspClass::getCpuFreqMHz(void) {
+	return 240;
+}
+
+uint32_t EspClass::getCycleCount(void) {
+#if defined(__x86_64__) || defined(__i386__)
+	return static_cast<uint32_t>(__builtin_ia32_rdtsc());
+#else
+	return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count());
+#endif
+}
+
+void EspClass::restart(void) {
+	abort();
+}
+
+void esp_deep_sleep_start(void) {
+	fprintf(stderr, "esp_deep_sleep_start()\n");
+	exit(0);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+// Host-shim of the Arduino-ESP32 core: just enough for the platform-independent modules to compile natively.
+// Time comes from HostClock (millis() / micros() / esp_timer_get_time() share one clock).
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctype.h>
+#include <type_traits>
+
+#include "WString.h"
+#include "esp_random.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+using std::max;
+using std::min;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH		 0x1
+#define LOW			 0x0
+#define INPUT		 0x01
+#define OUTPUT		 0x03
+#define PULLUP		 0x04
+#define INPUT_PULLUP 0x05
+#define CHANGE		 0x03
+#define FALLING		 0x02
+#define RISING		 0x01
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define EXT_RAM_ATTR
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(uint32_t ms);
+
+// GPIOs read as released (HIGH) unless a test sets them
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void *arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+template <typename T, typename L, typename H>
+inline auto constrain(T value, L low, H high) -> std::decay_t<decltype(value < low ? low : (value > high ? high : value))> {
+	return value < low ? low : (value > high ? high : value);
+}
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+	return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// PSRAM is reported as available; allocations come from the host-heap
+bool psramInit(void);
+bool psramFound(void);
+void *ps_malloc(size_t size);
+void *ps_calloc(size_t n, size_t size);
+void *ps_realloc(void *ptr, size_t size);
+
+#define MALLOC_CAP_EXEC		(1 << 0)
+#define MALLOC_CAP_32BIT	(1 << 1)
+#define MALLOC_CAP_8BIT		(1 << 2)
+#define MALLOC_CAP_DMA		(1 << 3)
+#define MALLOC_CAP_SPIRAM	(1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT	(1 << 12)
+void *heap_caps_malloc(size_t size, uint32_t caps);
+void *heap_caps_malloc_prefer(size_t size, size_t num, ...);
+void heap_caps_free(void *ptr);
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+
+class EspClass {
+public:
+	uint32_t getFreeHeap(void);
+	uint32_t getMinFreeHeap(void);
+	uint32_t getMaxAllocHeap(void);
+	uint32_t getHeapSize(void);
+	uint32_t getFreePsram(void);
+	uint32_t getPsramSize(void);
+	uint32_t getCpuFreqMHz(void);
+	uint32_t getCycleCount(void); // time-stamp counter of the host (or ns where there is none)
+	void restart(void);
+};
+extern EspClass ESP;
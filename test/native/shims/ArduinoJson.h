@@ -0,0 +1,314 @@
+#pragma once
+
+#include <FS.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Stand-in for ArduinoJson 6: a read-only document with the accessors the platform-independent modules use.
+// The capacity isn't enforced.
+namespace ArduinoJsonHost {
+struct Node {
+	enum class Type : uint8_t {
+		Null,
+		Bool,
+		Number,
+		String,
+		Array,
+		Object
+	};
+	Type type = Type::Null;
+	double number = 0;
+	std::string string;
+	std::vector<Node> items;
+	std::vector<std::pair<std::string, Node>> members;
+};
+
+class Parser {
+public:
+	explicit Parser(const std::string &input)
+		: input_(input) { }
+
+	bool parse(Node &node) {
+		skipSpace();
+		if (pos_ >= input_.size()) {
+			return false;
+		}
+		const char c = input_[pos_];
+		if (c == '{') {
+			return parseObject(node);
+		} else if (c == '[') {
+			return parseArray(node);
+		} else if (c == '"') {
+			node.type = Node::Type::String;
+			return parseString(node.string);
+		} else if (literal("true")) {
+			node.type = Node::Type::Bool;
+			node.number = 1;
+			return true;
+		} else if (literal("false")) {
+			node.type = Node::Type::Bool;
+			node.number = 0;
+			return true;
+		} else if (literal("null")) {
+			node.type = Node::Type::Null;
+			return true;
+		}
+		char *end = nullptr;
+		node.number = strtod(input_.c_str() + pos_, &end);
+		if (end == input_.c_str() + pos_) {
+			return false;
+		}
+		node.type = Node::Type::Number;
+		pos_ = end - input_.c_str();
+		return true;
+	}
+
+	bool atEnd() {
+		skipSpace();
+		return pos_ >= input_.size();
+	}
+
+private:
+	void skipSpace() {
+		while (pos_ < input_.size() && isspace(static_cast<unsigned char>(input_[pos_]))) {
+			pos_++;
+		}
+	}
+
+	bool consume(char c) {
+		skipSpace();
+		if (pos_ < input_.size() && input_[pos_] == c) {
+			pos_++;
+			return true;
+		}
+		return false;
+	}
+
+	bool literal(const char *text) {
+		const size_t length = strlen(text);
+		if (input_.compare(pos_, length, text) == 0) {
+			pos_ += length;
+			return true;
+		}
+		return false;
+	}
+
+	bool parseString(std::string &out) {
+		if (!consume('"')) {
+			return false;
+		}
+		while (pos_ < input_.size()) {
+			char c = input_[pos_++];
+			if (c == '"') {
+				return true;
+			}
+			if (c == '\\') {
+				if (pos_ >= input_.size()) {
+					return false;
+				}
+				c = input_[pos_++];
+				switch (c) {
+					case 'n':
+						c = '\n';
+						break;
+					case 't':
+						c = '\t';
+						break;
+					case 'r':
+						c = '\r';
+						break;
+					case 'u':
+						if (pos_ + 4 > input_.size()) {
+							return false;
+						}
+						c = static_cast<char>(strtoul(input_.substr(pos_, 4).c_str(), nullptr, 16)); // ASCII only
+						pos_ += 4;
+						break;
+					default:
+						break; // '"', '\\' and '/'
+				}
+			}
+			out += c;
+		}
+		return false;
+	}
+
+	bool parseArray(Node &node) {
+		node.type = Node::Type::Array;
+		consume('[');
+		if (consume(']')) {
+			return true;
+		}
+		do {
+			node.items.emplace_back();
+			if (!parse(node.items.back())) {
+				return false;
+			}
+		} while (consume(','));
+		return consume(']');
+	}
+
+	bool parseObject(Node &node) {
+		node.type = Node::Type::Object;
+		consume('{');
+		if (consume('}')) {
+			return true;
+		}
+		do {
+			std::string key;
+			skipSpace();
+			if (!parseString(key) || !consume(':')) {
+				return false;
+			}
+			node.members.emplace_back(std::move(key), Node());
+			if (!parse(node.members.back().second)) {
+				return false;
+			}
+		} while (consume(','));
+		return consume('}');
+	}
+
+	const std::string &input_;
+	size_t pos_ = 0;
+};
+} // namespace ArduinoJsonHost
+
+class JsonVariant {
+public:
+	class Iterator {
+	public:
+		explicit Iterator(const ArduinoJsonHost::Node *node)
+			: node_(node) { }
+		JsonVariant operator*() const {
+			return JsonVariant(node_);
+		}
+		Iterator &operator++() {
+			node_++;
+			return *this;
+		}
+		bool operator!=(const Iterator &other) const {
+			return node_ != other.node_;
+		}
+
+	private:
+		const ArduinoJsonHost::Node *node_;
+	};
+
+	JsonVariant(const ArduinoJsonHost::Node *node = nullptr)
+		: node_(node) { }
+
+	JsonVariant operator[](const char *key) const {
+		if (node_ != nullptr && node_->type == ArduinoJsonHost::Node::Type::Object) {
+			for (const auto &member : node_->members) {
+				if (member.first == key) {
+					return JsonVariant(&member.second);
+				}
+			}
+		}
+		return JsonVariant();
+	}
+
+	template <typename T>
+	T as() const {
+		if constexpr (std::is_same_v<T, const char *>) {
+			return is(ArduinoJsonHost::Node::Type::String) ? node_->string.c_str() : nullptr;
+		} else if constexpr (std::is_arithmetic_v<T>) {
+			return (is(ArduinoJsonHost::Node::Type::Number) || is(ArduinoJsonHost::Node::Type::Bool)) ? static_cast<T>(node_->number) : T();
+		} else {
+			return *this; // JsonArray, JsonObject
+		}
+	}
+
+	template <typename T>
+	T operator|(T fallback) const {
+		if constexpr (std::is_same_v<T, const char *>) {
+			return is(ArduinoJsonHost::Node::Type::String) ? node_->string.c_str() : fallback;
+		} else {
+			return is(ArduinoJsonHost::Node::Type::Number) ? static_cast<T>(node_->number) : fallback;
+		}
+	}
+
+	bool isNull() const {
+		return node_ == nullptr || node_->type == ArduinoJsonHost::Node::Type::Null;
+	}
+
+	Iterator begin() const {
+		return Iterator(is(ArduinoJsonHost::Node::Type::Array) ? node_->items.data() : nullptr);
+	}
+	Iterator end() const {
+		return Iterator(is(ArduinoJsonHost::Node::Type::Array) ? node_->items.data() + node_->items.size() : nullptr);
+	}
+
+private:
+	bool is(ArduinoJsonHost::Node::Type type) const {
+		return node_ != nullptr && node_->type == type;
+	}
+
+	const ArduinoJsonHost::Node *node_;
+};
+
+using JsonArray = JsonVariant;
+using JsonObject = JsonVariant;
+
+class DeserializationError {
+public:
+	enum Code {
+		Ok,
+		EmptyInput,
+		InvalidInput,
+	};
+
+	DeserializationError(Code code = Ok)
+		: code_(code) { }
+	explicit operator bool() const {
+		return code_ != Ok;
+	}
+	const char *c_str() const {
+		static const char *names[] = {"Ok", "EmptyInput", "InvalidInput"};
+		return names[code_];
+	}
+
+private:
+	Code code_;
+};
+
+class DynamicJsonDocument {
+public:
+	explicit DynamicJsonDocument(size_t) { }
+
+	JsonVariant operator[](const char *key) const {
+		return JsonVariant(&root_)[key];
+	}
+
+private:
+	friend DeserializationError deserializeJson(DynamicJsonDocument &doc, const std::string &input);
+	ArduinoJsonHost::Node root_;
+};
+
+inline DeserializationError deserializeJson(DynamicJsonDocument &doc, const std::string &input) {
+	doc.root_ = ArduinoJsonHost::Node();
+	ArduinoJsonHost::Parser parser(input);
+	if (parser.atEnd()) {
+		return DeserializationError::EmptyInput;
+	}
+	if (!parser.parse(doc.root_) || !parser.atEnd()) {
+		doc.root_ = ArduinoJsonHost::Node();
+		return DeserializationError::InvalidInput;
+	}
+	return DeserializationError::Ok;
+}
+
+inline DeserializationError deserializeJson(DynamicJsonDocument &doc, File &file) {
+	std::string input;
+	uint8_t buffer[256];
+	size_t read;
+	while ((read = file.read(buffer, sizeof(buffer))) > 0) {
+		input.append(reinterpret_cast<const char *>(buffer), read);
+	}
+	return deserializeJson(doc, input);
+}
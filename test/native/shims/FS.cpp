@@ -0,0 +1,229 @@
+#include "FS.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+
+using namespace fs;
+
+size_t File::write(uint8_t c) {
+	return write(&c, 1);
+}
+
+size_t File::write(const uint8_t *buf, size_t size) {
+	return _p ? _p->write(buf, size) : 0;
+}
+
+size_t File::write(const char *str) {
+	return write(reinterpret_cast<const uint8_t *>(str), strlen(str));
+}
+
+int File::available() {
+	return _p ? static_cast<int>(_p->size() - _p->position()) : 0;
+}
+
+int File::read() {
+	uint8_t c;
+	return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::peek() {
+	if (!_p) {
+		return -1;
+	}
+	const size_t pos = _p->position();
+	const int c = read();
+	_p->seek(pos, SeekSet);
+	return c;
+}
+
+void File::flush() {
+	if (_p) {
+		_p->flush();
+	}
+}
+
+size_t File::read(uint8_t *buf, size_t size) {
+	return _p ? _p->read(buf, size) : 0;
+}
+
+size_t File::readBytes(char *buffer, size_t length) {
+	return read(reinterpret_cast<uint8_t *>(buffer), length);
+}
+
+// Stream-semantics: the terminator is consumed but not stored
+size_t File::readBytesUntil(char terminator, char *buffer, size_t length) {
+	size_t index = 0;
+	while (index < length) {
+		const int c = read();
+		if (c < 0 || c == terminator) {
+			break;
+		}
+		buffer[index++] = static_cast<char>(c);
+	}
+	return index;
+}
+
+String File::readStringUntil(char terminator) {
+	std::string s;
+	int c;
+	while ((c = read()) >= 0 && c != terminator) {
+		s += static_cast<char>(c);
+	}
+	return String(s);
+}
+
+String File::readString() {
+	std::string s;
+	int c;
+	while ((c = read()) >= 0) {
+		s += static_cast<char>(c);
+	}
+	return String(s);
+}
+
+size_t File::print(const char *str) {
+	return write(str);
+}
+
+size_t File::print(const String &str) {
+	return write(str.c_str());
+}
+
+size_t File::println(const char *str) {
+	return print(str) + write("\r\n");
+}
+
+size_t File::println(const String &str) {
+	return println(str.c_str());
+}
+
+size_t File::printf(const char *format, ...) {
+	va_list args;
+	va_start(args, format);
+	char *buffer = nullptr;
+	const int len = vasprintf(&buffer, format, args);
+	va_end(args);
+	if (len < 0) {
+		return 0;
+	}
+	const size_t written = write(reinterpret_cast<const uint8_t *>(buffer), len);
+	free(buffer);
+	return written;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+	return _p && _p->seek(pos, mode);
+}
+
+size_t File::position() const {
+	return _p ? _p->position() : 0;
+}
+
+size_t File::size() const {
+	return _p ? _p->size() : 0;
+}
+
+bool File::setBufferSize(size_t size) {
+	return _p && _p->setBufferSize(size);
+}
+
+void File::close() {
+	if (_p) {
+		_p->close();
+		_p = nullptr;
+	}
+}
+
+File::operator bool() const {
+	return _p && static_cast<bool>(*_p);
+}
+
+time_t File::getLastWrite() {
+	return _p ? _p->getLastWrite() : 0;
+}
+
+const char *File::path() const {
+	return _p ? _p->path() : nullptr;
+}
+
+const char *File::name() const {
+	return _p ? _p->name() : nullptr;
+}
+
+bool File::isDirectory(void) {
+	return _p && _p->isDirectory();
+}
+
+File File::openNextFile(const char *mode) {
+	return _p ? File(_p->openNextFile(mode)) : File();
+}
+
+String File::getNextFileName(void) {
+	return getNextFileName(nullptr);
+}
+
+String File::getNextFileName(bool *isDir) {
+	return _p ? _p->getNextFileName(isDir) : String();
+}
+
+bool File::seekDir(long position) {
+	return _p ? _p->seekDir(position) : false;
+}
+
+void File::rewindDirectory(void) {
+	if (_p) {
+		_p->rewindDirectory();
+	}
+}
+
+File FS::open(const char *path, const char *mode, const bool create) {
+	if (!_impl || !path || path[0] != '/') {
+		return File();
+	}
+	return File(_impl->open(path, mode, create));
+}
+
+File FS::open(const String &path, const char *mode, const bool create) {
+	return open(path.c_str(), mode, create);
+}
+
+bool FS::exists(const char *path) {
+	return _impl && path && _impl->exists(path);
+}
+
+bool FS::exists(const String &path) {
+	return exists(path.c_str());
+}
+
+bool FS::remove(const char *path) {
+	return _impl && path && _impl->remove(path);
+}
+
+bool FS::remove(const String &path) {
+	return remove(path.c_str());
+}
+
+bool FS::rename(const char *pathFrom, const char *pathTo) {
+	return _impl && pathFrom && pathTo && _impl->rename(pathFrom, pathTo);
+}
+
+bool FS::rename(const String &pathFrom, const String &pathTo) {
+	return rename(pathFrom.c_str(), pathTo.c_str());
+}
+
+bool FS::mkdir(const char *path) {
+	return _impl && path && _impl->mkdir(path);
+}
+
+bool FS::mkdir(const String &path) {
+	return mkdir(path.c_str());
+}
+
+bool FS::rmdir(const char *path) {
+	return _impl && path && _impl->rmdir(path);
+}
+
+bool FS::rmdir(const String &path) {
+	return rmdir(path.c_str());
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+// Host-shim of Arduino-ESP32's FS.h / FSImpl.h: fs::FS and fs::File are handles to an implementation, like on the
+// target (so `fs::FS gFSystem = (fs::FS) SD;` shares the implementation of SD). HostFS.h provides implementations.
+#include "WString.h"
+
+#include <cstdint>
+#include <ctime>
+#include <memory>
+
+#define FILE_READ	"r"
+#define FILE_WRITE	"w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode {
+	SeekSet = 0,
+	SeekCur = 1,
+	SeekEnd = 2
+};
+
+class FileImpl;
+typedef std::shared_ptr<FileImpl> FileImplPtr;
+class FSImpl;
+typedef std::shared_ptr<FSImpl> FSImplPtr;
+
+class File {
+public:
+	File(FileImplPtr p = FileImplPtr())
+		: _p(p) { }
+
+	size_t write(uint8_t c);
+	size_t write(const uint8_t *buf, size_t size);
+	size_t write(const char *str);
+	int available();
+	int read();
+	int peek();
+	void flush();
+	size_t read(uint8_t *buf, size_t size);
+	size_t readBytes(char *buffer, size_t length);
+	size_t readBytesUntil(char terminator, char *buffer, size_t length);
+	String readStringUntil(char terminator);
+	String readString();
+	size_t print(const char *str);
+	size_t print(const String &str);
+	size_t println(const char *str = "");
+	size_t println(const String &str);
+	size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+	int getWriteError() const {
+		return 0;
+	}
+
+	bool seek(uint32_t pos, SeekMode mode);
+	bool seek(uint32_t pos) {
+		return seek(pos, SeekSet);
+	}
+	size_t position() const;
+	size_t size() const;
+	bool setBufferSize(size_t size);
+	void close();
+	operator bool() const;
+	time_t getLastWrite();
+	const char *path() const;
+	const char *name() const;
+
+	bool isDirectory(void);
+	File openNextFile(const char *mode = FILE_READ);
+	String getNextFileName(void);
+	String getNextFileName(bool *isDir);
+	bool seekDir(long position);
+	void rewindDirectory(void);
+
+protected:
+	FileImplPtr _p;
+};
+
+class FS {
+public:
+	FS(FSImplPtr impl)
+		: _impl(impl) { }
+
+	File open(const char *path, const char *mode = FILE_READ, const bool create = false);
+	File open(const String &path, const char *mode = FILE_READ, const bool create = false);
+	bool exists(const char *path);
+	bool exists(const String &path);
+	bool remove(const char *path);
+	bool remove(const String &path);
+	bool rename(const char *pathFrom, const char *pathTo);
+	bool rename(const String &pathFrom, const String &pathTo);
+	bool mkdir(const char *path);
+	bool mkdir(const String &path);
+	bool rmdir(const char *path);
+	bool rmdir(const String &path);
+
+protected:
+	FSImplPtr _impl;
+};
+
+class FileImpl {
+public:
+	virtual ~FileImpl() { }
+	virtual size_t write(const uint8_t *buf, size_t size) = 0;
+	virtual size_t read(uint8_t *buf, size_t size) = 0;
+	virtual void flush() = 0;
+	virtual bool seek(uint32_t pos, SeekMode mode) = 0;
+	virtual size_t position() const = 0;
+	virtual size_t size() const = 0;
+	virtual bool setBufferSize(size_t size) = 0;
+	virtual void close() = 0;
+	virtual time_t getLastWrite() = 0;
+	virtual const char *path() const = 0;
+	virtual const char *name() const = 0;
+	virtual bool isDirectory(void) = 0;
+	virtual FileImplPtr openNextFile(const char *mode) = 0;
+	virtual String getNextFileName(bool *isDir) = 0;
+	virtual String getNextFileName(void) { // not used by the host's implementations
+		return String();
+	}
+	virtual bool seekDir(long) {
+		return false;
+	}
+	virtual void rewindDirectory(void) = 0;
+	virtual operator bool() = 0;
+};
+
+class FSImpl {
+public:
+	virtual ~FSImpl() { }
+	virtual FileImplPtr open(const char *path, const char *mode, const bool create) = 0;
+	virtual bool exists(const char *path) = 0;
+	virtual bool rename(const char *pathFrom, const char *pathTo) = 0;
+	virtual bool remove(const char *path) = 0;
+	virtual bool mkdir(const char *path) = 0;
+	virtual bool rmdir(const char *path) = 0;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekMode;
+using fs::SeekSet;
@@ -0,0 +1,4 @@
+#pragma once
+
+// fs::FileImpl and fs::FSImpl are declared in FS.h of the shim
+#include "FS.h"
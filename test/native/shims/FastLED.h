@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+
+// The parts of FastLED (3.6) the platform-independent LED-code uses; blend() and ease8InOutQuad() compute
+// exactly what FastLED's C-implementations (FASTLED_BLEND_FIXED, FASTLED_SCALE8_FIXED) do.
+struct CRGB {
+	enum HTMLColorCode : uint32_t {
+		Black = 0x000000,
+		Blue = 0x0000FF,
+		BlueViolet = 0x8A2BE2,
+		Green = 0x008000,
+		Orange = 0xFFA500,
+		Red = 0xFF0000,
+		White = 0xFFFFFF,
+		Yellow = 0xFFFF00,
+	};
+
+	union {
+		struct {
+			uint8_t r;
+			uint8_t g;
+			uint8_t b;
+		};
+		uint8_t raw[3];
+	};
+
+	CRGB()
+		: r(0)
+		, g(0)
+		, b(0) { }
+	CRGB(uint8_t red, uint8_t green, uint8_t blue)
+		: r(red)
+		, g(green)
+		, b(blue) { }
+	CRGB(uint32_t colorcode)
+		: r(colorcode >> 16)
+		, g(colorcode >> 8)
+		, b(colorcode) { }
+	CRGB(HTMLColorCode colorcode)
+		: CRGB(static_cast<uint32_t>(colorcode)) { }
+};
+
+inline bool operator==(const CRGB &lhs, const CRGB &rhs) {
+	return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b;
+}
+
+inline bool operator!=(const CRGB &lhs, const CRGB &rhs) {
+	return !(lhs == rhs);
+}
+
+inline uint8_t scale8(uint8_t i, uint8_t scale) {
+	return (static_cast<uint16_t>(i) * (1 + static_cast<uint16_t>(scale))) >> 8;
+}
+
+inline uint8_t blend8(uint8_t a, uint8_t b, uint8_t amountOfB) {
+	uint16_t partial = (a << 8) | b;
+	partial += b * amountOfB;
+	partial -= a * amountOfB;
+	return partial >> 8;
+}
+
+inline CRGB blend(const CRGB &p1, const CRGB &p2, uint8_t amountOfP2) {
+	return CRGB(blend8(p1.r, p2.r, amountOfP2), blend8(p1.g, p2.g, amountOfP2), blend8(p1.b, p2.b, amountOfP2));
+}
+
+inline uint8_t ease8InOutQuad(uint8_t i) {
+	uint8_t j = i;
+	if (j & 0x80) {
+		j = 255 - j;
+	}
+	const uint8_t jj = scale8(j, j);
+	uint8_t jj2 = jj << 1;
+	if (i & 0x80) {
+		jj2 = 255 - jj2;
+	}
+	return jj2;
+}
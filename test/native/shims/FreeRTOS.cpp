@@ -0,0 +1,271 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+std::recursive_mutex criticalMutex;
+
+template <typename Predicate>
+bool waitFor(std::condition_variable &cv, std::unique_lock<std::mutex> &lock, TickType_t ticks, Predicate predicate) {
+	if (ticks == portMAX_DELAY) {
+		cv.wait(lock, predicate);
+		return true;
+	}
+	return cv.wait_for(lock, std::chrono::milliseconds(ticks), predicate);
+}
+
+const auto startTime = std::chrono::steady_clock::now();
+} // namespace
+
+void vPortEnterCritical(portMUX_TYPE *) {
+	criticalMutex.lock();
+}
+
+void vPortExitCritical(portMUX_TYPE *) {
+	criticalMutex.unlock();
+}
+
+// ---- semaphores
+
+struct HostSemaphore {
+	std::mutex mutex;
+	std::condition_variable cv;
+	uint32_t count;
+	std::thread::id owner; // recursive mutexes only
+	uint32_t recursion = 0;
+
+	explicit HostSemaphore(uint32_t initial)
+		: count(initial) { }
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+	return new HostSemaphore(1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) {
+	return new HostSemaphore(1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+	return new HostSemaphore(0);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+	std::unique_lock<std::mutex> lock(semaphore->mutex);
+	if (!waitFor(semaphore->cv, lock, ticksToWait, [semaphore] { return semaphore->count > 0; })) {
+		return pdFALSE;
+	}
+	semaphore->count--;
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+	{
+		std::lock_guard<std::mutex> lock(semaphore->mutex);
+		if (semaphore->count > 0) {
+			return pdFALSE; // mutexes and binary semaphores can't be given twice
+		}
+		semaphore->count++;
+	}
+	semaphore->cv.notify_one();
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+	{
+		std::lock_guard<std::mutex> lock(semaphore->mutex);
+		if (semaphore->recursion > 0 && semaphore->owner == std::this_thread::get_id()) {
+			semaphore->recursion++;
+			return pdTRUE;
+		}
+	}
+	if (xSemaphoreTake(semaphore, ticksToWait) != pdTRUE) {
+		return pdFALSE;
+	}
+	std::lock_guard<std::mutex> lock(semaphore->mutex);
+	semaphore->owner = std::this_thread::get_id();
+	semaphore->recursion = 1;
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore) {
+	{
+		std::lock_guard<std::mutex> lock(semaphore->mutex);
+		if (semaphore->recursion == 0 || semaphore->owner != std::this_thread::get_id()) {
+			return pdFALSE;
+		}
+		if (--semaphore->recursion > 0) {
+			return pdTRUE;
+		}
+	}
+	return xSemaphoreGive(semaphore);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higherPriorityTaskWoken) {
+	if (higherPriorityTaskWoken) {
+		*higherPriorityTaskWoken = pdFALSE;
+	}
+	return xSemaphoreGive(semaphore);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+	delete semaphore;
+}
+
+// ---- tasks
+
+struct HostTask {
+	std::string name;
+	std::mutex mutex;
+	std::condition_variable cv;
+	uint32_t notifications = 0;
+};
+
+namespace {
+thread_local HostTask *currentTask = nullptr;
+
+HostTask *getCurrentTask() {
+	if (!currentTask) {
+		static HostTask mainTask {"loopTask"};
+		static std::thread::id mainThread = std::this_thread::get_id();
+		if (std::this_thread::get_id() == mainThread) {
+			currentTask = &mainTask;
+		} else {
+			currentTask = new HostTask {"host"}; // thread not created by xTaskCreate (e.g. a test-helper)
+		}
+	}
+	return currentTask;
+}
+} // namespace
+
+// Task-objects are never freed: handles may still be notified after the task returned
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t, void *parameter, UBaseType_t, TaskHandle_t *handle, BaseType_t) {
+	HostTask *task = new HostTask {name ? name : ""};
+	if (handle) {
+		*handle = task;
+	}
+	std::thread([task, function, parameter] {
+		currentTask = task;
+		function(parameter);
+	}).detach();
+	return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stackDepth, void *parameter, UBaseType_t priority, TaskHandle_t *handle) {
+	return xTaskCreatePinnedToCore(function, name, stackDepth, parameter, priority, handle, 0);
+}
+
+void vTaskDelete(TaskHandle_t) {
+}
+
+void vTaskDelay(TickType_t ticks) {
+	std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+TickType_t xTaskGetTickCount(void) {
+	return static_cast<TickType_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count());
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+	return getCurrentTask();
+}
+
+const char *pcTaskGetName(TaskHandle_t task) {
+	return (task ? task : getCurrentTask())->name.c_str();
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+	{
+		std::lock_guard<std::mutex> lock(task->mutex);
+		task->notifications++;
+	}
+	task->cv.notify_one();
+	return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken) {
+	if (higherPriorityTaskWoken) {
+		*higherPriorityTaskWoken = pdFALSE;
+	}
+	xTaskNotifyGive(task);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+	HostTask *task = getCurrentTask();
+	std::unique_lock<std::mutex> lock(task->mutex);
+	waitFor(task->cv, lock, ticksToWait, [task] { return task->notifications > 0; });
+	const uint32_t value = task->notifications;
+	if (value > 0) {
+		task->notifications = clearCountOnExit ? 0 : value - 1;
+	}
+	return value;
+}
+
+// ---- queues
+
+struct HostQueue {
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::deque<std::vector<uint8_t>> items;
+	size_t length;
+	size_t itemSize;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+	HostQueue *queue = new HostQueue;
+	queue->length = length;
+	queue->itemSize = itemSize;
+	return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticksToWait) {
+	{
+		std::unique_lock<std::mutex> lock(queue->mutex);
+		if (!waitFor(queue->cv, lock, ticksToWait, [queue] { return queue->items.size() < queue->length; })) {
+			return pdFALSE;
+		}
+		const uint8_t *bytes = static_cast<const uint8_t *>(item);
+		queue->items.emplace_back(bytes, bytes + queue->itemSize);
+	}
+	queue->cv.notify_all();
+	return pdTRUE;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *higherPriorityTaskWoken) {
+	if (higherPriorityTaskWoken) {
+		*higherPriorityTaskWoken = pdFALSE;
+	}
+	return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticksToWait) {
+	{
+		std::unique_lock<std::mutex> lock(queue->mutex);
+		if (!waitFor(queue->cv, lock, ticksToWait, [queue] { return !queue->items.empty(); })) {
+			return pdFALSE;
+		}
+		memcpy(item, queue->items.front().data(), queue->itemSize);
+		queue->items.pop_front();
+	}
+	queue->cv.notify_all();
+	return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+	std::lock_guard<std::mutex> lock(queue->mutex);
+	return queue->items.size();
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+	delete queue;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+
+// Host-only: simulated time is added to the monotonic clock seen by esp_timer_get_time() / millis().
+// A frozen clock only advances by HostClock_Advance(), which makes timing-dependent logic deterministic.
+void HostClock_Advance(int64_t us);
+void HostClock_Freeze(bool frozen);
+int64_t HostClock_SimulatedUs(void);
+
+void HostRandom_Seed(uint32_t seed);
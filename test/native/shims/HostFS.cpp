@@ -0,0 +1,264 @@
+#include "HostFS.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <filesystem>
+#include <mutex>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace fs;
+
+namespace {
+
+class HostFileImpl : public FileImpl {
+public:
+	HostFileImpl(const std::string &hostPath, const std::string &path, FILE *file, DIR *dir)
+		: hostPath_(hostPath)
+		, path_(path)
+		, file_(file)
+		, dir_(dir) {
+		const size_t slash = path_.find_last_of('/');
+		name_ = slash == std::string::npos ? path_ : path_.substr(slash + 1);
+	}
+	~HostFileImpl() override {
+		close();
+	}
+
+	size_t write(const uint8_t *buf, size_t size) override {
+		return file_ ? fwrite(buf, 1, size, file_) : 0;
+	}
+	size_t read(uint8_t *buf, size_t size) override {
+		return file_ ? fread(buf, 1, size, file_) : 0;
+	}
+	void flush() override {
+		if (file_) {
+			fflush(file_);
+		}
+	}
+	bool seek(uint32_t pos, SeekMode mode) override {
+		const int whence = mode == SeekSet ? SEEK_SET : (mode == SeekCur ? SEEK_CUR : SEEK_END);
+		return file_ && fseek(file_, mode == SeekSet ? static_cast<long>(pos) : static_cast<long>(static_cast<int32_t>(pos)), whence) == 0;
+	}
+	size_t position() const override {
+		return file_ ? static_cast<size_t>(ftell(file_)) : 0;
+	}
+	size_t size() const override {
+		if (!file_) {
+			return 0;
+		}
+		fflush(file_);
+		struct stat st;
+		return fstat(fileno(file_), &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+	}
+	bool setBufferSize(size_t size) override {
+		return file_ && setvbuf(file_, nullptr, _IOFBF, size) == 0;
+	}
+	void close() override {
+		if (file_) {
+			fclose(file_);
+			file_ = nullptr;
+		}
+		if (dir_) {
+			closedir(dir_);
+			dir_ = nullptr;
+		}
+	}
+	time_t getLastWrite() override {
+		struct stat st;
+		return stat(hostPath_.c_str(), &st) == 0 ? st.st_mtime : 0;
+	}
+	const char *path() const override {
+		return path_.c_str();
+	}
+	const char *name() const override {
+		return name_.c_str();
+	}
+	bool isDirectory(void) override {
+		return dir_ != nullptr;
+	}
+	FileImplPtr openNextFile(const char *mode) override;
+	// Like the ESP32's VFS: the full path of the entry is returned
+	String getNextFileName(bool *isDir) override {
+		struct dirent *entry;
+		while (dir_ && (entry = readdir(dir_)) != nullptr) {
+			if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+				continue;
+			}
+			std::string entryPath = path_ == "/" ? path_ : path_ + "/";
+			entryPath += entry->d_name;
+			if (isDir) {
+				struct stat st;
+				*isDir = stat((hostPath_ + "/" + entry->d_name).c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+			}
+			return String(entryPath);
+		}
+		return String();
+	}
+	void rewindDirectory(void) override {
+		if (dir_) {
+			rewinddir(dir_);
+		}
+	}
+	operator bool() override {
+		return file_ != nullptr || dir_ != nullptr;
+	}
+
+private:
+	friend class HostFSImpl;
+
+	std::string hostPath_;
+	std::string path_;
+	std::string name_;
+	FILE *file_;
+	DIR *dir_;
+};
+
+class HostFSImpl : public FSImpl {
+public:
+	explicit HostFSImpl(const std::string &rootDir)
+		: rootDir_(rootDir) { }
+
+	FileImplPtr open(const char *path, const char *mode, const bool create) override {
+		const std::string hostPath = toHost(path);
+		struct stat st;
+		const bool existing = stat(hostPath.c_str(), &st) == 0;
+		if (existing && S_ISDIR(st.st_mode)) {
+			DIR *dir = opendir(hostPath.c_str());
+			return dir ? std::make_shared<HostFileImpl>(hostPath, path, nullptr, dir) : FileImplPtr();
+		}
+		if (!existing && mode[0] == 'r') {
+			return FileImplPtr();
+		}
+		if (!existing && create) {
+			std::error_code error;
+			std::filesystem::create_directories(std::filesystem::path(hostPath).parent_path(), error);
+		}
+		FILE *file = fopen(hostPath.c_str(), mode);
+		return file ? std::make_shared<HostFileImpl>(hostPath, path, file, nullptr) : FileImplPtr();
+	}
+	bool exists(const char *path) override {
+		struct stat st;
+		return stat(toHost(path).c_str(), &st) == 0;
+	}
+	bool rename(const char *pathFrom, const char *pathTo) override {
+		return ::rename(toHost(pathFrom).c_str(), toHost(pathTo).c_str()) == 0;
+	}
+	bool remove(const char *path) override {
+		return unlink(toHost(path).c_str()) == 0;
+	}
+	bool mkdir(const char *path) override {
+		return ::mkdir(toHost(path).c_str(), 0755) == 0;
+	}
+	bool rmdir(const char *path) override {
+		return ::rmdir(toHost(path).c_str()) == 0;
+	}
+
+private:
+	std::string toHost(const char *path) const {
+		return rootDir_ + path;
+	}
+
+	std::string rootDir_;
+};
+
+FileImplPtr HostFileImpl::openNextFile(const char *mode) {
+	bool isDir = false;
+	const String next = getNextFileName(&isDir);
+	if (next.isEmpty()) {
+		return FileImplPtr();
+	}
+	const std::string root = hostPath_.substr(0, hostPath_.size() - (path_ == "/" ? 1 : path_.size()));
+	return HostFSImpl(root).open(next.c_str(), mode, false);
+}
+
+// Forwards to the mounted implementation, so SD / SD_MMC (and copies of them) can be pointed to a directory by a test
+class HostMountImpl : public FSImpl {
+public:
+	void mount(FSImplPtr impl) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		target_ = impl;
+	}
+
+	FileImplPtr open(const char *path, const char *mode, const bool create) override {
+		const FSImplPtr target = get();
+		return target ? target->open(path, mode, create) : FileImplPtr();
+	}
+	bool exists(const char *path) override {
+		const FSImplPtr target = get();
+		return target && target->exists(path);
+	}
+	bool rename(const char *pathFrom, const char *pathTo) override {
+		const FSImplPtr target = get();
+		return target && target->rename(pathFrom, pathTo);
+	}
+	bool remove(const char *path) override {
+		const FSImplPtr target = get();
+		return target && target->remove(path);
+	}
+	bool mkdir(const char *path) override {
+		const FSImplPtr target = get();
+		return target && target->mkdir(path);
+	}
+	bool rmdir(const char *path) override {
+		const FSImplPtr target = get();
+		return target && target->rmdir(path);
+	}
+
+private:
+	FSImplPtr get() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return target_;
+	}
+
+	std::mutex mutex_;
+	FSImplPtr target_;
+};
+
+} // namespace
+
+FSImplPtr HostFS_CreateImpl(const std::string &rootDir) {
+	return std::make_shared<HostFSImpl>(rootDir);
+}
+
+FS HostFS_Create(const std::string &rootDir) {
+	return FS(HostFS_CreateImpl(rootDir));
+}
+
+// Used by SD.cpp to construct SD / SD_MMC
+std::shared_ptr<FSImpl> HostFS_GetMountImpl() {
+	static std::shared_ptr<HostMountImpl> mountImpl = std::make_shared<HostMountImpl>();
+	return mountImpl;
+}
+
+void HostFS_Mount(FSImplPtr impl) {
+	std::static_pointer_cast<HostMountImpl>(HostFS_GetMountImpl())->mount(impl);
+}
+
+HostTempDir::HostTempDir() {
+	char pattern[] = "/tmp/espuino-native-XXXXXX";
+	const char *dir = mkdtemp(pattern);
+	path_ = dir ? dir : "";
+}
+
+HostTempDir::~HostTempDir() {
+	if (!path_.empty()) {
+		std::error_code error;
+		std::filesystem::remove_all(path_, error);
+	}
+}
+
+bool HostTempDir::writeFile(const std::string &path, const std::string &content) const {
+	const std::filesystem::path hostPath = std::filesystem::path(path_) / path;
+	std::error_code error;
+	std::filesystem::create_directories(hostPath.parent_path(), error);
+	FILE *file = fopen(hostPath.c_str(), "wb");
+	if (!file) {
+		return false;
+	}
+	const bool okay = fwrite(content.data(), 1, content.size(), file) == content.size();
+	return fclose(file) == 0 && okay;
+}
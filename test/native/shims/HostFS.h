@@ -0,0 +1,30 @@
+#pragma once
+
+// Host-only filesystems for the native build:
+// - HostFS_Create(): FS rooted at a directory of the host ("/a/b" is <rootDir>/a/b)
+// - HostFS_Mount(): selects the implementation behind SD / SD_MMC (and thereby gFSystem)
+#include "FS.h"
+
+#include <string>
+
+fs::FSImplPtr HostFS_CreateImpl(const std::string &rootDir);
+fs::FS HostFS_Create(const std::string &rootDir);
+void HostFS_Mount(fs::FSImplPtr impl);
+
+// Temporary directory that is removed with everything in it on destruction
+class HostTempDir {
+public:
+	HostTempDir();
+	~HostTempDir();
+	HostTempDir(const HostTempDir &) = delete;
+	HostTempDir &operator=(const HostTempDir &) = delete;
+
+	const std::string &path() const {
+		return path_;
+	}
+	// Creates a file (and its parent directories) below the directory; path is relative to it
+	bool writeFile(const std::string &path, const std::string &content = std::string()) const;
+
+private:
+	std::string path_;
+};
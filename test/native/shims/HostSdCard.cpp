@@ -0,0 +1,657 @@
+#include "HostSdCard.h"
+
+#include "HostClock.h"
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace fs;
+
+namespace {
+constexpr uint32_t blockSize = 512;
+constexpr uint32_t blockBits = blockSize * 8;
+constexpr uint32_t slotsPerBlock = blockSize / 32;
+constexpr uint32_t longNameCharsPerSlot = 13;
+// Arduino-ESP32 2.0's VFSImpl resolves a path several times: open() tries opendir(), stat()s it and the
+// VFSFileImpl stat()s again before fopen() / opendir(); exists() constructs a VFSFileImpl
+constexpr uint32_t fileOpenLookups = 4;
+constexpr uint32_t directoryOpenLookups = 3;
+constexpr uint32_t existsLookups = 2;
+
+std::string normalize(const char *path) {
+	std::string normalized = path && path[0] == '/' ? path : std::string("/") + (path ? path : "");
+	while (normalized.size() > 1 && normalized.back() == '/') {
+		normalized.pop_back();
+	}
+	return normalized;
+}
+
+std::string parentOf(const std::string &path) {
+	const size_t slash = path.find_last_of('/');
+	return slash == 0 || slash == std::string::npos ? "/" : path.substr(0, slash);
+}
+
+std::string nameOf(const std::string &path) {
+	return path.substr(path.find_last_of('/') + 1);
+}
+
+// 8.3-names take one directory-entry, other names additionally one long-name entry per 13 characters
+uint32_t entrySlots(const std::string &name) {
+	const size_t dot = name.find('.');
+	const size_t baseLen = dot == std::string::npos ? name.size() : dot;
+	const size_t extLen = dot == std::string::npos ? 0 : name.size() - dot - 1;
+	bool shortName = baseLen > 0 && baseLen <= 8 && extLen <= 3 && (dot == std::string::npos || name.find('.', dot + 1) == std::string::npos);
+	for (size_t i = 0; shortName && i < name.size(); i++) {
+		const unsigned char c = name[i];
+		shortName = i == dot || isupper(c) || isdigit(c) || c == '_' || c == '-';
+	}
+	return shortName ? 1 : 1 + (name.size() + longNameCharsPerSlot - 1) / longNameCharsPerSlot;
+}
+
+struct DirectoryEntry {
+	std::string name;
+	bool isDir;
+	uint32_t firstSlot;
+	uint32_t slots;
+};
+
+struct DirectoryListing {
+	bool exists = false;
+	std::vector<DirectoryEntry> entries;
+	std::unordered_map<std::string, size_t> byName;
+	uint32_t totalSlots = 0;
+};
+typedef std::shared_ptr<DirectoryListing> DirectoryListingPtr;
+
+class HostSdCardImpl;
+
+class HostSdCardFile : public FileImpl {
+public:
+	HostSdCardFile(std::shared_ptr<HostSdCardImpl> card, FileImplPtr inner, const std::string &path, bool append)
+		: card_(card)
+		, inner_(inner)
+		, path_(path)
+		, name_(nameOf(path))
+		, size_(inner->size())
+		, pos_(append ? size_ : 0) { }
+	~HostSdCardFile() override {
+		close();
+	}
+
+	size_t write(const uint8_t *buf, size_t size) override;
+	size_t read(uint8_t *buf, size_t size) override;
+	void flush() override;
+	bool seek(uint32_t pos, SeekMode mode) override {
+		if (!inner_ || !inner_->seek(pos, mode)) {
+			return false;
+		}
+		pos_ = inner_->position();
+		return true;
+	}
+	size_t position() const override {
+		return pos_;
+	}
+	size_t size() const override {
+		return size_;
+	}
+	bool setBufferSize(size_t size) override {
+		return inner_ && inner_->setBufferSize(size);
+	}
+	void close() override;
+	time_t getLastWrite() override {
+		return inner_ ? inner_->getLastWrite() : 0;
+	}
+	const char *path() const override {
+		return path_.c_str();
+	}
+	const char *name() const override {
+		return name_.c_str();
+	}
+	bool isDirectory(void) override {
+		return false;
+	}
+	FileImplPtr openNextFile(const char *) override {
+		return FileImplPtr();
+	}
+	String getNextFileName(bool *) override {
+		return String();
+	}
+	void rewindDirectory(void) override {
+	}
+	operator bool() override {
+		return inner_ != nullptr;
+	}
+
+private:
+	friend class HostSdCardImpl;
+
+	std::shared_ptr<HostSdCardImpl> card_;
+	FileImplPtr inner_;
+	std::string path_;
+	std::string name_;
+	size_t size_;
+	size_t pos_;
+	int64_t bufferedBlock_ = -1; // FatFs' sector-buffer of the file
+	bool dirty_ = false;
+	bool modified_ = false;
+};
+
+class HostSdCardDirectory : public FileImpl {
+public:
+	HostSdCardDirectory(std::shared_ptr<HostSdCardImpl> card, const std::string &path)
+		: card_(card)
+		, path_(path)
+		, name_(nameOf(path)) { }
+
+	size_t write(const uint8_t *, size_t) override {
+		return 0;
+	}
+	size_t read(uint8_t *, size_t) override {
+		return 0;
+	}
+	void flush() override {
+	}
+	bool seek(uint32_t, SeekMode) override {
+		return false;
+	}
+	size_t position() const override {
+		return 0;
+	}
+	size_t size() const override {
+		return 0;
+	}
+	bool setBufferSize(size_t) override {
+		return false;
+	}
+	void close() override {
+		open_ = false;
+	}
+	time_t getLastWrite() override {
+		return 0;
+	}
+	const char *path() const override {
+		return path_.c_str();
+	}
+	const char *name() const override {
+		return name_.c_str();
+	}
+	bool isDirectory(void) override {
+		return true;
+	}
+	FileImplPtr openNextFile(const char *mode) override;
+	String getNextFileName(bool *isDir) override;
+	void rewindDirectory(void) override {
+		index_ = 0;
+		slot_ = 0;
+	}
+	operator bool() override {
+		return open_;
+	}
+
+private:
+	std::shared_ptr<HostSdCardImpl> card_;
+	std::string path_;
+	std::string name_;
+	bool open_ = true;
+	size_t index_ = 0; // next entry
+	uint32_t slot_ = 0; // directory-entries scanned so far
+};
+
+class HostSdCardImpl : public FSImpl, public std::enable_shared_from_this<HostSdCardImpl> {
+public:
+	HostSdCardImpl(FSImplPtr backing, const HostSdCardModel &model)
+		: backing_(backing)
+		, model_(model) { }
+
+	FileImplPtr open(const char *path, const char *mode, const bool create) override {
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		const std::string normalized = normalize(path);
+		const DirectoryListingPtr dirListing = listing(normalized);
+		if (dirListing->exists) {
+			lookup(normalized, directoryOpenLookups);
+			return std::make_shared<HostSdCardDirectory>(shared_from_this(), normalized);
+		}
+		const bool existed = lookup(normalized, fileOpenLookups);
+		FileImplPtr inner = backing_->open(normalized.c_str(), mode, create);
+		if (!inner) {
+			return FileImplPtr();
+		}
+		if (!existed) {
+			// open(.., create) also creates missing parent-directories
+			for (std::string dirPath = parentOf(normalized);; dirPath = parentOf(dirPath)) {
+				invalidate(dirPath);
+				if (dirPath == "/") {
+					break;
+				}
+			}
+			invalidate(normalized);
+			updateEntry(normalized);
+		} else if (mode[0] == 'w') {
+			writeBlocks(1); // truncation frees the clusters in the FAT
+		}
+		return std::make_shared<HostSdCardFile>(shared_from_this(), inner, normalized, mode[0] == 'a');
+	}
+	bool exists(const char *path) override {
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		const std::string normalized = normalize(path);
+		lookup(normalized, existsLookups);
+		return backing_->exists(normalized.c_str());
+	}
+	bool rename(const char *pathFrom, const char *pathTo) override {
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		const std::string from = normalize(pathFrom);
+		const std::string to = normalize(pathTo);
+		lookup(from, existsLookups + 1);
+		lookup(to, 1);
+		if (!backing_->rename(from.c_str(), to.c_str())) {
+			return false;
+		}
+		invalidateTree(from);
+		invalidate(parentOf(from));
+		invalidate(parentOf(to));
+		updateEntry(from);
+		updateEntry(to);
+		return true;
+	}
+	bool remove(const char *path) override {
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		const std::string normalized = normalize(path);
+		lookup(normalized, 2);
+		if (!backing_->remove(normalized.c_str())) {
+			return false;
+		}
+		updateEntry(normalized);
+		invalidate(normalized);
+		invalidate(parentOf(normalized));
+		return true;
+	}
+	bool mkdir(const char *path) override {
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		const std::string normalized = normalize(path);
+		lookup(normalized, 2);
+		if (!backing_->mkdir(normalized.c_str())) {
+			return false;
+		}
+		writeBlocks(model_.clusterBlocks);
+		invalidate(normalized);
+		invalidate(parentOf(normalized));
+		updateEntry(normalized);
+		return true;
+	}
+	bool rmdir(const char *path) override {
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		const std::string normalized = normalize(path);
+		lookup(normalized, 2);
+		scan(normalized, listing(normalized)->totalSlots + 1); // has to be empty
+		if (!backing_->rmdir(normalized.c_str())) {
+			return false;
+		}
+		updateEntry(normalized);
+		invalidateTree(normalized);
+		invalidate(parentOf(normalized));
+		return true;
+	}
+
+	// Next entry of a directory, scanning the directory-entries from where the previous call stopped
+	String nextEntry(const std::string &dirPath, size_t &index, uint32_t &slot, bool *isDir) {
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		const DirectoryListingPtr dirListing = listing(dirPath);
+		if (index >= dirListing->entries.size()) {
+			scanFrom(dirPath, slot, dirListing->totalSlots + 1);
+			slot = dirListing->totalSlots + 1;
+			return String();
+		}
+		const DirectoryEntry &entry = dirListing->entries[index++];
+		scanFrom(dirPath, slot, entry.firstSlot + entry.slots);
+		slot = entry.firstSlot + entry.slots;
+		if (isDir) {
+			*isDir = entry.isDir;
+		}
+		return String((dirPath == "/" ? dirPath : dirPath + "/") + entry.name);
+	}
+
+	size_t fileRead(HostSdCardFile &file, uint8_t *buf, size_t size) {
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		const size_t bytesRead = file.inner_->read(buf, size);
+		size_t pos = file.pos_;
+		const size_t end = pos + bytesRead;
+		while (pos < end) {
+			const size_t block = pos / blockSize;
+			if (pos % blockSize == 0 && end - pos >= blockSize) {
+				// whole blocks are read directly into the caller's buffer
+				const size_t blocks = (end - pos) / blockSize;
+				readBlocks(blocks);
+				pos += blocks * blockSize;
+				continue;
+			}
+			loadBlock(file, block, true);
+			pos = std::min(end, (block + 1) * blockSize);
+		}
+		file.pos_ = end;
+		return bytesRead;
+	}
+
+	size_t fileWrite(HostSdCardFile &file, const uint8_t *buf, size_t size) {
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		const size_t bytesWritten = file.inner_->write(buf, size);
+		size_t pos = file.pos_;
+		const size_t end = pos + bytesWritten;
+		while (pos < end) {
+			const size_t block = pos / blockSize;
+			if (pos % blockSize == 0 && end - pos >= blockSize) {
+				const size_t blocks = (end - pos) / blockSize;
+				if (file.bufferedBlock_ >= static_cast<int64_t>(block) && file.bufferedBlock_ < static_cast<int64_t>(block + blocks)) {
+					file.bufferedBlock_ = -1;
+					file.dirty_ = false;
+				}
+				writeBlocks(blocks);
+				pos += blocks * blockSize;
+				continue;
+			}
+			// partial blocks are assembled in the file's buffer (read first, if it holds data already)
+			loadBlock(file, block, block * blockSize < file.size_);
+			file.dirty_ = true;
+			pos = std::min(end, (block + 1) * blockSize);
+		}
+		file.pos_ = end;
+		file.size_ = std::max(file.size_, end);
+		file.modified_ = file.modified_ || bytesWritten > 0;
+		return bytesWritten;
+	}
+
+	// f_sync(): buffered block, FAT and directory-entry
+	void fileSync(HostSdCardFile &file) {
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		if (file.dirty_) {
+			writeBlocks(1);
+			file.dirty_ = false;
+		}
+		if (file.modified_) {
+			writeBlocks(1);
+			updateEntry(file.path_);
+			file.modified_ = false;
+		}
+	}
+
+	HostSdCardStats stats() {
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		return stats_;
+	}
+	void resetStats() {
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		stats_ = HostSdCardStats {};
+	}
+
+private:
+	uint32_t clockKHz() const {
+		if (model_.clockKHz != 0) {
+			return model_.clockKHz;
+		}
+		return std::max<uint32_t>(1, HostSd_SdmmcClockKHz());
+	}
+
+	void charge(uint64_t ns) {
+		pendingNs_ += ns;
+		const int64_t us = static_cast<int64_t>(pendingNs_ / 1000);
+		pendingNs_ %= 1000;
+		stats_.simulatedUs += us;
+		HostClock_Advance(us);
+	}
+
+	uint64_t blockNs() const {
+		return (static_cast<uint64_t>(blockBits) + model_.blockOverheadBits) * 1000000ull / clockKHz();
+	}
+
+	// single-block transfers need one command, multi-block transfers a second one to stop
+	void readBlocks(size_t blocks) {
+		const uint32_t commands = blocks > 1 ? 2 : 1;
+		stats_.commands += commands;
+		stats_.blocksRead += blocks;
+		charge(commands * model_.commandUs * 1000ull + model_.readLatencyUs * 1000ull + blocks * blockNs());
+	}
+
+	void writeBlocks(size_t blocks) {
+		const uint32_t commands = blocks > 1 ? 2 : 1;
+		stats_.commands += commands;
+		stats_.blocksWritten += blocks;
+		charge(commands * model_.commandUs * 1000ull + blocks * (blockNs() + model_.writeBusyUs * 1000ull));
+	}
+
+	void loadBlock(HostSdCardFile &file, size_t block, bool read) {
+		if (file.bufferedBlock_ == static_cast<int64_t>(block)) {
+			return;
+		}
+		if (file.dirty_) {
+			writeBlocks(1);
+			file.dirty_ = false;
+		}
+		if (read) {
+			readBlocks(1);
+		}
+		file.bufferedBlock_ = static_cast<int64_t>(block);
+	}
+
+	// FatFs keeps one sector of the directories in its window
+	void readDirectoryBlock(const std::string &dirPath, uint32_t block) {
+		if (windowPath_ == dirPath && windowBlock_ == block) {
+			return;
+		}
+		windowPath_ = dirPath;
+		windowBlock_ = block;
+		readBlocks(1);
+	}
+
+	// Scans the directory-entries [fromSlot, toSlot) of a directory
+	void scanFrom(const std::string &dirPath, uint32_t fromSlot, uint32_t toSlot) {
+		if (toSlot <= fromSlot) {
+			return;
+		}
+		stats_.directoryEntriesScanned += toSlot - fromSlot;
+		charge(static_cast<uint64_t>(toSlot - fromSlot) * model_.dirEntryUs * 1000ull);
+		const uint32_t firstBlock = fromSlot / slotsPerBlock;
+		const uint32_t lastBlock = (toSlot - 1) / slotsPerBlock;
+		if (lastBlock > firstBlock + 1) {
+			// blocks in between can't be in the window: charged at once, as large directories have thousands of them
+			readDirectoryBlock(dirPath, firstBlock);
+			const uint32_t between = lastBlock - firstBlock - 1;
+			stats_.commands += between;
+			stats_.blocksRead += between;
+			charge(between * (model_.commandUs * 1000ull + model_.readLatencyUs * 1000ull + blockNs()));
+			windowBlock_ = UINT32_MAX;
+			readDirectoryBlock(dirPath, lastBlock);
+			return;
+		}
+		for (uint32_t block = firstBlock; block <= lastBlock; block++) {
+			readDirectoryBlock(dirPath, block);
+		}
+	}
+
+	void scan(const std::string &dirPath, uint32_t slots) {
+		scanFrom(dirPath, 0, slots);
+	}
+
+	// Resolves a path component by component like FatFs' follow_path() (count times, see the VFS-comment above)
+	bool lookup(const std::string &path, uint32_t count) {
+		bool found = true;
+		for (uint32_t i = 0; i < count; i++) {
+			stats_.pathLookups++;
+			charge(model_.openUs * 1000ull);
+			found = true;
+			std::string dirPath = "/";
+			size_t start = 1;
+			while (found && start < path.size()) {
+				const size_t slash = path.find('/', start);
+				const std::string name = path.substr(start, slash == std::string::npos ? std::string::npos : slash - start);
+				const DirectoryListingPtr dirListing = listing(dirPath);
+				const auto it = dirListing->byName.find(name);
+				if (it == dirListing->byName.end()) {
+					scan(dirPath, dirListing->totalSlots + 1);
+					found = false;
+					break;
+				}
+				const DirectoryEntry &entry = dirListing->entries[it->second];
+				scan(dirPath, entry.firstSlot + entry.slots);
+				dirPath = (dirPath == "/" ? dirPath : dirPath + "/") + name;
+				start = slash == std::string::npos ? path.size() : slash + 1;
+			}
+		}
+		return found;
+	}
+
+	// Writes the directory-block holding the entry of path and the FAT
+	void updateEntry(const std::string &path) {
+		const std::string dirPath = parentOf(path);
+		const DirectoryListingPtr dirListing = listing(dirPath);
+		const auto it = dirListing->byName.find(nameOf(path));
+		const uint32_t slot = it == dirListing->byName.end() ? dirListing->totalSlots : dirListing->entries[it->second].firstSlot;
+		windowPath_ = dirPath;
+		windowBlock_ = slot / slotsPerBlock;
+		writeBlocks(1);
+		writeBlocks(1);
+	}
+
+	DirectoryListingPtr listing(const std::string &dirPath) {
+		const auto cached = listings_.find(dirPath);
+		if (cached != listings_.end()) {
+			return cached->second;
+		}
+		DirectoryListingPtr dirListing = std::make_shared<DirectoryListing>();
+		FileImplPtr dir = backing_->open(dirPath.c_str(), "r", false);
+		if (dir && dir->isDirectory()) {
+			dirListing->exists = true;
+			while (true) {
+				bool isDir = false;
+				const String entryPath = dir->getNextFileName(&isDir);
+				if (entryPath.isEmpty()) {
+					break;
+				}
+				dirListing->entries.push_back(DirectoryEntry {nameOf(entryPath.c_str()), isDir, 0, 0});
+			}
+			dir->close();
+			std::sort(dirListing->entries.begin(), dirListing->entries.end(), [](const DirectoryEntry &a, const DirectoryEntry &b) {
+				return a.name < b.name;
+			});
+			uint32_t slot = dirPath == "/" ? 0 : 2; // "." and ".."
+			for (size_t i = 0; i < dirListing->entries.size(); i++) {
+				DirectoryEntry &entry = dirListing->entries[i];
+				entry.firstSlot = slot;
+				entry.slots = entrySlots(entry.name);
+				slot += entry.slots;
+				dirListing->byName[entry.name] = i;
+			}
+			dirListing->totalSlots = slot;
+		}
+		listings_[dirPath] = dirListing;
+		return dirListing;
+	}
+
+	void invalidate(const std::string &dirPath) {
+		listings_.erase(dirPath);
+		if (windowPath_ == dirPath) {
+			windowBlock_ = UINT32_MAX;
+		}
+	}
+
+	void invalidateTree(const std::string &path) {
+		for (auto it = listings_.begin(); it != listings_.end();) {
+			if (it->first == path || it->first.compare(0, path.size() + 1, path + "/") == 0) {
+				it = listings_.erase(it);
+			} else {
+				++it;
+			}
+		}
+		windowBlock_ = UINT32_MAX;
+	}
+
+	FSImplPtr backing_;
+	const HostSdCardModel model_;
+	std::recursive_mutex mutex_; // the bus: one operation at a time
+	std::map<std::string, DirectoryListingPtr> listings_;
+	std::string windowPath_;
+	uint32_t windowBlock_ = UINT32_MAX;
+	uint64_t pendingNs_ = 0;
+	HostSdCardStats stats_;
+};
+
+size_t HostSdCardFile::write(const uint8_t *buf, size_t size) {
+	return inner_ ? card_->fileWrite(*this, buf, size) : 0;
+}
+
+size_t HostSdCardFile::read(uint8_t *buf, size_t size) {
+	return inner_ ? card_->fileRead(*this, buf, size) : 0;
+}
+
+void HostSdCardFile::flush() {
+	if (inner_) {
+		card_->fileSync(*this);
+		inner_->flush();
+	}
+}
+
+void HostSdCardFile::close() {
+	if (inner_) {
+		card_->fileSync(*this);
+		inner_->close();
+		inner_.reset();
+	}
+}
+
+String HostSdCardDirectory::getNextFileName(bool *isDir) {
+	return open_ ? card_->nextEntry(path_, index_, slot_, isDir) : String();
+}
+
+// Like the VFS: the next entry is opened by its path (that's why getNextFileName() is much cheaper)
+FileImplPtr HostSdCardDirectory::openNextFile(const char *mode) {
+	const String next = getNextFileName(nullptr);
+	return next.isEmpty() ? FileImplPtr() : card_->open(next.c_str(), mode, false);
+}
+
+} // namespace
+
+HostSdCardModel HostSdCard_SpiModel(uint32_t clockKHz) {
+	HostSdCardModel model;
+	model.bus = HostSdCardBus::Spi;
+	model.clockKHz = clockKHz;
+	model.commandUs = 60; // several SPI-transactions per command (CS, frame, polling for R1)
+	model.blockOverheadBits = 8 * 8; // start-token, CRC, polling for the token
+	model.readLatencyUs = 250;
+	model.writeBusyUs = 250;
+	model.dirEntryUs = 3;
+	model.openUs = 60;
+	return model;
+}
+
+HostSdCardModel HostSdCard_Sdmmc1BitModel(uint32_t clockKHz) {
+	HostSdCardModel model;
+	model.bus = HostSdCardBus::Sdmmc1Bit;
+	model.clockKHz = clockKHz;
+	model.commandUs = 25; // 48-bit command and response on the CMD-line, interrupt of the host-driver
+	model.blockOverheadBits = 1 + 16 + 1 + 8; // start-bit, CRC16, end-bit, access-gap
+	model.readLatencyUs = 150;
+	model.writeBusyUs = 250;
+	model.dirEntryUs = 3;
+	model.openUs = 60;
+	return model;
+}
+
+FSImplPtr HostSdCard_CreateImpl(FSImplPtr backing, const HostSdCardModel &model) {
+	return std::make_shared<HostSdCardImpl>(backing, model);
+}
+
+HostSdCardStats HostSdCard_GetStats(const FSImplPtr &card) {
+	const std::shared_ptr<HostSdCardImpl> impl = std::dynamic_pointer_cast<HostSdCardImpl>(card);
+	return impl ? impl->stats() : HostSdCardStats {};
+}
+
+void HostSdCard_ResetStats(const FSImplPtr &card) {
+	const std::shared_ptr<HostSdCardImpl> impl = std::dynamic_pointer_cast<HostSdCardImpl>(card);
+	if (impl) {
+		impl->resetStats();
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+// Host-only: simulated SD-card. Wraps another filesystem-implementation (usually HostFS_CreateImpl()) and charges the
+// time an ESP32 would need for every operation to HostClock, so timings measured with esp_timer_get_time() / millis()
+// are those of the model (freeze the clock to see nothing but the model):
+// - bus: command-overhead and 512-byte blocks over SPI or SDMMC 1-bit at a given clock
+// - card: read-latency and programming-time per written block
+// - FatFs / VFS: directory-scans (32-byte entries, long names take additional ones) for every path-lookup and
+//   while enumerating, a one-sector window for directories and one sector-buffer per file
+// Entries of a directory are in name-order (on a real card it's the order they were created in).
+// The default models are ballpark-figures; calibrate them against SdCard_RunBenchmark() on a device.
+#include "FS.h"
+
+#include <cstdint>
+
+enum class HostSdCardBus : uint8_t {
+	Spi = 0,
+	Sdmmc1Bit = 1,
+};
+
+struct HostSdCardModel {
+	HostSdCardBus bus = HostSdCardBus::Sdmmc1Bit;
+	uint32_t clockKHz = 0; // 0: follow sdmmc_host_set_card_clk() (SDMMC only)
+	uint32_t commandUs = 0; // per command: command-frame, response and the host-driver
+	uint32_t blockOverheadBits = 0; // per 512-byte block on the bus: start-token, CRC, gaps
+	uint32_t readLatencyUs = 0; // until the card delivers the first block of a read
+	uint32_t writeBusyUs = 0; // programming-time per written block
+	uint32_t dirEntryUs = 0; // CPU per directory-entry that is scanned or enumerated (FatFs, VFS, String)
+	uint32_t openUs = 0; // CPU per path-lookup (VFS, FatFs-lock, path-parsing)
+	uint32_t clusterBlocks = 64; // a new directory's cluster is cleared on mkdir (32 KiB-clusters)
+};
+
+HostSdCardModel HostSdCard_SpiModel(uint32_t clockKHz = 4000); // Arduino's SD.begin() defaults to 4 MHz
+HostSdCardModel HostSdCard_Sdmmc1BitModel(uint32_t clockKHz = 0);
+
+struct HostSdCardStats {
+	uint64_t commands = 0;
+	uint64_t blocksRead = 0;
+	uint64_t blocksWritten = 0;
+	uint64_t pathLookups = 0;
+	uint64_t directoryEntriesScanned = 0;
+	int64_t simulatedUs = 0;
+};
+
+fs::FSImplPtr HostSdCard_CreateImpl(fs::FSImplPtr backing, const HostSdCardModel &model);
+HostSdCardStats HostSdCard_GetStats(const fs::FSImplPtr &card);
+void HostSdCard_ResetStats(const fs::FSImplPtr &card);
+
+// Clock set by sdmmc_host_set_card_clk()
+uint32_t HostSd_SdmmcClockKHz(void);
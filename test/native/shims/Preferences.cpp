@@ -0,0 +1,197 @@
+#include "Preferences.h"
+
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace {
+std::mutex storeMutex;
+std::map<std::string, std::map<std::string, std::vector<uint8_t>>> store;
+std::atomic<uint32_t> writes {0};
+} // namespace
+
+uint32_t HostPreferences_Writes(void) {
+	return writes;
+}
+
+void HostPreferences_Reset(void) {
+	std::lock_guard<std::mutex> lock(storeMutex);
+	store.clear();
+	writes = 0;
+}
+
+bool Preferences::begin(const char *name, bool readOnly, const char *) {
+	namespace_ = name;
+	readOnly_ = readOnly;
+	started_ = true;
+	return true;
+}
+
+void Preferences::end() {
+	started_ = false;
+}
+
+bool Preferences::clear() {
+	std::lock_guard<std::mutex> lock(storeMutex);
+	store[namespace_].clear();
+	writes++;
+	return true;
+}
+
+bool Preferences::remove(const char *key) {
+	std::lock_guard<std::mutex> lock(storeMutex);
+	writes++;
+	return store[namespace_].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char *key) {
+	std::lock_guard<std::mutex> lock(storeMutex);
+	return store[namespace_].count(key) > 0;
+}
+
+size_t Preferences::freeEntries() {
+	return 1000;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len) {
+	if (!started_ || readOnly_ || !key) {
+		return 0;
+	}
+	std::lock_guard<std::mutex> lock(storeMutex);
+	const uint8_t *bytes = static_cast<const uint8_t *>(value);
+	store[namespace_][key] = std::vector<uint8_t>(bytes, bytes + len);
+	writes++;
+	return len;
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+	std::lock_guard<std::mutex> lock(storeMutex);
+	const auto &entries = store[namespace_];
+	const auto it = entries.find(key);
+	return it == entries.end() ? 0 : it->second.size();
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen) {
+	std::lock_guard<std::mutex> lock(storeMutex);
+	const auto &entries = store[namespace_];
+	const auto it = entries.find(key);
+	if (it == entries.end() || it->second.size() > maxLen) {
+		return 0;
+	}
+	memcpy(buf, it->second.data(), it->second.size());
+	return it->second.size();
+}
+
+template <typename T>
+size_t Preferences::put(const char *key, T value) {
+	return putBytes(key, &value, sizeof(value));
+}
+
+template <typename T>
+T Preferences::get(const char *key, T defaultValue) {
+	T value;
+	return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+size_t Preferences::putChar(const char *key, int8_t value) {
+	return put(key, value);
+}
+size_t Preferences::putUChar(const char *key, uint8_t value) {
+	return put(key, value);
+}
+size_t Preferences::putShort(const char *key, int16_t value) {
+	return put(key, value);
+}
+size_t Preferences::putUShort(const char *key, uint16_t value) {
+	return put(key, value);
+}
+size_t Preferences::putInt(const char *key, int32_t value) {
+	return put(key, value);
+}
+size_t Preferences::putUInt(const char *key, uint32_t value) {
+	return put(key, value);
+}
+size_t Preferences::putLong(const char *key, int32_t value) {
+	return put(key, value);
+}
+size_t Preferences::putULong(const char *key, uint32_t value) {
+	return put(key, value);
+}
+size_t Preferences::putLong64(const char *key, int64_t value) {
+	return put(key, value);
+}
+size_t Preferences::putULong64(const char *key, uint64_t value) {
+	return put(key, value);
+}
+size_t Preferences::putFloat(const char *key, float value) {
+	return put(key, value);
+}
+size_t Preferences::putDouble(const char *key, double value) {
+	return put(key, value);
+}
+size_t Preferences::putBool(const char *key, bool value) {
+	return put(key, static_cast<uint8_t>(value));
+}
+size_t Preferences::putString(const char *key, const char *value) {
+	return putBytes(key, value, strlen(value) + 1) ? strlen(value) : 0;
+}
+size_t Preferences::putString(const char *key, const String &value) {
+	return putString(key, value.c_str());
+}
+
+int8_t Preferences::getChar(const char *key, int8_t defaultValue) {
+	return get(key, defaultValue);
+}
+uint8_t Preferences::getUChar(const char *key, uint8_t defaultValue) {
+	return get(key, defaultValue);
+}
+int16_t Preferences::getShort(const char *key, int16_t defaultValue) {
+	return get(key, defaultValue);
+}
+uint16_t Preferences::getUShort(const char *key, uint16_t defaultValue) {
+	return get(key, defaultValue);
+}
+int32_t Preferences::getInt(const char *key, int32_t defaultValue) {
+	return get(key, defaultValue);
+}
+uint32_t Preferences::getUInt(const char *key, uint32_t defaultValue) {
+	return get(key, defaultValue);
+}
+int32_t Preferences::getLong(const char *key, int32_t defaultValue) {
+	return get(key, defaultValue);
+}
+uint32_t Preferences::getULong(const char *key, uint32_t defaultValue) {
+	return get(key, defaultValue);
+}
+int64_t Preferences::getLong64(const char *key, int64_t defaultValue) {
+	return get(key, defaultValue);
+}
+uint64_t Preferences::getULong64(const char *key, uint64_t defaultValue) {
+	return get(key, defaultValue);
+}
+float Preferences::getFloat(const char *key, float defaultValue) {
+	return get(key, defaultValue);
+}
+double Preferences::getDouble(const char *key, double defaultValue) {
+	return get(key, defaultValue);
+}
+bool Preferences::getBool(const char *key, bool defaultValue) {
+	return get<uint8_t>(key, defaultValue) != 0;
+}
+
+size_t Preferences::getString(const char *key, char *value, size_t maxLen) {
+	const size_t len = getBytes(key, value, maxLen);
+	return len ? len - 1 : 0;
+}
+
+String Preferences::getString(const char *key, String defaultValue) {
+	const size_t len = getBytesLength(key);
+	if (len == 0) {
+		return defaultValue;
+	}
+	std::vector<char> buffer(len);
+	getBytes(key, buffer.data(), len);
+	return String(buffer.data());
+}
@@ -0,0 +1,78 @@
+#include "SD.h"
+#include "SD_MMC.h"
+#include "driver/sdmmc_host.h"
+#include "HostSdCard.h"
+
+#include <atomic>
+#include <memory>
+
+std::shared_ptr<fs::FSImpl> HostFS_GetMountImpl();
+
+// Constructed before all other globals: firmware-modules copy them during their static initialization
+// (fs::FS gFSystem = (fs::FS) SD)
+fs::SDFS SD __attribute__((init_priority(101))) (HostFS_GetMountImpl());
+fs::SDMMCFS SD_MMC __attribute__((init_priority(101))) (HostFS_GetMountImpl());
+SPIClass SPI(VSPI);
+
+namespace {
+constexpr uint64_t hostCardSize = 32ull * 1024 * 1024 * 1024;
+std::atomic<uint32_t> sdmmcClockKHz {SDMMC_FREQ_DEFAULT};
+} // namespace
+
+esp_err_t sdmmc_host_set_card_clk(int slot, uint32_t freq_khz) {
+	if (slot != SDMMC_HOST_SLOT_1 || freq_khz == 0) {
+		return ESP_ERR_INVALID_ARG;
+	}
+	sdmmcClockKHz = freq_khz;
+	return ESP_OK;
+}
+
+uint32_t HostSd_SdmmcClockKHz(void) {
+	return sdmmcClockKHz;
+}
+
+bool fs::SDFS::begin(uint8_t, SPIClass &, uint32_t, const char *, uint8_t, bool) {
+	return true;
+}
+
+void fs::SDFS::end() {
+}
+
+sdcard_type_t fs::SDFS::cardType() {
+	return CARD_SDHC;
+}
+
+uint64_t fs::SDFS::cardSize() {
+	return hostCardSize;
+}
+
+uint64_t fs::SDFS::totalBytes() {
+	return hostCardSize;
+}
+
+uint64_t fs::SDFS::usedBytes() {
+	return 0;
+}
+
+bool fs::SDMMCFS::begin(const char *, bool, bool, int, uint8_t) {
+	return true;
+}
+
+void fs::SDMMCFS::end() {
+}
+
+sdcard_type_t fs::SDMMCFS::cardType() {
+	return CARD_SDHC;
+}
+
+uint64_t fs::SDMMCFS::cardSize() {
+	return hostCardSize;
+}
+
+uint64_t fs::SDMMCFS::totalBytes() {
+	return hostCardSize;
+}
+
+uint64_t fs::SDMMCFS::usedBytes() {
+	return 0;
+}
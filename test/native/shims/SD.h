@@ -0,0 +1,24 @@
+#pragma once
+
+// Host-shim: SD is backed by whatever HostFS_Mount() selected (see HostFS.h)
+#include "FS.h"
+#include "SPI.h"
+#include "sd_defines.h"
+
+namespace fs {
+class SDFS : public FS {
+public:
+	SDFS(FSImplPtr impl)
+		: FS(impl) { }
+	bool begin(uint8_t ssPin = SS, SPIClass &spi = SPI, uint32_t frequency = 4000000, const char *mountpoint = "/sd", uint8_t maxFiles = 5, bool formatIfEmpty = false);
+	void end();
+	sdcard_type_t cardType();
+	uint64_t cardSize();
+	uint64_t totalBytes();
+	uint64_t usedBytes();
+};
+} // namespace fs
+
+extern fs::SDFS SD;
+
+using namespace fs;
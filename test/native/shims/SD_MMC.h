@@ -0,0 +1,23 @@
+#pragma once
+
+// Host-shim: SD_MMC is backed by whatever HostFS_Mount() selected (see HostFS.h)
+#include "FS.h"
+#include "sd_defines.h"
+
+namespace fs {
+class SDMMCFS : public FS {
+public:
+	SDMMCFS(FSImplPtr impl)
+		: FS(impl) { }
+	bool begin(const char *mountpoint = "/sdcard", bool mode1bit = false, bool formatIfMountFailed = false, int sdmmcFrequency = 20000, uint8_t maxFiles = 5);
+	void end();
+	sdcard_type_t cardType();
+	uint64_t cardSize();
+	uint64_t totalBytes();
+	uint64_t usedBytes();
+};
+} // namespace fs
+
+extern fs::SDMMCFS SD_MMC;
+
+using namespace fs;
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+#define FSPI 1
+#define HSPI 2
+#define VSPI 3
+#define SS	 5
+
+class SPIClass {
+public:
+	explicit SPIClass(uint8_t spiBus = HSPI)
+		: spiBus_(spiBus) { }
+	void begin(int8_t = -1, int8_t = -1, int8_t = -1, int8_t = -1) { }
+	void end() { }
+	void setFrequency(uint32_t) { }
+
+private:
+	uint8_t spiBus_;
+};
+
+extern SPIClass SPI;
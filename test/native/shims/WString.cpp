@@ -0,0 +1,105 @@
+#include "WString.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <type_traits>
+
+namespace {
+template <typename T>
+std::string toBase(T value, unsigned char base) {
+	if (base == 10) {
+		return std::to_string(value);
+	}
+	using Unsigned = typename std::make_unsigned<T>::type;
+	Unsigned magnitude = static_cast<Unsigned>(value);
+	std::string digits;
+	do {
+		const unsigned digit = magnitude % base;
+		digits.insert(digits.begin(), static_cast<char>(digit < 10 ? '0' + digit : 'a' + digit - 10));
+		magnitude /= base;
+	} while (magnitude != 0);
+	return digits;
+}
+
+std::string toFixed(double value, unsigned int decimalPlaces) {
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "%.*f", static_cast<int>(decimalPlaces), value);
+	return buffer;
+}
+} // namespace
+
+String::String(int value, unsigned char base)
+	: s_(toBase(value, base)) { }
+String::String(unsigned int value, unsigned char base)
+	: s_(toBase(value, base)) { }
+String::String(long value, unsigned char base)
+	: s_(toBase(value, base)) { }
+String::String(unsigned long value, unsigned char base)
+	: s_(toBase(value, base)) { }
+String::String(long long value, unsigned char base)
+	: s_(toBase(value, base)) { }
+String::String(unsigned long long value, unsigned char base)
+	: s_(toBase(value, base)) { }
+String::String(float value, unsigned int decimalPlaces)
+	: s_(toFixed(value, decimalPlaces)) { }
+String::String(double value, unsigned int decimalPlaces)
+	: s_(toFixed(value, decimalPlaces)) { }
+
+bool String::equalsIgnoreCase(const String &rhs) const {
+	return s_.size() == rhs.s_.size() && std::equal(s_.begin(), s_.end(), rhs.s_.begin(), [](char a, char b) { return tolower(static_cast<unsigned char>(a)) == tolower(static_cast<unsigned char>(b)); });
+}
+
+// Like Arduino: 'to' is exclusive, swapped if smaller than 'from'
+String String::substring(unsigned int from, unsigned int to) const {
+	if (from > to) {
+		std::swap(from, to);
+	}
+	if (from >= s_.length()) {
+		return String();
+	}
+	to = std::min<unsigned int>(to, s_.length());
+	return String(s_.substr(from, to - from));
+}
+
+void String::replace(char find, char replace) {
+	std::replace(s_.begin(), s_.end(), find, replace);
+}
+
+void String::replace(const String &find, const String &replace) {
+	if (find.s_.empty()) {
+		return;
+	}
+	size_t pos = 0;
+	while ((pos = s_.find(find.s_, pos)) != std::string::npos) {
+		s_.replace(pos, find.s_.length(), replace.s_);
+		pos += replace.s_.length();
+	}
+}
+
+void String::toLowerCase() {
+	std::transform(s_.begin(), s_.end(), s_.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+}
+
+void String::toUpperCase() {
+	std::transform(s_.begin(), s_.end(), s_.begin(), [](unsigned char c) { return static_cast<char>(toupper(c)); });
+}
+
+void String::trim() {
+	const auto isSpace = [](unsigned char c) { return isspace(c) != 0; };
+	s_.erase(s_.begin(), std::find_if_not(s_.begin(), s_.end(), isSpace));
+	s_.erase(std::find_if_not(s_.rbegin(), s_.rend(), isSpace).base(), s_.end());
+}
+
+void String::getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index) const {
+	if (!buf || bufsize == 0) {
+		return;
+	}
+	if (index >= s_.length()) {
+		buf[0] = '\0';
+		return;
+	}
+	const size_t n = std::min<size_t>(bufsize - 1, s_.length() - index);
+	memcpy(buf, s_.data() + index, n);
+	buf[n] = '\0';
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+// Host-shim of Arduino's String (the subset used by the natively built modules), backed by std::string
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+class String {
+public:
+	String() = default;
+	String(const char *s)
+		: s_(s ? s : "") { }
+	String(const char *s, size_t len)
+		: s_(s ? std::string(s, len) : std::string()) { }
+	String(const std::string &s)
+		: s_(s) { }
+	explicit String(char c)
+		: s_(1, c) { }
+	explicit String(int value, unsigned char base = 10);
+	explicit String(unsigned int value, unsigned char base = 10);
+	explicit String(long value, unsigned char base = 10);
+	explicit String(unsigned long value, unsigned char base = 10);
+	explicit String(long long value, unsigned char base = 10);
+	explicit String(unsigned long long value, unsigned char base = 10);
+	explicit String(float value, unsigned int decimalPlaces = 2);
+	explicit String(double value, unsigned int decimalPlaces = 2);
+
+	const char *c_str() const {
+		return s_.c_str();
+	}
+	unsigned int length() const {
+		return s_.length();
+	}
+	bool isEmpty() const {
+		return s_.empty();
+	}
+	bool reserve(unsigned int size) {
+		s_.reserve(size);
+		return true;
+	}
+
+	String &operator+=(const String &rhs) {
+		s_ += rhs.s_;
+		return *this;
+	}
+	String &operator+=(const char *rhs) {
+		s_ += rhs ? rhs : "";
+		return *this;
+	}
+	String &operator+=(char c) {
+		s_ += c;
+		return *this;
+	}
+	String &operator+=(int value) {
+		return *this += String(value);
+	}
+	String &operator+=(unsigned int value) {
+		return *this += String(value);
+	}
+	String &operator+=(long value) {
+		return *this += String(value);
+	}
+	String &operator+=(unsigned long value) {
+		return *this += String(value);
+	}
+	bool concat(const String &rhs) {
+		*this += rhs;
+		return true;
+	}
+	bool concat(const char *rhs) {
+		*this += rhs;
+		return true;
+	}
+	bool concat(char c) {
+		*this += c;
+		return true;
+	}
+
+	bool equals(const String &rhs) const {
+		return s_ == rhs.s_;
+	}
+	bool equals(const char *rhs) const {
+		return s_ == (rhs ? rhs : "");
+	}
+	bool equalsIgnoreCase(const String &rhs) const;
+	int compareTo(const String &rhs) const {
+		return s_.compare(rhs.s_);
+	}
+	bool operator==(const String &rhs) const {
+		return equals(rhs);
+	}
+	bool operator==(const char *rhs) const {
+		return equals(rhs);
+	}
+	bool operator!=(const String &rhs) const {
+		return !equals(rhs);
+	}
+	bool operator!=(const char *rhs) const {
+		return !equals(rhs);
+	}
+	bool operator<(const String &rhs) const {
+		return s_ < rhs.s_;
+	}
+	bool operator>(const String &rhs) const {
+		return s_ > rhs.s_;
+	}
+
+	bool startsWith(const String &prefix) const {
+		return s_.compare(0, prefix.s_.length(), prefix.s_) == 0;
+	}
+	bool startsWith(const String &prefix, unsigned int offset) const {
+		return offset <= s_.length() && s_.compare(offset, prefix.s_.length(), prefix.s_) == 0;
+	}
+	bool endsWith(const String &suffix) const {
+		return s_.length() >= suffix.s_.length() && s_.compare(s_.length() - suffix.s_.length(), suffix.s_.length(), suffix.s_) == 0;
+	}
+
+	char charAt(unsigned int index) const {
+		return index < s_.length() ? s_[index] : 0;
+	}
+	char operator[](unsigned int index) const {
+		return charAt(index);
+	}
+	char &operator[](unsigned int index) {
+		return s_[index];
+	}
+	void setCharAt(unsigned int index, char c) {
+		if (index < s_.length()) {
+			s_[index] = c;
+		}
+	}
+
+	int indexOf(char c, unsigned int from = 0) const {
+		return toIndex(s_.find(c, from));
+	}
+	int indexOf(const String &str, unsigned int from = 0) const {
+		return toIndex(s_.find(str.s_, from));
+	}
+	int lastIndexOf(char c) const {
+		return toIndex(s_.rfind(c));
+	}
+	int lastIndexOf(char c, unsigned int from) const {
+		return toIndex(s_.rfind(c, from));
+	}
+	int lastIndexOf(const String &str) const {
+		return toIndex(s_.rfind(str.s_));
+	}
+
+	String substring(unsigned int from) const {
+		return from < s_.length() ? String(s_.substr(from)) : String();
+	}
+	String substring(unsigned int from, unsigned int to) const;
+
+	void replace(char find, char replace);
+	void replace(const String &find, const String &replace);
+	void remove(unsigned int index) {
+		if (index < s_.length()) {
+			s_.erase(index);
+		}
+	}
+	void remove(unsigned int index, unsigned int count) {
+		if (index < s_.length()) {
+			s_.erase(index, count);
+		}
+	}
+	void toLowerCase();
+	void toUpperCase();
+	void trim();
+
+	void toCharArray(char *buf, unsigned int bufsize, unsigned int index = 0) const {
+		getBytes(reinterpret_cast<unsigned char *>(buf), bufsize, index);
+	}
+	void getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index = 0) const;
+	long toInt() const {
+		return strtol(s_.c_str(), nullptr, 10);
+	}
+	float toFloat() const {
+		return strtof(s_.c_str(), nullptr);
+	}
+
+	friend String operator+(const String &lhs, const String &rhs) {
+		return String(lhs.s_ + rhs.s_);
+	}
+	friend String operator+(const String &lhs, const char *rhs) {
+		return String(lhs.s_ + (rhs ? rhs : ""));
+	}
+	friend String operator+(const char *lhs, const String &rhs) {
+		return String((lhs ? lhs : "") + rhs.s_);
+	}
+	friend String operator+(const String &lhs, char rhs) {
+		return String(lhs.s_ + rhs);
+	}
+
+private:
+	static int toIndex(size_t pos) {
+		return pos == std::string::npos ? -1 : static_cast<int>(pos);
+	}
+
+	std::string s_;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "esp_err.h"
+
+#include <cstdint>
+
+#define SDMMC_HOST_SLOT_0	 0
+#define SDMMC_HOST_SLOT_1	 1
+#define SDMMC_FREQ_DEFAULT	 20000
+#define SDMMC_FREQ_HIGHSPEED 40000
+#define SDMMC_FREQ_PROBING	 400
+#define SDMMC_FREQ_52M		 52000
+#define SDMMC_FREQ_26M		 26000
+
+// Host-shim: the clock is recorded, HostSdCard's SDMMC-model transfers at it
+esp_err_t sdmmc_host_set_card_clk(int slot, uint32_t freq_khz);
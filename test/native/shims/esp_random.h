@@ -0,0 +1,6 @@
+#pragma once
+
+#include <cstdint>
+
+// Deterministic on the host (seeded by HostRandom_Seed()), so benchmarks and tests are reproducible
+uint32_t esp_random(void);
@@ -0,0 +1,4 @@
+#pragma once
+
+// Host-shim: deep-sleep ends the process (the target doesn't return from it either)
+[[noreturn]] void esp_deep_sleep_start(void);
@@ -0,0 +1,5 @@
+#pragma once
+
+// Host-shim: there's no task-watchdog
+inline void esp_task_wdt_reset(void) {
+}
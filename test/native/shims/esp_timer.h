@@ -0,0 +1,6 @@
+#pragma once
+
+#include <cstdint>
+
+// Microseconds since start: the host's monotonic clock plus simulated time (see HostClock.h)
+int64_t esp_timer_get_time(void);
@@ -0,0 +1,39 @@
+#pragma once
+
+// Host-shim of the FreeRTOS-API used by the natively built modules: tasks are std::threads, semaphores and
+// queues are implemented with std::mutex / std::condition_variable. Ticks are milliseconds (CONFIG_FREERTOS_HZ=1000).
+#include <cstdint>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE			   0
+#define pdTRUE			   1
+#define pdFAIL			   pdFALSE
+#define pdPASS			   pdTRUE
+#define portMAX_DELAY	   ((TickType_t) 0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms)  ((TickType_t) (ms))
+#define portPRIVILEGE_BIT  0
+#define portNUM_PROCESSORS 2
+#define configMAX_PRIORITIES 25
+#define tskIDLE_PRIORITY	 ((UBaseType_t) 0U)
+
+// Critical sections protect against the other core / ISRs on the target; a global mutex is the host-equivalent
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+void vPortEnterCritical(portMUX_TYPE *mux);
+void vPortExitCritical(portMUX_TYPE *mux);
+#define portENTER_CRITICAL(mux)		vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux)		vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux)	vPortExitCritical(mux)
+#define portYIELD_FROM_ISR()
+inline UBaseType_t portSET_INTERRUPT_MASK_FROM_ISR(void) {
+	return 0;
+}
+inline void portCLEAR_INTERRUPT_MASK_FROM_ISR(UBaseType_t) { }
+inline BaseType_t xPortGetCoreID(void) {
+	return 1;
+}
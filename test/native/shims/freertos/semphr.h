@@ -0,0 +1,17 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+// Mutexes and binary semaphores share one counting implementation (a mutex starts given, a binary semaphore taken)
+struct HostSemaphore;
+typedef HostSemaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticksToWait);
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higherPriorityTaskWoken);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+struct HostTask;
+typedef HostTask *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackDepth, void *parameter, UBaseType_t priority, TaskHandle_t *handle, BaseType_t coreId);
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stackDepth, void *parameter, UBaseType_t priority, TaskHandle_t *handle);
+// Only deleting the calling task is supported (it has to return right after, as it does on the target in practice)
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+const char *pcTaskGetName(TaskHandle_t task);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken);
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
@@ -0,0 +1,108 @@
+#include "strnatcmp.h"
+
+#include <cctype>
+
+// Same ordering as natsort's strnatcmp.c: whitespace is skipped, runs of digits are compared by value
+// (runs with leading zeros as fractional parts), everything else by character.
+namespace {
+bool isDigit(char c) {
+	return isdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+bool isSpace(char c) {
+	return isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+// Longest run of digits wins; for runs of the same length the first difference decides
+int compareRight(char const *a, char const *b) {
+	int bias = 0;
+	for (;; a++, b++) {
+		if (!isDigit(*a) && !isDigit(*b)) {
+			return bias;
+		}
+		if (!isDigit(*a)) {
+			return -1;
+		}
+		if (!isDigit(*b)) {
+			return +1;
+		}
+		if (*a < *b) {
+			if (!bias) {
+				bias = -1;
+			}
+		} else if (*a > *b) {
+			if (!bias) {
+				bias = +1;
+			}
+		} else if (!*a && !*b) {
+			return bias;
+		}
+	}
+}
+
+// Fractional parts: the first difference decides
+int compareLeft(char const *a, char const *b) {
+	for (;; a++, b++) {
+		if (!isDigit(*a) && !isDigit(*b)) {
+			return 0;
+		}
+		if (!isDigit(*a)) {
+			return -1;
+		}
+		if (!isDigit(*b)) {
+			return +1;
+		}
+		if (*a < *b) {
+			return -1;
+		}
+		if (*a > *b) {
+			return +1;
+		}
+	}
+}
+
+int compare(char const *a, char const *b, bool foldCase) {
+	int ai = 0;
+	int bi = 0;
+	while (true) {
+		char ca = a[ai];
+		char cb = b[bi];
+		while (isSpace(ca)) {
+			ca = a[++ai];
+		}
+		while (isSpace(cb)) {
+			cb = b[++bi];
+		}
+		if (isDigit(ca) && isDigit(cb)) {
+			const bool fractional = (ca == '0' || cb == '0');
+			const int result = fractional ? compareLeft(a + ai, b + bi) : compareRight(a + ai, b + bi);
+			if (result != 0) {
+				return result;
+			}
+		}
+		if (!ca && !cb) {
+			return 0;
+		}
+		if (foldCase) {
+			ca = static_cast<char>(toupper(static_cast<unsigned char>(ca)));
+			cb = static_cast<char>(toupper(static_cast<unsigned char>(cb)));
+		}
+		if (ca < cb) {
+			return -1;
+		}
+		if (ca > cb) {
+			return +1;
+		}
+		++ai;
+		++bi;
+	}
+}
+} // namespace
+
+int strnatcmp(char const *a, char const *b) {
+	return compare(a, b, false);
+}
+
+int strnatcasecmp(char const *a, char const *b) {
+	return compare(a, b, true);
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// Stand-in for the natsort library (used when its sources aren't found, see ../../CMakeLists.txt)
+int strnatcmp(char const *a, char const *b);
+int strnatcasecmp(char const *a, char const *b);
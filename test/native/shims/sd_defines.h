@@ -0,0 +1,9 @@
+#pragma once
+
+typedef enum {
+	CARD_NONE,
+	CARD_MMC,
+	CARD_SD,
+	CARD_SDHC,
+	CARD_UNKNOWN
+} sdcard_type_t;
@@ -0,0 +1,13 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "AudioPlayer.h"
+
+// Host-stubs of the AudioPlayer-functions used by the natively built modules
+playlistSortMode AudioPlayer_GetPlaylistSortMode(void) {
+	return AUDIOPLAYER_PLAYLIST_SORT_MODE_DEFAULT;
+}
+
+void AudioPlayer_SortPlaylist(Playlist *playlist) {
+	Playlist_Sort(playlist, AudioPlayer_GetPlaylistSortMode());
+}
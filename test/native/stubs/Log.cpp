@@ -0,0 +1,43 @@
+#include <Arduino.h>
+
+#include "Log.h"
+
+// Host-stub of Log.cpp: messages go to stderr if ESPUINO_NATIVE_LOG is set (to the maximum level to print)
+static uint8_t Log_HostLevel(void) {
+	static const uint8_t level = [] {
+		const char *env = getenv("ESPUINO_NATIVE_LOG");
+		return static_cast<uint8_t>(env ? atoi(env) : 0);
+	}();
+	return level;
+}
+
+void Log_Println(const char *_logBuffer, const uint8_t _minLogLevel) {
+	if (_minLogLevel <= Log_HostLevel()) {
+		fprintf(stderr, "%s\n", _logBuffer);
+	}
+}
+
+void Log_Print(const char *_logBuffer, const uint8_t _minLogLevel, bool) {
+	if (_minLogLevel <= Log_HostLevel()) {
+		fputs(_logBuffer, stderr);
+	}
+}
+
+int Log_Printf(const uint8_t _minLogLevel, const char *format, ...) {
+	if (_minLogLevel > Log_HostLevel()) {
+		return 0;
+	}
+	va_list args;
+	va_start(args, format);
+	const int len = vfprintf(stderr, format, args);
+	va_end(args);
+	fputc('\n', stderr);
+	return len;
+}
+
+void Log_Init(void) {
+}
+
+String Log_GetRingBuffer(void) {
+	return String();
+}
@@ -0,0 +1,8 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "System.h"
+
+// Host-stub of System.cpp: only the NVS-namespaces used by the natively built modules
+Preferences gPrefsRfid;
+Preferences gPrefsSettings;
@@ -0,0 +1,8 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Web.h"
+
+// Host-stub of Web.cpp: there is no webgui to notify
+void Web_SendWebsocketData(uint32_t, WebsocketCodeType) {
+}
@@ -0,0 +1,152 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Announcement.h"
+
+#include "HostFS.h"
+
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+#if (LANGUAGE == DE)
+const std::string clipDir = std::string(ANNOUNCEMENT_CLIP_DIR + 1) + "/de/";
+#elif (LANGUAGE == FR)
+const std::string clipDir = std::string(ANNOUNCEMENT_CLIP_DIR + 1) + "/fr/";
+#else
+const std::string clipDir = std::string(ANNOUNCEMENT_CLIP_DIR + 1) + "/en/";
+#endif
+
+std::vector<std::string> strings(const std::vector<String> &clips) {
+	std::vector<std::string> result;
+	for (const String &clip : clips) {
+		result.push_back(clip.c_str());
+	}
+	return result;
+}
+
+// Clips of numbers >= 10 that are "on the card"
+AnnouncementClipAvailable availableOf(std::set<std::string> clips) {
+	return [clips](const String &clip) { return clips.count(clip.c_str()) > 0; };
+}
+
+std::string le16(uint16_t value) {
+	return {static_cast<char>(value), static_cast<char>(value >> 8)};
+}
+
+std::string le32(uint32_t value) {
+	return le16(value) + le16(value >> 16);
+}
+
+// PCM-wav with a LIST-chunk in front of the data-chunk (odd-sized, so it's padded)
+std::string wav(uint16_t channels, uint32_t sampleRate, uint16_t bitsPerSample, const std::string &data) {
+	const uint16_t blockAlign = channels * bitsPerSample / 8;
+	const std::string fmt = le16(1) + le16(channels) + le32(sampleRate) + le32(sampleRate * blockAlign) + le16(blockAlign) + le16(bitsPerSample);
+	const std::string list = "INFOx";
+	const std::string chunks = "fmt " + le32(fmt.size()) + fmt + "LIST" + le32(list.size()) + list + '\0' + "data" + le32(data.size()) + data;
+	return "RIFF" + le32(4 + chunks.size()) + "WAVE" + chunks;
+}
+
+class AnnouncementTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		HostFS_Mount(HostFS_CreateImpl(dir_.path()));
+	}
+	void TearDown() override {
+		HostFS_Mount(nullptr);
+	}
+
+	void writeClip(const std::string &clip, const std::string &content) {
+		dir_.writeFile(clipDir + clip + ".wav", content);
+	}
+
+	static std::string readAnnouncement() {
+		File file = gFSystemAnnouncement.open(announcementPath, FILE_READ);
+		if (!file) {
+			ADD_FAILURE() << "announcement can't be opened";
+			return std::string();
+		}
+		std::string content(file.size(), '\0');
+		content.resize(file.read(reinterpret_cast<uint8_t *>(&content[0]), content.size()));
+		file.close();
+		return content;
+	}
+
+	HostTempDir dir_;
+};
+} // namespace
+
+TEST(AnnouncementSequenceTest, IpIsSpokenDigitByDigit) {
+	EXPECT_EQ(strings(Announcement_SequenceIp("192.168.0.12")), (std::vector<std::string> {"1", "9", "2", "point", "1", "6", "8", "point", "0", "point", "1", "2"}));
+	EXPECT_TRUE(Announcement_SequenceIp("").empty());
+}
+
+#if (LANGUAGE == DE) || (LANGUAGE == FR)
+TEST(AnnouncementSequenceTest, TimeIn24Hours) {
+	const AnnouncementClipAvailable none = availableOf({});
+	EXPECT_EQ(strings(Announcement_SequenceTime(0, 0, none)), (std::vector<std::string> {"itIs", "0", "oclock"}));
+	EXPECT_EQ(strings(Announcement_SequenceTime(9, 5, none)), (std::vector<std::string> {"itIs", "9", "oclock", "5"}));
+	EXPECT_EQ(strings(Announcement_SequenceTime(15, 0, none)), (std::vector<std::string> {"itIs", "1", "5", "oclock"}));
+	EXPECT_EQ(strings(Announcement_SequenceTime(23, 59, none)), (std::vector<std::string> {"itIs", "2", "3", "oclock", "5", "9"}));
+}
+
+TEST(AnnouncementSequenceTest, TimeUsesClipsOfNumbersIfAvailable) {
+	EXPECT_EQ(strings(Announcement_SequenceTime(23, 59, availableOf({"23", "59"}))), (std::vector<std::string> {"itIs", "23", "oclock", "59"}));
+	EXPECT_EQ(strings(Announcement_SequenceTime(12, 34, availableOf({"12"}))), (std::vector<std::string> {"itIs", "12", "oclock", "3", "4"}));
+}
+#else
+TEST(AnnouncementSequenceTest, TimeIn12Hours) {
+	const AnnouncementClipAvailable none = availableOf({});
+	EXPECT_EQ(strings(Announcement_SequenceTime(0, 0, none)), (std::vector<std::string> {"itIs", "1", "2", "oclock", "am"}));
+	EXPECT_EQ(strings(Announcement_SequenceTime(9, 5, none)), (std::vector<std::string> {"itIs", "9", "0", "5", "am"}));
+	EXPECT_EQ(strings(Announcement_SequenceTime(12, 0, none)), (std::vector<std::string> {"itIs", "1", "2", "oclock", "pm"}));
+	EXPECT_EQ(strings(Announcement_SequenceTime(23, 59, none)), (std::vector<std::string> {"itIs", "1", "1", "5", "9", "pm"}));
+}
+
+TEST(AnnouncementSequenceTest, TimeUsesClipsOfNumbersIfAvailable) {
+	EXPECT_EQ(strings(Announcement_SequenceTime(23, 59, availableOf({"11", "59"}))), (std::vector<std::string> {"itIs", "11", "59", "pm"}));
+	EXPECT_EQ(strings(Announcement_SequenceTime(12, 34, availableOf({"12"}))), (std::vector<std::string> {"itIs", "12", "3", "4", "pm"}));
+}
+#endif
+
+// The virtual file is a header for the sum of the data-chunks, followed by them
+TEST_F(AnnouncementTest, ClipsAreConcatenated) {
+	writeClip("1", wav(2, 22050, 16, "AAAABBBB"));
+	writeClip("point", wav(2, 22050, 16, "CCCC"));
+	writeClip("2", wav(2, 22050, 16, "DDDDEEEEFFFF"));
+	ASSERT_TRUE(Announcement_PrepareIp("1.2"));
+
+	const std::string expected = wav(2, 22050, 16, "AAAABBBBCCCCDDDDEEEEFFFF");
+	const std::string content = readAnnouncement();
+	ASSERT_EQ(content.size(), 44u + 24u);
+	EXPECT_EQ(content.substr(0, 8), "RIFF" + le32(36 + 24));
+	EXPECT_EQ(content.substr(8, 28), expected.substr(8, 28)); // WAVE, fmt-chunk
+	EXPECT_EQ(content.substr(36, 8), "data" + le32(24));
+	EXPECT_EQ(content.substr(44), "AAAABBBBCCCCDDDDEEEEFFFF");
+}
+
+// A clip ending in a partial frame would swap the channels (or bytes of a sample) of all clips after it
+TEST_F(AnnouncementTest, PartialFramesAreDropped) {
+	writeClip("1", wav(2, 22050, 16, "AAAAB"));
+	writeClip("point", wav(2, 22050, 16, "CCCCDDD"));
+	writeClip("2", wav(2, 22050, 16, "EEEE"));
+	ASSERT_TRUE(Announcement_PrepareIp("1.2"));
+
+	const std::string content = readAnnouncement();
+	EXPECT_EQ(content.substr(36, 8), "data" + le32(12));
+	EXPECT_EQ(content.substr(44), "AAAACCCCEEEE");
+}
+
+TEST_F(AnnouncementTest, MissingClipOrOtherFormatIsRejected) {
+	writeClip("1", wav(1, 22050, 16, "AA"));
+	writeClip("point", wav(1, 22050, 16, "BB"));
+	EXPECT_FALSE(Announcement_PrepareIp("1.2")); // no "2"
+	writeClip("2", wav(1, 44100, 16, "CC"));
+	EXPECT_FALSE(Announcement_PrepareIp("1.2"));
+	writeClip("2", wav(1, 22050, 16, "CC"));
+	EXPECT_TRUE(Announcement_PrepareIp("1.2"));
+	writeClip("2", wav(0, 22050, 16, "CC")); // no frame-size
+	EXPECT_FALSE(Announcement_PrepareIp("1.2"));
+}
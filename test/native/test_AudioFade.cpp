@@ -0,0 +1,99 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "AudioFade.h"
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+constexpr uint32_t sampleRate = 44100;
+constexpr int16_t level = 16384;
+
+// Mono block of a constant level, so every sample is the gain of its frame
+std::vector<int16_t> process(size_t frames, int16_t value = level) {
+	std::vector<int16_t> block(frames, value);
+	AudioFade_Process(block.data(), frames, 1);
+	return block;
+}
+
+class AudioFadeTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		AudioFade_SetSampleRate(sampleRate);
+		AudioFade_SetTrackGain(0);
+		AudioFade_To(AudioFadeEnvelope::Transition, audioFadeUnity, 0);
+		AudioFade_To(AudioFadeEnvelope::Sleep, audioFadeUnity, 0);
+		process(1);
+	}
+};
+} // namespace
+
+TEST_F(AudioFadeTest, UnityLeavesSamplesUntouched) {
+	std::vector<int16_t> block = {0, 1, -1, 12345, INT16_MIN, INT16_MAX};
+	const std::vector<int16_t> input = block;
+	AudioFade_Process(block.data(), block.size() / 2, 2);
+	EXPECT_EQ(block, input);
+	EXPECT_TRUE(AudioFade_IsUnity(AudioFadeEnvelope::Transition));
+	EXPECT_FALSE(AudioFade_IsSilent(AudioFadeEnvelope::Transition));
+}
+
+// A fade starts with the next block and ends exactly after the requested time, at its target
+TEST_F(AudioFadeTest, RampEndsExactlyAtTarget) {
+	AudioFade_To(AudioFadeEnvelope::Transition, 0, 10); // 441 frames
+	EXPECT_FALSE(AudioFade_IsUnity(AudioFadeEnvelope::Transition));
+	EXPECT_FALSE(AudioFade_IsSilent(AudioFadeEnvelope::Transition)); // requested, not yet faded
+	const std::vector<int16_t> first = process(440);
+	EXPECT_LT(first.front(), level);
+	EXPECT_GT(first.front(), level - 100);
+	EXPECT_GT(first[400], 0); // x^2: the last frames are already below one step of 16 bit
+	EXPECT_FALSE(AudioFade_IsSilent(AudioFadeEnvelope::Transition));
+	EXPECT_EQ(process(1).front(), 0);
+	EXPECT_TRUE(AudioFade_IsSilent(AudioFadeEnvelope::Transition));
+	EXPECT_EQ(process(64), std::vector<int16_t>(64, 0));
+
+	AudioFade_To(AudioFadeEnvelope::Transition, audioFadeUnity, 10);
+	const std::vector<int16_t> back = process(441);
+	EXPECT_EQ(back.back(), level);
+	EXPECT_TRUE(AudioFade_IsUnity(AudioFadeEnvelope::Transition));
+}
+
+// The position moves linearly, the gain is its square
+TEST_F(AudioFadeTest, GainFollowsSquareOfPosition) {
+	constexpr size_t frames = 4410;
+	AudioFade_To(AudioFadeEnvelope::Transition, 0, 100);
+	const std::vector<int16_t> block = process(frames);
+	for (size_t frame = 0; frame < frames; frame += 441) {
+		const double x = 1.0 - double(frame + 1) / frames;
+		EXPECT_NEAR(block[frame], level * x * x, 2.0) << "frame " << frame;
+	}
+	EXPECT_NEAR(block[frames / 2 - 1], level / 4, 2.0); // half-way: -12 dB, not -6 dB
+}
+
+TEST_F(AudioFadeTest, TrackGainIsClampedAndSaturates) {
+	AudioFade_SetTrackGain(-600); // -6 dB
+	EXPECT_NEAR(process(1).front(), level * pow(10.0, -6.0 / 20), 1.0);
+	AudioFade_SetTrackGain(300);
+	EXPECT_NEAR(process(1, 10000).front(), 10000 * pow(10.0, 3.0 / 20), 1.0);
+	AudioFade_SetTrackGain(1200); // more than +6 dB is clamped to gain 2
+	EXPECT_EQ(process(1, 10000).front(), 19999);
+	EXPECT_EQ(process(1, 30000).front(), INT16_MAX);
+	EXPECT_EQ(process(1, -30000).front(), INT16_MIN);
+}
+
+// Envelopes are multiplied: a track-change fading in again can't undo the sleep-fade
+TEST_F(AudioFadeTest, EnvelopesAreMultiplied) {
+	AudioFade_To(AudioFadeEnvelope::Sleep, audioFadeUnity / 2, 0);
+	AudioFade_To(AudioFadeEnvelope::Transition, audioFadeUnity / 2, 0);
+	EXPECT_EQ(process(1).front(), level / 16);
+
+	AudioFade_To(AudioFadeEnvelope::Transition, audioFadeUnity, 10);
+	EXPECT_EQ(process(441).back(), level / 4);
+	EXPECT_TRUE(AudioFade_IsUnity(AudioFadeEnvelope::Transition));
+	EXPECT_FALSE(AudioFade_IsUnity(AudioFadeEnvelope::Sleep));
+
+	AudioFade_To(AudioFadeEnvelope::Sleep, 0, 0);
+	EXPECT_EQ(process(16), std::vector<int16_t>(16, 0));
+	EXPECT_TRUE(AudioFade_IsSilent(AudioFadeEnvelope::Sleep));
+}
@@ -0,0 +1,227 @@
+#include "ButtonGesture.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+constexpr uint32_t debounceMs = 50;
+constexpr uint32_t longPressMs = 700;
+constexpr uint32_t doubleClickMs = 300;
+constexpr uint32_t ms = 1000; // times are in µs
+
+// Samples the buttons like the button-task: on every edge and every 10 ms while it's busy
+class Simulation {
+public:
+	explicit Simulation(std::vector<ButtonGestureConfig> configs, uint32_t startUs = 1000 * ms)
+		: configs_(std::move(configs))
+		, nowUs_(startUs)
+		, raw_(configs_.size(), false)
+		, gestures_(configs_.size(), configs_.data(), debounceMs, longPressMs, doubleClickMs, [this](const ButtonGestureEvent &event) { events_.push_back(event); }) { }
+
+	void set(uint8_t button, bool pressed) {
+		raw_[button] = pressed;
+		sample(nowUs_);
+	}
+	// Edges 2 ms apart before the contact settles in the given state
+	void bounce(uint8_t button, bool pressed) {
+		for (int i = 0; i < 4; i++) {
+			set(button, (i % 2 == 0) == pressed);
+			advance(2);
+		}
+		set(button, pressed);
+	}
+	void advance(uint32_t durationMs) {
+		const uint32_t endUs = nowUs_ + durationMs * ms;
+		while (int32_t(endUs - nowUs_) > 0) {
+			nowUs_ += std::min<uint32_t>(10 * ms, endUs - nowUs_);
+			sample(nowUs_);
+		}
+	}
+	uint32_t now() const {
+		return nowUs_;
+	}
+	std::vector<ButtonGestureEvent> &events() {
+		return events_;
+	}
+	const ButtonGestures &gestures() const {
+		return gestures_;
+	}
+
+private:
+	void sample(uint32_t edgeUs) {
+		for (uint8_t button = 0; button < raw_.size(); button++) {
+			gestures_.update(button, raw_[button], edgeUs, nowUs_);
+		}
+	}
+
+	std::vector<ButtonGestureConfig> configs_;
+	uint32_t nowUs_;
+	std::vector<bool> raw_;
+	std::vector<ButtonGestureEvent> events_;
+	ButtonGestures gestures_;
+};
+
+constexpr ButtonGestureConfig plain = {false, ButtonLongPress::Once};
+constexpr ButtonGestureConfig withDouble = {true, ButtonLongPress::Once};
+constexpr ButtonGestureConfig volume = {false, ButtonLongPress::Repeat};
+constexpr ButtonGestureConfig sleepMode = {false, ButtonLongPress::OnRelease};
+
+void expectEvent(const ButtonGestureEvent &event, ButtonGesture gesture, uint8_t button, uint32_t inputUs) {
+	EXPECT_EQ(event.gesture, gesture);
+	EXPECT_EQ(event.button, button);
+	EXPECT_EQ(event.inputUs, inputUs);
+}
+} // namespace
+
+TEST(ButtonGesture, BouncingContactGivesOneShortPress) {
+	Simulation sim({plain});
+	const uint32_t pressUs = sim.now();
+	sim.bounce(0, true);
+	EXPECT_TRUE(sim.gestures().isPressed(0));
+	sim.advance(200);
+	const uint32_t releaseUs = sim.now();
+	sim.bounce(0, false);
+	sim.advance(500);
+	EXPECT_FALSE(sim.gestures().isPressed(0));
+	ASSERT_EQ(sim.events().size(), 1u);
+	expectEvent(sim.events()[0], ButtonGesture::Short, 0, releaseUs);
+	EXPECT_NE(releaseUs, pressUs);
+}
+
+// Edges are locked out for the debounce-interval after an accepted one; the state is taken once it's over
+TEST(ButtonGesture, TapShorterThanDebounceIsTakenAfterLockout) {
+	Simulation sim({plain});
+	const uint32_t pressUs = sim.now();
+	sim.set(0, true);
+	sim.advance(10);
+	sim.set(0, false);
+	EXPECT_TRUE(sim.gestures().isPressed(0));
+	EXPECT_TRUE(sim.events().empty());
+	sim.advance(100);
+	EXPECT_FALSE(sim.gestures().isPressed(0));
+	ASSERT_EQ(sim.events().size(), 1u);
+	expectEvent(sim.events()[0], ButtonGesture::Short, 0, pressUs + debounceMs * ms); // first sample after the lockout
+}
+
+TEST(ButtonGesture, LongPressFiresOnceWhileHeld) {
+	Simulation sim({plain});
+	const uint32_t pressUs = sim.now();
+	sim.set(0, true);
+	sim.advance(690);
+	EXPECT_TRUE(sim.events().empty());
+	sim.advance(2000);
+	sim.set(0, false);
+	sim.advance(500);
+	ASSERT_EQ(sim.events().size(), 1u);
+	expectEvent(sim.events()[0], ButtonGesture::Long, 0, pressUs + longPressMs * ms);
+}
+
+TEST(ButtonGesture, LongPressRepeatsForVolume) {
+	Simulation sim({volume});
+	const uint32_t pressUs = sim.now();
+	sim.set(0, true);
+	sim.advance(2200);
+	sim.set(0, false);
+	sim.advance(500);
+	ASSERT_EQ(sim.events().size(), 3u);
+	for (uint32_t i = 0; i < 3; i++) {
+		expectEvent(sim.events()[i], ButtonGesture::Long, 0, pressUs + (i + 1) * longPressMs * ms);
+	}
+
+	sim.events().clear(); // short press is still a short press
+	sim.set(0, true);
+	sim.advance(100);
+	sim.set(0, false);
+	ASSERT_EQ(sim.events().size(), 1u);
+	EXPECT_EQ(sim.events()[0].gesture, ButtonGesture::Short);
+}
+
+// Sleep-mode fires on release, otherwise the held button would wake the ESP32 up again
+TEST(ButtonGesture, SleepFiresOnRelease) {
+	Simulation sim({sleepMode});
+	sim.set(0, true);
+	sim.advance(3000);
+	EXPECT_TRUE(sim.events().empty());
+	const uint32_t releaseUs = sim.now();
+	sim.set(0, false);
+	ASSERT_EQ(sim.events().size(), 1u);
+	expectEvent(sim.events()[0], ButtonGesture::Long, 0, releaseUs);
+}
+
+TEST(ButtonGesture, DoubleClickWithinWindow) {
+	Simulation sim({withDouble});
+	sim.set(0, true);
+	sim.advance(100);
+	sim.set(0, false);
+	sim.advance(250);
+	const uint32_t secondUs = sim.now();
+	sim.set(0, true);
+	sim.advance(100);
+	sim.set(0, false);
+	sim.advance(1000);
+	ASSERT_EQ(sim.events().size(), 1u);
+	expectEvent(sim.events()[0], ButtonGesture::Double, 0, secondUs);
+}
+
+// Without a second click the short-press fires when the window is over; its input is the release
+TEST(ButtonGesture, ShortPressWaitsForDoubleClickWindow) {
+	Simulation sim({withDouble});
+	sim.set(0, true);
+	sim.advance(100);
+	const uint32_t releaseUs = sim.now();
+	sim.set(0, false);
+	sim.advance(doubleClickMs - 10);
+	EXPECT_TRUE(sim.events().empty());
+	sim.advance(10);
+	ASSERT_EQ(sim.events().size(), 1u);
+	expectEvent(sim.events()[0], ButtonGesture::Short, 0, releaseUs);
+
+	sim.set(0, true); // a later click is a new gesture
+	sim.advance(100);
+	sim.set(0, false);
+	sim.advance(1000);
+	ASSERT_EQ(sim.events().size(), 2u);
+	EXPECT_EQ(sim.events()[1].gesture, ButtonGesture::Short);
+}
+
+TEST(ButtonGesture, ParallelPressIsMulti) {
+	Simulation sim({plain, plain, plain});
+	sim.set(2, true);
+	sim.advance(30);
+	const uint32_t secondUs = sim.now();
+	sim.set(0, true);
+	sim.advance(2000); // no long-press of either
+	sim.set(0, false);
+	sim.set(2, false);
+	sim.advance(500);
+	ASSERT_EQ(sim.events().size(), 1u);
+	expectEvent(sim.events()[0], ButtonGesture::Multi, 0, secondUs);
+	EXPECT_EQ(sim.events()[0].other, 2);
+}
+
+// A button that already fired its long-press doesn't form a multi-press with one pressed later
+TEST(ButtonGesture, NoMultiAfterLongPress) {
+	Simulation sim({plain, plain});
+	sim.set(0, true);
+	sim.advance(1000);
+	sim.set(1, true);
+	sim.advance(100);
+	sim.set(1, false);
+	sim.set(0, false);
+	sim.advance(500);
+	ASSERT_EQ(sim.events().size(), 2u);
+	EXPECT_EQ(sim.events()[0].gesture, ButtonGesture::Long);
+	expectEvent(sim.events()[1], ButtonGesture::Short, 1, sim.events()[1].inputUs);
+}
+
+// The µs-timer wraps after ~71 minutes
+TEST(ButtonGesture, TimerWrapAround) {
+	Simulation sim({volume}, UINT32_MAX - 500 * ms);
+	const uint32_t pressUs = sim.now();
+	sim.set(0, true);
+	sim.advance(1500);
+	sim.set(0, false);
+	ASSERT_EQ(sim.events().size(), 2u);
+	expectEvent(sim.events()[0], ButtonGesture::Long, 0, pressUs + longPressMs * ms);
+	expectEvent(sim.events()[1], ButtonGesture::Long, 0, pressUs + 2 * longPressMs * ms);
+}
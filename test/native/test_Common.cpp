@@ -0,0 +1,90 @@
+#include "Common.h"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+TEST(Common, FileValidAcceptsAudioFilesAndStreams) {
+	EXPECT_TRUE(fileValid("/music/01 Track.mp3"));
+	EXPECT_TRUE(fileValid("/music/Track.M4A"));
+	EXPECT_TRUE(fileValid("/music/list.m3u8"));
+	EXPECT_TRUE(fileValid("http://example.org/stream"));
+	EXPECT_TRUE(fileValid("https://example.org/stream"));
+	EXPECT_TRUE(fileValid("Track.flac"));
+}
+
+TEST(Common, FileValidRejectsHiddenAndUnknownFiles) {
+	EXPECT_FALSE(fileValid(nullptr));
+	EXPECT_FALSE(fileValid(""));
+	EXPECT_FALSE(fileValid("/music/._Track.mp3"));
+	EXPECT_FALSE(fileValid("/music/cover.jpg"));
+	EXPECT_FALSE(fileValid("/music/mp3"));
+	EXPECT_FALSE(fileValid(".hidden.mp3"));
+}
+
+TEST(Common, ParseRfidPreferenceEntry) {
+	char file[64];
+	uint32_t lastPlayPos, playMode, lastPlayPosMs;
+	uint16_t trackLastPlayed;
+	ASSERT_TRUE(parseRfidPreferenceEntry("#/audio/book#1234#3#7", file, sizeof(file), lastPlayPos, playMode, trackLastPlayed, lastPlayPosMs));
+	EXPECT_STREQ(file, "/audio/book");
+	EXPECT_EQ(lastPlayPos, 1234u);
+	EXPECT_EQ(playMode, 3u);
+	EXPECT_EQ(trackLastPlayed, 7u);
+	EXPECT_EQ(lastPlayPosMs, 0u);
+
+	// position in ms as 5th field: written by earlier versions, now kept beside the entry
+	ASSERT_TRUE(parseRfidPreferenceEntry("#/a.mp3#0#5#1#98765", file, sizeof(file), lastPlayPos, playMode, trackLastPlayed, lastPlayPosMs));
+	EXPECT_EQ(lastPlayPosMs, 98765u);
+}
+
+TEST(Common, ParseRfidPreferenceEntryRejectsMalformedEntries) {
+	char file[8];
+	uint32_t lastPlayPos, playMode, lastPlayPosMs;
+	uint16_t trackLastPlayed;
+	EXPECT_FALSE(parseRfidPreferenceEntry("#/a#1#2", file, sizeof(file), lastPlayPos, playMode, trackLastPlayed, lastPlayPosMs)); // too few fields
+	EXPECT_FALSE(parseRfidPreferenceEntry("#/a#1#2#3#4#5", file, sizeof(file), lastPlayPos, playMode, trackLastPlayed, lastPlayPosMs)); // too many
+	EXPECT_FALSE(parseRfidPreferenceEntry("#/far/too/long#1#2#3", file, sizeof(file), lastPlayPos, playMode, trackLastPlayed, lastPlayPosMs)); // buffer
+	EXPECT_FALSE(parseRfidPreferenceEntry("", file, sizeof(file), lastPlayPos, playMode, trackLastPlayed, lastPlayPosMs));
+}
+
+TEST(Common, ConvertAsciiToUtf8) {
+	char utf8[32];
+	convertAsciiToUtf8("\x8e\x84\x9a\x81\x99\x94\xe1-x", utf8, sizeof(utf8));
+	EXPECT_STREQ(utf8, "ÄäÜüÖöß-x");
+
+	char small[4]; // umlauts take two bytes, the result is truncated but terminated
+	convertAsciiToUtf8("\x8e\x8e\x8e", small, sizeof(small));
+	EXPECT_STREQ(small, "Ä");
+}
+
+namespace {
+std::string decode(const std::string &encoded) {
+	std::string buffer = encoded;
+	buffer.resize(b64decode(buffer.data(), buffer.data(), encoded.size())); // in place, like CoverCache does
+	return buffer;
+}
+} // namespace
+
+TEST(Common, B64Decode) {
+	EXPECT_EQ(decode(""), "");
+	EXPECT_EQ(decode("TWFu"), "Man");
+	EXPECT_EQ(decode("TWE="), "Ma");
+	EXPECT_EQ(decode("TWE"), "Ma"); // padding is optional
+	EXPECT_EQ(decode("TQ=="), "M");
+	EXPECT_EQ(decode("TQ"), "M");
+	EXPECT_EQ(decode("SGVsbG8sIFdvcmxkIQ=="), "Hello, World!");
+	EXPECT_EQ(decode("-_8"), decode("+/8")); // URL-safe alphabet
+	EXPECT_EQ(decode("TQ="), "M"); // padding of a group of three
+}
+
+// A single character left over is invalid; it must not be decoded (reading the byte after the input)
+TEST(Common, B64DecodeRejectsSingleCharacterTail) {
+	for (const std::string encoded : {"T", "TWFuT", "TWFuTWFuT"}) {
+		SCOPED_TRACE(encoded);
+		std::vector<uint8_t> input(encoded.begin(), encoded.end()); // exactly sized, so ASan sees reads beyond it
+		std::vector<uint8_t> output(input.size(), 0xAA);
+		EXPECT_EQ(b64decode(input.data(), output.data(), input.size()), 0u);
+		EXPECT_EQ(output, std::vector<uint8_t>(input.size(), 0xAA));
+	}
+}
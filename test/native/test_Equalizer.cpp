@@ -0,0 +1,110 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Equalizer.h"
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+constexpr uint32_t sampleRate = 44100;
+constexpr uint16_t blockFrames = 1152;
+constexpr uint8_t channels = 2;
+
+void setup(EqualizerPresets presets, EqualizerOutput output = EqualizerOutput::Speaker) {
+	Equalizer_SetSampleRate(48000); // starts with empty filter-states
+	Equalizer_SetSampleRate(sampleRate);
+	Equalizer_SelectOutput(output);
+	Equalizer_SetPresets(presets);
+}
+
+// Runs a sine (one channel inverted) through the equalizer in blocks; returns the gain in dB after settling
+double gainDb(double frequency, double amplitude = 8000) {
+	const size_t settleFrames = sampleRate / 5;
+	const size_t frames = settleFrames + sampleRate;
+	double inputPower = 0;
+	double outputPower = 0;
+	std::vector<int16_t> block(blockFrames * channels);
+	for (size_t offset = 0; offset < frames; offset += blockFrames) {
+		for (size_t i = 0; i < blockFrames; i++) {
+			const int16_t value = static_cast<int16_t>(lround(amplitude * sin(2 * M_PI * frequency * (offset + i) / sampleRate)));
+			block[i * channels] = value;
+			block[i * channels + 1] = -value;
+		}
+		const std::vector<int16_t> input = block;
+		Equalizer_Process(block.data(), blockFrames, channels);
+		if (offset < settleFrames) {
+			continue;
+		}
+		for (size_t i = 0; i < block.size(); i++) {
+			inputPower += double(input[i]) * input[i];
+			outputPower += double(block[i]) * block[i];
+		}
+	}
+	return 10 * log10(outputPower / inputPower);
+}
+
+EqualizerPresets speaker(std::vector<int8_t> gains) {
+	EqualizerPresets presets = {};
+	std::copy(gains.begin(), gains.end(), presets.speaker);
+	return presets;
+}
+} // namespace
+
+TEST(Equalizer, FlatPresetLeavesSamplesUntouched) {
+	setup(EqualizerPresets {});
+	std::vector<int16_t> block(blockFrames * channels);
+	for (size_t i = 0; i < block.size(); i++) {
+		block[i] = static_cast<int16_t>(i * 37);
+	}
+	const std::vector<int16_t> input = block;
+	Equalizer_Process(block.data(), blockFrames, channels);
+	EXPECT_EQ(block, input);
+	EqualizerStats stats;
+	Equalizer_GetStats(stats);
+	EXPECT_EQ(stats.activeBands, 0u);
+}
+
+// The largest boost is taken off the overall level: the boosted band keeps its level, the rest is lowered
+TEST(Equalizer, PeakBoostIsTakenOffTheOverallLevel) {
+	setup(speaker({0, 0, 0, 0, 6, 0, 0, 0}));
+	EXPECT_NEAR(gainDb(1000), 0.0, 0.3);
+	EXPECT_NEAR(gainDb(60), -6.0, 0.3);
+	EXPECT_NEAR(gainDb(10000), -6.0, 0.3);
+	EqualizerStats stats;
+	Equalizer_GetStats(stats);
+	EXPECT_EQ(stats.activeBands, 1u);
+}
+
+TEST(Equalizer, ShelvesCutTheirEnds) {
+	setup(speaker({-6, 0, 0, 0, 0, 0, 0, -6}));
+	EXPECT_NEAR(gainDb(20), -6.0, 0.8);
+	EXPECT_NEAR(gainDb(60), -3.0, 0.5); // corner-frequency: half of the gain
+	EXPECT_NEAR(gainDb(1000), 0.0, 0.3);
+	EXPECT_NEAR(gainDb(8000), -3.0, 0.5);
+	EXPECT_NEAR(gainDb(18000), -6.0, 0.8);
+}
+
+TEST(Equalizer, OutputsHavePresetsOfTheirOwn) {
+	EqualizerPresets presets = {};
+	presets.headphone[4] = -6;
+	setup(presets, EqualizerOutput::Headphone);
+	EXPECT_NEAR(gainDb(1000), -6.0, 0.3);
+	Equalizer_SelectOutput(EqualizerOutput::Speaker);
+	EXPECT_NEAR(gainDb(1000), 0.0, 0.01);
+}
+
+// The error-feedback mustn't keep a limit-cycle running: silence in, silence out
+TEST(Equalizer, SettlesToSilence) {
+	setup(speaker({6, -6, 6, -6, 6, -6, 6, -6}));
+	gainDb(50, 30000);
+	std::vector<int16_t> block(blockFrames * channels);
+	bool silent = false;
+	for (int i = 0; i < 40 && !silent; i++) { // about 1 s
+		std::fill(block.begin(), block.end(), 0);
+		Equalizer_Process(block.data(), blockFrames, channels);
+		silent = std::all_of(block.begin(), block.end(), [](int16_t value) { return value == 0; });
+	}
+	EXPECT_TRUE(silent);
+}
@@ -0,0 +1,256 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "SdCard.h"
+
+#include "HostClock.h"
+#include "HostFS.h"
+#include "HostSdCard.h"
+#include "driver/sdmmc_host.h"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+// The simulated card charges its model to a frozen clock: every timing below is that of the model and deterministic
+namespace {
+class HostSdCardTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		HostClock_Freeze(true);
+		sdmmc_host_set_card_clk(SDMMC_HOST_SLOT_1, SDMMC_FREQ_26M);
+	}
+	void TearDown() override {
+		HostClock_Freeze(false);
+		sdmmc_host_set_card_clk(SDMMC_HOST_SLOT_1, SDMMC_FREQ_DEFAULT);
+	}
+
+	fs::FSImplPtr card(const HostSdCardModel &model) {
+		return HostSdCard_CreateImpl(HostFS_CreateImpl(dir_.path()), model);
+	}
+
+	template <typename F>
+	int64_t measureUs(F &&f) {
+		const int64_t startUs = esp_timer_get_time();
+		f();
+		return esp_timer_get_time() - startUs;
+	}
+
+	int64_t readFileUs(File file, size_t chunkSize) {
+		std::vector<uint8_t> buffer(chunkSize);
+		return measureUs([&]() {
+			while (file.read(buffer.data(), buffer.size()) > 0) { }
+		});
+	}
+
+	int64_t enumerateUs(File dir, size_t &entries) {
+		entries = 0;
+		return measureUs([&]() {
+			while (!dir.getNextFileName().isEmpty()) {
+				entries++;
+			}
+		});
+	}
+
+	void createFiles(const std::string &dirPath, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			char name[64];
+			snprintf(name, sizeof(name), "%s/%04zu - Some track with a long name.mp3", dirPath.c_str(), i);
+			dir_.writeFile(name);
+		}
+	}
+
+	HostTempDir dir_;
+};
+} // namespace
+
+TEST_F(HostSdCardTest, SequentialReadFollowsBusModel) {
+	dir_.writeFile("file.bin", std::string(1024 * 1024, 'x'));
+	const HostSdCardModel sdmmcModel = HostSdCard_Sdmmc1BitModel();
+	const HostSdCardModel spiModel = HostSdCard_SpiModel();
+	fs::FSImplPtr sdmmcImpl = card(sdmmcModel);
+	fs::FS sdmmc(sdmmcImpl);
+	fs::FS spi(card(spiModel));
+
+	File file = sdmmc.open("/file.bin");
+	HostSdCard_ResetStats(sdmmcImpl);
+	const int64_t sdmmcUs = readFileUs(file, 4096);
+	const HostSdCardStats stats = HostSdCard_GetStats(sdmmcImpl);
+	EXPECT_EQ(stats.blocksRead, 2048u);
+	EXPECT_EQ(stats.commands, 2 * 256u); // a multi-block read (and its stop-command) per 4 KiB
+
+	// 2048 blocks of 512 bytes and their overhead at 26 MHz on one data-line, plus command-overhead and latency
+	const int64_t transferUs = 2048ll * (4096 + sdmmcModel.blockOverheadBits) * 1000 / 26000;
+	const int64_t perReadUs = 2 * sdmmcModel.commandUs + sdmmcModel.readLatencyUs;
+	EXPECT_NEAR(sdmmcUs, transferUs + 256 * perReadUs, 2);
+	EXPECT_NEAR(stats.simulatedUs, sdmmcUs, 1);
+
+	const int64_t spiUs = readFileUs(spi.open("/file.bin"), 4096);
+	EXPECT_GT(spiUs, 4 * sdmmcUs); // 4 MHz vs. 26 MHz
+}
+
+TEST_F(HostSdCardTest, SmallReadsShareTheFileBuffer) {
+	dir_.writeFile("file.bin", std::string(64 * 1024, 'x'));
+	fs::FSImplPtr impl = card(HostSdCard_Sdmmc1BitModel());
+	fs::FS fileSystem(impl);
+
+	File file = fileSystem.open("/file.bin");
+	HostSdCard_ResetStats(impl);
+	readFileUs(file, 64);
+	EXPECT_EQ(HostSdCard_GetStats(impl).blocksRead, 128u); // every block once, although read in 64-byte pieces
+}
+
+TEST_F(HostSdCardTest, SdmmcFollowsCardClock) {
+	dir_.writeFile("file.bin", std::string(256 * 1024, 'x'));
+	fs::FS fileSystem(card(HostSdCard_Sdmmc1BitModel()));
+
+	sdmmc_host_set_card_clk(SDMMC_HOST_SLOT_1, SDMMC_FREQ_DEFAULT);
+	const int64_t slowUs = readFileUs(fileSystem.open("/file.bin"), 16384);
+	sdmmc_host_set_card_clk(SDMMC_HOST_SLOT_1, SDMMC_FREQ_HIGHSPEED);
+	const int64_t fastUs = readFileUs(fileSystem.open("/file.bin"), 16384);
+	EXPECT_LT(fastUs, slowUs * 6 / 10);
+}
+
+TEST_F(HostSdCardTest, EnumerationCostIsPerEntry) {
+	createFiles("small", 200);
+	createFiles("large", 400);
+	fs::FSImplPtr impl = card(HostSdCard_Sdmmc1BitModel());
+	fs::FS fileSystem(impl);
+
+	size_t smallEntries = 0;
+	size_t largeEntries = 0;
+	const int64_t smallUs = enumerateUs(fileSystem.open("/small"), smallEntries);
+	File large = fileSystem.open("/large");
+	HostSdCard_ResetStats(impl);
+	const int64_t largeUs = enumerateUs(large, largeEntries);
+	EXPECT_EQ(smallEntries, 200u);
+	EXPECT_EQ(largeEntries, 400u);
+	EXPECT_NEAR(static_cast<double>(largeUs) / smallUs, 2.0, 0.1);
+
+	// "0000 - Some track with a long name.mp3" has 38 characters: 3 long-name entries and the 8.3-entry
+	const HostSdCardStats stats = HostSdCard_GetStats(impl);
+	EXPECT_EQ(stats.directoryEntriesScanned, 2 + 400u * 4 + 1);
+	EXPECT_EQ(stats.blocksRead, (2 + 400u * 4 + 1 + 15) / 16);
+}
+
+TEST_F(HostSdCardTest, OpenScansDirectoryUpToTheEntry) {
+	createFiles("dir", 1000);
+	fs::FS fileSystem(card(HostSdCard_SpiModel()));
+
+	const int64_t firstUs = measureUs([&]() { fileSystem.open("/dir/0000 - Some track with a long name.mp3").close(); });
+	const int64_t lastUs = measureUs([&]() { fileSystem.open("/dir/0999 - Some track with a long name.mp3").close(); });
+	const int64_t missingUs = measureUs([&]() { EXPECT_FALSE(fileSystem.exists("/dir/missing.mp3")); });
+	EXPECT_GT(lastUs, 10 * firstUs);
+	EXPECT_GT(missingUs, lastUs / 2); // a miss scans the whole directory (twice for exists(), four times for open())
+}
+
+TEST_F(HostSdCardTest, OpenNextFileCostsMoreThanGetNextFileName) {
+	createFiles("dir", 300);
+	fs::FS fileSystem(card(HostSdCard_Sdmmc1BitModel()));
+
+	size_t entries = 0;
+	const int64_t namesUs = enumerateUs(fileSystem.open("/dir"), entries);
+	File dir = fileSystem.open("/dir");
+	const int64_t filesUs = measureUs([&]() {
+		for (File file = dir.openNextFile(); file; file = dir.openNextFile()) { }
+	});
+	EXPECT_GT(filesUs, 10 * namesUs);
+}
+
+TEST_F(HostSdCardTest, WritesAndDirectoryChangesAreVisible) {
+	fs::FSImplPtr impl = card(HostSdCard_Sdmmc1BitModel());
+	fs::FS fileSystem(impl);
+
+	ASSERT_TRUE(fileSystem.mkdir("/new"));
+	File file = fileSystem.open("/new/file.bin", FILE_WRITE);
+	ASSERT_TRUE(file);
+	const std::string content(1500, 'y');
+	EXPECT_EQ(file.write(reinterpret_cast<const uint8_t *>(content.data()), content.size()), content.size());
+	file.close();
+
+	std::vector<std::string> names;
+	EXPECT_TRUE(SdCard_ListDirectory(fileSystem, "/new", [&names](const String &name, bool) { names.push_back(name.c_str()); }));
+	EXPECT_EQ(names, (std::vector<std::string> {"file.bin"}));
+	EXPECT_EQ(fileSystem.open("/new/file.bin").size(), content.size());
+	EXPECT_GE(HostSdCard_GetStats(impl).blocksWritten, 3u);
+
+	EXPECT_TRUE(fileSystem.rename("/new/file.bin", "/new/renamed.bin"));
+	EXPECT_FALSE(fileSystem.exists("/new/file.bin"));
+	EXPECT_TRUE(fileSystem.exists("/new/renamed.bin"));
+	EXPECT_TRUE(SdCard_DeletePath(fileSystem, "/new"));
+	EXPECT_FALSE(fileSystem.exists("/new"));
+}
+
+TEST_F(HostSdCardTest, PlaylistMatchesHostAndCostsEnumeration) {
+	createFiles("album", 50);
+	createFiles("tree/cd1", 20);
+	createFiles("tree/cd2", 20);
+	fs::FS host = HostFS_Create(dir_.path());
+	fs::FSImplPtr impl = card(HostSdCard_SpiModel());
+	fs::FS simulated(impl);
+
+	for (const auto &[path, playMode] : std::vector<std::pair<const char *, uint32_t>> {{"/album", ALL_TRACKS_OF_DIR_SORTED}, {"/tree", ALL_TRACKS_OF_ALL_SUBDIRS_SORTED}}) {
+		std::optional<Playlist *> expected = SdCard_ReturnPlaylist(host, path, playMode);
+		HostSdCard_ResetStats(impl);
+		const int64_t startUs = esp_timer_get_time();
+		std::optional<Playlist *> actual = SdCard_ReturnPlaylist(simulated, path, playMode);
+		const int64_t durationUs = esp_timer_get_time() - startUs;
+		ASSERT_TRUE(expected && actual);
+		ASSERT_EQ((*actual)->size(), (*expected)->size());
+		std::vector<std::string> expectedEntries;
+		std::vector<std::string> actualEntries;
+		for (size_t i = 0; i < (*actual)->size(); i++) {
+			expectedEntries.push_back((*expected)->at(i).c_str());
+			actualEntries.push_back((*actual)->at(i).c_str());
+		}
+		if (playMode == ALL_TRACKS_OF_DIR_SORTED) { // sorted by AudioPlayer_SortPlaylist() later on
+			std::sort(expectedEntries.begin(), expectedEntries.end());
+			std::sort(actualEntries.begin(), actualEntries.end());
+		}
+		EXPECT_EQ(actualEntries, expectedEntries) << path;
+		EXPECT_GT(HostSdCard_GetStats(impl).directoryEntriesScanned, (*actual)->size()) << path;
+		EXPECT_GT(durationUs, 0) << path;
+		freePlaylist(*expected);
+		freePlaylist(*actual);
+	}
+}
+
+TEST_F(HostSdCardTest, BenchmarkRunsAgainstSimulatedCard) {
+	fs::FS spi(card(HostSdCard_SpiModel()));
+	fs::FS sdmmc(card(HostSdCard_Sdmmc1BitModel()));
+
+	SdCardBenchmarkConfig config;
+	config.sizeBytes = 256 * 1024;
+	config.runAccessPatterns = true;
+	config.directoryEntries = 32;
+	config.randomReadCount = 32;
+
+	SdCardBenchmarkResult spiResult;
+	config.fileSystem = &spi;
+	ASSERT_TRUE(SdCard_RunBenchmark(config, spiResult)) << spiResult.message;
+	EXPECT_TRUE(spiResult.patterns.success) << spiResult.patterns.message;
+
+	SdCardBenchmarkResult sdmmcResult;
+	config.fileSystem = &sdmmc;
+	config.runFrequencySweep = true;
+	ASSERT_TRUE(SdCard_RunBenchmark(config, sdmmcResult)) << sdmmcResult.message;
+	EXPECT_TRUE(sdmmcResult.patterns.success) << sdmmcResult.patterns.message;
+	ASSERT_EQ(sdmmcResult.sweepEntryCount, 3u);
+	EXPECT_LT(sdmmcResult.sweepEntries[0].readSpeedKiBs, sdmmcResult.sweepEntries[1].readSpeedKiBs);
+	EXPECT_LT(sdmmcResult.sweepEntries[1].readSpeedKiBs, sdmmcResult.sweepEntries[2].readSpeedKiBs);
+	EXPECT_EQ(sdmmcResult.frequencyKHz, static_cast<uint32_t>(SDMMC_FREQ_HIGHSPEED));
+
+	EXPECT_GT(sdmmcResult.readSpeedKiBs, 3 * spiResult.readSpeedKiBs);
+	EXPECT_GT(sdmmcResult.patterns.randomReadIops, spiResult.patterns.randomReadIops);
+	EXPECT_EQ(spiResult.patterns.directoryEntries, 32u);
+	EXPECT_GT(spiResult.patterns.directoryLatency.maxUs, 0u);
+
+	// nothing but the model takes time: a second run measures the same
+	SdCardBenchmarkResult again;
+	config.runFrequencySweep = false;
+	config.runAccessPatterns = false;
+	config.fileSystem = &spi;
+	ASSERT_TRUE(SdCard_RunBenchmark(config, again));
+	EXPECT_EQ(again.writeDurationMs, spiResult.writeDurationMs);
+	EXPECT_EQ(again.readDurationMs, spiResult.readDurationMs);
+}
@@ -0,0 +1,117 @@
+#include "IndexPermutation.h"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+
+namespace {
+const std::vector<uint32_t> seeds = {0, 1, 2, 1234, 0x9E3779B9u, 0xDEADBEEFu, 0xFFFFFFFFu};
+
+// 0 - 3 and the sizes around the borders of the Feistel-domain (4^k)
+std::vector<size_t> sizes() {
+	std::vector<size_t> result = {0, 1, 2, 3};
+	for (size_t power = 4; power <= (1u << 20); power *= 4) {
+		result.push_back(power - 1);
+		result.push_back(power);
+		result.push_back(power + 1);
+	}
+	return result;
+}
+
+std::vector<size_t> order(const IndexPermutation &permutation, size_t size) {
+	std::vector<size_t> result(size);
+	for (size_t i = 0; i < size; i++) {
+		result[i] = permutation(i);
+	}
+	return result;
+}
+
+// Pearson's chi-squared statistic of observed counts against the same expected count for each
+double chiSquared(const std::vector<size_t> &counts, double expected) {
+	double sum = 0;
+	for (const size_t count : counts) {
+		sum += (count - expected) * (count - expected) / expected;
+	}
+	return sum;
+}
+} // namespace
+
+TEST(IndexPermutation, IsABijection) {
+	for (const size_t size : sizes()) {
+		for (const uint32_t seed : seeds) {
+			if (size > 70000 && seed > 2) {
+				continue; // the largest sizes with a few seeds only
+			}
+			SCOPED_TRACE(testing::Message() << "size " << size << ", seed " << seed);
+			std::vector<bool> hit(size, false);
+			size_t duplicates = 0;
+			const IndexPermutation permutation(size, seed);
+			for (size_t i = 0; i < size; i++) {
+				const size_t value = permutation(i);
+				ASSERT_LT(value, size);
+				duplicates += hit[value];
+				hit[value] = true;
+			}
+			ASSERT_EQ(duplicates, 0u);
+		}
+	}
+}
+
+TEST(IndexPermutation, SmallSizesAndOutOfRangeAreIdentity) {
+	EXPECT_FALSE(IndexPermutation(0, 42).isActive());
+	EXPECT_FALSE(IndexPermutation(1, 42).isActive());
+	EXPECT_EQ(IndexPermutation(1, 42)(0), 0u);
+	EXPECT_TRUE(IndexPermutation(2, 42).isActive());
+	EXPECT_EQ(IndexPermutation()(7), 7u);
+	EXPECT_EQ(IndexPermutation(10, 42)(10), 10u);
+	EXPECT_EQ(IndexPermutation(10, 42)(1000), 1000u);
+}
+
+// A persisted (size, seed) has to continue in the same order
+TEST(IndexPermutation, SameSeedSameOrder) {
+	EXPECT_EQ(order(IndexPermutation(1000, 77), 1000), order(IndexPermutation(1000, 77), 1000));
+	EXPECT_NE(order(IndexPermutation(1000, 77), 1000), order(IndexPermutation(1000, 78), 1000));
+	EXPECT_EQ(IndexPermutation(1000, 77).seed(), 77u);
+}
+
+// Every order of 3 - 5 entries occurs about equally often over consecutive seeds (chi-squared, p = 0.001)
+TEST(IndexPermutation, AllOrdersAreEquallyLikely) {
+	const std::map<size_t, double> critical = {{3, 20.52}, {4, 49.73}, {5, 172.42}}; // size! - 1 degrees of freedom
+	for (const auto &[size, limit] : critical) {
+		SCOPED_TRACE(testing::Message() << "size " << size);
+		constexpr uint32_t runs = 48000;
+		std::map<std::vector<size_t>, size_t> orders;
+		for (uint32_t seed = 0; seed < runs; seed++) {
+			orders[order(IndexPermutation(size, seed), size)]++;
+		}
+		std::vector<size_t> counts;
+		for (const auto &entry : orders) {
+			counts.push_back(entry.second);
+		}
+		size_t permutations = 1;
+		for (size_t i = 2; i <= size; i++) {
+			permutations *= i;
+		}
+		ASSERT_EQ(counts.size(), permutations);
+		EXPECT_LT(chiSquared(counts, double(runs) / permutations), limit);
+	}
+}
+
+// Every entry lands on every position about equally often: shuffled by table (5, 16) and by the Feistel-network
+// with cycle-walking (17, 65)
+TEST(IndexPermutation, PositionsAreUniform) {
+	const std::map<size_t, double> critical = {{5, 39.25}, {16, 296.29}, {17, 331.66}, {65, 4381.4}}; // (size - 1)^2 degrees of freedom
+	for (const auto &[size, limit] : critical) {
+		SCOPED_TRACE(testing::Message() << "size " << size);
+		const uint32_t runs = 1000 * size;
+		std::vector<size_t> counts(size * size, 0);
+		for (uint32_t seed = 0; seed < runs; seed++) {
+			const IndexPermutation permutation(size, seed);
+			for (size_t i = 0; i < size; i++) {
+				counts[i * size + permutation(i)]++;
+			}
+		}
+		EXPECT_LT(chiSquared(counts, double(runs) / size), limit);
+	}
+}
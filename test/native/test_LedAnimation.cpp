@@ -0,0 +1,226 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "LedAnimation.h"
+
+#include "HostFS.h"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+// Led_Address() of the firmware for a ring of N LEDs, with LED_OFFSET and NEOPIXEL_REVERSE_ROTATION
+template <uint8_t N, uint8_t Offset, bool Reverse>
+uint8_t address(uint8_t number) {
+	if constexpr (Reverse) {
+		if constexpr (Offset > 0) {
+			return number <= Offset - 1 ? Offset - 1 - number : N + Offset - 1 - number;
+		}
+		return N - 1 - number;
+	} else {
+		if constexpr (Offset > 0) {
+			return number >= N - Offset ? number + Offset - N : number + Offset;
+		}
+		return number;
+	}
+}
+
+struct Ring {
+	const char *name;
+	uint8_t numLeds;
+	uint8_t numDots;
+	LedAnimation::AddressFunction address;
+};
+
+const std::vector<Ring> rings = {
+	{"24", 24, 4, address<24, 0, false>},
+	{"24 reversed", 24, 4, address<24, 0, true>},
+	{"24 offset 5", 24, 4, address<24, 5, false>},
+	{"24 reversed, offset 5", 24, 4, address<24, 5, true>},
+	{"12 with 3 dots", 12, 3, address<12, 0, false>},
+	{"10 (dots not evenly spread)", 10, 4, address<10, 0, true>},
+	{"single LED", 1, 4, address<1, 0, false>},
+};
+
+using Frame = std::vector<CRGB>;
+
+// What the code-rendered idle-, busy-, pause- and speech-animations drew (Led_DrawIdleDots() on black)
+Frame drawDots(const Ring &ring, uint8_t offset, CRGB color) {
+	Frame leds(ring.numLeds, CRGB::Black);
+	for (uint8_t i = 0; i < ring.numDots; i++) {
+		leds[(ring.address(offset) + i * (ring.numLeds / ring.numDots)) % ring.numLeds] = color;
+	}
+	return leds;
+}
+
+struct Rendered {
+	Frame leds;
+	uint16_t holdMs;
+	bool active;
+};
+
+std::vector<Rendered> renderAll(LedAnimation &animation, uint8_t numLeds, size_t maxFrames = 1000) {
+	std::vector<Rendered> frames;
+	bool active = true;
+	for (size_t i = 0; active && i < maxFrames; i++) {
+		Rendered frame {Frame(numLeds), 0, false};
+		frame.active = active = animation.render(i == 0, frame.leds.data(), frame.holdMs);
+		frames.push_back(frame);
+	}
+	return frames;
+}
+
+std::string hex(const Frame &leds) {
+	std::string result;
+	char buffer[8];
+	for (const CRGB &led : leds) {
+		snprintf(buffer, sizeof(buffer), "%02x%02x%02x ", led.r, led.g, led.b);
+		result += buffer;
+	}
+	result.pop_back();
+	return result;
+}
+
+std::vector<std::string> hexFrames(const std::vector<Rendered> &frames) {
+	std::vector<std::string> result;
+	for (const Rendered &frame : frames) {
+		result.push_back(std::to_string(frame.holdMs) + (frame.active ? " A " : " - ") + hex(frame.leds));
+	}
+	return result;
+}
+} // namespace
+
+// The rotating dots (idle, busy) from a table look and time like the code that drew them every step
+TEST(LedAnimationTest, RotatingDotsMatchCodeRendering) {
+	for (const Ring &ring : rings) {
+		SCOPED_TRACE(ring.name);
+		LedAnimation animation;
+		ASSERT_TRUE(animation.compile(LedAnimation_RotatingDots(CRGB::White, 500, ring.numLeds, ring.numDots, ring.address), ring.numLeds, ring.address));
+		const std::vector<Rendered> frames = renderAll(animation, ring.numLeds);
+		ASSERT_EQ(frames.size(), ring.numLeds); // one round
+		for (uint8_t step = 0; step < ring.numLeds; step++) {
+			EXPECT_EQ(hex(frames[step].leds), hex(drawDots(ring, step, CRGB::White))) << "step " << int(step);
+			EXPECT_EQ(frames[step].holdMs, 500);
+			EXPECT_EQ(frames[step].active, step + 1 < ring.numLeds);
+		}
+	}
+}
+
+TEST(LedAnimationTest, EvenlySpreadDotsNeedOnlyOneDistanceOfFrames) {
+	LedAnimation animation;
+	ASSERT_TRUE(animation.compile(LedAnimation_RotatingDots(CRGB::White, 50, 24, 4, address<24, 0, false>), 24, address<24, 0, false>));
+	EXPECT_EQ(animation.frameCount(), 6u);
+	ASSERT_TRUE(animation.compile(LedAnimation_RotatingDots(CRGB::White, 50, 10, 4, address<10, 0, false>), 10, address<10, 0, false>));
+	EXPECT_EQ(animation.frameCount(), 10u);
+}
+
+TEST(LedAnimationTest, StaticDotsMatchCodeRendering) {
+	for (const Ring &ring : rings) {
+		SCOPED_TRACE(ring.name);
+		const uint8_t offset = (ring.numLeds >= 2 * ring.numDots) ? ((ring.numLeds / ring.numDots) / 2) - 1 : 0; // OFFSET_PAUSE_LEDS
+		LedAnimation animation;
+		ASSERT_TRUE(animation.compile(LedAnimationDescriptor {{CRGB::Yellow}, {{10, LedEasing::Step, LedAnimation_DotsPattern(ring.numLeds, ring.numDots, offset, ring.address)}}, 1}, ring.numLeds, ring.address));
+		const std::vector<Rendered> frames = renderAll(animation, ring.numLeds);
+		ASSERT_EQ(frames.size(), 1u);
+		EXPECT_EQ(hex(frames[0].leds), hex(drawDots(ring, offset, CRGB::Yellow)));
+		EXPECT_EQ(frames[0].holdMs, 10);
+		EXPECT_FALSE(frames[0].active);
+	}
+}
+
+// Golden frames: 8 LEDs, mapped with an offset of 2
+TEST(LedAnimationTest, GoldenFramesOfSteps) {
+	LedAnimation boot;
+	ASSERT_TRUE(boot.compile(LedAnimationDescriptor {{CRGB::Orange}, {{500, LedEasing::Step, "0."}, {500, LedEasing::Step, ".0"}}, 0}, 8, address<8, 2, false>));
+	EXPECT_EQ(hexFrames(renderAll(boot, 8, 3)), (std::vector<std::string> {
+													"500 A ffa500 000000 ffa500 000000 ffa500 000000 ffa500 000000",
+													"500 A 000000 ffa500 000000 ffa500 000000 ffa500 000000 ffa500",
+													"500 A ffa500 000000 ffa500 000000 ffa500 000000 ffa500 000000",
+												}));
+
+	LedAnimation warning;
+	ASSERT_TRUE(warning.compile(LedAnimationDescriptor {{CRGB::Red}, {{200, LedEasing::Step, "0"}, {200, LedEasing::Step, "."}}, 3}, 8, address<8, 2, false>));
+	const std::string red = "ff0000 ff0000 ff0000 ff0000 ff0000 ff0000 ff0000 ff0000";
+	const std::string black = "000000 000000 000000 000000 000000 000000 000000 000000";
+	EXPECT_EQ(hexFrames(renderAll(warning, 8)), (std::vector<std::string> {"200 A " + red, "200 A " + black, "200 A " + red, "200 A " + black, "200 A " + red, "200 - " + black}));
+
+	LedAnimation pattern;
+	ASSERT_TRUE(pattern.compile(LedAnimationDescriptor {{CRGB::Red, CRGB::Green}, {{100, LedEasing::Step, "01."}}, 1}, 8, address<8, 2, false>));
+	EXPECT_EQ(hexFrames(renderAll(pattern, 8)), (std::vector<std::string> {"100 - ff0000 008000 ff0000 008000 000000 ff0000 008000 000000"}));
+}
+
+// Eased transitions compute what FastLED's blend() and ease8InOutQuad() give; the last keyframe eases back as it's repeated
+TEST(LedAnimationTest, GoldenFramesOfTransitions) {
+	LedAnimation fade;
+	ASSERT_TRUE(fade.compile(LedAnimationDescriptor {{CRGB(0xff0000), CRGB(0x0000ff)}, {{100, LedEasing::EaseInOut, "0"}, {60, LedEasing::Linear, "1"}}, 2}, 1, address<1, 0, false>));
+	EXPECT_EQ(fade.frameCount(), 8u);
+	EXPECT_EQ(hexFrames(renderAll(fade, 1)), (std::vector<std::string> {
+												 "20 A ff0000",
+												 "20 A eb0014",
+												 "20 A ad0052",
+												 "20 A 5200ad",
+												 "20 A 1400eb",
+												 "20 A 0000ff",
+												 "20 A 5500aa",
+												 "20 A aa0055",
+												 "20 A ff0000",
+												 "20 A eb0014",
+												 "20 A ad0052",
+												 "20 A 5200ad",
+												 "20 A 1400eb",
+												 "20 A 0000ff",
+												 "20 A 5500aa",
+												 "20 - aa0055",
+											 }));
+
+	LedAnimation once; // not repeated: no transition back to the first keyframe
+	ASSERT_TRUE(once.compile(LedAnimationDescriptor {{CRGB(0xff0000), CRGB(0x0000ff)}, {{40, LedEasing::Linear, "0"}, {70, LedEasing::Linear, "1"}}, 1}, 1, address<1, 0, false>));
+	EXPECT_EQ(hexFrames(renderAll(once, 1)), (std::vector<std::string> {"20 A ff0000", "20 A 7f0080", "70 - 0000ff"}));
+}
+
+TEST(LedAnimationTest, TooManyFramesKeepTheCompiledTable) {
+	LedAnimation animation;
+	ASSERT_TRUE(animation.compile(LedAnimationDescriptor {{CRGB::Green}, {{400, LedEasing::Step, "0"}}, 1}, 8, address<8, 0, false>));
+	EXPECT_FALSE(animation.compile(LedAnimationDescriptor {{CRGB(1)}, {{5000, LedEasing::Linear, "0"}, {5000, LedEasing::Linear, "."}}, 0}, 8, address<8, 0, false>));
+	EXPECT_FALSE(animation.compile(LedAnimationDescriptor {{CRGB(1)}, {}, 0}, 8, address<8, 0, false>));
+	EXPECT_EQ(hexFrames(renderAll(animation, 8)), (std::vector<std::string> {"400 - 008000 008000 008000 008000 008000 008000 008000 008000"}));
+}
+
+class LedAnimationLoadTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		HostFS_Mount(HostFS_CreateImpl(dir_.path()));
+	}
+	void TearDown() override {
+		HostFS_Mount(nullptr);
+	}
+
+	HostTempDir dir_;
+};
+
+TEST_F(LedAnimationLoadTest, LoadsCustomAnimation) {
+	dir_.writeFile(std::string(LED_ANIMATION_DIR + 1) + "/ok.json", R"({"palette": ["#00ff00", "0000ff"], "repeats": 2, "keyframes": [{"ms": 200, "pattern": "0"}, {"ms": 100, "ease": "easeInOut", "pattern": "1."}]})");
+	LedAnimationDescriptor descriptor;
+	ASSERT_TRUE(LedAnimation_Load("ok", descriptor));
+	ASSERT_EQ(descriptor.palette.size(), 2u);
+	EXPECT_EQ(descriptor.palette[0], CRGB(0x00ff00));
+	EXPECT_EQ(descriptor.palette[1], CRGB(0x0000ff));
+	EXPECT_EQ(descriptor.repeats, 2);
+	ASSERT_EQ(descriptor.keyframes.size(), 2u);
+	EXPECT_EQ(descriptor.keyframes[0].durationMs, 200);
+	EXPECT_EQ(descriptor.keyframes[0].easing, LedEasing::Step);
+	EXPECT_STREQ(descriptor.keyframes[0].pattern.c_str(), "0");
+	EXPECT_EQ(descriptor.keyframes[1].durationMs, 100);
+	EXPECT_EQ(descriptor.keyframes[1].easing, LedEasing::EaseInOut);
+	EXPECT_STREQ(descriptor.keyframes[1].pattern.c_str(), "1.");
+}
+
+TEST_F(LedAnimationLoadTest, RejectsMissingOrBrokenFiles) {
+	LedAnimationDescriptor descriptor;
+	EXPECT_FALSE(LedAnimation_Load("idle", descriptor));
+	dir_.writeFile(std::string(LED_ANIMATION_DIR + 1) + "/busy.json", R"({"palette": ["#00ff00"], "keyframes": [)");
+	EXPECT_FALSE(LedAnimation_Load("busy", descriptor));
+	dir_.writeFile(std::string(LED_ANIMATION_DIR + 1) + "/pause.json", R"({"palette": ["#00ff00"], "keyframes": []})");
+	EXPECT_FALSE(LedAnimation_Load("pause", descriptor));
+}
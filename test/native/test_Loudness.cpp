@@ -0,0 +1,218 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Loudness.h"
+
+#include "HostFS.h"
+#include "Metadata.h"
+#include "SdCard.h"
+
+#include <chrono>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr float toleranceLu = 0.1f; // of EBU Tech 3341
+
+struct Segment {
+	float dbfs; // peak-level of the 1 kHz sine
+	float seconds;
+};
+
+// Stereo 1 kHz sine (both channels in phase), level changes between the segments
+std::vector<int16_t> sine(uint32_t sampleRate, const std::vector<Segment> &segments) {
+	std::vector<int16_t> samples;
+	size_t n = 0;
+	for (const Segment &segment : segments) {
+		const double amplitude = 32767.0 * pow(10.0, segment.dbfs / 20.0);
+		const size_t frames = segment.seconds * sampleRate;
+		for (size_t i = 0; i < frames; i++, n++) {
+			const int16_t sample = lround(amplitude * sin(2.0 * M_PI * 1000.0 * n / sampleRate));
+			samples.push_back(sample);
+			samples.push_back(sample);
+		}
+	}
+	return samples;
+}
+
+std::string le16(uint16_t value) {
+	return {static_cast<char>(value), static_cast<char>(value >> 8)};
+}
+
+std::string le32(uint32_t value) {
+	return le16(value) + le16(value >> 16);
+}
+
+std::string wav(uint32_t sampleRate, uint16_t channels, uint16_t bitsPerSample, const std::string &data) {
+	const uint16_t blockAlign = channels * bitsPerSample / 8;
+	std::string fmt = le16(1) + le16(channels) + le32(sampleRate) + le32(sampleRate * blockAlign) + le16(blockAlign) + le16(bitsPerSample);
+	std::string list = "INFO"; // a chunk in front of "data" has to be skipped
+	return "RIFF" + le32(4 + 8 + fmt.size() + 8 + list.size() + 8 + data.size()) + "WAVE" + "fmt " + le32(fmt.size()) + fmt + "LIST" + le32(list.size()) + list + "data" + le32(data.size()) + data;
+}
+
+std::string wav16(uint32_t sampleRate, const std::vector<int16_t> &stereo) {
+	return wav(sampleRate, 2, 16, std::string(reinterpret_cast<const char *>(stereo.data()), stereo.size() * sizeof(int16_t)));
+}
+
+class LoudnessTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		HostFS_Mount(HostFS_CreateImpl(dir_.path()));
+	}
+	void TearDown() override {
+		HostFS_Mount(nullptr);
+	}
+
+	LoudnessResult measure(const std::string &name, const std::string &content, float &lufs) {
+		dir_.writeFile(name, content);
+		File file = gFSystem.open(("/" + name).c_str(), FILE_READ);
+		if (!file) {
+			ADD_FAILURE() << "unable to open " << name;
+			return LoudnessResult::Unsupported;
+		}
+		const LoudnessResult result = Loudness_MeasureWav(file, lufs);
+		file.close();
+		return result;
+	}
+
+	HostTempDir dir_;
+};
+
+// Measurement while playing: needs a record of the track in the metadata-index
+class LoudnessPlaybackTest : public LoudnessTest {
+protected:
+	void SetUp() override {
+		LoudnessTest::SetUp();
+		static const bool initialised = [] {
+			Metadata_Init();
+			return true;
+		}();
+		(void) initialised;
+	}
+
+	bool index(const std::string &path) {
+		dir_.writeFile(path.substr(1), std::string(4096, '\0')); // no tag, no frames
+		Playlist playlist;
+		playlist.push_back(strdup(path.c_str()));
+		Metadata_IndexPlaylist(&playlist);
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+		MetadataInfo info;
+		while (!Metadata_Lookup(path.c_str(), info)) {
+			if (std::chrono::steady_clock::now() > deadline) {
+				return false;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		}
+		return info.replayGain == metadataGainUnknown;
+	}
+
+	// Feeds PCM in blocks like audio_process_i2s() gets them
+	static void play(const std::vector<int16_t> &stereo, uint32_t sampleRate) {
+		constexpr size_t blockFrames = 1152;
+		for (size_t frame = 0; frame < stereo.size() / 2; frame += blockFrames) {
+			const size_t frames = std::min(blockFrames, stereo.size() / 2 - frame);
+			Loudness_ProcessTrack(stereo.data() + frame * 2, frames, 2, sampleRate);
+		}
+	}
+
+	static int16_t gainOf(const std::string &path) {
+		MetadataInfo info;
+		return Metadata_Lookup(path.c_str(), info) ? info.replayGain : metadataGainUnknown;
+	}
+};
+} // namespace
+
+// EBU Tech 3341, test-cases 1 - 4 (the relative gate is what 3 and 4 are about)
+TEST_F(LoudnessTest, Tech3341Case1) {
+	float lufs = 0;
+	ASSERT_EQ(measure("case1.wav", wav16(48000, sine(48000, {{-23, 20}})), lufs), LoudnessResult::Measured);
+	EXPECT_NEAR(lufs, -23.0f, toleranceLu);
+}
+
+TEST_F(LoudnessTest, Tech3341Case2) {
+	float lufs = 0;
+	ASSERT_EQ(measure("case2.wav", wav16(48000, sine(48000, {{-33, 20}})), lufs), LoudnessResult::Measured);
+	EXPECT_NEAR(lufs, -33.0f, toleranceLu);
+}
+
+TEST_F(LoudnessTest, Tech3341Case3) {
+	float lufs = 0;
+	ASSERT_EQ(measure("case3.wav", wav16(48000, sine(48000, {{-36, 10}, {-23, 60}, {-36, 10}})), lufs), LoudnessResult::Measured);
+	EXPECT_NEAR(lufs, -23.0f, toleranceLu);
+}
+
+TEST_F(LoudnessTest, Tech3341Case4) {
+	float lufs = 0;
+	ASSERT_EQ(measure("case4.wav", wav16(48000, sine(48000, {{-72, 10}, {-36, 10}, {-23, 60}, {-36, 10}, {-72, 10}})), lufs), LoudnessResult::Measured);
+	EXPECT_NEAR(lufs, -23.0f, toleranceLu);
+}
+
+TEST_F(LoudnessTest, OtherSampleRate) {
+	float lufs = 0;
+	ASSERT_EQ(measure("44k1.wav", wav16(44100, sine(44100, {{-23, 20}})), lufs), LoudnessResult::Measured);
+	EXPECT_NEAR(lufs, -23.0f, toleranceLu);
+}
+
+TEST_F(LoudnessTest, SilenceAndUnsupportedFormatsAreDistinct) {
+	float lufs = 0;
+	EXPECT_EQ(measure("silence.wav", wav16(48000, std::vector<int16_t>(48000 * 2 * 5, 0)), lufs), LoudnessResult::Silent);
+	EXPECT_EQ(measure("24bit.wav", wav(48000, 2, 24, std::string(48000 * 6, '\0')), lufs), LoudnessResult::Unsupported);
+	EXPECT_EQ(measure("track.mp3", std::string(4096, '\0'), lufs), LoudnessResult::Unsupported);
+}
+
+TEST_F(LoudnessPlaybackTest, CompletedTrackIsStoredAsGain) {
+	ASSERT_TRUE(index("/played/complete.mp3"));
+	Loudness_BeginTrack("/played/complete.mp3");
+	play(sine(44100, {{-23, 20}}), 44100);
+	Loudness_EndTrack(true);
+	EXPECT_NEAR(gainOf("/played/complete.mp3"), (REPLAYGAIN_TARGET_LUFS + 23) * 100, toleranceLu * 100);
+}
+
+// Metering runs in the PCM-callback: its cost per block is reported like the equalizer's
+TEST_F(LoudnessPlaybackTest, MeteredBlocksAreCounted) {
+	ASSERT_TRUE(index("/played/cost.mp3"));
+	LoudnessStats before;
+	Loudness_GetStats(before);
+	Loudness_BeginTrack("/played/cost.mp3");
+	play(sine(44100, {{-23, 2}}), 44100); // 77 blocks of 1152 frames (the last one shorter)
+	Loudness_EndTrack(false);
+	LoudnessStats after;
+	Loudness_GetStats(after);
+	EXPECT_EQ(after.blocks - before.blocks, 77u);
+	EXPECT_GT(after.lastCycles, 0u);
+	EXPECT_GE(after.maxCycles, after.lastCycles);
+
+	Loudness_BeginTrack(nullptr); // tracks that aren't measured cost nothing
+	play(sine(44100, {{-23, 1}}), 44100);
+	Loudness_GetStats(before);
+	EXPECT_EQ(before.blocks, after.blocks);
+}
+
+TEST_F(LoudnessPlaybackTest, InterruptedTrackStaysUnknown) {
+	ASSERT_TRUE(index("/played/skipped.mp3"));
+	Loudness_BeginTrack("/played/skipped.mp3");
+	play(sine(44100, {{-23, 5}}), 44100);
+	Loudness_EndTrack(false); // seeked
+	Loudness_EndTrack(true); // the eof after the seek
+	EXPECT_EQ(gainOf("/played/skipped.mp3"), metadataGainUnknown);
+}
+
+TEST_F(LoudnessPlaybackTest, SilentTrackIsUnmeasurableNotZero) {
+	ASSERT_TRUE(index("/played/silent.mp3"));
+	Loudness_BeginTrack("/played/silent.mp3");
+	play(std::vector<int16_t>(44100 * 2 * 5, 0), 44100);
+	Loudness_EndTrack(true);
+	EXPECT_EQ(gainOf("/played/silent.mp3"), metadataGainUnmeasurable);
+}
+
+TEST_F(LoudnessPlaybackTest, FormatChangeWithinTrackIsDiscarded) {
+	ASSERT_TRUE(index("/played/changed.mp3"));
+	Loudness_BeginTrack("/played/changed.mp3");
+	play(sine(44100, {{-23, 5}}), 44100);
+	play(sine(48000, {{-23, 5}}), 48000);
+	Loudness_EndTrack(true);
+	EXPECT_EQ(gainOf("/played/changed.mp3"), metadataGainUnknown);
+}
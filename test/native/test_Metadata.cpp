@@ -0,0 +1,159 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Metadata.h"
+
+#include "HostFS.h"
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+namespace {
+// ID3v2.3-tag with text-frames (ISO-8859-1) followed by a few bytes of "audio"
+std::string id3Tag(const std::vector<std::pair<std::string, std::string>> &frames) {
+	std::string body;
+	for (const auto &frame : frames) {
+		const uint32_t size = frame.second.size() + 1;
+		body += frame.first;
+		body += {static_cast<char>(size >> 24), static_cast<char>(size >> 16), static_cast<char>(size >> 8), static_cast<char>(size)};
+		body += std::string(2, '\0'); // flags
+		body += '\0'; // encoding
+		body += frame.second;
+	}
+	const uint32_t size = body.size();
+	std::string tag = "ID3";
+	tag += {3, 0, 0, static_cast<char>((size >> 21) & 0x7F), static_cast<char>((size >> 14) & 0x7F), static_cast<char>((size >> 7) & 0x7F), static_cast<char>(size & 0x7F)};
+	return tag + body + std::string(64, '\0');
+}
+
+std::string le32(uint32_t value) {
+	return {static_cast<char>(value), static_cast<char>(value >> 8), static_cast<char>(value >> 16), static_cast<char>(value >> 24)};
+}
+
+// FLAC with nothing but a Vorbis-comment block
+std::string flacWithComments(const std::vector<std::string> &comments) {
+	std::string block = le32(6) + "vendor" + le32(comments.size());
+	for (const std::string &comment : comments) {
+		block += le32(comment.size()) + comment;
+	}
+	std::string flac = "fLaC";
+	flac += {static_cast<char>(0x80 | 4), static_cast<char>(block.size() >> 16), static_cast<char>(block.size() >> 8), static_cast<char>(block.size())};
+	return flac + block;
+}
+
+Playlist *makePlaylist(const std::vector<std::string> &entries) {
+	Playlist *playlist = new Playlist();
+	for (const std::string &entry : entries) {
+		playlist->push_back(strdup(entry.c_str()));
+	}
+	return playlist;
+}
+
+std::vector<std::string> contents(const Playlist &playlist) {
+	std::vector<std::string> result;
+	for (size_t i = 0; i < playlist.size(); i++) {
+		result.push_back(playlist.at(i).c_str());
+	}
+	return result;
+}
+
+// The index is global and keyed by path: every test uses directories of its own
+class MetadataTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		HostFS_Mount(HostFS_CreateImpl(dir_.path()));
+		static const bool initialised = [] {
+			Metadata_Init();
+			return true;
+		}();
+		(void) initialised;
+	}
+	void TearDown() override {
+		HostFS_Mount(nullptr);
+	}
+
+	// Lets the metadata-task index the playlist and waits until it saved the index
+	bool indexAndWait(const std::vector<std::string> &paths) {
+		Playlist *playlist = makePlaylist(paths);
+		Metadata_IndexPlaylist(playlist);
+		freePlaylist(playlist);
+		const std::string indexFile = dir_.path() + METADATA_INDEX_FILE;
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+		while (std::chrono::steady_clock::now() < deadline) {
+			size_t indexed = 0;
+			for (const std::string &path : paths) {
+				MetadataInfo info;
+				indexed += Metadata_Lookup(path.c_str(), info);
+			}
+			struct stat st;
+			if (indexed == paths.size() && stat(indexFile.c_str(), &st) == 0 && st.st_size > 0) {
+				return true;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		}
+		return false;
+	}
+
+	HostTempDir dir_;
+};
+} // namespace
+
+TEST_F(MetadataTest, ParsesDiscAndTrackNumbers) {
+	dir_.writeFile("parse/id3.mp3", id3Tag({{"TIT2", "Title"}, {"TRCK", "3/12"}, {"TPOS", "2/2"}}));
+	dir_.writeFile("parse/vorbis.flac", flacWithComments({"TRACKNUMBER=7", "DISCNUMBER=3/4", "TITLE=Flac"}));
+	ASSERT_TRUE(indexAndWait({"/parse/id3.mp3", "/parse/vorbis.flac"}));
+
+	MetadataInfo info;
+	ASSERT_TRUE(Metadata_Lookup("/parse/id3.mp3", info));
+	EXPECT_STREQ(info.title, "Title");
+	EXPECT_EQ(info.trackNumber, 3);
+	EXPECT_EQ(info.discNumber, 2);
+	ASSERT_TRUE(Metadata_Lookup("/parse/vorbis.flac", info));
+	EXPECT_STREQ(info.title, "Flac");
+	EXPECT_EQ(info.trackNumber, 7);
+	EXPECT_EQ(info.discNumber, 3);
+}
+
+TEST_F(MetadataTest, SortDoesNotParseUnindexedFiles) {
+	dir_.writeFile("unindexed/a.mp3", id3Tag({{"TRCK", "2"}}));
+	dir_.writeFile("unindexed/b.mp3", id3Tag({{"TRCK", "1"}}));
+	Playlist *playlist = makePlaylist({"/unindexed/a.mp3", "/unindexed/b.mp3"});
+	Metadata_SortByTrackNumber(playlist);
+
+	EXPECT_EQ(contents(*playlist), (std::vector<std::string> {"/unindexed/a.mp3", "/unindexed/b.mp3"}));
+	MetadataInfo info;
+	EXPECT_FALSE(Metadata_Lookup("/unindexed/a.mp3", info));
+	freePlaylist(playlist);
+}
+
+TEST_F(MetadataTest, SortsByDiscThenTrackThenFilename) {
+	const std::vector<std::string> byName = {"/album/a.mp3", "/album/b.mp3", "/album/c.mp3", "/album/d.mp3", "/album/e.mp3"};
+	dir_.writeFile("album/a.mp3", id3Tag({{"TRCK", "1"}, {"TPOS", "2"}}));
+	dir_.writeFile("album/b.mp3", id3Tag({{"TRCK", "2"}, {"TPOS", "1/2"}}));
+	dir_.writeFile("album/c.mp3", id3Tag({{"TRCK", "1"}, {"TPOS", "1"}}));
+	dir_.writeFile("album/d.mp3", id3Tag({{"TRCK", "1"}})); // no disc: the first one
+	dir_.writeFile("album/e.mp3", id3Tag({{"TRCK", "10"}, {"TPOS", "1"}}));
+	ASSERT_TRUE(indexAndWait(byName));
+
+	Playlist *playlist = makePlaylist(byName);
+	Metadata_SortByTrackNumber(playlist);
+	EXPECT_EQ(contents(*playlist), (std::vector<std::string> {"/album/c.mp3", "/album/d.mp3", "/album/b.mp3", "/album/e.mp3", "/album/a.mp3"}));
+	freePlaylist(playlist);
+}
+
+TEST_F(MetadataTest, MissingTrackNumberKeepsFilenameOrder) {
+	const std::vector<std::string> byName = {"/partial/01.mp3", "/partial/02.mp3", "/partial/03.mp3"};
+	dir_.writeFile("partial/01.mp3", id3Tag({{"TRCK", "3"}}));
+	dir_.writeFile("partial/02.mp3", id3Tag({{"TIT2", "untracked"}}));
+	dir_.writeFile("partial/03.mp3", id3Tag({{"TRCK", "1"}}));
+	ASSERT_TRUE(indexAndWait(byName));
+
+	Playlist *playlist = makePlaylist(byName);
+	Metadata_SortByTrackNumber(playlist);
+	EXPECT_EQ(contents(*playlist), byName);
+	freePlaylist(playlist);
+}
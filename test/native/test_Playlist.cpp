@@ -0,0 +1,105 @@
+#include <Arduino.h>
+
+#include "Playlist.h"
+
+#include <gtest/gtest.h>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+Playlist *makePlaylist(const std::vector<const char *> &entries) {
+	Playlist *playlist = new Playlist();
+	for (const char *entry : entries) {
+		playlist->push_back(strdup(entry));
+	}
+	return playlist;
+}
+
+std::vector<std::string> contents(const Playlist &playlist) {
+	std::vector<std::string> result;
+	for (size_t i = 0; i < playlist.size(); i++) {
+		result.push_back(playlist.at(i).c_str());
+	}
+	return result;
+}
+} // namespace
+
+TEST(Playlist, SortModes) {
+	const std::vector<const char *> entries = {"/b/Track 10.mp3", "/b/track 2.mp3", "/b/Track 1.mp3"};
+
+	Playlist *playlist = makePlaylist(entries);
+	Playlist_Sort(playlist, playlistSortMode::STRCMP);
+	EXPECT_EQ(contents(*playlist), (std::vector<std::string> {"/b/Track 1.mp3", "/b/Track 10.mp3", "/b/track 2.mp3"}));
+	freePlaylist(playlist);
+
+	playlist = makePlaylist(entries);
+	Playlist_Sort(playlist, playlistSortMode::STRNATCMP);
+	EXPECT_EQ(contents(*playlist), (std::vector<std::string> {"/b/Track 1.mp3", "/b/Track 10.mp3", "/b/track 2.mp3"}));
+	freePlaylist(playlist);
+
+	playlist = makePlaylist(entries);
+	Playlist_Sort(playlist, playlistSortMode::STRNATCASECMP);
+	EXPECT_EQ(contents(*playlist), (std::vector<std::string> {"/b/Track 1.mp3", "/b/track 2.mp3", "/b/Track 10.mp3"}));
+	freePlaylist(playlist);
+	EXPECT_EQ(playlist, nullptr);
+}
+
+TEST(Playlist, ShuffleIsAPermutationOfTheEntries) {
+	Playlist *playlist = makePlaylist({"a", "b", "c", "d", "e"});
+	playlist->shuffle(1234);
+	std::vector<std::string> shuffled = contents(*playlist);
+	std::sort(shuffled.begin(), shuffled.end());
+	EXPECT_EQ(shuffled, (std::vector<std::string> {"a", "b", "c", "d", "e"}));
+	freePlaylist(playlist);
+}
+
+TEST(Playlist, EditsInPlaybackOrder) {
+	Playlist *playlist = makePlaylist({"a", "b", "c"});
+	playlist->insert(1, strdup("x")); // play next after "a"
+	playlist->insert(playlist->size(), strdup("y")); // append
+	playlist->erase(3); // "c"
+	EXPECT_EQ(contents(*playlist), (std::vector<std::string> {"a", "x", "b", "y"}));
+	EXPECT_EQ(playlist->edits().size(), 4u);
+	freePlaylist(playlist);
+}
+
+// Audiobook-resume: the card restarts with the unedited playlist, so the stored track is the unedited position
+TEST(Playlist, ResumeIndexAfterInsert) {
+	Playlist *playlist = makePlaylist({"a", "b", "c", "d"});
+	playlist->insert(1, strdup("x")); // play next while at "a"
+	EXPECT_EQ(playlist->uneditedIndex(0), std::optional<size_t>(0));
+	EXPECT_EQ(playlist->uneditedIndex(1), std::nullopt); // "x" isn't stored
+	EXPECT_EQ(playlist->nextUnedited(1), 2u); // "a" finished: continue with "b"...
+	EXPECT_EQ(playlist->uneditedIndex(2), std::optional<size_t>(1)); // ...which is track 1 of the card
+	playlist->insert(playlist->size(), strdup("y")); // append
+	EXPECT_EQ(playlist->nextUnedited(5), playlist->size()); // only added entries left
+	EXPECT_EQ(playlist->uneditedIndex(playlist->size()), std::nullopt);
+	EXPECT_EQ(playlist->uneditedSize(), 4u);
+	freePlaylist(playlist);
+}
+
+TEST(Playlist, ResumeIndexAfterRemove) {
+	Playlist *playlist = makePlaylist({"a", "b", "c", "d", "e"});
+	playlist->erase(1); // "b" while at "d" (position 3, becomes 2)
+	EXPECT_EQ(playlist->at(2), "d");
+	EXPECT_EQ(playlist->uneditedIndex(2), std::optional<size_t>(3));
+	EXPECT_EQ(playlist->nextUnedited(3), 3u);
+	EXPECT_EQ(playlist->uneditedIndex(3), std::optional<size_t>(4));
+	EXPECT_EQ(playlist->uneditedSize(), 5u);
+	freePlaylist(playlist);
+}
+
+TEST(PlaylistEdits, PieceTableMapsPositions) {
+	PlaylistEdits edits(5);
+	EXPECT_FALSE(edits.isActive());
+	EXPECT_EQ(edits(3), 3u);
+	edits.erase(0);
+	edits.insert(2, 0); // added entry #0 at position 2
+	EXPECT_EQ(edits.size(), 5u);
+	const std::vector<size_t> expected = {1, 2, 5, 3, 4};
+	for (size_t i = 0; i < expected.size(); i++) {
+		EXPECT_EQ(edits(i), expected[i]) << "position " << i;
+	}
+	EXPECT_EQ(edits(5), SIZE_MAX);
+}
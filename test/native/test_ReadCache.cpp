@@ -0,0 +1,183 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "ReadCache.h"
+
+#include "HostFS.h"
+#include "HostSdCard.h"
+#include "SdCard.h"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr uint32_t trackBytes = 8 * READ_CACHE_BLOCK_SIZE + 1000; // the last block is a partial one
+constexpr uint32_t trackBlocks = 9;
+constexpr uint32_t sdBlock = 512;
+
+// Chunk-sizes like those the decoders request (refill of the input-buffer after a frame was decoded)
+constexpr size_t decoderChunks[] = {1600, 4096, 417, 2880, 1044};
+
+std::string pattern(uint32_t size, uint32_t seed) {
+	std::string content(size, '\0');
+	uint32_t value = seed;
+	for (char &c : content) {
+		value = value * 1664525u + 1013904223u;
+		c = static_cast<char>(value >> 24);
+	}
+	return content;
+}
+
+ReadCacheStats operator-(const ReadCacheStats &a, const ReadCacheStats &b) {
+	ReadCacheStats delta;
+	delta.hits = a.hits - b.hits;
+	delta.misses = a.misses - b.misses;
+	delta.bypassReads = a.bypassReads - b.bypassReads;
+	delta.blockLoads = a.blockLoads - b.blockLoads;
+	delta.bytesRequested = a.bytesRequested - b.bytesRequested;
+	delta.bytesFromCard = a.bytesFromCard - b.bytesFromCard;
+	return delta;
+}
+
+class ReadCacheTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		static const bool initialised = [] {
+			ReadCache_Init();
+			return true;
+		}();
+		(void) initialised;
+		ASSERT_TRUE(ReadCache_IsEnabled());
+		track_ = pattern(trackBytes, 1);
+		cover_ = pattern(3 * READ_CACHE_BLOCK_SIZE, 2);
+		dir_.writeFile("track.mp3", track_);
+		dir_.writeFile("cover.jpg", cover_);
+		card_ = HostSdCard_CreateImpl(HostFS_CreateImpl(dir_.path()), HostSdCard_Sdmmc1BitModel());
+		HostFS_Mount(card_);
+		ReadCache_GetStats(before_);
+	}
+	void TearDown() override {
+		HostFS_Mount(nullptr);
+	}
+
+	ReadCacheStats delta() const {
+		ReadCacheStats stats;
+		ReadCache_GetStats(stats);
+		return stats - before_;
+	}
+
+	// Reads from the current position in decoder-sized chunks and compares with the file's content
+	uint32_t readLikeDecoder(File &file, uint32_t bytes, uint32_t &reads) {
+		std::vector<uint8_t> buf(4096);
+		uint32_t done = 0;
+		for (size_t i = 0; done < bytes; i++) {
+			const uint32_t position = file.position();
+			const size_t size = std::min<size_t>(decoderChunks[i % std::size(decoderChunks)], bytes - done);
+			const size_t bytesRead = file.read(buf.data(), size);
+			reads++;
+			if (bytesRead == 0) {
+				break;
+			}
+			EXPECT_EQ(std::string(buf.begin(), buf.begin() + bytesRead), track_.substr(position, bytesRead)) << "at " << position;
+			done += bytesRead;
+		}
+		return done;
+	}
+
+	HostTempDir dir_;
+	fs::FSImplPtr card_;
+	std::string track_;
+	std::string cover_;
+	ReadCacheStats before_;
+};
+} // namespace
+
+// Every byte is read from card once, in whole cache-blocks: one miss per block, all other reads are hits
+TEST_F(ReadCacheTest, DecoderReadsAreServedFromBlocks) {
+	File file = gFSystemAudio.open("/track.mp3", FILE_READ);
+	ASSERT_TRUE(file);
+	HostSdCard_ResetStats(card_);
+	uint32_t reads = 0;
+	EXPECT_EQ(readLikeDecoder(file, trackBytes, reads), trackBytes);
+	uint8_t byte;
+	EXPECT_EQ(file.read(&byte, 1), 0u); // end of file
+	file.close();
+
+	const ReadCacheStats stats = delta();
+	EXPECT_EQ(stats.bytesFromCard, trackBytes);
+	EXPECT_EQ(stats.blockLoads, trackBlocks);
+	EXPECT_EQ(stats.misses, trackBlocks);
+	EXPECT_EQ(stats.hits, reads - trackBlocks);
+	EXPECT_EQ(stats.bypassReads, 0u);
+	EXPECT_GT(double(stats.hits) / (stats.hits + stats.misses), 0.9); // ~16 decoder-reads per block
+	EXPECT_EQ(HostSdCard_GetStats(card_).blocksRead, (trackBytes + sdBlock - 1) / sdBlock);
+}
+
+// A read behind a seek bypasses the cache (it may be a probe of the decoder); continuing reads load blocks again.
+// Seeking within a cached block is served from it.
+TEST_F(ReadCacheTest, SeekThenSequentialReads) {
+	File file = gFSystemAudio.open("/track.mp3", FILE_READ);
+	ASSERT_TRUE(file);
+	uint32_t reads = 0;
+	readLikeDecoder(file, 10000, reads);
+	ASSERT_TRUE(file.seek(100));
+	readLikeDecoder(file, 4096, reads);
+	ReadCacheStats stats = delta();
+	EXPECT_EQ(stats.bytesFromCard, READ_CACHE_BLOCK_SIZE);
+	EXPECT_EQ(stats.bypassReads, 0u);
+
+	constexpr uint32_t target = 5 * READ_CACHE_BLOCK_SIZE + 100;
+	ASSERT_TRUE(file.seek(target));
+	EXPECT_EQ(readLikeDecoder(file, trackBytes - target, reads), trackBytes - target);
+	file.close();
+
+	stats = delta();
+	EXPECT_EQ(stats.bypassReads, 1u);
+	EXPECT_EQ(stats.blockLoads, 1 + (trackBlocks - 5));
+	// block 0, the bypassed first chunk (1600 bytes) and blocks 5-8 (block 5 again, as a whole)
+	EXPECT_EQ(stats.bytesFromCard, READ_CACHE_BLOCK_SIZE + decoderChunks[0] + (trackBytes - 5 * READ_CACHE_BLOCK_SIZE));
+	EXPECT_GT(double(stats.hits) / (stats.hits + stats.misses), 0.85);
+}
+
+// Cover-art/explorer read beside the decoder (other task, gFSystem) and a decoder-file that lost the pool to one
+// opened later: both read the right data and neither evicts nor loads cache-blocks
+TEST_F(ReadCacheTest, NonOwnerReadersDontTouchTheCache) {
+	File file = gFSystemAudio.open("/track.mp3", FILE_READ);
+	ASSERT_TRUE(file);
+	std::atomic<bool> coverOk {false};
+	std::thread coverReader([this, &coverOk] {
+		File cover = gFSystem.open("/cover.jpg", FILE_READ);
+		std::string content;
+		char buf[700];
+		size_t bytesRead;
+		while (cover && (bytesRead = cover.read(reinterpret_cast<uint8_t *>(buf), sizeof(buf))) > 0) {
+			content.append(buf, bytesRead);
+		}
+		coverOk = content == cover_;
+	});
+	uint32_t reads = 0;
+	EXPECT_EQ(readLikeDecoder(file, 4 * READ_CACHE_BLOCK_SIZE, reads), 4 * READ_CACHE_BLOCK_SIZE);
+	coverReader.join();
+	EXPECT_TRUE(coverOk);
+	ReadCacheStats stats = delta();
+	EXPECT_EQ(stats.bytesFromCard, 4 * READ_CACHE_BLOCK_SIZE);
+	EXPECT_EQ(stats.misses, 4u);
+	EXPECT_EQ(stats.hits, reads - 4);
+
+	File next = gFSystemAudio.open("/track.mp3", FILE_READ); // prefetch of the next track takes the pool
+	ASSERT_TRUE(next);
+	EXPECT_EQ(readLikeDecoder(file, trackBytes - 4 * READ_CACHE_BLOCK_SIZE, reads), trackBytes - 4 * READ_CACHE_BLOCK_SIZE);
+	const ReadCacheStats afterDisplaced = delta();
+	EXPECT_EQ(afterDisplaced.bytesFromCard, stats.bytesFromCard); // passed through, not counted
+	EXPECT_EQ(afterDisplaced.blockLoads, stats.blockLoads);
+	file.close();
+
+	uint32_t nextReads = 0;
+	EXPECT_EQ(readLikeDecoder(next, READ_CACHE_BLOCK_SIZE, nextReads), READ_CACHE_BLOCK_SIZE); // closing file left the pool alone
+	EXPECT_EQ(delta().blockLoads, stats.blockLoads + 1);
+	next.close();
+}
@@ -0,0 +1,70 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "Rfid.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+constexpr uint8_t cardA[cardIdSize] = {1, 2, 3, 4};
+constexpr uint8_t cardB[cardIdSize] = {5, 6, 7, 8};
+} // namespace
+
+TEST(RfidPresence, CardBecomesStableAfterConfirmPolls) {
+	RfidPresenceTracker tracker;
+	RfidPresenceTracker_Init(tracker);
+	uint32_t now = 0;
+	for (uint8_t i = 1; i < RFID_PRESENT_CONFIRM_POLLS; i++) {
+		EXPECT_FALSE(RfidPresenceTracker_Update(tracker, true, cardA, now += 100).stableCardDetected);
+		EXPECT_EQ(tracker.state, RfidPresenceState::CandidatePresent);
+	}
+	EXPECT_TRUE(RfidPresenceTracker_Update(tracker, true, cardA, now += 100).stableCardDetected);
+	EXPECT_EQ(tracker.state, RfidPresenceState::PresentStable);
+	EXPECT_FALSE(RfidPresenceTracker_Update(tracker, true, cardA, now += 100).stableCardDetected); // reported once
+}
+
+TEST(RfidPresence, DifferentCardRestartsConfirmation) {
+	RfidPresenceTracker tracker;
+	RfidPresenceTracker_Init(tracker);
+	RfidPresenceTracker_Update(tracker, true, cardA, 0);
+	RfidPresenceTracker_Update(tracker, true, cardB, 100);
+	EXPECT_EQ(tracker.presentConfirmCount, 1);
+	EXPECT_EQ(memcmp(tracker.candidateCardId, cardB, cardIdSize), 0);
+}
+
+TEST(RfidPresence, RemovalNeedsPollsAndMinimumTime) {
+	RfidPresenceTracker tracker;
+	RfidPresenceTracker_Init(tracker);
+	uint32_t now = 0;
+	for (uint8_t i = 0; i < RFID_PRESENT_CONFIRM_POLLS; i++) {
+		RfidPresenceTracker_Update(tracker, true, cardA, now += 10);
+	}
+	ASSERT_TRUE(tracker.hasStableCard);
+
+	// enough negative polls, but too fast
+	for (uint8_t i = 0; i < RFID_REMOVED_CONFIRM_POLLS; i++) {
+		EXPECT_FALSE(RfidPresenceTracker_Update(tracker, false, nullptr, now += 10).stableCardRemoved);
+	}
+	EXPECT_EQ(tracker.state, RfidPresenceState::CandidateAbsent);
+	EXPECT_TRUE(RfidPresenceTracker_Update(tracker, false, nullptr, now += RFID_REMOVED_MIN_MS).stableCardRemoved);
+	EXPECT_EQ(tracker.state, RfidPresenceState::NoCard);
+
+	// pause only after the grace-period
+	EXPECT_FALSE(RfidPresenceTracker_ShouldPause(tracker, now));
+	EXPECT_TRUE(RfidPresenceTracker_ShouldPause(tracker, now + RFID_REAPPLY_GRACE_MS));
+	EXPECT_FALSE(RfidPresenceTracker_ShouldPause(tracker, now + RFID_REAPPLY_GRACE_MS)); // once
+}
+
+TEST(RfidPresence, ShortDropoutKeepsCard) {
+	RfidPresenceTracker tracker;
+	RfidPresenceTracker_Init(tracker);
+	uint32_t now = 0;
+	for (uint8_t i = 0; i < RFID_PRESENT_CONFIRM_POLLS; i++) {
+		RfidPresenceTracker_Update(tracker, true, cardA, now += 10);
+	}
+	RfidPresenceTracker_Update(tracker, false, nullptr, now += 1000);
+	const RfidPresenceUpdate update = RfidPresenceTracker_Update(tracker, true, cardA, now += 10);
+	EXPECT_FALSE(update.stableCardDetected);
+	EXPECT_FALSE(update.stableCardRemoved);
+	EXPECT_EQ(tracker.state, RfidPresenceState::PresentStable);
+}
@@ -0,0 +1,195 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "SdCard.h"
+
+#include "HostFS.h"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+class SdCardTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		HostFS_Mount(HostFS_CreateImpl(dir_.path()));
+	}
+	void TearDown() override {
+		HostFS_Mount(nullptr);
+	}
+
+	std::vector<std::string> build(const char *path, uint32_t playMode) {
+		std::vector<std::string> result;
+		std::optional<Playlist *> playlist = SdCard_ReturnPlaylist(path, playMode);
+		if (!playlist) {
+			ADD_FAILURE() << "no playlist for " << path;
+			return result;
+		}
+		for (size_t i = 0; i < (*playlist)->size(); i++) {
+			result.push_back((*playlist)->at(i).c_str());
+		}
+		freePlaylist(*playlist);
+		return result;
+	}
+
+	HostTempDir dir_;
+};
+} // namespace
+
+TEST_F(SdCardTest, DirectoryContainsValidFilesOnly) {
+	dir_.writeFile("album/02.mp3");
+	dir_.writeFile("album/01.mp3");
+	dir_.writeFile("album/cover.jpg");
+	dir_.writeFile("album/.hidden.mp3");
+	dir_.writeFile("album/sub/03.mp3");
+
+	std::vector<std::string> entries = build("/album", ALL_TRACKS_OF_DIR_SORTED);
+	std::sort(entries.begin(), entries.end()); // sorting is done by the AudioPlayer, enumeration-order is the card's
+	EXPECT_EQ(entries, (std::vector<std::string> {"/album/01.mp3", "/album/02.mp3"}));
+}
+
+TEST_F(SdCardTest, SingleFile) {
+	dir_.writeFile("a/track.mp3");
+	EXPECT_EQ(build("/a/track.mp3", SINGLE_TRACK), (std::vector<std::string> {"/a/track.mp3"}));
+}
+
+TEST_F(SdCardTest, MissingPathHasNoPlaylist) {
+	EXPECT_FALSE(SdCard_ReturnPlaylist("/missing", ALL_TRACKS_OF_DIR_SORTED));
+}
+
+TEST_F(SdCardTest, SingleRandomTrackOfDirectory) {
+	for (int i = 0; i < 20; i++) {
+		dir_.writeFile("d/" + std::to_string(i) + ".mp3");
+	}
+	const std::vector<std::string> entries = build("/d", SINGLE_TRACK_OF_DIR_RANDOM);
+	ASSERT_EQ(entries.size(), 1u);
+	EXPECT_EQ(entries[0].rfind("/d/", 0), 0u);
+}
+
+TEST_F(SdCardTest, ExtendedM3u) {
+	dir_.writeFile("list.m3u", "#EXTM3U\n#EXTINF:123,Artist - Title\n/music/a.mp3\r\n#EXTINF:1,x\nhttp://example.org/stream\n");
+	EXPECT_EQ(build("/list.m3u", LOCAL_M3U), (std::vector<std::string> {"/music/a.mp3", "http://example.org/stream"}));
+}
+
+TEST_F(SdCardTest, PlainM3u) {
+	dir_.writeFile("list.m3u", "/music/a.mp3\n/music/b.mp3\n");
+	EXPECT_EQ(build("/list.m3u", LOCAL_M3U), (std::vector<std::string> {"/music/a.mp3", "/music/b.mp3"}));
+}
+
+TEST_F(SdCardTest, RecursivePlaylistIsVirtualAndSortedPerDirectory) {
+	dir_.writeFile("r/b/2.mp3");
+	dir_.writeFile("r/b/10.mp3");
+	dir_.writeFile("r/a/1.mp3");
+	dir_.writeFile("r/0.mp3");
+	dir_.writeFile("r/.hidden/x.mp3");
+	dir_.writeFile("r/a/notes.txt");
+
+	std::optional<Playlist *> playlist = SdCard_ReturnPlaylist("/r", ALL_TRACKS_OF_ALL_SUBDIRS_SORTED);
+	ASSERT_TRUE(playlist);
+	EXPECT_TRUE((*playlist)->isVirtual());
+	std::vector<std::string> entries;
+	for (size_t i = 0; i < (*playlist)->size(); i++) {
+		entries.push_back((*playlist)->at(i).c_str());
+	}
+	// natural order of the default sort-mode, directories sort with their trailing '/'
+	EXPECT_EQ(entries, (std::vector<std::string> {"/r/0.mp3", "/r/a/1.mp3", "/r/b/2.mp3", "/r/b/10.mp3"}));
+	freePlaylist(*playlist);
+}
+
+// Entries of a virtual playlist are copied under the index' mutex: concurrent readers (audio-task and webserver)
+// never see an entry that was replaced in the resolve-window meanwhile
+TEST_F(SdCardTest, VirtualPlaylistConcurrentReaders) {
+	constexpr size_t files = 64;
+	for (size_t i = 0; i < files; i++) {
+		char name[32];
+		snprintf(name, sizeof(name), "v/%03zu.mp3", i);
+		dir_.writeFile(name);
+	}
+	std::optional<Playlist *> playlist = SdCard_ReturnPlaylist("/v", ALL_TRACKS_OF_ALL_SUBDIRS_SORTED);
+	ASSERT_TRUE(playlist);
+	ASSERT_EQ((*playlist)->size(), files);
+
+	std::atomic<size_t> mismatches {0};
+	auto reader = [&](size_t offset) {
+		for (size_t round = 0; round < 20; round++) {
+			for (size_t i = 0; i < files; i++) {
+				const size_t index = (i * 7 + offset) % files;
+				char expected[32];
+				snprintf(expected, sizeof(expected), "/v/%03zu.mp3", index);
+				if ((*playlist)->at(index) != expected) {
+					mismatches++;
+				}
+			}
+		}
+	};
+	std::thread a(reader, 0), b(reader, 3);
+	a.join();
+	b.join();
+	EXPECT_EQ(mismatches, 0u);
+	freePlaylist(*playlist);
+}
+
+// The index-files of a playlist that is still played are never reused: neither by the next ones nor after a failed
+// generation
+TEST_F(SdCardTest, VirtualPlaylistKeepsItsIndexWhileInUse) {
+	dir_.writeFile("p/1.mp3");
+	dir_.writeFile("p/2.mp3");
+	dir_.writeFile("q/x/3.mp3");
+	std::optional<Playlist *> playing = SdCard_ReturnPlaylist("/p", ALL_TRACKS_OF_ALL_SUBDIRS_SORTED);
+	ASSERT_TRUE(playing);
+
+	for (int i = 0; i < 3; i++) { // next playlists, each released before the following one
+		EXPECT_EQ(build("/q", ALL_TRACKS_OF_ALL_SUBDIRS_SORTED), (std::vector<std::string> {"/q/x/3.mp3"}));
+	}
+	std::optional<Playlist *> queued = SdCard_ReturnPlaylist("/q", ALL_TRACKS_OF_ALL_SUBDIRS_SORTED);
+	std::optional<Playlist *> next = SdCard_ReturnPlaylist("/q", ALL_TRACKS_OF_ALL_SUBDIRS_SORTED);
+	ASSERT_TRUE(queued);
+	ASSERT_TRUE(next);
+	EXPECT_FALSE(SdCard_ReturnPlaylist("/q", ALL_TRACKS_OF_ALL_SUBDIRS_SORTED)); // all slots in use
+	freePlaylist(*queued);
+	freePlaylist(*next);
+
+	std::vector<std::string> entries; // resolved from the index-files only now
+	for (size_t i = 0; i < (*playing)->size(); i++) {
+		entries.push_back((*playing)->at(i).c_str());
+	}
+	EXPECT_EQ(entries, (std::vector<std::string> {"/p/1.mp3", "/p/2.mp3"}));
+	freePlaylist(*playing);
+}
+
+TEST_F(SdCardTest, ListDirectoryHidesHiddenEntriesOfRoot) {
+	dir_.writeFile("album/01.mp3");
+	dir_.writeFile("album/.hidden.mp3");
+	dir_.writeFile("track.mp3");
+	dir_.writeFile(".playlistIndex0");
+
+	std::map<std::string, bool> root;
+	EXPECT_TRUE(SdCard_ListDirectory(gFSystem, "/", [&root](const String &name, bool isDir) { root[name.c_str()] = isDir; }));
+	EXPECT_EQ(root, (std::map<std::string, bool> {{"album", true}, {"track.mp3", false}}));
+
+	// like before: only entries of the root-directory start with "/."
+	std::map<std::string, bool> album;
+	EXPECT_TRUE(SdCard_ListDirectory(gFSystem, "/album", [&album](const String &name, bool isDir) { album[name.c_str()] = isDir; }));
+	EXPECT_EQ(album, (std::map<std::string, bool> {{".hidden.mp3", false}, {"01.mp3", false}}));
+
+	EXPECT_FALSE(SdCard_ListDirectory(gFSystem, "/missing", [](const String &, bool) { }));
+	EXPECT_FALSE(SdCard_ListDirectory(gFSystem, "/track.mp3", [](const String &, bool) { }));
+}
+
+TEST_F(SdCardTest, DeletePathRemovesFilesAndTrees) {
+	dir_.writeFile("album/01.mp3");
+	dir_.writeFile("album/cd1/02.mp3");
+	dir_.writeFile("album/cd2/03.mp3");
+	dir_.writeFile("track.mp3");
+
+	EXPECT_TRUE(SdCard_DeletePath(gFSystem, "/track.mp3"));
+	EXPECT_FALSE(gFSystem.exists("/track.mp3"));
+	EXPECT_TRUE(SdCard_DeletePath(gFSystem, "/album"));
+	EXPECT_FALSE(gFSystem.exists("/album"));
+	EXPECT_FALSE(SdCard_DeletePath(gFSystem, "/album"));
+}
@@ -0,0 +1,242 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "SeekTable.h"
+
+#include "HostFS.h"
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+// MPEG-1 layer III, 44.1 kHz, stereo: 1152 samples (26.122 ms) per frame
+constexpr uint32_t frameUs = 1152u * 1000000u / 44100u;
+constexpr uint32_t frameBytes128k = 417;
+constexpr uint32_t frameBytes64k = 208;
+
+std::string be16(uint32_t value) {
+	return {static_cast<char>(value >> 8), static_cast<char>(value)};
+}
+
+std::string be32(uint32_t value) {
+	return {static_cast<char>(value >> 24), static_cast<char>(value >> 16), static_cast<char>(value >> 8), static_cast<char>(value)};
+}
+
+// A frame of the given bitrate; payload (Xing/VBRI-header) is placed behind the side-info
+std::string mpegFrame(bool kbps128, const std::string &payload = std::string()) {
+	std::string frame = {'\xFF', '\xFB', kbps128 ? '\x90' : '\x50', '\x00'};
+	frame += std::string(32, '\0') + payload;
+	frame.resize(kbps128 ? frameBytes128k : frameBytes64k, '\0');
+	return frame;
+}
+
+std::string frames(size_t count, bool kbps128) {
+	std::string result;
+	for (size_t i = 0; i < count; i++) {
+		result += mpegFrame(kbps128);
+	}
+	return result;
+}
+
+std::string id3Tag(uint32_t bodySize) {
+	std::string tag = "ID3";
+	tag += {3, 0, 0, static_cast<char>((bodySize >> 21) & 0x7F), static_cast<char>((bodySize >> 14) & 0x7F), static_cast<char>((bodySize >> 7) & 0x7F), static_cast<char>(bodySize & 0x7F)};
+	return tag + std::string(bodySize, '\0');
+}
+
+std::string atom(const char *type, const std::string &data) {
+	return be32(data.size() + 8) + type + data;
+}
+
+// Audio-track of an MP4: chunk-offsets (stco), samples per chunk (stsc) and their durations (stts)
+struct Mp4Fixture {
+	uint32_t timescale;
+	std::vector<std::pair<uint32_t, uint32_t>> stts; // sample-count, delta
+	std::vector<std::pair<uint32_t, uint32_t>> stsc; // first chunk, samples per chunk
+	std::vector<uint32_t> stco;
+};
+
+std::string mp4Track(const Mp4Fixture &fixture, const char *handler) {
+	std::string stts = be32(0) + be32(fixture.stts.size());
+	for (const auto &entry : fixture.stts) {
+		stts += be32(entry.first) + be32(entry.second);
+	}
+	std::string stsc = be32(0) + be32(fixture.stsc.size());
+	for (const auto &entry : fixture.stsc) {
+		stsc += be32(entry.first) + be32(entry.second) + be32(1);
+	}
+	std::string stco = be32(0) + be32(fixture.stco.size());
+	for (uint32_t offset : fixture.stco) {
+		stco += be32(offset);
+	}
+	const std::string mdhd = be32(0) + be32(0) + be32(0) + be32(fixture.timescale) + be32(0) + be32(0);
+	const std::string hdlr = be32(0) + be32(0) + handler + std::string(12, '\0');
+	const std::string stbl = atom("stbl", atom("stts", stts) + atom("stsc", stsc) + atom("stco", stco));
+	return atom("trak", atom("mdia", atom("mdhd", mdhd) + atom("hdlr", hdlr) + atom("minf", stbl)));
+}
+
+class SeekTableTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		HostFS_Mount(HostFS_CreateImpl(dir_.path()));
+		static const bool initialised = [] {
+			SeekTable_Init();
+			return true;
+		}();
+		(void) initialised;
+		SeekTable_Select(nullptr);
+	}
+	void TearDown() override {
+		SeekTable_Select(nullptr);
+		HostFS_Mount(nullptr);
+	}
+
+	// Selects the file and waits until the task built its table
+	bool selectAndWait(const char *path) {
+		SeekTable_Select(path);
+		uint32_t durationMs;
+		for (int i = 0; i < 200; i++) {
+			if (SeekTable_GetDurationMs(durationMs)) {
+				return true;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		return false;
+	}
+
+	uint32_t offsetFor(uint32_t timeMs) {
+		uint32_t offset = UINT32_MAX;
+		EXPECT_TRUE(SeekTable_OffsetForTime(timeMs, offset));
+		return offset;
+	}
+	uint32_t timeFor(uint32_t offset) {
+		uint32_t timeMs = UINT32_MAX;
+		EXPECT_TRUE(SeekTable_TimeForOffset(offset, timeMs));
+		return timeMs;
+	}
+	uint32_t duration() {
+		uint32_t durationMs = 0;
+		EXPECT_TRUE(SeekTable_GetDurationMs(durationMs));
+		return durationMs;
+	}
+
+	HostTempDir dir_;
+};
+} // namespace
+
+// Xing-TOC: every percent of the duration maps to toc[i] / 256 of the audio-data
+TEST_F(SeekTableTest, Mp3XingToc) {
+	constexpr uint32_t frameCount = 1000;
+	constexpr uint32_t bytes = frameCount * frameBytes128k;
+	uint8_t toc[100];
+	for (uint32_t i = 0; i < 100; i++) {
+		toc[i] = i * i * 256 / 10000; // most of the data is at the end
+	}
+	const std::string xing = std::string("Xing") + be32(0x07) + be32(frameCount) + be32(bytes) + std::string(reinterpret_cast<const char *>(toc), sizeof(toc));
+	dir_.writeFile("xing.mp3", mpegFrame(true, xing) + frames(frameCount - 1, true));
+	ASSERT_TRUE(selectAndWait("/xing.mp3"));
+
+	const uint32_t durationMs = uint64_t(frameCount) * 1152 * 1000 / 44100;
+	EXPECT_EQ(duration(), durationMs);
+	const uint32_t halfMs = durationMs * 50 / 100;
+	EXPECT_EQ(offsetFor(halfMs), toc[50] * bytes / 256);
+	EXPECT_EQ(timeFor(toc[50] * bytes / 256), halfMs);
+	const uint32_t betweenMs = (durationMs * 80 / 100 + durationMs * 81 / 100) / 2; // interpolated between two entries
+	EXPECT_NEAR(offsetFor(betweenMs), (toc[80] + toc[81]) * bytes / 512, 1.0 * bytes / 256);
+	EXPECT_EQ(offsetFor(durationMs + 1000), bytes); // beyond the end: end of the audio-data
+}
+
+// VBRI-TOC: byte-size of every framesPerEntry frames
+TEST_F(SeekTableTest, Mp3VbriToc) {
+	constexpr uint32_t framesPerEntry = 100;
+	const std::vector<uint32_t> sizes = {30000, 50000, 20000, 41700, 60000, 10000};
+	std::string vbri = std::string("VBRI") + be16(1) + be16(0) + be16(75);
+	uint32_t total = 0;
+	for (uint32_t size : sizes) {
+		total += size;
+	}
+	vbri += be32(total) + be32(framesPerEntry * sizes.size()) + be16(sizes.size()) + be16(1) + be16(2) + be16(framesPerEntry);
+	for (uint32_t size : sizes) {
+		vbri += be16(size);
+	}
+	dir_.writeFile("vbri.mp3", mpegFrame(true, vbri) + frames(total / frameBytes128k, true));
+	ASSERT_TRUE(selectAndWait("/vbri.mp3"));
+
+	uint32_t offset = 0;
+	for (size_t i = 0; i < sizes.size(); i++) {
+		const uint32_t timeMs = uint64_t(i) * framesPerEntry * 1152 * 1000 / 44100;
+		EXPECT_EQ(offsetFor(timeMs), offset) << "entry " << i;
+		EXPECT_EQ(timeFor(offset), timeMs) << "entry " << i;
+		offset += sizes[i];
+	}
+	EXPECT_EQ(duration(), uint64_t(sizes.size()) * framesPerEntry * 1152 * 1000 / 44100);
+}
+
+// No TOC: the frame-scan finds the change of the bitrate, where an average bitrate would be off by seconds
+TEST_F(SeekTableTest, Mp3FrameScan) {
+	constexpr uint32_t tagBytes = 10 + 990;
+	constexpr uint32_t framesEach = 200;
+	dir_.writeFile("scan.mp3", id3Tag(990) + frames(framesEach, true) + frames(framesEach, false));
+	ASSERT_TRUE(selectAndWait("/scan.mp3"));
+
+	EXPECT_EQ(duration(), 2 * framesEach * frameUs / 1000);
+	EXPECT_EQ(offsetFor(0), tagBytes);
+	auto expectedOffset = [](uint32_t timeMs) { // within the frame that plays at timeMs
+		const uint32_t frame = uint64_t(timeMs) * 1000 / frameUs;
+		return frame < framesEach ? tagBytes + frame * frameBytes128k : tagBytes + framesEach * frameBytes128k + (frame - framesEach) * frameBytes64k;
+	};
+	for (uint32_t timeMs : {2500u, 5000u, 7000u, 9500u}) {
+		EXPECT_NEAR(offsetFor(timeMs), expectedOffset(timeMs), frameBytes128k) << timeMs << " ms";
+	}
+	const uint32_t secondHalf = tagBytes + framesEach * frameBytes128k + 100 * frameBytes64k;
+	EXPECT_NEAR(timeFor(secondHalf), (framesEach + 100) * frameUs / 1000, frameUs / 1000 + 1);
+}
+
+// MP4: points are the chunk-offsets at the start-time of their first sample; a video-track is skipped
+TEST_F(SeekTableTest, M4aSampleTables) {
+	const Mp4Fixture video = {90000, {{10, 3000}}, {{1, 10}}, {50000}};
+	const Mp4Fixture audio = {1000, {{12, 500}, {6, 1000}}, {{1, 4}, {4, 2}}, {2000, 6000, 7000, 11000, 11500, 15000}};
+	const std::string ftyp = atom("ftyp", std::string("M4A ") + be32(0));
+	std::string file = ftyp + atom("moov", mp4Track(video, "vide") + mp4Track(audio, "soun"));
+	file += atom("mdat", std::string(16000, '\0'));
+	dir_.writeFile("book.m4a", file);
+	ASSERT_TRUE(selectAndWait("/book.m4a"));
+
+	// chunks 1-3: 4 samples of 500 ms, chunks 4-6: 2 samples of 1000 ms
+	const std::vector<uint32_t> startMs = {0, 2000, 4000, 6000, 8000, 10000};
+	for (size_t i = 0; i < startMs.size(); i++) {
+		EXPECT_EQ(offsetFor(startMs[i]), audio.stco[i]) << "chunk " << i + 1;
+		EXPECT_EQ(timeFor(audio.stco[i]), startMs[i]) << "chunk " << i + 1;
+	}
+	EXPECT_EQ(offsetFor(9000), (audio.stco[4] + audio.stco[5]) / 2); // interpolated between chunk 5 and 6
+	EXPECT_EQ(timeFor(6500), 3000u); // between chunk 2 and 3
+	EXPECT_EQ(duration(), 12000u);
+}
+
+// A table is cached on SD: selecting the file again loads it at once (resume needs it before playback starts)
+TEST_F(SeekTableTest, CachedTableIsLoadedOnSelect) {
+	dir_.writeFile("cached.mp3", frames(100, true) + frames(100, false));
+	ASSERT_TRUE(selectAndWait("/cached.mp3"));
+	const uint32_t offset = offsetFor(3000);
+
+	SeekTable_Select(nullptr);
+	uint32_t durationMs;
+	EXPECT_FALSE(SeekTable_GetDurationMs(durationMs));
+	SeekTable_Select("/cached.mp3");
+	EXPECT_TRUE(SeekTable_GetDurationMs(durationMs)); // without waiting for the task
+	EXPECT_EQ(offsetFor(3000), offset);
+}
+
+TEST_F(SeekTableTest, FilesWithoutTable) {
+	dir_.writeFile("a.flac", std::string("fLaC") + std::string(4096, '\0'));
+	dir_.writeFile("noise.mp3", std::string(8192, '\x55'));
+	for (const char *path : {"/a.flac", "/noise.mp3"}) {
+		SeekTable_Select(path);
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		uint32_t offset;
+		EXPECT_FALSE(SeekTable_OffsetForTime(1000, offset)) << path;
+	}
+}
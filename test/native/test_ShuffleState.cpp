@@ -0,0 +1,145 @@
+#include <Arduino.h>
+#include "settings.h"
+
+#include "ShuffleState.h"
+
+#include <Preferences.h>
+#include <gtest/gtest.h>
+#include <string>
+
+namespace {
+constexpr char tag[] = "123045067089"; // as gCurrentRfidTagId
+constexpr char folder[] = "/Hoerspiele";
+
+Playlist *makePlaylist(size_t size) {
+	Playlist *playlist = new Playlist();
+	for (size_t i = 0; i < size; i++) {
+		playlist->push_back(strdup((std::string(folder) + "/" + std::to_string(i) + ".mp3").c_str()));
+	}
+	return playlist;
+}
+
+class ShuffleStateTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		HostPreferences_Reset();
+		ShuffleState_Init();
+	}
+	void TearDown() override {
+		ShuffleState_Forget(tag);
+		for (Playlist *playlist : playlists_) {
+			freePlaylist(playlist);
+		}
+	}
+
+	// Card applied: the bag is restored and handed to the "audio-task"
+	Playlist *start(size_t size, size_t &startTrack) {
+		Playlist *playlist = makePlaylist(size);
+		playlists_.push_back(playlist);
+		startTrack = ShuffleState_Restore(tag, folder, playlist);
+		ShuffleState_Activate(playlist);
+		return playlist;
+	}
+
+	std::vector<Playlist *> playlists_;
+};
+} // namespace
+
+TEST_F(ShuffleStateTest, FinishedTracksAreSavedInBatches) {
+	size_t startTrack;
+	Playlist *playlist = start(20, startTrack);
+	EXPECT_EQ(startTrack, 0u);
+
+	uint32_t writes = HostPreferences_Writes();
+	for (size_t track = 0; track < 4; track++) {
+		ShuffleState_TrackFinished(playlist, track);
+	}
+	EXPECT_EQ(HostPreferences_Writes(), writes);
+	ShuffleState_TrackFinished(playlist, 4);
+	EXPECT_GT(HostPreferences_Writes(), writes);
+
+	writes = HostPreferences_Writes();
+	ShuffleState_TrackFinished(playlist, 5);
+	EXPECT_EQ(HostPreferences_Writes(), writes);
+	ShuffleState_Flush(); // pause
+	EXPECT_GT(HostPreferences_Writes(), writes);
+	writes = HostPreferences_Writes();
+	ShuffleState_Flush();
+	EXPECT_EQ(HostPreferences_Writes(), writes);
+}
+
+TEST_F(ShuffleStateTest, UnsavedTracksAreSavedWhenThePlaylistChanges) {
+	size_t startTrack;
+	Playlist *playlist = start(20, startTrack);
+	ShuffleState_TrackFinished(playlist, 0);
+	ShuffleState_TrackFinished(playlist, 1);
+	start(20, startTrack); // same card again: a new playlist replaces the active one
+	EXPECT_EQ(startTrack, 2u);
+}
+
+// Jumping to the last track leaves tracks out; the bag isn't complete before they were played
+TEST_F(ShuffleStateTest, BagIsCompleteWhenAllTracksWerePlayed) {
+	size_t startTrack;
+	Playlist *playlist = start(5, startTrack);
+	const uint32_t seed = playlist->order().seed();
+	ShuffleState_TrackFinished(playlist, 0);
+	ShuffleState_TrackFinished(playlist, 4);
+	EXPECT_FALSE(ShuffleState_NewBag(playlist));
+	EXPECT_EQ(playlist->order().seed(), seed);
+	EXPECT_EQ(ShuffleState_NextTrack(playlist, 0), 1u);
+
+	for (size_t track = 1; track < 4; track++) {
+		EXPECT_EQ(ShuffleState_NextTrack(playlist, track), track);
+		ShuffleState_TrackFinished(playlist, track);
+	}
+	EXPECT_EQ(ShuffleState_NextTrack(playlist, 0), 5u);
+	EXPECT_TRUE(ShuffleState_NewBag(playlist));
+	EXPECT_NE(playlist->order().seed(), seed);
+	EXPECT_EQ(ShuffleState_NextTrack(playlist, 0), 0u);
+}
+
+TEST_F(ShuffleStateTest, RestoredBagContinuesWithLeftOutTracks) {
+	size_t startTrack;
+	Playlist *playlist = start(5, startTrack);
+	const uint32_t seed = playlist->order().seed();
+	ShuffleState_TrackFinished(playlist, 0);
+	ShuffleState_TrackFinished(playlist, 1);
+	ShuffleState_TrackFinished(playlist, 4);
+	ShuffleState_Flush(); // stop at the end of the playlist
+
+	playlist = start(5, startTrack);
+	EXPECT_EQ(playlist->order().seed(), seed);
+	EXPECT_EQ(startTrack, 2u);
+	EXPECT_EQ(ShuffleState_NextTrack(playlist, 3), 3u);
+	EXPECT_EQ(ShuffleState_NextTrack(playlist, 4), 5u);
+}
+
+TEST_F(ShuffleStateTest, CompleteBagIsNotRestored) {
+	size_t startTrack;
+	Playlist *playlist = start(5, startTrack);
+	const uint32_t seed = playlist->order().seed();
+	for (size_t track = 0; track < 5; track++) {
+		ShuffleState_TrackFinished(playlist, track);
+	}
+	ShuffleState_Flush();
+
+	playlist = start(5, startTrack);
+	EXPECT_NE(playlist->order().seed(), seed);
+	EXPECT_EQ(startTrack, 0u);
+}
+
+// Without a bitmap (playlist bigger than SHUFFLE_STATE_MAX_TRACKS) only the position is kept
+TEST_F(ShuffleStateTest, BigPlaylistKeepsPosition) {
+	size_t startTrack;
+	Playlist *playlist = start(SHUFFLE_STATE_MAX_TRACKS + 1, startTrack);
+	const uint32_t seed = playlist->order().seed();
+	ShuffleState_TrackFinished(playlist, 0);
+	ShuffleState_TrackFinished(playlist, 7);
+	EXPECT_EQ(ShuffleState_NextTrack(playlist, 1), 1u);
+	EXPECT_FALSE(ShuffleState_NewBag(playlist));
+	ShuffleState_Flush();
+
+	playlist = start(SHUFFLE_STATE_MAX_TRACKS + 1, startTrack);
+	EXPECT_EQ(playlist->order().seed(), seed);
+	EXPECT_EQ(startTrack, 8u);
+}